@@ -1,6 +1,8 @@
 #include "admin.h"
 #include "window.h"
 #include "scene.h"
+#include "gesture.h"
+#include "gl_state.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,6 +14,7 @@
 #endif
 
 #include <iostream>
+#include <cstdio>
 #include <cmath>
 #include <algorithm>
 
@@ -35,75 +38,30 @@ bool isRunningAsAdmin() {
     #endif
 }
 
-// Check if click is in top-right 64x64 area and handle tetra-click detection
-bool checkTetraClick(WindowData& wd, double xpos, double ypos, int windowWidth, int windowHeight, double currentTime) {
-    if (!wd.isAdmin) return false;
-    
-    // Top-right 64x64 area
-    double topRightX = windowWidth - 64.0;
-    double topRightY = 0.0;
-    
-    // Check if click is in top-right 64x64 area
-    if (xpos >= topRightX && xpos <= windowWidth && ypos >= topRightY && ypos <= 64.0) {
-        // Check if we need to reset the click sequence (too much time passed or outside time window)
-        const double TETRA_CLICK_TIME_WINDOW = 2.0; // 1.5-2 seconds
-        
-        if (wd.adminClickCount == 0 || (currentTime - wd.adminClickStartTime) > TETRA_CLICK_TIME_WINDOW) {
-            // Start new sequence
-            wd.adminClickCount = 1;
-            wd.adminClickStartTime = currentTime;
-            wd.adminClickTimes.clear();
-            wd.adminClickPositions.clear();
-            wd.adminClickTimes.push_back(currentTime);
-            wd.adminClickPositions.push_back(std::make_pair(xpos, ypos));
-            std::cout << "[DEBUG] Admin click sequence started: 1/4" << std::endl;
-        } else {
-            // Continue sequence
-            wd.adminClickCount++;
-            wd.adminClickTimes.push_back(currentTime);
-            wd.adminClickPositions.push_back(std::make_pair(xpos, ypos));
-            std::cout << "[DEBUG] Admin click: " << wd.adminClickCount << "/4" << std::endl;
-            
-            // Check if we have 4 clicks within the time window
-            if (wd.adminClickCount >= 4 && (currentTime - wd.adminClickStartTime) <= TETRA_CLICK_TIME_WINDOW) {
-                // Tetra-click detected! Activate admin mode
-                wd.adminModeActive = true;
-                wd.state = DisplayState::ADMIN_SCENE;
-                wd.currentAdminScene = "scenes/admin.scene.json";
-                wd.stateStartTime = currentTime;
-                std::cout << "[DEBUG] Admin mode activated!" << std::endl;
-                return true;
-            }
-        }
-    } else {
-        // Click outside the area - reset sequence
-        if (wd.adminClickCount > 0) {
-            wd.adminClickCount = 0;
-            wd.adminClickStartTime = 0.0;
-            wd.adminClickTimes.clear();
-            wd.adminClickPositions.clear();
-        }
-    }
-    
-    return false;
+// Handle a recognized tetra-click (four clicks in the top-right 64x64 area
+// within 2 seconds, see the gesture table in render.cpp)
+bool checkTetraClick(WindowData& wd, const Gesture& gesture) {
+    if (!wd.isAdmin || wd.adminModeActive) return false;
+    
+    // Tetra-click detected! Activate admin mode
+    wd.adminModeActive = true;
+    wd.adminClickCount = 0;
+    wd.state = DisplayState::ADMIN_SCENE;
+    wd.currentAdminScene = "scenes/admin.scene.json";
+    wd.stateStartTime = gesture.time;
+    std::cout << "[DEBUG] Admin mode activated!" << std::endl;
+    return true;
 }
 
 // Render "admin mode" text at bottom-left in red and tetra-click indicator
 void renderAdminModeText(int windowWidth, int windowHeight) {
     // Set up 2D rendering
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+    setGLOrtho2D(windowWidth, windowHeight);
     
     // This is a placeholder - actual text rendering would need a font library
     // For now, just draw a red rectangle indicator at bottom-left
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     glColor4f(1.0f, 0.0f, 0.0f, 0.8f); // Red
     glBegin(GL_QUADS);
         glVertex2f(10.0f, 10.0f);
@@ -111,12 +69,6 @@ void renderAdminModeText(int windowWidth, int windowHeight) {
         glVertex2f(150.0f, 30.0f);
         glVertex2f(10.0f, 30.0f);
     glEnd();
-    glDisable(GL_BLEND);
-    
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
 }
 
 // Render tetra-click indicator in top-right corner
@@ -124,17 +76,10 @@ void renderTetraClickIndicator(int windowWidth, int windowHeight, int clickCount
     if (clickCount <= 0 || clickCount > 4) return;
     
     // Set up 2D rendering
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+    setGLOrtho2D(windowWidth, windowHeight);
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     // Draw indicator in top-right 64x64 area
     float x = windowWidth - 64.0f;
@@ -155,47 +100,6 @@ void renderTetraClickIndicator(int windowWidth, int windowHeight, int clickCount
             glVertex2f(x + 10.0f, barY + barHeight);
         glEnd();
     }
-    
-    glDisable(GL_BLEND);
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-    
-    // Disable texturing
-    glDisable(GL_TEXTURE_2D);
-    
-    // Enable blending for text
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // Set red color
-    glColor3f(1.0f, 0.0f, 0.0f); // Red
-    
-    // Simple text rendering using quads (you can improve this with proper font rendering)
-    // For now, draw a small rectangle as placeholder - proper text rendering would need font loading
-    float textX = 10.0f;
-    float textY = 10.0f;
-    float textWidth = 120.0f;
-    float textHeight = 20.0f;
-    
-    // Draw red rectangle as placeholder for "admin mode" text
-    glBegin(GL_QUADS);
-    glVertex2f(textX, textY);
-    glVertex2f(textX + textWidth, textY);
-    glVertex2f(textX + textWidth, textY + textHeight);
-    glVertex2f(textX, textY + textHeight);
-    glEnd();
-    
-    glDisable(GL_BLEND);
-    glEnable(GL_TEXTURE_2D);
-    
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
 }
 
 // Load admin scene
@@ -203,9 +107,22 @@ bool loadAdminScene(const std::string& sceneFile, Scene& scene) {
     return loadScene(sceneFile, scene);
 }
 
-// Handle admin click (widget interaction)
-void handleAdminClick(WindowData& wd, double xpos, double ypos, int windowWidth, int windowHeight, double currentTime) {
-    // This will be called when clicking on admin scene widgets
-    // Handle tab switching and control button clicks here
-    // For now, placeholder implementation
+// Handle a click on an admin scene widget (resolved by the hit index in render.cpp)
+// Tabs switch to the scene named by their "scene" property; tabs whose scene
+// file does not exist yet are ignored
+void handleAdminClick(WindowData& wd, const Widget& widget) {
+    if (widget.type != "tab") return;
+    auto scene = widget.properties.find("scene");
+    if (scene == widget.properties.end() || scene->second.empty()) return;
+    
+    std::string sceneFile = "scenes/" + scene->second;
+    if (sceneFile == wd.currentAdminScene) return;
+    FILE* file = fopen(sceneFile.c_str(), "r");
+    if (!file) {
+        std::cerr << "[WARNING] Admin tab scene not found: " << sceneFile << std::endl;
+        return;
+    }
+    fclose(file);
+    wd.currentAdminScene = sceneFile;
+    std::cout << "[DEBUG] Admin tab selected: " << sceneFile << std::endl;
 }
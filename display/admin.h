@@ -6,13 +6,14 @@
 #include "scene.h"
 
 struct WindowData;
+struct Gesture;
 
 // Admin mode functions
 bool isRunningAsAdmin();
-bool checkTetraClick(WindowData& wd, double xpos, double ypos, int windowWidth, int windowHeight, double currentTime);
+bool checkTetraClick(WindowData& wd, const Gesture& gesture);
 void renderAdminModeText(int windowWidth, int windowHeight);
 void renderTetraClickIndicator(int windowWidth, int windowHeight, int clickCount);
 bool loadAdminScene(const std::string& sceneFile, Scene& scene);
-void handleAdminClick(WindowData& wd, double xpos, double ypos, int windowWidth, int windowHeight, double currentTime);
+void handleAdminClick(WindowData& wd, const Widget& widget);
 
 #endif // ADMIN_H
@@ -0,0 +1,282 @@
+#include "animation.h"
+#include "scene.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_SSE2 1
+#include <emmintrin.h>
+#else
+#define ANIMATION_SSE2 0
+#endif
+
+// Easing curves as cubic coefficients: ease(t) = t * (a + t * (b + t * c))
+struct EasingCurve {
+    const char* name;
+    float a, b, c;
+};
+
+static const EasingCurve EASINGS[] = {
+    {"linear", 1.0f, 0.0f, 0.0f},
+    {"ease_in", 0.0f, 0.0f, 1.0f},          // t^3
+    {"ease_out", 3.0f, -3.0f, 1.0f},        // 1 - (1 - t)^3
+    {"ease_in_out", 0.0f, 3.0f, -2.0f},     // Smoothstep
+};
+
+struct ParsedKey {
+    float time;
+    float value[3];     // One per track the field drives
+    const EasingCurve* ease;
+};
+
+struct AnimatedField {
+    const char* name;
+    AnimationChannel channel;   // First channel; color drives three
+    bool color;
+};
+
+static const AnimatedField ANIMATED_FIELDS[] = {
+    {"animate_col", AnimationChannel::COL, false},
+    {"animate_row", AnimationChannel::ROW, false},
+    {"animate_width", AnimationChannel::WIDTH, false},
+    {"animate_height", AnimationChannel::HEIGHT, false},
+    {"animate_color", AnimationChannel::COLOR_R, true},
+    {"animate_opacity", AnimationChannel::OPACITY, false},
+};
+
+static bool parseNumber(const std::string& text, float& value) {
+    char* end = nullptr;
+    value = strtof(text.c_str(), &end);
+    return !text.empty() && end && *end == '\0' && std::isfinite(value);
+}
+
+static bool parseHexColor(const std::string& text, float rgb[3]) {
+    if (text.size() != 7 || text[0] != '#') return false;
+    for (size_t i = 1; i < text.size(); i++) {
+        if (!isxdigit((unsigned char)text[i])) return false;
+    }
+    parseColor(text, rgb[0], rgb[1], rgb[2]);
+    return true;
+}
+
+// "<seconds> <value> [easing], ..." with times in order; false (and a reason) otherwise
+static bool parseKeyframes(const std::string& spec, bool color, std::vector<ParsedKey>& keys, std::string& error) {
+    keys.clear();
+    std::stringstream list(spec);
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        std::istringstream fields(entry);
+        std::string timeText, valueText, easeText, extra;
+        fields >> timeText >> valueText >> easeText >> extra;
+        if (timeText.empty() && valueText.empty()) continue; // Trailing comma
+        ParsedKey key;
+        key.value[0] = key.value[1] = key.value[2] = 0.0f;
+        key.ease = &EASINGS[0];
+        if (!parseNumber(timeText, key.time) || key.time < 0.0f) {
+            error = "bad time \"" + timeText + "\"";
+            return false;
+        }
+        bool valueOk = color ? parseHexColor(valueText, key.value) : parseNumber(valueText, key.value[0]);
+        if (!valueOk) {
+            error = "bad value \"" + valueText + "\"" + (color ? " (expected #rrggbb)" : "");
+            return false;
+        }
+        if (!easeText.empty()) {
+            key.ease = nullptr;
+            for (const EasingCurve& curve : EASINGS) {
+                if (easeText == curve.name) key.ease = &curve;
+            }
+            if (!key.ease) {
+                error = "unknown easing \"" + easeText + "\"";
+                return false;
+            }
+        }
+        if (!extra.empty()) {
+            error = "unexpected \"" + extra + "\" (keyframes are separated by commas)";
+            return false;
+        }
+        if (!keys.empty() && key.time < keys.back().time) {
+            error = "keyframe times go backwards";
+            return false;
+        }
+        keys.push_back(key);
+    }
+    if (keys.empty()) {
+        error = "no keyframes";
+        return false;
+    }
+    return true;
+}
+
+static void addTrack(WidgetAnimations& animations, uint32_t slot, const std::vector<ParsedKey>& keys, int component, bool loop) {
+    animations.trackSlot.push_back(slot);
+    animations.trackFirstKey.push_back((uint32_t)animations.keyTime.size());
+    animations.trackCursor.push_back((uint32_t)animations.keyTime.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        const ParsedKey& key = keys[i];
+        float span = i + 1 < keys.size() ? keys[i + 1].time - key.time : 0.0f;
+        animations.keyTime.push_back(key.time);
+        animations.keyValue.push_back(key.value[component]);
+        animations.keyRate.push_back(span > 0.0f ? 1.0f / span : 0.0f);
+        animations.keyEaseA.push_back(key.ease->a);
+        animations.keyEaseB.push_back(key.ease->b);
+        animations.keyEaseC.push_back(key.ease->c);
+    }
+    animations.trackLastKey.push_back((uint32_t)animations.keyTime.size() - 1);
+    animations.trackDuration.push_back(keys.back().time);
+    animations.trackLoop.push_back(loop ? 1 : 0);
+    animations.trackPeriod.push_back(loop && keys.back().time > 0.0f ? keys.back().time : 0.0f);
+}
+
+// Time on a track's keyframes (wrapped when it loops)
+static inline float getTrackLocalTime(float period, float time) {
+    return period > 0.0f ? time - period * floorf(time / period) : time;
+}
+
+static inline float easeSegment(float from, float to, float local, float start, float rate, float a, float b, float c) {
+    float t = (local - start) * rate;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    float ease = t * (a + t * (b + t * c));
+    return from + (to - from) * ease;
+}
+
+static void evaluateTracks(WidgetAnimations& animations) {
+    size_t tracks = animations.trackSlot.size();
+    float time = animations.time;
+    const uint32_t* firstKey = animations.trackFirstKey.data();
+    const uint32_t* lastKey = animations.trackLastKey.data();
+    const float* period = animations.trackPeriod.data();
+    uint32_t* cursor = animations.trackCursor.data();
+    const float* keyTime = animations.keyTime.data();
+    const float* keyValue = animations.keyValue.data();
+    const float* keyRate = animations.keyRate.data();
+    const float* keyA = animations.keyEaseA.data();
+    const float* keyB = animations.keyEaseB.data();
+    const float* keyC = animations.keyEaseC.data();
+    float* from = animations.segmentFrom.data();
+    float* to = animations.segmentTo.data();
+    float* local = animations.segmentLocal.data();
+    float* start = animations.segmentStart.data();
+    float* rate = animations.segmentRate.data();
+    float* a = animations.segmentA.data();
+    float* b = animations.segmentB.data();
+    float* c = animations.segmentC.data();
+    float* value = animations.segmentValue.data();
+
+    // Segment lookup: cursors only move forward unless the clock wraps or restarts
+    for (size_t k = 0; k < tracks; k++) {
+        float trackTime = getTrackLocalTime(period[k], time);
+        uint32_t last = lastKey[k];
+        uint32_t key = cursor[k];
+        if (keyTime[key] > trackTime) key = firstKey[k];
+        while (key < last && keyTime[key + 1] <= trackTime) key++;
+        cursor[k] = key;
+        from[k] = keyValue[key];
+        to[k] = keyValue[key < last ? key + 1 : key];
+        local[k] = trackTime;
+        start[k] = keyTime[key];
+        rate[k] = keyRate[key];
+        a[k] = keyA[key];
+        b[k] = keyB[key];
+        c[k] = keyC[key];
+    }
+
+    // Place, ease and blend every track at once (the segment arrays are padded to 4)
+    size_t padded = animations.segmentValue.size();
+    size_t i = 0;
+#if ANIMATION_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= padded; i += 4) {
+        __m128 vt = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(local + i), _mm_loadu_ps(start + i)), _mm_loadu_ps(rate + i));
+        vt = _mm_min_ps(_mm_max_ps(vt, zero), one);
+        __m128 ease = _mm_add_ps(_mm_loadu_ps(b + i), _mm_mul_ps(vt, _mm_loadu_ps(c + i)));
+        ease = _mm_mul_ps(vt, _mm_add_ps(_mm_loadu_ps(a + i), _mm_mul_ps(vt, ease)));
+        __m128 vfrom = _mm_loadu_ps(from + i);
+        _mm_storeu_ps(value + i, _mm_add_ps(vfrom, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(to + i), vfrom), ease)));
+    }
+#endif
+    for (; i < padded; i++) {
+        value[i] = easeSegment(from[i], to[i], local[i], start[i], rate[i], a[i], b[i], c[i]);
+    }
+
+    const uint32_t* slot = animations.trackSlot.data();
+    float* values = animations.values.data();
+    for (size_t k = 0; k < tracks; k++) {
+        values[slot[k]] = value[k];
+    }
+}
+
+void buildWidgetAnimations(const std::vector<Widget>& widgets, WidgetAnimations& animations) {
+    animations = WidgetAnimations();
+    animations.widgetCount = widgets.size();
+    size_t count = widgets.size();
+    animations.values.assign((size_t)AnimationChannel::COUNT * count, 0.0f);
+    auto slot = [count](AnimationChannel channel, size_t widget) { return (uint32_t)((size_t)channel * count + widget); };
+
+    std::vector<ParsedKey> keys;
+    for (size_t i = 0; i < count; i++) {
+        const Widget& widget = widgets[i];
+        animations.values[slot(AnimationChannel::COL, i)] = (float)widget.col;
+        animations.values[slot(AnimationChannel::ROW, i)] = (float)widget.row;
+        animations.values[slot(AnimationChannel::WIDTH, i)] = (float)widget.width;
+        animations.values[slot(AnimationChannel::HEIGHT, i)] = (float)widget.height;
+        float rgb[3] = {-1.0f, -1.0f, -1.0f};
+        auto color = widget.properties.find("color");
+        if (color != widget.properties.end() && !parseHexColor(color->second, rgb)) {
+            std::cerr << "[WARNING] Animation: Widget " << i << " (" << widget.type << ") color \"" << color->second
+                      << "\" is not #rrggbb, ignored" << std::endl;
+            rgb[0] = rgb[1] = rgb[2] = -1.0f;
+        }
+        animations.values[slot(AnimationChannel::COLOR_R, i)] = rgb[0];
+        animations.values[slot(AnimationChannel::COLOR_G, i)] = rgb[1];
+        animations.values[slot(AnimationChannel::COLOR_B, i)] = rgb[2];
+        animations.values[slot(AnimationChannel::OPACITY, i)] = 1.0f;
+
+        auto loopField = widget.properties.find("animate_loop");
+        bool loop = loopField != widget.properties.end() && (loopField->second == "true" || loopField->second == "1");
+        for (const AnimatedField& field : ANIMATED_FIELDS) {
+            auto spec = widget.properties.find(field.name);
+            if (spec == widget.properties.end()) continue;
+            std::string error;
+            if (!parseKeyframes(spec->second, field.color, keys, error)) {
+                std::cerr << "[WARNING] Animation: Widget " << i << " (" << widget.type << ") " << field.name
+                          << ": " << error << ", not animated" << std::endl;
+                continue;
+            }
+            for (int component = 0; component < (field.color ? 3 : 1); component++) {
+                addTrack(animations, slot((AnimationChannel)((int)field.channel + component), i), keys, component, loop);
+            }
+        }
+    }
+
+    size_t padded = (animations.trackSlot.size() + 3) & ~(size_t)3;
+    for (std::vector<float>* segment : {&animations.segmentFrom, &animations.segmentTo, &animations.segmentLocal,
+                                        &animations.segmentStart, &animations.segmentRate, &animations.segmentA, &animations.segmentB, &animations.segmentC,
+                                        &animations.segmentValue}) {
+        segment->assign(padded, 0.0f);
+    }
+    evaluateTracks(animations);
+}
+
+void evaluateWidgetAnimations(WidgetAnimations& animations, double now) {
+    if (!hasWidgetAnimations(animations)) return;
+    if (animations.startTime < 0.0) animations.startTime = now;
+    double elapsed = now - animations.startTime;
+    animations.time = elapsed > 0.0 ? (float)elapsed : 0.0f;
+    evaluateTracks(animations);
+}
+
+float sampleAnimationTrack(const WidgetAnimations& animations, size_t track, float time) {
+    float local = getTrackLocalTime(animations.trackPeriod[track], time);
+    uint32_t key = animations.trackFirstKey[track];
+    uint32_t last = animations.trackLastKey[track];
+    while (key < last && animations.keyTime[key + 1] <= local) key++;
+    uint32_t next = key < last ? key + 1 : key;
+    return easeSegment(animations.keyValue[key], animations.keyValue[next], local, animations.keyTime[key],
+                       animations.keyRate[key], animations.keyEaseA[key], animations.keyEaseB[key], animations.keyEaseC[key]);
+}
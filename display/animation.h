@@ -0,0 +1,97 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Widget keyframe animation
+// Scene widgets animate their grid position, size, fill color and opacity
+// with string fields next to their static ones:
+//
+//   "animate_col": "0 -2 ease_out, 0.6 2",
+//   "animate_opacity": "0 0, 0.4 1",
+//   "animate_color": "0 #202830 ease_in_out, 1.5 #3a6ea5",
+//   "animate_loop": "true"
+//
+// Each keyframe is "<seconds> <value> [easing]"; the easing (linear, ease_in,
+// ease_out, ease_in_out) shapes the segment leaving that keyframe. Before the
+// first keyframe a track holds its first value, after the last one it holds
+// the last value unless the widget loops.
+//
+// Tracks of every widget are stored flat, structure-of-arrays, and evaluated
+// in one pass per frame: a scalar pass finds each track's current segment,
+// then one SIMD pass places, eases and blends all of them. Easings are cubics, so the
+// blend has no per-track branches. Hit testing keeps using the widgets' static
+// rects.
+
+enum class AnimationChannel {
+    COL,        // Grid cells, as Widget::col
+    ROW,
+    WIDTH,
+    HEIGHT,
+    COLOR_R,    // 0..1; negative when the widget keeps its own color
+    COLOR_G,
+    COLOR_B,
+    OPACITY,    // 0..1, multiplies every alpha the widget draws
+    COUNT
+};
+
+struct Widget;
+
+struct WidgetAnimations {
+    size_t widgetCount = 0;
+    double startTime = -1.0;              // First evaluation time (-1: not started)
+    float time = 0.0f;                    // Seconds since startTime
+
+    // Tracks, one per animated widget channel
+    std::vector<uint32_t> trackSlot;      // Index into values
+    std::vector<uint32_t> trackFirstKey;
+    std::vector<uint32_t> trackLastKey;
+    std::vector<uint32_t> trackCursor;    // Key the last evaluation's segment started at
+    std::vector<float> trackDuration;     // Time of the last key
+    std::vector<unsigned char> trackLoop;
+    std::vector<float> trackPeriod;       // Loop length, 0 when the track holds at its end
+
+    // Keyframes of every track; the segment leaving a key runs at keyRate
+    // (1 / its length, 0 on a track's last key) and eases by
+    // t * (easeA + t * (easeB + t * easeC))
+    std::vector<float> keyTime;
+    std::vector<float> keyValue;
+    std::vector<float> keyRate;
+    std::vector<float> keyEaseA;
+    std::vector<float> keyEaseB;
+    std::vector<float> keyEaseC;
+
+    // Per-track segment gathered each evaluation, padded to a multiple of 4
+    std::vector<float> segmentFrom;
+    std::vector<float> segmentTo;
+    std::vector<float> segmentLocal;      // Track-local time
+    std::vector<float> segmentStart;
+    std::vector<float> segmentRate;
+    std::vector<float> segmentA;
+    std::vector<float> segmentB;
+    std::vector<float> segmentC;
+    std::vector<float> segmentValue;
+
+    // Channel-major: values[channel * widgetCount + widget]; channels without
+    // a track keep the widget's static value
+    std::vector<float> values;
+};
+
+// Parse the widgets' animate_* fields; values start at time 0
+void buildWidgetAnimations(const std::vector<Widget>& widgets, WidgetAnimations& animations);
+// Evaluate every track at `now` (seconds, any clock); the first call starts the clock
+void evaluateWidgetAnimations(WidgetAnimations& animations, double now);
+// One track at one time, without touching the cursors (reference for tests)
+float sampleAnimationTrack(const WidgetAnimations& animations, size_t track, float time);
+
+inline bool hasWidgetAnimations(const WidgetAnimations& animations) {
+    return !animations.trackSlot.empty();
+}
+
+inline float getWidgetAnimationValue(const WidgetAnimations& animations, AnimationChannel channel, size_t widget) {
+    return animations.values[(size_t)channel * animations.widgetCount + widget];
+}
+
+#endif // ANIMATION_H
@@ -3,12 +3,29 @@
 #include "scene.h"
 #include "audio.h"
 #include "network.h"
+#include "stt_stream.h"
+#include "stt_spool.h"
+#include "stt_router.h"
+#include "stt_session.h"
+#include "kws.h"
+#include "dsp.h"
+#include "beamform.h"
+#include "shm_ring.h"
+#include "transcript.h"
+#include "config.h"
 #include "logging.h"
 #include "render.h"
 #include "texture.h"
 #include "admin.h"
 #include "scene_logger.h"
 #include "opening_scene.h"
+#include "jobs.h"
+#include "rng.h"
+#include "scene_watch.h"
+#include "latency.h"
+#include "snapshot.h"
+#include "mirror.h"
+#include "startup.h"
 #include <GLFW/glfw3.h>
 
 #ifdef _WIN32
@@ -21,82 +38,344 @@
 #include <stdexcept>
 #include <exception>
 #include <cmath>
+#include <chrono>
 #include <map>
 #include <cstdlib>
+#include <sstream>
 
 /**
- * Initialize all application systems (logging, network, audio generation, audio capture)
- * This function coordinates initialization of multiple subsystems:
- * - Scene logger (for debug logging)
- * - Network (for Whisper STT)
- * - Audio generation (procedural audio based on seed)
- * - Audio capture (microphone input for waveform and STT)
- * 
- * Attempts to load audio seed from config file, falls back to default
- * Wraps initialization in try-catch to handle any exceptions gracefully
+ * Startup dependency graph (see startup.h)
+ * Built and started by startApplication; the main loop runs its remaining
+ * main-thread tasks and keeps presenting frames until every task has finished
  */
-bool initializeSystems() {
-    std::cout << "[DEBUG] Initializing audio..." << std::endl;
+static StartupGraph startupGraph;
+
+/**
+ * Initialize the systems every startup task relies on (main thread, before the graph)
+ * Scene logger, config, random seed, job system, audio generation and capture DSP
+ * Everything here is cheap; slow work (device, network, files) is left to the graph
+ */
+static void initializeCoreSystems() {
+    std::cout << "[DEBUG] Initializing core systems..." << std::endl;
     
     // Initialize scene logger (which also initializes audio logger)
     initSceneLogger();
     
+    /**
+     * Load application settings (STT transport, endpoints, tuning values)
+     * Every setting has a built-in default, so a missing file is not an error
+     */
+    if (!loadConfig("config/app.conf")) {
+        std::cout << "[DEBUG] No config/app.conf found, using built-in defaults" << std::endl;
+    }
+    
+    /**
+     * Seed procedural generation (background particles, new audio seeds)
+     * rng.seed = 0 picks one from the clock; it is logged so a run can be reproduced
+     */
+    uint64_t randomSeed = (uint64_t)(uint32_t)getConfigInt("rng.seed", 0);
+    if (randomSeed == 0) {
+        randomSeed = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+    }
+    setRandomSeed(randomSeed);
+    std::cout << "[DEBUG] Procedural generation seed: " << randomSeed << std::endl;
+    
+    /**
+     * Start the worker threads shared by loaders, DSP and simulation
+     * This thread owns a deque too and runs jobs while it waits on them
+     * If the workers fail to start, jobs simply run inline on the submitter
+     */
+    if (startJobSystem(getConfigInt("jobs.workers", 0))) {
+        std::cout << "[DEBUG] Job system started with " << getJobWorkerCount() << " workers" << std::endl;
+    } else {
+        std::cerr << "[WARNING] Job system failed to start - jobs will run inline" << std::endl;
+    }
+    
     /**
      * Attempt to load audio seed from config file
      * If file doesn't exist or load fails, use default seed (12345)
      * This ensures audio always has a valid seed even if config is missing
      */
-    try {
-        int seed = 12345; // Default seed
-        if (!loadAudioSeed("config/audio_seed.txt")) {
-            // File doesn't exist or failed to load, use default
-            std::cout << "[DEBUG] Using default audio seed: " << seed << std::endl;
-        } else {
-            seed = getAudioSeed();
-            std::cout << "[DEBUG] Loaded audio seed from config: " << seed << std::endl;
+    int seed = 12345; // Default seed
+    if (!loadAudioSeed("config/audio_seed.txt")) {
+        // File doesn't exist or failed to load, use default
+        std::cout << "[DEBUG] Using default audio seed: " << seed << std::endl;
+    } else {
+        seed = getAudioSeed();
+        std::cout << "[DEBUG] Loaded audio seed from config: " << seed << std::endl;
+    }
+    
+    /**
+     * Initialize audio generation system with the determined seed
+     * This sets up procedural audio generation based on the seed value
+     * Any exceptions during initialization will be caught and logged
+     */
+    initAudioGeneration(seed);
+    std::cout << "[DEBUG] Audio generation initialized successfully" << std::endl;
+    
+    /**
+     * Capture-side DSP (high-pass, noise gate, AGC) runs on every captured
+     * block before the waveform, wake gate and STT see it
+     */
+    CaptureDSPConfig dspConfig;
+    dspConfig.enabled = getConfigBool("dsp.enabled", dspConfig.enabled);
+    dspConfig.highpassHz = getConfigFloat("dsp.highpass_hz", dspConfig.highpassHz);
+    dspConfig.agc = getConfigBool("dsp.agc", dspConfig.agc);
+    dspConfig.agcTargetDbfs = getConfigFloat("dsp.agc_target_dbfs", dspConfig.agcTargetDbfs);
+    dspConfig.agcMaxGainDb = getConfigFloat("dsp.agc_max_gain_db", dspConfig.agcMaxGainDb);
+    dspConfig.agcMinGainDb = getConfigFloat("dsp.agc_min_gain_db", dspConfig.agcMinGainDb);
+    dspConfig.agcAttackMs = getConfigFloat("dsp.agc_attack_ms", dspConfig.agcAttackMs);
+    dspConfig.agcReleaseMs = getConfigFloat("dsp.agc_release_ms", dspConfig.agcReleaseMs);
+    dspConfig.gate = getConfigBool("dsp.gate", dspConfig.gate);
+    dspConfig.gateOpenDbfs = getConfigFloat("dsp.gate_open_dbfs", dspConfig.gateOpenDbfs);
+    dspConfig.gateCloseDbfs = getConfigFloat("dsp.gate_close_dbfs", dspConfig.gateCloseDbfs);
+    dspConfig.gateHoldMs = getConfigFloat("dsp.gate_hold_ms", dspConfig.gateHoldMs);
+    initCaptureDSP(dspConfig, 44100);
+    
+    /**
+     * Microphone array: mic.array lists one "x,y" position (metres) per
+     * channel; capture then opens that many channels and a delay-and-sum
+     * beam, steered at mic.steer_deg or following the talker, feeds the rest
+     */
+    std::string micArray = getConfigString("mic.array", "");
+    if (!micArray.empty()) {
+        BeamformerConfig beamConfig;
+        beamConfig.steerDeg = getConfigFloat("mic.steer_deg", beamConfig.steerDeg);
+        if (!parseMicArray(micArray, beamConfig.mics) || !initBeamformer(beamConfig, 44100)) {
+            std::cerr << "[WARNING] Invalid mic.array \"" << micArray << "\" - capturing mono" << std::endl;
         }
+    }
+}
+
+/**
+ * Start the background services (startup worker task)
+ * Scene watcher and thumbnail service each run on their own thread
+ */
+static void startBackgroundServices() {
+    /**
+     * Watch scenes/ so edited scene files apply without a restart
+     * scenes.watch: auto (inotify where available), poll, or off
+     */
+    std::string watchMode = getConfigString("scenes.watch", "auto");
+    if (watchMode != "off") {
+        startSceneWatcher("scenes", watchMode == "poll" ? SceneWatchMode::POLL : SceneWatchMode::AUTO,
+                          getConfigInt("scenes.watch_poll_ms", 250));
+    }
+    
+    /**
+     * Publish per-monitor thumbnails for remote monitoring
+     * snapshot.interval_ms = 0 keeps the service idle until a snapshot is requested
+     */
+    SnapshotConfig snapshotConfig;
+    snapshotConfig.directory = getConfigString("snapshot.directory", snapshotConfig.directory);
+    snapshotConfig.intervalMs = getConfigInt("snapshot.interval_ms", snapshotConfig.intervalMs);
+    snapshotConfig.ringSize = getConfigInt("snapshot.ring", snapshotConfig.ringSize);
+    snapshotConfig.maxWidth = getConfigInt("snapshot.max_width", snapshotConfig.maxWidth);
+    snapshotConfig.maxHeight = getConfigInt("snapshot.max_height", snapshotConfig.maxHeight);
+    if (!startSnapshotService(snapshotConfig)) {
+        std::cerr << "[WARNING] Snapshot service failed to start - no thumbnails" << std::endl;
+    }
+}
+
+/**
+ * Initialize network and STT upload paths (startup worker task)
+ * Network thread, streaming transport, router, spool and the optional wake phrase
+ */
+static void initializeNetworkSystems() {
+    /**
+     * Export mode: with stt.export_shm set, captured session audio is published
+     * to that shared-memory segment and the stt_sidecar process uploads it, so
+     * the display opens no STT connections of its own
+     */
+    std::string exportName = getConfigString("stt.export_shm", "");
+    bool exportAudio = !exportName.empty() && startSharedAudioExport(exportName, 44100);
+    
+    /**
+     * Initialize network subsystem for Whisper STT
+     * This sets up WinSock2 on Windows or prepares network for Unix
+     * and starts the network thread that runs all outbound I/O
+     * Must be done before any network operations
+     */
+    if (!initNetwork()) {
+        std::cerr << "[WARNING] Network initialization failed - STT will not work" << std::endl;
+    } else {
+        std::cout << "[DEBUG] Network initialized successfully" << std::endl;
         
         /**
-         * Initialize network subsystem for Whisper STT
-         * This sets up WinSock2 on Windows or prepares network for Unix
-         * Must be done before any network operations
+         * Start the WebSocket streaming transport for continuous transcription
+         * Connects in the background; until it is connected (or if the server
+         * has no streaming endpoint) audio goes through the batch POST path
          */
-        if (!initNetwork()) {
-            std::cerr << "[WARNING] Network initialization failed - STT will not work" << std::endl;
-        } else {
-            std::cout << "[DEBUG] Network initialized successfully" << std::endl;
+        if (!exportAudio && getConfigBool("stt.stream", true)) {
+            startSTTStream(getConfigString("stt.host", "localhost"),
+                           getConfigInt("stt.port", 8070),
+                           getConfigString("stt.stream_path", "/v1/audio/stream"),
+                           44100,
+                           getConfigInt("stt.stream_frame_ms", 100));
         }
         
         /**
-         * Initialize audio generation system with the determined seed
-         * This sets up procedural audio generation based on the seed value
-         * Any exceptions during initialization will be caught and logged
+         * Route uploads across the configured STT servers
+         * stt.endpoints lists "host:port" pairs; without it the single
+         * stt.host/stt.port server is used
          */
-        initAudioGeneration(seed);
-        std::cout << "[DEBUG] Audio generation initialized successfully" << std::endl;
+        std::string defaultEndpoint = getConfigString("stt.host", "localhost") + ":" + std::to_string(getConfigInt("stt.port", 8070));
+        STTRouterConfig routerConfig;
+        routerConfig.hedging = getConfigBool("stt.hedging", true);
+        routerConfig.minHedgeMs = getConfigInt("stt.hedge_min_ms", 50);
+        routerConfig.failureThreshold = getConfigInt("stt.eject_after_failures", 3);
+        routerConfig.ejectMs = getConfigInt("stt.eject_ms", 5000);
+        bool routerReady = !exportAudio && initSTTRouter(parseSTTEndpoints(getConfigString("stt.endpoints", defaultEndpoint)), routerConfig);
         
         /**
-         * Initialize audio capture for Whisper STT
-         * This sets up Windows waveIn API to capture microphone input
-         * Audio will be captured at 44.1kHz sample rate
+         * Start the disk-backed upload spool for batch POSTs
+         * Utterances queue to spool/ and upload in order from a background thread,
+         * so an unreachable server costs neither audio nor render-thread time
          */
-        if (!initAudioCapture(44100)) {
-            std::cerr << "[WARNING] Audio capture initialization failed - STT will not receive audio" << std::endl;
-        } else {
-            std::cout << "[DEBUG] Audio capture initialized successfully" << std::endl;
-            // Start capturing audio immediately for STT
-            startAudioCapture();
-            std::cout << "[DEBUG] Audio capture started" << std::endl;
+        STTSpoolConfig spoolConfig;
+        spoolConfig.useRouter = routerReady;
+        spoolConfig.directory = getConfigString("stt.spool_dir", "spool");
+        spoolConfig.host = getConfigString("stt.host", "localhost");
+        spoolConfig.port = getConfigInt("stt.port", 8070);
+        spoolConfig.maxBytes = (uint64_t)getConfigInt("stt.spool_max_mb", 64) * 1024 * 1024;
+        spoolConfig.segmentBytes = (uint64_t)getConfigInt("stt.spool_segment_kb", 1024) * 1024;
+        spoolConfig.maxBackoffMs = getConfigInt("stt.retry_max_ms", 30000);
+        /**
+         * Batch uploads carry only audio not sent yet, in chunks of stt.chunk_ms
+         * of capture time, each repeating stt.context_overlap_ms of the previous
+         * chunk so words cut at a boundary are still recognized
+         */
+        STTSessionConfig sessionConfig;
+        sessionConfig.chunkMs = getConfigInt("stt.chunk_ms", 3000);
+        sessionConfig.contextMs = getConfigInt("stt.context_overlap_ms", 250);
+        configureSTTSessions(sessionConfig);
+        
+        /**
+         * Optional wake phrase: with kws.enabled, nothing is uploaded or streamed
+         * until one of the kws.templates recordings is heard, then kws.listen_ms
+         * of audio is (each repeat of the phrase extends it)
+         */
+        if (getConfigBool("kws.enabled", false)) {
+            KWSConfig kwsConfig;
+            kwsConfig.threshold = getConfigFloat("kws.threshold", kwsConfig.threshold);
+            kwsConfig.listenMs = getConfigInt("kws.listen_ms", kwsConfig.listenMs);
+            std::vector<std::string> templatePaths;
+            std::stringstream list(getConfigString("kws.templates", ""));
+            std::string path;
+            while (std::getline(list, path, ',')) {
+                size_t first = path.find_first_not_of(" \t");
+                if (first == std::string::npos) continue;
+                templatePaths.push_back(path.substr(first, path.find_last_not_of(" \t") - first + 1));
+            }
+            if (!initKeywordSpotter(kwsConfig, templatePaths)) {
+                std::cerr << "[WARNING] Wake phrase templates unusable - STT uploads are not gated" << std::endl;
+            }
         }
         
-        return true;
+        if (exportAudio) {
+            std::cout << "[DEBUG] STT uploads handed to the sidecar via \"" << exportName << "\"" << std::endl;
+        } else if (!startSTTSpool(spoolConfig)) {
+            std::cerr << "[WARNING] STT spool failed to start - batch uploads disabled" << std::endl;
+        }
+    }
+}
+
+/**
+ * Open and start audio capture (startup worker task, after the network)
+ * Opening the device is the slowest startup step on Windows, so it runs
+ * while the first frames are already on screen
+ */
+static void initializeAudioCapture() {
+    /**
+     * Initialize audio capture for Whisper STT
+     * This sets up Windows waveIn API to capture microphone input,
+     * or plays audio.source_file through the same pipeline instead
+     * Audio will be captured at 44.1kHz sample rate
+     */
+    std::string sourceFile = getConfigString("audio.source_file", "");
+    
+    /**
+     * Latency loopback mode: capture a generated click track through the
+     * file source in real time, so every hop (bars, segments, uploads,
+     * transcripts) is measured against a known input
+     */
+    configureLatencyReport(getConfigFloat("latency.report_s", 0.0f));
+    if (getConfigBool("latency.loopback", false)) {
+        sourceFile = "latency_clicks.wav";
+        if (!saveWAVFile(sourceFile, makeClickTrack(44100, 30.0, 500), 44100)) {
+            std::cerr << "[WARNING] Cannot write latency click track " << sourceFile << std::endl;
+        }
+        float reportSeconds = getConfigFloat("latency.report_s", 0.0f);
+        configureLatencyReport(reportSeconds > 0.0f ? reportSeconds : 5.0f);
+        std::cout << "[DEBUG] Latency loopback: capturing " << sourceFile << std::endl;
+    }
+    bool captureReady = sourceFile.empty() ? initAudioCapture(44100) : initAudioCaptureFromFile(sourceFile, 44100);
+    if (!captureReady) {
+        std::cerr << "[WARNING] Audio capture initialization failed - STT will not receive audio" << std::endl;
+    } else {
+        std::cout << "[DEBUG] Audio capture initialized successfully" << std::endl;
+        // Start capturing audio immediately for STT
+        startAudioCapture();
+        std::cout << "[DEBUG] Audio capture started" << std::endl;
+    }
+}
+
+/**
+ * Start the application: windows, logos and every subsystem
+ * Startup runs as a dependency graph: the logos decode on workers while
+ * GLFW creates the windows on this thread, and network, audio capture and the
+ * opening scene prefetch carry on in the background after this returns.
+ * Returns once each window has its logo, ready for the first frame.
+ */
+bool startApplication(std::vector<WindowData>& windows) {
+    try {
+        initializeCoreSystems();
     } catch (const std::exception& e) {
-        std::cerr << "[ERROR] Exception during audio initialization: " << e.what() << std::endl;
-        return false;
+        std::cerr << "[ERROR] Exception during core initialization: " << e.what() << std::endl;
     } catch (...) {
-        std::cerr << "[ERROR] Unknown exception during audio initialization" << std::endl;
-        return false;
+        std::cerr << "[ERROR] Unknown exception during core initialization" << std::endl;
+    }
+    
+    /**
+     * Each decode task fills its own entry; the map itself is not modified after this
+     */
+    std::map<std::string, DecodedImage> logos;
+    logos[HORIZONTAL_LOGO_PATH] = DecodedImage();
+    logos[VERTICAL_LOGO_PATH] = DecodedImage();
+    bool isAdmin = false;
+    
+    int adminCheck = addStartupTask(startupGraph, "admin_check", StartupThread::WORKER, [&isAdmin]() {
+        isAdmin = isRunningAsAdmin();
+        std::cout << "[DEBUG] " << (isAdmin ? "Running as administrator" : "Not running as admin") << std::endl;
+    });
+    std::vector<int> logoReady = {adminCheck};
+    for (auto& logo : logos) {
+        const std::string& path = logo.first;
+        DecodedImage& image = logo.second;
+        logoReady.push_back(addStartupTask(startupGraph, "decode " + path.substr(path.rfind('/') + 1),
+                                           StartupThread::WORKER, [&path, &image]() {
+            decodeImage(path.c_str(), image);
+        }));
     }
+    int created = addStartupTask(startupGraph, "create_windows", StartupThread::MAIN, [&windows]() {
+        windows = createWindows();
+    });
+    logoReady.push_back(created);
+    int logosShown = addStartupTask(startupGraph, "upload_logos", StartupThread::MAIN, [&windows, &logos, &isAdmin]() {
+        uploadWindowLogos(windows, logos);
+        for (auto& wd : windows) {
+            wd.isAdmin = isAdmin;
+        }
+    }, logoReady);
+    addStartupTask(startupGraph, "services", StartupThread::WORKER, startBackgroundServices);
+    addStartupTask(startupGraph, "scene_prefetch", StartupThread::WORKER, prefetchOpeningScene);
+    int network = addStartupTask(startupGraph, "network", StartupThread::WORKER, initializeNetworkSystems);
+    addStartupTask(startupGraph, "audio_capture", StartupThread::WORKER, initializeAudioCapture, {network});
+    
+    startStartupGraph(startupGraph);
+    waitForStartupTask(startupGraph, logosShown);
+    std::cout << "[DEBUG] Startup: windows ready at " << getStartupClockMs() << " ms" << std::endl;
+    return !windows.empty();
 }
 
 
@@ -261,6 +540,18 @@ void runMainLoop(std::vector<WindowData>& windows) {
      */
     double lastFrameTime = glfwGetTime();
     std::cout << "[DEBUG] Initial lastFrameTime: " << lastFrameTime << std::endl;
+    
+    /**
+     * Mirrored monitors (same size, orientation and content) render once per frame
+     * display.mirror = false renders every window on its own
+     */
+    bool mirrorWindows = getConfigBool("display.mirror", true);
+    
+    /**
+     * Redundant GL state changes are dropped against a per-context shadow
+     * display.gl_state_validate = true cross-checks every dropped change with glGet (slow, debugging only)
+     */
+    setGLStateValidation(getConfigBool("display.gl_state_validate", false));
     std::cout << "[DEBUG] Entering main loop..." << std::endl;
     
     /**
@@ -269,6 +560,7 @@ void runMainLoop(std::vector<WindowData>& windows) {
      * Each iteration represents one frame of rendering
      */
     int frameCount = 0;
+    bool startupDone = isStartupGraphDone(startupGraph);
     while (!windows.empty()) {
         try {
             /**
@@ -290,12 +582,69 @@ void runMainLoop(std::vector<WindowData>& windows) {
                 break; // Exit main loop
             }
             
+            /**
+             * Deliver transcript events from the network thread
+             * Drained once per frame (lock-free) so every window shows the same lines
+             */
+            drainTranscriptEvents();
+            
+            /**
+             * Advance each window's display state for this frame
+             * Runs before any window renders, so windows showing the same thing can be grouped
+             */
+            bool transitionsEnabled = parseTransitionEffect(getConfigString("display.transition", "fade")) != TransitionEffect::NONE;
+            std::vector<double> frameTimes(windows.size(), 0.0);
+            std::vector<float> frameAlphas(windows.size(), 1.0f);
+            std::vector<MirrorCandidate> candidates(windows.size());
+            for (size_t i = 0; i < windows.size(); i++) {
+                WindowData& wd = windows[i];
+                MirrorCandidate& candidate = candidates[i];
+                candidate.fbWidth = 0;
+                candidate.fbHeight = 0;
+                candidate.isVertical = wd.isVertical;
+                try {
+                    glfwMakeContextCurrent(wd.window);
+                    bindGLStateCache(&wd.glState);
+                    glfwGetFramebufferSize(wd.window, &candidate.fbWidth, &candidate.fbHeight);
+                    
+                    /**
+                     * Get current time for state management
+                     * Time is used for fade timing and automatic state transitions
+                     * Elapsed time calculations determine fade progress
+                     */
+                    frameTimes[i] = glfwGetTime();
+                    std::cout << "[DEBUG] Current time: " << frameTimes[i] << std::endl;
+                    
+                    /**
+                     * Handle display state transitions
+                     * State machine manages logo fade-in, showing, fade-out, and scene states
+                     * Updates alpha value based on current state and elapsed time
+                     */
+                    handleDisplayState(wd, frameTimes[i], frameAlphas[i]);
+                    if (mirrorWindows) {
+                        candidate.contentKey = getMirrorContentKey(wd, frameAlphas[i]);
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[ERROR] Exception during display state update: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "[ERROR] Unknown exception during display state update" << std::endl;
+                }
+            }
+            
+            /**
+             * Group windows with the same framebuffer size, orientation and content
+             * Only the first window of a group renders; the others present its frame
+             */
+            std::vector<MirrorGroup> mirrorGroups = buildMirrorGroups(candidates);
+            std::vector<int> groupOfWindow = getMirrorGroupIndex(mirrorGroups, windows.size());
+            
             /**
              * Render each window for this frame
-             * Each window is rendered independently with its own OpenGL context
+             * Each window has its own OpenGL context; the contexts share textures
              * Rendering includes logo, scenes, and all visual elements
              */
-            for (auto& wd : windows) {
+            for (size_t i = 0; i < windows.size(); i++) {
+                WindowData& wd = windows[i];
                 try {
                     /**
                      * Prepare window context and framebuffer
@@ -304,30 +653,51 @@ void runMainLoop(std::vector<WindowData>& windows) {
                      */
                     int fbWidth, fbHeight;
                     prepareWindowForRendering(wd, fbWidth, fbHeight);
+                    double currentTime = frameTimes[i];
+                    MirrorGroup& group = mirrorGroups[groupOfWindow[i]];
+                    bool leader = group.members[0] == (int)i;
                     
-                    /**
-                     * Get current time for state management
-                     * Time is used for fade timing and automatic state transitions
-                     * Elapsed time calculations determine fade progress
-                     */
-                    double currentTime = glfwGetTime();
-                    std::cout << "[DEBUG] Current time: " << currentTime << std::endl;
-                    double elapsed = currentTime - wd.fadeStartTime;
-                    float alpha = 1.0f;
+                    if (!leader && group.texture != 0) {
+                        /**
+                         * Mirror: present the frame the group's first window rendered
+                         * One textured quad instead of the whole scene
+                         */
+                        presentMirrorFrame(group);
+                    } else {
+                        /**
+                         * Render content based on current state
+                         * Routes to logo texture, opening scene, admin scene, or error placeholder
+                         * Opening scene is rendered here; logo alpha is used for fade effects
+                         */
+                        renderContentForState(wd, fbWidth, fbHeight, frameAlphas[i], lastFrameTime, frameCount);
+                        
+                        /**
+                         * Composite the previous scene's snapshot while a scene transition runs
+                         * Only the incoming scene is rendered live
+                         */
+                        drawSceneTransition(wd.transition, fbWidth, fbHeight, currentTime);
+                        
+                        /**
+                         * Hand the finished frame to the rest of the mirror group
+                         */
+                        if (leader && group.members.size() > 1) {
+                            captureMirrorFrame(group);
+                        }
+                    }
                     
                     /**
-                     * Handle display state transitions
-                     * State machine manages logo fade-in, showing, fade-out, and scene states
-                     * Updates alpha value based on current state and elapsed time
+                     * Keep a copy of the finished frame for the next scene transition
+                     * Copied before the swap: the buffers' contents are undefined after it
                      */
-                    handleDisplayState(wd, currentTime, alpha);
+                    if (transitionsEnabled) {
+                        captureTransitionFrame(wd.transition, fbWidth, fbHeight);
+                    }
                     
                     /**
-                     * Render content based on current state
-                     * Routes to logo texture, opening scene, admin scene, or error placeholder
-                     * Opening scene is rendered here; logo alpha is used for fade effects
+                     * Queue an asynchronous thumbnail readback of the finished frame
+                     * Readbacks issued frames ago are mapped here once their fence has signalled
                      */
-                    renderContentForState(wd, fbWidth, fbHeight, alpha, lastFrameTime, frameCount);
+                    captureSnapshotFrame(wd.snapshot, (int)i, fbWidth, fbHeight, currentTime);
                     
                     /**
                      * Swap front and back buffers to display rendered frame
@@ -337,6 +707,19 @@ void runMainLoop(std::vector<WindowData>& windows) {
                     std::cout << "[DEBUG] Swapping buffers..." << std::endl;
                     glfwSwapBuffers(wd.window);
                     std::cout << "[DEBUG] Buffers swapped" << std::endl;
+                    
+                    /**
+                     * Close this window's GL state counters for the frame
+                     */
+                    finishGLStateFrame(wd.glState);
+                    if (frameCount % 1000 == 0) {
+                        const GLStateCounters& glFrame = wd.glState.lastFrame;
+                        std::cout << "[DEBUG] GL state (window " << i << "): " << glFrame.issued << " changes issued, "
+                                  << glFrame.elided << " redundant elided";
+                        if (glFrame.mismatches > 0) std::cout << ", " << glFrame.mismatches << " shadow mismatches";
+                        if (transitionsEnabled) std::cout << ", transition frame copy " << wd.transition.copyUs << " us CPU";
+                        std::cout << std::endl;
+                    }
                 } catch (const std::exception& e) {
                     std::cerr << "[ERROR] Exception during window rendering: " << e.what() << std::endl;
                     // Continue to next window
@@ -346,21 +729,51 @@ void runMainLoop(std::vector<WindowData>& windows) {
                 }
             }
             
+            /**
+             * Startup milestones: the first frame is on screen, and later the first
+             * frame with every startup task finished (audio, network, scene prefetch)
+             */
+            markStartupMilestone("first_frame");
+            if (startupDone) {
+                if (getStartupMilestone("interactive") < 0.0) {
+                    markStartupMilestone("interactive");
+                    std::cout << "[DEBUG] Startup: first frame at " << getStartupMilestone("first_frame")
+                              << " ms, interactive at " << getStartupMilestone("interactive") << " ms\n"
+                              << formatStartupReport(startupGraph) << std::flush;
+                }
+            } else {
+                startupDone = runStartupMainTasks(startupGraph);
+            }
+            
             /**
              * Process all pending events from GLFW
              * This includes window events, keyboard input, mouse input, etc.
              * Must be called regularly to keep window responsive
+             * Mouse events queued by the callbacks then become this frame's gestures
              */
             std::cout << "[DEBUG] Polling events..." << std::endl;
             try {
                 glfwPollEvents();
                 std::cout << "[DEBUG] Events polled" << std::endl;
+                updateInputGestures(glfwGetTime());
             } catch (const std::exception& e) {
                 std::cerr << "[ERROR] Exception during event polling: " << e.what() << std::endl;
             } catch (...) {
                 std::cerr << "[ERROR] Unknown exception during event polling" << std::endl;
             }
             
+            /**
+             * Apply scene files edited since the last frame
+             * Files are parsed on the watcher thread; only the diff is applied here
+             */
+            try {
+                applySceneUpdates(windows);
+            } catch (const std::exception& e) {
+                std::cerr << "[ERROR] Exception during scene hot reload: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "[ERROR] Unknown exception during scene hot reload" << std::endl;
+            }
+            
             /**
              * Update audio system for this frame (DISABLED FOR DEBUGGING)
              * Audio updates include waveform generation and procedural sound
@@ -381,7 +794,9 @@ void runMainLoop(std::vector<WindowData>& windows) {
                 }
                 
                 lastFrameTime = currentFrameTime;
-                updateAudio(deltaTime); // Re-enabled for waveform widget
+                if (startupDone) {
+                    updateAudio(deltaTime); // Capture may still be opening on a startup worker until then
+                }
                 std::cout << "[DEBUG] Audio updated" << std::endl;
             } catch (const std::exception& e) {
                 std::cerr << "[ERROR] Exception during audio update: " << e.what() << std::endl;
@@ -428,6 +843,18 @@ void cleanupApplication(std::vector<WindowData>& windows) {
     std::cout << "NDT Logo Display shutting down gracefully..." << std::endl;
     std::cout << "[DEBUG] Starting cleanup..." << std::endl;
     
+    /**
+     * Let startup tasks still running finish first
+     * Otherwise a subsystem could be started after it has been shut down
+     */
+    try {
+        waitForStartupGraph(startupGraph);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Exception during startup wait: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[ERROR] Unknown exception during startup wait" << std::endl;
+    }
+    
     /**
      * Cleanup windows and release OpenGL contexts
      * This closes all windows and destroys their GLFW resources
@@ -450,6 +877,7 @@ void cleanupApplication(std::vector<WindowData>& windows) {
     try {
         stopAudioCapture();
         cleanupAudioCapture();
+        stopSharedAudioExport();
         std::cout << "[DEBUG] Audio capture cleaned up" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] Exception during audio capture cleanup: " << e.what() << std::endl;
@@ -465,18 +893,64 @@ void cleanupApplication(std::vector<WindowData>& windows) {
     try {
         cleanupAudio();
         std::cout << "[DEBUG] Audio cleaned up" << std::endl;
+        std::string latencyReport = formatLatencyReport();
+        if (!latencyReport.empty()) {
+            std::cout << "[DEBUG] Capture latency since startup:\n" << latencyReport;
+        }
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] Exception during audio cleanup: " << e.what() << std::endl;
     } catch (...) {
         std::cerr << "[ERROR] Unknown exception during audio cleanup" << std::endl;
     }
     
+    /**
+     * Stop the snapshot worker after the windows released their readback buffers
+     * Frames already handed over are still encoded and written
+     */
+    try {
+        stopSnapshotService();
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Exception during snapshot service shutdown: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[ERROR] Unknown exception during snapshot service shutdown" << std::endl;
+    }
+    
+    /**
+     * Stop the scene watcher thread
+     * Pending re-parsed scenes are discarded
+     */
+    try {
+        stopSceneWatcher();
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Exception during scene watcher shutdown: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[ERROR] Unknown exception during scene watcher shutdown" << std::endl;
+    }
+    
+    /**
+     * Stop the job system once audio no longer submits work
+     * Queued jobs are finished before the workers are joined
+     */
+    try {
+        stopJobSystem();
+        std::cout << "[DEBUG] Job system stopped" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Exception during job system shutdown: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[ERROR] Unknown exception during job system shutdown" << std::endl;
+    }
+    
     /**
      * Cleanup network subsystem
      * On Windows, cleans up WinSock2
      * Must be done after all network operations are complete
+     * The streaming transport and upload spool are stopped first so their threads
+     * release their sockets (the spool flushes queued audio to disk)
      */
         try {
+            stopSTTStream();
+            stopSTTSpool();
+            shutdownSTTRouter();
             cleanupNetwork();
             std::cout << "[DEBUG] Network cleaned up" << std::endl;
         } catch (const std::exception& e) {
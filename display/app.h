@@ -15,11 +15,14 @@
 struct WindowData;
 
 /**
- * Initialize all application systems (logging, network, audio generation, audio capture)
- * Coordinates initialization of multiple subsystems
- * @return true if initialization succeeded, false otherwise
+ * Start the application: create windows, show their logos, start all subsystems
+ * Startup runs as a dependency graph; slow steps (audio device, network,
+ * scene prefetch) keep running in the background after this returns and the
+ * main loop finishes them off
+ * @param windows Output: the created windows, each with its logo uploaded
+ * @return true if at least one window was created
  */
-bool initializeSystems();
+bool startApplication(std::vector<WindowData>& windows);
 
 
 /**
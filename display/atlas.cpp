@@ -0,0 +1,220 @@
+#include "atlas.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// GL 1.2; Windows headers stop at 1.1
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+static int roundUp(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+void initTextureAtlas(TextureAtlas& atlas, int width, int height, int padding) {
+    int pad = 1;
+    while (pad < padding) pad <<= 1;
+    atlas.padding = pad;
+    atlas.width = roundUp(std::max(width, pad), pad);
+    atlas.height = roundUp(std::max(height, pad), pad);
+    atlas.rgba.assign((size_t)atlas.width * atlas.height * 4, 0);
+    atlas.skylineX.assign(1, 0);
+    atlas.skylineY.assign(1, 0);
+    atlas.skylineWidth.assign(1, atlas.width);
+    atlas.regions.clear();
+    atlas.regionsByName.clear();
+    atlas.usedArea = 0;
+    atlas.dirty = true;
+}
+
+// Lowest top edge a footprint starting at segment `index` can rest on, or -1 if it does not fit
+static int getSkylineFit(const TextureAtlas& atlas, size_t index, int width, int height) {
+    int x = atlas.skylineX[index];
+    if (x + width > atlas.width) return -1;
+    int y = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; i++) {
+        y = std::max(y, atlas.skylineY[i]);
+        if (y + height > atlas.height) return -1;
+        remaining -= atlas.skylineWidth[i];
+    }
+    return y;
+}
+
+// Raise the skyline under a placed footprint and merge level neighbours
+static void addSkylineLevel(TextureAtlas& atlas, size_t index, int x, int y, int width) {
+    atlas.skylineX.insert(atlas.skylineX.begin() + index, x);
+    atlas.skylineY.insert(atlas.skylineY.begin() + index, y);
+    atlas.skylineWidth.insert(atlas.skylineWidth.begin() + index, width);
+
+    for (size_t i = index + 1; i < atlas.skylineX.size();) {
+        int shadowEnd = atlas.skylineX[i - 1] + atlas.skylineWidth[i - 1];
+        if (atlas.skylineX[i] >= shadowEnd) break;
+        int shrink = shadowEnd - atlas.skylineX[i];
+        if (shrink < atlas.skylineWidth[i]) {
+            atlas.skylineX[i] += shrink;
+            atlas.skylineWidth[i] -= shrink;
+            break;
+        }
+        atlas.skylineX.erase(atlas.skylineX.begin() + i);
+        atlas.skylineY.erase(atlas.skylineY.begin() + i);
+        atlas.skylineWidth.erase(atlas.skylineWidth.begin() + i);
+    }
+    for (size_t i = 1; i < atlas.skylineX.size();) {
+        if (atlas.skylineY[i - 1] == atlas.skylineY[i]) {
+            atlas.skylineWidth[i - 1] += atlas.skylineWidth[i];
+            atlas.skylineX.erase(atlas.skylineX.begin() + i);
+            atlas.skylineY.erase(atlas.skylineY.begin() + i);
+            atlas.skylineWidth.erase(atlas.skylineWidth.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+int addAtlasImage(TextureAtlas& atlas, const std::string& name, const DecodedImage& image) {
+    auto existing = atlas.regionsByName.find(name);
+    if (existing != atlas.regionsByName.end()) return existing->second;
+    if (atlas.width <= 0 || image.width <= 0 || image.height <= 0 ||
+        image.rgba.size() < (size_t)image.width * image.height * 4) {
+        return -1;
+    }
+    int pad = atlas.padding;
+    int footprintWidth = roundUp(image.width + 2 * pad, pad);
+    int footprintHeight = roundUp(image.height + 2 * pad, pad);
+
+    // Bottom-left: the lowest resting place, then the one leaving the least
+    // space wasted under the footprint, then the leftmost
+    size_t bestIndex = 0;
+    int bestY = INT_MAX, bestWaste = INT_MAX;
+    for (size_t i = 0; i < atlas.skylineX.size(); i++) {
+        int y = getSkylineFit(atlas, i, footprintWidth, footprintHeight);
+        if (y < 0) continue;
+        int waste = 0, remaining = footprintWidth;
+        for (size_t j = i; remaining > 0; j++) {
+            int span = std::min(remaining, atlas.skylineWidth[j]);
+            waste += (y - atlas.skylineY[j]) * span;
+            remaining -= span;
+        }
+        if (y < bestY || (y == bestY && waste < bestWaste)) {
+            bestIndex = i;
+            bestY = y;
+            bestWaste = waste;
+        }
+    }
+    if (bestY == INT_MAX) return -1;
+
+    int left = atlas.skylineX[bestIndex];
+    addSkylineLevel(atlas, bestIndex, left, bestY + footprintHeight, footprintWidth);
+
+    // Copy the image, replicating its edge texels out across the gutter
+    for (int fy = 0; fy < footprintHeight; fy++) {
+        int sy = std::min(std::max(fy - pad, 0), image.height - 1);
+        unsigned char* row = &atlas.rgba[((size_t)(bestY + fy) * atlas.width + left) * 4];
+        const unsigned char* source = &image.rgba[(size_t)sy * image.width * 4];
+        for (int fx = 0; fx < footprintWidth; fx++) {
+            int sx = std::min(std::max(fx - pad, 0), image.width - 1);
+            std::copy(source + sx * 4, source + sx * 4 + 4, row + fx * 4);
+        }
+    }
+
+    AtlasRegion region;
+    region.x = left + pad;
+    region.y = bestY + pad;
+    region.width = image.width;
+    region.height = image.height;
+    region.u0 = (float)region.x / atlas.width;
+    region.v0 = (float)region.y / atlas.height;
+    region.u1 = (float)(region.x + region.width) / atlas.width;
+    region.v1 = (float)(region.y + region.height) / atlas.height;
+    atlas.regions.push_back(region);
+    int index = (int)atlas.regions.size() - 1;
+    atlas.regionsByName[name] = index;
+    atlas.usedArea += footprintWidth * footprintHeight;
+    atlas.dirty = true;
+    return index;
+}
+
+int findAtlasImage(const TextureAtlas& atlas, const std::string& name) {
+    auto region = atlas.regionsByName.find(name);
+    return region != atlas.regionsByName.end() ? region->second : -1;
+}
+
+unsigned int syncTextureAtlas(TextureAtlas& atlas) {
+    if (!atlas.dirty) return atlas.texture;
+    atlas.dirty = false;
+    if (atlas.regions.empty()) return atlas.texture;
+    if (atlas.texture == 0) glGenTextures(1, &atlas.texture);
+    bindGLTexture(atlas.texture);
+
+    // Mip levels stop where the gutter would shrink below one texel
+    int levels = 0;
+    while ((2 << levels) <= atlas.padding) levels++;
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.width, atlas.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.rgba.data());
+    std::vector<unsigned char> level = atlas.rgba, next;
+    int levelWidth = atlas.width, levelHeight = atlas.height;
+    for (int l = 1; l <= levels; l++) {
+        int nextWidth = levelWidth / 2, nextHeight = levelHeight / 2;
+        next.resize((size_t)nextWidth * nextHeight * 4);
+        for (int y = 0; y < nextHeight; y++) {
+            const unsigned char* top = &level[(size_t)(2 * y) * levelWidth * 4];
+            const unsigned char* bottom = top + (size_t)levelWidth * 4;
+            unsigned char* out = &next[(size_t)y * nextWidth * 4];
+            for (int x = 0; x < nextWidth * 4; x++) {
+                int c = (x / 4) * 8 + x % 4;
+                out[x] = (unsigned char)((top[c] + top[c + 4] + bottom[c] + bottom[c + 4] + 2) / 4);
+            }
+        }
+        glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA, nextWidth, nextHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, next.data());
+        level.swap(next);
+        levelWidth = nextWidth;
+        levelHeight = nextHeight;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    bindGLTexture(0);
+    std::cout << "[DEBUG] Atlas: Uploaded " << atlas.regions.size() << " images, " << atlas.width << "x" << atlas.height
+              << " page, " << (100 * atlas.usedArea / (atlas.width * atlas.height)) << "% used, " << levels
+              << " mip levels" << std::endl;
+    return atlas.texture;
+}
+
+void releaseTextureAtlas(TextureAtlas& atlas) {
+    deleteGLTexture(atlas.texture);
+    atlas.dirty = !atlas.regions.empty();
+}
+
+void appendAtlasQuad(const AtlasRegion& region, float x, float y, float w, float h, float alpha, std::vector<float>& vertices) {
+    if (region.width <= 0 || region.height <= 0 || w <= 0.0f || h <= 0.0f) return;
+    float scale = std::min(w / region.width, h / region.height);
+    float quadWidth = region.width * scale;
+    float quadHeight = region.height * scale;
+    float left = x + (w - quadWidth) * 0.5f;
+    float bottom = y + (h - quadHeight) * 0.5f;
+    // Image row 0 is its top: v0 goes on the upper edge
+    const float quad[4][4] = {
+        {left, bottom, region.u0, region.v1},
+        {left + quadWidth, bottom, region.u1, region.v1},
+        {left + quadWidth, bottom + quadHeight, region.u1, region.v0},
+        {left, bottom + quadHeight, region.u0, region.v0},
+    };
+    for (const auto& vertex : quad) {
+        vertices.insert(vertices.end(), vertex, vertex + 4);
+        vertices.push_back(alpha);
+    }
+}
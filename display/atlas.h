@@ -0,0 +1,55 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "texture.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Texture atlas for small scene images
+// Widget images (the "image" property of cards, tabs and icons) are packed
+// into one RGBA page with a skyline bottom-left packer, so a scene's whole
+// image layer draws with one texture bind and one draw call. Every image is
+// surrounded by a gutter of its own edge texels, `padding` wide, and placed
+// on a `padding` grid; the page carries log2(padding) mip levels, so neither
+// bilinear filtering nor minification bleeds a neighbour into an image.
+// Packing only touches memory (any thread); the page is uploaded on the
+// render thread by syncTextureAtlas.
+
+static const int ATLAS_MAX_IMAGE_SIZE = 256;  // Larger images are not atlased
+
+struct AtlasRegion {
+    int x, y;              // Image texels in the page, gutter excluded (row 0 at the top)
+    int width, height;
+    float u0, v0, u1, v1;  // Texture coordinates of the image's top-left and bottom-right
+};
+
+struct TextureAtlas {
+    int width = 0;
+    int height = 0;
+    int padding = 0;                      // Power of two
+    std::vector<unsigned char> rgba;      // Page pixels, width * height * 4
+    std::vector<int> skylineX;            // Skyline segments, left to right
+    std::vector<int> skylineY;
+    std::vector<int> skylineWidth;
+    std::vector<AtlasRegion> regions;
+    std::map<std::string, int> regionsByName;
+    int usedArea = 0;                     // Texels covered by images and gutters
+    unsigned int texture = 0;             // GL texture of the page (0 until first synced)
+    bool dirty = false;                   // Pixels changed since the last upload
+};
+
+// Empty page; the GL texture (if any) is kept and refilled on the next sync
+void initTextureAtlas(TextureAtlas& atlas, int width = 1024, int height = 1024, int padding = 4);
+// Pack an image; returns its region, the existing one for a name already added, or -1 when it does not fit
+int addAtlasImage(TextureAtlas& atlas, const std::string& name, const DecodedImage& image);
+int findAtlasImage(const TextureAtlas& atlas, const std::string& name);
+// Upload the page if it changed (context current); returns the texture
+unsigned int syncTextureAtlas(TextureAtlas& atlas);
+void releaseTextureAtlas(TextureAtlas& atlas); // Context current
+
+// Append a quad drawing `region` aspect-fit and centered in x, y, w, h (origin
+// bottom-left) as four x, y, u, v, alpha vertices for one batched GL_QUADS draw
+void appendAtlasQuad(const AtlasRegion& region, float x, float y, float w, float h, float alpha, std::vector<float>& vertices);
+
+#endif // ATLAS_H
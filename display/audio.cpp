@@ -1,54 +1,95 @@
 #include "audio.h"
 #include "network.h"
+#include "stt_stream.h"
+#include "stt_spool.h"
+#include "stt_session.h"
+#include "kws.h"
+#include "dsp.h"
+#include "beamform.h"
+#include "shm_ring.h"
 #include "scene_logger.h"
+#include "rng.h"
+#include "waveform_pyramid.h"
+#include "latency.h"
 #include <cmath>
 #include <cstdio>  // For FILE, fopen, fclose, fscanf, fprintf
 #include <cstdlib>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <mmsystem.h>
+#include <mmreg.h>
 #pragma comment(lib, "winmm.lib")
 #pragma comment(lib, "ws2_32.lib")
 
-// Audio capture state for STT
+// Audio capture state for the waveIn device
 static HWAVEIN hWaveIn = NULL;
-static WAVEFORMATEX wfx = {0};
+static WAVEFORMATEXTENSIBLE wfx = {0};
 static WAVEHDR waveHdr[2] = {0};
-static std::vector<short> capturedSamples;
-static bool audioCapturing = false;
-static int captureSampleRate = 44100;
-static const int CAPTURE_BUFFER_SIZE = 44100; // 1 second of audio at 44.1kHz
-static const int SAMPLES_TO_SEND = 44100 * 3; // Send 3 seconds of audio to Whisper
+static const int CAPTURE_BUFFER_SIZE = 44100; // Frames per buffer: 1 second of audio at 44.1kHz
 
 #endif // End of Windows-specific audio capture variables
 
+// Capture state shared by the device and file-source backends
+// Buffers are sized when capture starts; the per-block chain (waveform, upload
+// session, stream ring) does not allocate, apart from the log line every 100 blocks
+static std::atomic<bool> audioCapturing(false);
+static int captureSampleRate = 44100;
+static int captureChannels = 1;               // Interleaved channels per captured frame
+static int captureBlockFrames = 0;            // Largest block the backend delivers
+static std::vector<short> monoScratch;        // Beamformer output / channel 0 of multi-channel blocks
+static std::vector<float> floatScratch;       // Block converted for the waveform, captureBlockFrames long
+static const int SAMPLES_TO_SEND = 44100 * 3; // Recent audio kept for getCapturedAudioSamples
+static std::mutex capturedMutex;              // Ring is written on the capture thread, read by getCapturedAudioSamples
+static std::vector<short> capturedRing;       // Last SAMPLES_TO_SEND samples, oldest at capturedWrite once full
+static size_t capturedWrite = 0;
+static size_t capturedCount = 0;
+
+// File-source backend: a WAV played through the capture pipeline
+static const int FILE_BLOCK_FRAMES = 4410;    // 100 ms blocks at 44.1kHz
+static bool fileSourceLoaded = false;
+static bool fileSourceRealtime = true;
+static std::vector<short> fileSourceFrames;   // Interleaved, captureChannels per frame
+static std::thread fileSourceThread;
+static std::atomic<bool> fileSourceStop(false);
+
 static int audioSeed = 12345;
+static RandomStream audioRandom = makeRandomStream(12345, RandomStreamId::AUDIO); // Keyed by audioSeed
 static bool audioInitialized = false;
 static double soundStartTime = -1.0;
 static float soundDuration = 2.0f;
 static float soundFadeInDuration = 2.0f;
 
 // Waveform widget state - RMS-based waveform renderer
-// Captures audio at 44100 Hz, processes in chunks of 512 samples
-// Updates waveform bars at 30fps (every 2 frames at 60fps)
+// Bars run on the audio sample clock: one bar per 1/WAVEFORM_BARS_PER_SECOND
+// of captured audio, computed on the capture thread as blocks arrive, so the
+// scroll speed does not depend on the display refresh rate
 static const int SAMPLE_RATE = 44100;
-static const int SAMPLE_BUFFER_SIZE = 512; // Circular buffer for samples
-static const int RMS_HISTORY_SIZE = 30; // 1 second of RMS history at 30fps
-static const int MAX_BARS = 300; // ~10 seconds at 30fps
+static const int WAVEFORM_BARS_PER_SECOND = 30;
+static const int RMS_HISTORY_SIZE = 30; // 1 second of RMS history
+static const int MAX_BARS = 300; // ~10 seconds
 static const float CLAMP_THRESHOLD = 0.02f; // Clamp bars below 2% of max
 static const float SILENCE_THRESHOLD = 0.001f; // RMS below this is considered silence
 
-// Sample buffer (circular buffer, max 512 samples)
-static std::vector<float> sampleBuffer(SAMPLE_BUFFER_SIZE, 0.0f);
-static int sampleBufferWriteIndex = 0;
-static int sampleBufferCount = 0; // Number of valid samples in buffer
+// Capture thread publishes bars, the render thread reads them
+static std::mutex waveformMutex;
+static int waveformSampleRate = SAMPLE_RATE;
+static int samplesPerBar = SAMPLE_RATE / WAVEFORM_BARS_PER_SECOND;
+static double barSumSquares = 0.0; // Bar in progress
+static int barSamples = 0;
+
+// Long history for zoomed-out views: min/max/RMS of every captured sample
+static WaveformPyramid waveformHistory;
 
-// RMS history (30 values for 1 second at 30fps)
-static std::vector<float> rmsHistory;
+// RMS history ring (30 values for 1 second), bar n's RMS at n % RMS_HISTORY_SIZE
+static float rmsHistory[RMS_HISTORY_SIZE];
 static float maxRMSSeen = 0.0001f; // Small value to avoid division by zero
 
 // Bar data structure
@@ -56,63 +97,112 @@ struct BarData {
     float height; // Normalized height (0.0 to 1.0)
 };
 
-// Bar history (300 bars for ~10 seconds)
-static std::vector<BarData> barHistory;
+// Bar history ring (300 bars for ~10 seconds), bar n at n % MAX_BARS
+// Fixed arrays: publishing a bar on the capture thread never allocates
+static BarData barHistory[MAX_BARS];
+static uint64_t barsPublished = 0;
+
+static size_t getBarHistorySize() {
+    return (size_t)std::min<uint64_t>(barsPublished, MAX_BARS);
+}
+
+// age 0 is the newest bar
+static const BarData& getBarByAge(size_t age) {
+    return barHistory[(barsPublished - 1 - age) % MAX_BARS];
+}
+
+// Arrival of the last captured block, for interpolating between blocks
+static int lastBlockSamples = 0;
+static std::chrono::steady_clock::time_point lastBlockTime;
 
 // Audio device name (stored during initialization)
 static std::string audioDeviceName = "Unknown";
 
-// Update tracking - update at 30fps (every 2 frames at 60fps)
-static int frameCount = 0;
-static const int UPDATE_INTERVAL_FRAMES = 2; // Update every 2 frames (30fps from 60fps)
-
-// Add audio samples to circular buffer (called from audio callback)
-static void updateAudioSamples(const float* samples, int numSamples) {
-    for (int i = 0; i < numSamples; i++) {
-        sampleBuffer[sampleBufferWriteIndex] = samples[i];
-        sampleBufferWriteIndex = (sampleBufferWriteIndex + 1) % SAMPLE_BUFFER_SIZE;
-        if (sampleBufferCount < SAMPLE_BUFFER_SIZE) {
-            sampleBufferCount++;
-        }
-    }
+// Add a new bar to history
+static void addBar(float heightPercent) {
+    // Overwrites the oldest bar once MAX_BARS have been published
+    barHistory[barsPublished % MAX_BARS].height = heightPercent;
+    barsPublished++;
 }
 
-// Calculate RMS from current sample buffer
-static float calculateRMS() {
-    if (sampleBufferCount == 0) return 0.0f;
+// Normalize one finished bar against the last second and publish it
+static void publishBar(float rms) {
+    // Silence detection: if RMS is below threshold, treat as silence
+    if (rms < SILENCE_THRESHOLD) {
+        rms = 0.0f; // Set to zero for silence
+    }
     
-    float sumSquared = 0.0f;
-    for (int i = 0; i < sampleBufferCount; i++) {
-        float sample = sampleBuffer[i];
-        sumSquared += sample * sample;
+    // Add RMS to history (replacing the one from a second ago)
+    rmsHistory[barsPublished % RMS_HISTORY_SIZE] = rms;
+    size_t rmsCount = (size_t)std::min<uint64_t>(barsPublished + 1, RMS_HISTORY_SIZE);
+    
+    // Track max RMS from history
+    maxRMSSeen = 0.0001f; // Reset to small value
+    for (size_t i = 0; i < rmsCount; i++) {
+        if (rmsHistory[i] > maxRMSSeen) {
+            maxRMSSeen = rmsHistory[i];
+        }
     }
     
-    return sqrtf(sumSquared / sampleBufferCount);
-}
-
-// Add a new bar to history
-static void addBar(float heightPercent) {
-    BarData bar;
-    bar.height = heightPercent;
+    // Calculate heightPercent = rms / maxRMSSeen (0.0 to 1.0)
+    float heightPercent = (maxRMSSeen > 0.0001f) ? (rms / maxRMSSeen) : 0.0f;
     
-    barHistory.insert(barHistory.begin(), bar); // Insert at front (newest first)
+    // Apply clamp threshold: if heightPercent < clampPercent, set to 0
+    if (heightPercent < CLAMP_THRESHOLD) {
+        heightPercent = 0.0f;
+    }
     
-    // Keep only MAX_BARS
-    if (barHistory.size() > MAX_BARS) {
-        barHistory.resize(MAX_BARS);
+    // Calculate bar height (heightPercent * 1.6 as per spec, clamped to 1.0)
+    addBar(fminf(heightPercent * 1.6f, 1.0f));
+}
+
+// Each capture run starts on a bar boundary, in samples of its own rate
+// (the previous run's last block keeps scrolling out meanwhile)
+static void startWaveformRun(int sampleRate) {
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    if (waveformHistory.levels.empty() || waveformHistory.sampleRate != sampleRate) {
+        initWaveformPyramid(waveformHistory, sampleRate);
+    }
+    waveformSampleRate = sampleRate;
+    samplesPerBar = std::max(1, sampleRate / WAVEFORM_BARS_PER_SECOND);
+    barSumSquares = 0.0;
+    barSamples = 0;
+}
+
+// Feed one captured block (called from the capture thread): every bar
+// boundary crossed inside the block publishes a bar
+static void advanceWaveform(const float* samples, int numSamples, const CaptureTag& tag) {
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    appendWaveformSamples(waveformHistory, samples, (size_t)numSamples);
+    int offset = 0;
+    while (offset < numSamples) {
+        int take = std::min(numSamples - offset, samplesPerBar - barSamples);
+        float rms = computeRMS(samples + offset, take);
+        barSumSquares += (double)rms * rms * take;
+        barSamples += take;
+        offset += take;
+        if (barSamples == samplesPerBar) {
+            publishBar((float)sqrt(barSumSquares / barSamples));
+            recordLatencySince(LatencyStage::WAVEFORM_BAR, captureTimeAt(tag, offset));
+            barSumSquares = 0.0;
+            barSamples = 0;
+        }
     }
+    lastBlockSamples = numSamples;
+    lastBlockTime = std::chrono::steady_clock::now();
 }
 
-// Simple PRNG based on seed
-static float randomFloat(int& seed) {
-    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
-    return (float)seed / 0x7fffffff;
+// Restart the waveform stream so the same audio seed always gives the same sound
+static void resetAudioRandom() {
+    audioRandom = makeRandomStream((uint64_t)(uint32_t)audioSeed, RandomStreamId::AUDIO);
 }
 
 // Generate procedural bass waveform
-static void generateBassWaveform(short* buffer, int samples, int sampleRate, int& seed) {
+static void generateBassWaveform(short* buffer, int samples, int sampleRate, RandomStream& random) {
     float phase = 0.0f;
-    float freq = 60.0f + randomFloat(seed) * 40.0f; // 60-100 Hz bass
+    float freq = randomRange(random, 60.0f, 100.0f); // 60-100 Hz bass
+    std::vector<float> noiseValues(samples);
+    fillRandomFloat(random, noiseValues.data(), noiseValues.size());
     
     for (int i = 0; i < samples; i++) {
         float time = (float)i / sampleRate;
@@ -127,7 +217,7 @@ static void generateBassWaveform(short* buffer, int samples, int sampleRate, int
         
         // Generate waveform: mix sine and low-frequency noise
         float sine = sinf(phase * 2.0f * 3.14159f);
-        float noise = (randomFloat(seed) - 0.5f) * 0.2f;
+        float noise = (noiseValues[i] - 0.5f) * 0.2f;
         
         // Low-pass filter the noise
         static float filteredNoise = 0.0f;
@@ -144,10 +234,46 @@ static void generateBassWaveform(short* buffer, int samples, int sampleRate, int
     }
 }
 
+// Pass the capture-clock ranges the stream carried on to the session
+static void coverStreamedAudio() {
+    static std::vector<STTStreamCoverage> ranges; // Render thread only
+    if (takeSTTStreamCoverage(ranges)) {
+        for (const STTStreamCoverage& range : ranges) {
+            coverSTTSessionAudio(range.from, range.to, range.open);
+        }
+    }
+}
+
+// Hand each chunk of unsent capture audio to the spool
+// Chunks follow the capture clock, not frame time: every upload carries only
+// new audio (plus the session's context overlap) and its sample offset.
+// Audio the WebSocket stream delivered is marked as covered instead of
+// uploaded; what it missed (captured before it connected, or still queued
+// when it dropped) is uploaded here. In export mode the sidecar uploads
+// everything from the shared-memory ring.
+static void updateSTTUpload() {
+    if (!audioCapturing) {
+        return;
+    }
+    if (isSharedAudioExporting()) {
+        skipSTTSessionAudio(); // The take below then only closes a finished listen window
+    } else {
+        coverStreamedAudio();
+    }
+    
+    STTUploadChunk chunk;
+    while (takeSTTSessionChunk(chunk)) {
+        // Hand off to the spool's uploader thread - never block the render thread on a socket
+        if (!enqueueSTTUpload(chunk.samples, chunk.sampleRate, &chunk.info)) {
+            std::cerr << "[WARNING] Audio: STT spool not running, dropping " << chunk.samples.size() << " samples" << std::endl;
+        }
+    }
+}
+
 void initAudioGeneration(int seed) {
     audioSeed = seed;
     audioInitialized = true;
-    srand(seed);
+    resetAudioRandom();
 }
 
 void playBassSound(float duration, float fadeInDuration) {
@@ -168,116 +294,65 @@ void playBassSound(float duration, float fadeInDuration) {
 }
 
 void updateAudio(float deltaTime) {
-    // Update waveform bars at 30fps (every 2 frames at 60fps)
-    frameCount++;
-    
-    // Only update every UPDATE_INTERVAL_FRAMES frames (30fps from 60fps)
-    if (frameCount % UPDATE_INTERVAL_FRAMES != 0) {
-#ifdef _WIN32
-        // Still need to send audio to Whisper STT
-        static double accumulatedTime = 0.0;
-        accumulatedTime += deltaTime;
-        static double lastSTTSend = 0.0;
-        if (audioCapturing && accumulatedTime - lastSTTSend >= 3.0) {
-            lastSTTSend = accumulatedTime;
-            std::vector<short> samplesToSend = capturedSamples;
-            if (samplesToSend.size() >= SAMPLES_TO_SEND) {
-                samplesToSend.erase(samplesToSend.begin(), samplesToSend.begin() + (samplesToSend.size() - SAMPLES_TO_SEND));
-            }
-            if (!samplesToSend.empty()) {
-                std::cout << "[DEBUG] Audio: Sending " << samplesToSend.size() << " samples to Whisper STT" << std::endl;
-                sendAudioToWhisper(samplesToSend, captureSampleRate, "localhost", 8070);
-            }
-        }
-#endif
-        return;
-    }
-    
-    // Only process if we have real audio data
-    // Don't generate simulated data - if no audio is capturing, just skip update
-#ifdef _WIN32
-    if (!audioCapturing) {
-        // No audio capturing - don't update waveform, just return
-        return;
-    }
-#endif
-    
-    // Calculate RMS from current sample buffer (from real microphone)
-    float rms = calculateRMS();
-    
-    // Silence detection: if RMS is below threshold, treat as silence
-    if (rms < SILENCE_THRESHOLD) {
-        rms = 0.0f; // Set to zero for silence
-    }
-    
-    // Add RMS to history
-    rmsHistory.insert(rmsHistory.begin(), rms);
-    if (rmsHistory.size() > RMS_HISTORY_SIZE) {
-        rmsHistory.resize(RMS_HISTORY_SIZE);
-    }
-    
-    // Track max RMS from history
-    maxRMSSeen = 0.0001f; // Reset to small value
-    for (float h : rmsHistory) {
-        if (h > maxRMSSeen) {
-            maxRMSSeen = h;
-        }
-    }
-    
-    // Calculate heightPercent = rms / maxRMSSeen (0.0 to 1.0)
-    float heightPercent = (maxRMSSeen > 0.0001f) ? (rms / maxRMSSeen) : 0.0f;
-    
-    // Apply clamp threshold: if heightPercent < clampPercent, set to 0
-    if (heightPercent < CLAMP_THRESHOLD) {
-        heightPercent = 0.0f;
-    }
-    
-    // Calculate bar height (heightPercent * 1.6 as per spec, clamped to 1.0)
-    float barHeight = fminf(heightPercent * 1.6f, 1.0f);
-    
-    // Add new bar to history
-    addBar(barHeight);
-    
-#ifdef _WIN32
-    // Send captured audio to Whisper STT every 3 seconds
-    static double accumulatedTime = 0.0;
-    accumulatedTime += deltaTime * UPDATE_INTERVAL_FRAMES; // Account for frame skip
-    static double lastSTTSend = 0.0;
-    if (audioCapturing && accumulatedTime - lastSTTSend >= 3.0) {
-        lastSTTSend = accumulatedTime;
-        std::vector<short> samplesToSend = capturedSamples;
-        if (samplesToSend.size() >= SAMPLES_TO_SEND) {
-            samplesToSend.erase(samplesToSend.begin(), samplesToSend.begin() + (samplesToSend.size() - SAMPLES_TO_SEND));
-        }
-        if (!samplesToSend.empty()) {
-            std::cout << "[DEBUG] Audio: Sending " << samplesToSend.size() << " samples to Whisper STT" << std::endl;
-            sendAudioToWhisper(samplesToSend, captureSampleRate, "localhost", 8070);
-        }
-    }
-#endif
+    // Send newly captured audio to Whisper STT
+    // Waveform bars are produced by the capture thread (see advanceWaveform)
+    updateSTTUpload();
+    updateLatencyReport();
 }
 
 std::vector<float> getWaveformAmplitudes() {
     // Return bar heights from history (convert BarData to float heights)
-    std::vector<float> heights;
-    heights.reserve(barHistory.size());
-    for (const auto& bar : barHistory) {
-        heights.push_back(bar.height);
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    std::vector<float> heights(getBarHistorySize());
+    for (size_t i = 0; i < heights.size(); i++) {
+        heights[i] = getBarByAge(i).height; // Newest first
     }
     return heights;
 }
 
+WaveformSnapshot getWaveformSnapshot() {
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    WaveformSnapshot snapshot;
+    snapshot.scroll = 0.0f;
+    snapshot.position = (double)barsPublished;
+    if (barsPublished == 0) return snapshot;
+    
+    // Blocks arrive in bursts; play each one out over the time it took to
+    // record, one block behind the newest sample, so the display never runs
+    // ahead of published bars
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastBlockTime).count();
+    double samplesBehind = std::max(0.0, lastBlockSamples - elapsed * waveformSampleRate);
+    double position = barsPublished + (barSamples - samplesBehind) / samplesPerBar;
+    double whole = std::floor(position);
+    size_t hidden = (size_t)std::max(0.0, (double)barsPublished - whole);
+    snapshot.scroll = (float)(position - whole);
+    snapshot.position = position;
+    
+    size_t bars = getBarHistorySize();
+    snapshot.heights.reserve(bars);
+    for (size_t i = hidden; i < bars; i++) {
+        snapshot.heights.push_back(getBarByAge(i).height);
+    }
+    return snapshot;
+}
+
+void readWaveformHistory(double seconds, int columns, WaveformView& view) {
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    readWaveformView(waveformHistory, seconds, columns, view);
+}
+
+uint64_t getWaveformBarCount() {
+    std::lock_guard<std::mutex> lock(waveformMutex);
+    return barsPublished;
+}
+
 // Get audio device name
 std::string getAudioDeviceName() {
     return audioDeviceName;
 }
 
 void cleanupAudio() {
-#ifdef _WIN32
     cleanupAudioCapture();
-#else
-    // Audio capture not supported on non-Windows
-#endif
     audioInitialized = false;
 }
 
@@ -288,7 +363,7 @@ int getAudioSeed() {
 void setAudioSeed(int seed) {
     audioSeed = seed;
     if (audioInitialized) {
-        srand(seed);
+        resetAudioRandom();
     }
 }
 
@@ -338,54 +413,248 @@ bool loadAudioSeed(const std::string& filename) {
     }
     
     /**
-     * If audio is already initialized, update random seed
+     * If audio is already initialized, restart the waveform stream
      * This ensures new seed takes effect immediately
      */
     if (audioInitialized) {
-        srand(audioSeed);
+        resetAudioRandom();
     }
     return true;
 }
 
+// Keep the newest samples in the fixed-size ring
+static void appendCapturedSamples(const short* samples, int numSamples) {
+    std::lock_guard<std::mutex> lock(capturedMutex);
+    size_t size = capturedRing.size();
+    if (size == 0 || numSamples <= 0) return;
+    size_t count = (size_t)numSamples;
+    if (count >= size) {
+        std::copy(samples + (count - size), samples + count, capturedRing.begin());
+        capturedWrite = 0;
+        capturedCount = size;
+        return;
+    }
+    size_t first = std::min(count, size - capturedWrite);
+    std::copy(samples, samples + first, capturedRing.begin() + capturedWrite);
+    std::copy(samples + first, samples + count, capturedRing.begin());
+    capturedWrite = (capturedWrite + count) % size;
+    capturedCount = std::min(size, capturedCount + count);
+}
+
+// Capture pipeline shared by the waveIn device and the file source
+// Takes one block of interleaved frames (captureChannels samples each)
+static void handleCapturedBlock(short* frames, int numFrames) {
+    CaptureTag tag = tagCapturedBlock(numFrames, captureSampleRate);
+    short* samples = frames;
+    int numSamples = numFrames;
+    if (captureChannels > 1) {
+        // One enhanced stream from the array; without a geometry, the first channel
+        numSamples = std::min(numFrames, (int)monoScratch.size());
+        if (getBeamformerChannels() == captureChannels) {
+            beamformBlock(frames, numSamples, monoScratch.data());
+        } else {
+            for (int i = 0; i < numSamples; i++) {
+                monoScratch[i] = frames[i * captureChannels];
+            }
+        }
+        samples = monoScratch.data();
+    }
+    
+    // High-pass, gate and AGC in place, so every consumer below sees the cleaned audio
+    if (isCaptureDSPEnabled()) {
+        processCaptureBlock(samples, numSamples);
+    }
+    recordLatencySince(LatencyStage::CAPTURE, tag.time);
+    appendCapturedSamples(samples, numSamples);
+    // Advance the session's capture clock (with a wake phrase configured, only
+    // while the phrase has opened a session) and stream the same audio
+    if (feedWakeGate(samples, numSamples, captureSampleRate, &tag)) {
+        pushSTTStreamSamples(samples, numSamples, tag.sample);
+        if (isSharedAudioExporting()) {
+            STTSessionStats session = getSTTSessionStats();
+            publishSharedAudio(samples, numSamples, session.sessionId, session.capturedSamples);
+        }
+    }
+    
+    // Convert captured short samples to float32 and advance the waveform
+    // This feeds the RMS-based waveform system on the audio sample clock
+    numSamples = std::min(numSamples, (int)floatScratch.size());
+    if (numSamples > 0) {
+        float* floatSamples = floatScratch.data();
+        for (int i = 0; i < numSamples; i++) {
+            // Convert 16-bit signed integer to float32 normalized range [-1.0, 1.0]
+            floatSamples[i] = (float)samples[i] / 32768.0f;
+        }
+        advanceWaveform(floatSamples, numSamples, tag);
+        
+        // Log periodically to verify real audio is being captured
+        static int callbackCount = 0;
+        callbackCount++;
+        if (callbackCount % 100 == 0) {
+            // Log every 100 callbacks (roughly every few seconds)
+            float currentRMS = computeRMS(floatSamples, numSamples);
+            logAudio("Audio callback: " + std::to_string(numSamples) + " samples, RMS: " + std::to_string(currentRMS));
+            if (isCaptureDSPEnabled()) {
+                CaptureDSPStats dsp = getCaptureDSPStats();
+                logAudio("Capture DSP: " + std::to_string(dsp.lastBlockUs) + " us/block (max " +
+                         std::to_string(dsp.maxBlockUs) + ", " + std::to_string(dsp.overBudgetBlocks) +
+                         " over budget), gain " + std::to_string(dsp.gainDb) + " dB, gate " +
+                         (dsp.gateOpen ? "open" : "closed"));
+            }
+            if (getBeamformerChannels() > 0) {
+                BeamformerStats beam = getBeamformerStats();
+                logAudio("Beamformer: " + std::to_string(beam.channels) + " mics, steering " +
+                         std::to_string((int)beam.steerDeg) + " deg (DOA " + std::to_string((int)beam.doaDeg) +
+                         " deg, confidence " + std::to_string(beam.doaConfidence) + "), " +
+                         std::to_string(beam.usPerAudioSecond) + " us per audio second");
+            }
+        }
+    }
+}
+
+static void beginCaptureRun() {
+    {
+        std::lock_guard<std::mutex> lock(capturedMutex);
+        capturedRing.assign(SAMPLES_TO_SEND, 0);
+        capturedWrite = 0;
+        capturedCount = 0;
+    }
+    floatScratch.assign(captureBlockFrames, 0.0f);
+    startWaveformRun(captureSampleRate);
+    audioCapturing = true;
+    if (!isKeywordSpotterActive()) {
+        beginSTTSession(captureSampleRate); // Each capture run is a new upload session
+    }
+}
+
+static void endCaptureRun() {
+    audioCapturing = false;
+    
+    // Upload the tail that did not fill a whole chunk (and whatever the stream did not carry)
+    STTUploadChunk chunk;
+    if (!isSharedAudioExporting()) {
+        coverStreamedAudio();
+        while (takeSTTSessionChunk(chunk, true)) {
+            enqueueSTTUpload(chunk.samples, chunk.sampleRate, &chunk.info);
+        }
+    }
+    endSTTSession();
+}
+
+// File source thread: feeds the WAV in FILE_BLOCK_FRAMES blocks, paced like
+// a device when realtime, then ends the capture run at the end of the file
+static void runFileSource() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<short> block(FILE_BLOCK_FRAMES * captureChannels);
+    size_t totalFrames = fileSourceFrames.size() / captureChannels;
+    for (size_t frame = 0; frame < totalFrames && !fileSourceStop; frame += FILE_BLOCK_FRAMES) {
+        size_t count = std::min((size_t)FILE_BLOCK_FRAMES, totalFrames - frame);
+        if (fileSourceRealtime) {
+            // A device hands over each block once it has been fully recorded
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((double)(frame + count) / captureSampleRate)));
+        }
+        // The pipeline works in place - keep the source intact for the next run
+        std::copy(fileSourceFrames.begin() + frame * captureChannels,
+                  fileSourceFrames.begin() + (frame + count) * captureChannels, block.begin());
+        handleCapturedBlock(block.data(), (int)count);
+    }
+    endCaptureRun();
+}
+
+bool initAudioCaptureFromFile(const std::string& path, int sampleRate, bool realtime) {
+    cleanupAudioCapture();
+    
+    std::vector<short> frames;
+    int channels = 0, rate = 0;
+    if (!loadWAVFileChannels(path, frames, channels, rate)) {
+        std::cerr << "[ERROR] Audio: Cannot read capture source " << path << " (16-bit PCM WAV expected)" << std::endl;
+        return false;
+    }
+    if (rate != sampleRate) {
+        std::cerr << "[ERROR] Audio: Capture source " << path << " is " << rate << " Hz, capture runs at " << sampleRate << " Hz" << std::endl;
+        return false;
+    }
+    int arrayChannels = getBeamformerChannels();
+    if (arrayChannels > 0 && channels != arrayChannels) {
+        std::cerr << "[ERROR] Audio: Capture source " << path << " has " << channels << " channel(s), mic array has "
+                  << arrayChannels << std::endl;
+        return false;
+    }
+    if (arrayChannels == 0 && channels > 1) {
+        std::cerr << "[WARNING] Audio: No mic array configured - using the first of " << channels << " channels" << std::endl;
+    }
+    
+    fileSourceFrames.swap(frames);
+    captureChannels = channels;
+    captureSampleRate = rate;
+    captureBlockFrames = FILE_BLOCK_FRAMES;
+    monoScratch.assign(FILE_BLOCK_FRAMES, 0);
+    fileSourceRealtime = realtime;
+    fileSourceLoaded = true;
+    audioDeviceName = "File: " + path;
+    logAudio("Audio capture from file " + path + ": " + std::to_string(channels) + " channel(s), " +
+             std::to_string(fileSourceFrames.size() / channels) + " frames at " + std::to_string(rate) + " Hz");
+    std::cout << "[DEBUG] Audio: Capture source is " << path << " (" << channels << " channel(s))" << std::endl;
+    return true;
+}
+
+static void startFileSource() {
+    if (audioCapturing) {
+        return;
+    }
+    if (fileSourceThread.joinable()) {
+        fileSourceThread.join(); // Previous run reached the end of the file
+    }
+    fileSourceStop = false;
+    beginCaptureRun();
+    fileSourceThread = std::thread(runFileSource);
+    std::cout << "[DEBUG] Audio: Capture started" << std::endl;
+}
+
+static void stopFileSource() {
+    fileSourceStop = true;
+    if (fileSourceThread.joinable()) {
+        fileSourceThread.join(); // The thread ends the capture run itself
+        std::cout << "[DEBUG] Audio: Capture stopped" << std::endl;
+    }
+}
+
+static void cleanupFileSource() {
+    stopFileSource();
+    fileSourceLoaded = false;
+    fileSourceFrames.clear();
+    captureChannels = 1;
+}
+
+bool isAudioCapturing() {
+    return audioCapturing;
+}
+
+std::vector<short> getCapturedAudioSamples() {
+    std::lock_guard<std::mutex> lock(capturedMutex);
+    std::vector<short> samples(capturedCount);
+    size_t start = capturedCount < capturedRing.size() ? 0 : capturedWrite;
+    for (size_t i = 0; i < capturedCount; i++) {
+        samples[i] = capturedRing[(start + i) % capturedRing.size()];
+    }
+    return samples;
+}
+
 #ifdef _WIN32
 // Windows audio capture functions (continued from line 10)
 // All common functions are defined above (lines 85-247)
 
+// KSDATAFORMAT_SUBTYPE_PCM, spelled out to avoid pulling in ksmedia.h and its GUID library
+static const GUID PCM_SUBFORMAT = {0x00000001, 0x0000, 0x0010, {0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71}};
+
 // Windows audio capture callback
 static void CALLBACK waveInProc(HWAVEIN hWaveIn, UINT uMsg, DWORD_PTR dwInstance, DWORD_PTR dwParam1, DWORD_PTR dwParam2) {
     if (uMsg == WIM_DATA) {
         WAVEHDR* pwh = (WAVEHDR*)dwParam1;
         if (pwh && pwh->dwBytesRecorded > 0) {
-            // Add captured samples to buffer
-            int numSamples = pwh->dwBytesRecorded / sizeof(short);
-            short* samples = (short*)pwh->lpData;
-            capturedSamples.insert(capturedSamples.end(), samples, samples + numSamples);
-            
-            // Keep buffer size manageable - keep last SAMPLES_TO_SEND samples
-            if (capturedSamples.size() > SAMPLES_TO_SEND) {
-                capturedSamples.erase(capturedSamples.begin(), capturedSamples.begin() + (capturedSamples.size() - SAMPLES_TO_SEND));
-            }
-            
-            // Convert captured short samples to float32 and add to circular buffer
-            // This feeds the RMS-based waveform system
-            if (numSamples > 0) {
-                std::vector<float> floatSamples(numSamples);
-                for (int i = 0; i < numSamples; i++) {
-                    // Convert 16-bit signed integer to float32 normalized range [-1.0, 1.0]
-                    floatSamples[i] = (float)samples[i] / 32768.0f;
-                }
-                // Add samples to circular buffer for RMS calculation
-                updateAudioSamples(floatSamples.data(), numSamples);
-                
-                // Log periodically to verify real audio is being captured
-                static int callbackCount = 0;
-                callbackCount++;
-                if (callbackCount % 100 == 0) {
-                    // Log every 100 callbacks (roughly every few seconds)
-                    float currentRMS = calculateRMS();
-                    logAudio("Audio callback: " + std::to_string(numSamples) + " samples, RMS: " + std::to_string(currentRMS));
-                }
-            }
+            int numFrames = pwh->dwBytesRecorded / (sizeof(short) * captureChannels);
+            handleCapturedBlock((short*)pwh->lpData, numFrames);
         }
         
         // Re-add buffer for continuous capture
@@ -397,21 +666,31 @@ static void CALLBACK waveInProc(HWAVEIN hWaveIn, UINT uMsg, DWORD_PTR dwInstance
     }
 }
 
+// PCM16 format for the given channel count (more than two needs the extensible header)
+static void setCaptureFormat(int sampleRate, int channels) {
+    wfx = WAVEFORMATEXTENSIBLE();
+    wfx.Format.wFormatTag = channels > 2 ? WAVE_FORMAT_EXTENSIBLE : WAVE_FORMAT_PCM;
+    wfx.Format.nChannels = channels;
+    wfx.Format.nSamplesPerSec = sampleRate;
+    wfx.Format.wBitsPerSample = 16;
+    wfx.Format.nBlockAlign = wfx.Format.nChannels * (wfx.Format.wBitsPerSample / 8);
+    wfx.Format.nAvgBytesPerSec = wfx.Format.nSamplesPerSec * wfx.Format.nBlockAlign;
+    wfx.Format.cbSize = channels > 2 ? sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX) : 0;
+    wfx.Samples.wValidBitsPerSample = 16;
+    wfx.dwChannelMask = 0; // Array channels have no speaker positions
+    wfx.SubFormat = PCM_SUBFORMAT;
+}
+
 bool initAudioCapture(int sampleRate) {
     if (hWaveIn != NULL) {
         return true; // Already initialized
     }
+    cleanupFileSource();
     
     captureSampleRate = sampleRate;
-    
-    // Set up WAVEFORMATEX structure
-    wfx.wFormatTag = WAVE_FORMAT_PCM;
-    wfx.nChannels = 1; // Mono
-    wfx.nSamplesPerSec = sampleRate;
-    wfx.wBitsPerSample = 16;
-    wfx.nBlockAlign = wfx.nChannels * (wfx.wBitsPerSample / 8);
-    wfx.nAvgBytesPerSec = wfx.nSamplesPerSec * wfx.nBlockAlign;
-    wfx.cbSize = 0;
+    // One channel per microphone when an array geometry is configured
+    captureChannels = std::max(1, getBeamformerChannels());
+    setCaptureFormat(sampleRate, captureChannels);
     
     // Get number of audio input devices and log default device info
     UINT numDevices = waveInGetNumDevs();
@@ -440,16 +719,28 @@ bool initAudioCapture(int sampleRate) {
     }
     
     // Open wave input device
-    MMRESULT result = waveInOpen(&hWaveIn, WAVE_MAPPER, &wfx, (DWORD_PTR)waveInProc, 0, CALLBACK_FUNCTION);
+    MMRESULT result = waveInOpen(&hWaveIn, WAVE_MAPPER, &wfx.Format, (DWORD_PTR)waveInProc, 0, CALLBACK_FUNCTION);
+    if (result != MMSYSERR_NOERROR && captureChannels > 1) {
+        // Device cannot deliver the array's channels - carry on without beamforming
+        std::cerr << "[WARNING] Audio: " << captureChannels << "-channel capture unavailable (" << result
+                  << "), falling back to mono" << std::endl;
+        logAudio("Mic array capture unavailable - mono fallback");
+        captureChannels = 1;
+        setCaptureFormat(sampleRate, 1);
+        result = waveInOpen(&hWaveIn, WAVE_MAPPER, &wfx.Format, (DWORD_PTR)waveInProc, 0, CALLBACK_FUNCTION);
+    }
     if (result != MMSYSERR_NOERROR) {
         std::cerr << "[ERROR] Audio: waveInOpen failed: " << result << std::endl;
         return false;
     }
+    captureBlockFrames = CAPTURE_BUFFER_SIZE;
+    monoScratch.assign(captureChannels > 1 ? CAPTURE_BUFFER_SIZE : 0, 0);
     
     // Prepare buffers
+    DWORD bufferBytes = CAPTURE_BUFFER_SIZE * sizeof(short) * captureChannels;
     for (int i = 0; i < 2; i++) {
-        waveHdr[i].lpData = (LPSTR)malloc(CAPTURE_BUFFER_SIZE * sizeof(short));
-        waveHdr[i].dwBufferLength = CAPTURE_BUFFER_SIZE * sizeof(short);
+        waveHdr[i].lpData = (LPSTR)malloc(bufferBytes);
+        waveHdr[i].dwBufferLength = bufferBytes;
         waveHdr[i].dwFlags = 0;
         
         result = waveInPrepareHeader(hWaveIn, &waveHdr[i], sizeof(WAVEHDR));
@@ -461,12 +752,13 @@ bool initAudioCapture(int sampleRate) {
         }
     }
     
-    std::cout << "[DEBUG] Audio: Capture initialized at " << sampleRate << "Hz" << std::endl;
+    std::cout << "[DEBUG] Audio: Capture initialized at " << sampleRate << "Hz, " << captureChannels << " channel(s)" << std::endl;
     return true;
 }
 
 void cleanupAudioCapture() {
     stopAudioCapture();
+    cleanupFileSource();
     
     if (hWaveIn) {
         // Free buffers
@@ -481,11 +773,19 @@ void cleanupAudioCapture() {
         hWaveIn = NULL;
     }
     
-    capturedSamples.clear();
+    {
+        std::lock_guard<std::mutex> lock(capturedMutex);
+        capturedCount = 0;
+        capturedWrite = 0;
+    }
     std::cout << "[DEBUG] Audio: Capture cleaned up" << std::endl;
 }
 
 void startAudioCapture() {
+    if (fileSourceLoaded) {
+        startFileSource();
+        return;
+    }
     if (!hWaveIn || audioCapturing) {
         return;
     }
@@ -499,19 +799,25 @@ void startAudioCapture() {
         }
     }
     
-    // Start recording
+    // Set up the run before recording: the first block can arrive on the
+    // driver thread as soon as waveInStart returns
+    beginCaptureRun();
     MMRESULT result = waveInStart(hWaveIn);
     if (result != MMSYSERR_NOERROR) {
         std::cerr << "[ERROR] Audio: waveInStart failed: " << result << std::endl;
+        waveInReset(hWaveIn);
+        endCaptureRun();
         return;
     }
     
-    audioCapturing = true;
-    capturedSamples.clear();
     std::cout << "[DEBUG] Audio: Capture started" << std::endl;
 }
 
 void stopAudioCapture() {
+    if (fileSourceLoaded) {
+        stopFileSource();
+        return;
+    }
     if (!hWaveIn || !audioCapturing) {
         return;
     }
@@ -524,42 +830,33 @@ void stopAudioCapture() {
         waveInUnprepareHeader(hWaveIn, &waveHdr[i], sizeof(WAVEHDR));
     }
     
-    audioCapturing = false;
+    endCaptureRun();
     std::cout << "[DEBUG] Audio: Capture stopped" << std::endl;
 }
 
-bool isAudioCapturing() {
-    return audioCapturing;
-}
-
-std::vector<short> getCapturedAudioSamples() {
-    return capturedSamples;
-}
-
 #else
-// Non-Windows stub implementation - only platform-specific functions here
+// Non-Windows: no capture device, only the file source
 bool initAudioCapture(int sampleRate) {
     return false;
 }
 
 void cleanupAudioCapture() {
-    // No-op on non-Windows
+    cleanupFileSource();
+    {
+        std::lock_guard<std::mutex> lock(capturedMutex);
+        capturedCount = 0;
+        capturedWrite = 0;
+    }
 }
 
 void startAudioCapture() {
-    // No-op on non-Windows
+    if (fileSourceLoaded) {
+        startFileSource();
+    }
 }
 
 void stopAudioCapture() {
-    // No-op on non-Windows
-}
-
-bool isAudioCapturing() {
-    return false;
-}
-
-std::vector<short> getCapturedAudioSamples() {
-    return std::vector<short>();
+    stopFileSource();
 }
 
 #endif // _WIN32
@@ -1,6 +1,8 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include "waveform_pyramid.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -14,11 +16,24 @@ void setAudioSeed(int seed);
 bool saveAudioSeed(const std::string& filename);
 bool loadAudioSeed(const std::string& filename);
 
-// Waveform widget - amplitude values updated every 100ms
-std::vector<float> getWaveformAmplitudes(); // Returns amplitude values for waveform bars
+// Waveform widget - one bar per 1/30 s of captured audio, whatever the frame rate
+std::vector<float> getWaveformAmplitudes(); // Returns amplitude values for waveform bars (newest first)
+struct WaveformSnapshot {
+    std::vector<float> heights; // Bars due on screen now, newest first
+    float scroll;               // 0..1: progress of the bar after heights[0], for smooth scrolling
+    double position;            // Bars scrolled in since startup, including scroll
+};
+WaveformSnapshot getWaveformSnapshot();
+uint64_t getWaveformBarCount(); // Bars published since startup
+// Min/max/RMS columns over the last `seconds` of capture (up to hours), read
+// from a decimation pyramid so the cost follows `columns`, not the window
+void readWaveformHistory(double seconds, int columns, WaveformView& view);
 
 // Audio capture and STT
 bool initAudioCapture(int sampleRate = 44100);
+// File-source backend: a 16-bit PCM WAV (mono, or one channel per array microphone)
+// runs through the same pipeline as the device; realtime=false feeds it as fast as possible
+bool initAudioCaptureFromFile(const std::string& path, int sampleRate = 44100, bool realtime = true);
 void cleanupAudioCapture();
 void startAudioCapture();
 void stopAudioCapture();
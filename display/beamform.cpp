@@ -0,0 +1,415 @@
+#include "beamform.h"
+#include "fft.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BF_SSE2 1
+#include <emmintrin.h>
+#else
+#define BF_SSE2 0
+#endif
+
+static const double PI = 3.14159265358979323846;
+static const int FD_TAPS = 16;             // Fractional-delay FIR length
+static const size_t CHUNK_FRAMES = 1024;   // Frames beamformed per pass
+static const int DOA_GRID = 360;           // Candidate azimuths, 1 degree apart
+static const int INTERP_TAPS = 8;          // Windowed-sinc taps reading the correlation between lags
+static const float DOA_SMOOTHING = 0.6f;   // Weight of the previous frames in the averaged cross-spectra
+
+// Delay-and-sum state (owned by the capture thread once initialized)
+static bool active = false;
+static BeamformerConfig bfConfig;
+static int bfRate = 44100;
+static int channels = 0;
+static int historyLen = 0;                 // Samples carried over per channel for the delay lines
+static std::vector<float> lines;           // channels x (historyLen + CHUNK_FRAMES)
+static std::vector<float> taps;            // channels x FD_TAPS, scaled by 1/channels
+static std::vector<int> intDelay;
+static std::vector<float> accum;           // CHUNK_FRAMES
+static float currentSteer = 0.0f;
+
+// GCC-PHAT direction of arrival
+static FFTPlan doaPlan;
+static std::vector<float> doaWindow;
+static std::vector<float> doaFrames;       // channels x doaFrame
+static int doaFill = 0;
+static std::vector<float> spectraRe;       // channels x doaFrame
+static std::vector<float> spectraIm;
+static std::vector<float> crossRe;
+static std::vector<float> crossIm;
+static std::vector<float> phaseRe;         // pairs x doaFrame: averaged PHAT cross-spectra
+static std::vector<float> phaseIm;
+static int maxLag = 0;
+static std::vector<std::pair<int, int>> pairs;
+static std::vector<int> pairLagBase;       // pairs x DOA_GRID: first correlation index to read...
+static std::vector<float> pairLagWeights;  // ...and INTERP_TAPS weights landing on the predicted lag
+static std::vector<float> pairCorr;        // pairs x (2 * maxLag + 1)
+
+static std::mutex statsMutex;
+static BeamformerStats bfStats;
+static double totalBlockUs = 0.0;
+static double totalAudioSeconds = 0.0;
+static uint64_t blockCount = 0;
+
+bool parseMicArray(const std::string& spec, std::vector<MicPosition>& mics) {
+    mics.clear();
+    std::stringstream list(spec);
+    std::string entry;
+    while (std::getline(list, entry, ';')) {
+        if (entry.find_first_not_of(" \t") == std::string::npos) continue;
+        MicPosition mic;
+        char comma = 0;
+        std::stringstream coords(entry);
+        if (!(coords >> mic.x >> comma >> mic.y) || comma != ',') {
+            mics.clear();
+            return false;
+        }
+        mics.push_back(mic);
+    }
+    return mics.size() >= 2;
+}
+
+// Distance along the look direction: larger means the wavefront arrives earlier
+static double projection(const MicPosition& mic, double azimuthDeg) {
+    double a = azimuthDeg * PI / 180.0;
+    return mic.x * cos(a) + mic.y * sin(a);
+}
+
+// Hann-windowed sinc centred on FD_TAPS / 2 - 1 + frac, unity gain at DC
+static void designFractionalDelay(double frac, float* h) {
+    double centre = FD_TAPS / 2 - 1 + frac;
+    double sum = 0.0;
+    for (int k = 0; k < FD_TAPS; k++) {
+        double t = k - centre;
+        double sinc = fabs(t) < 1e-9 ? 1.0 : sin(PI * t) / (PI * t);
+        double window = 0.5 * (1.0 + cos(PI * t / (FD_TAPS / 2)));
+        h[k] = (float)(sinc * window);
+        sum += h[k];
+    }
+    for (int k = 0; k < FD_TAPS; k++) {
+        h[k] = (float)(h[k] / sum);
+    }
+}
+
+static void steer(float azimuthDeg) {
+    double minProjection = 1e9;
+    for (const MicPosition& mic : bfConfig.mics) {
+        minProjection = std::min(minProjection, projection(mic, azimuthDeg));
+    }
+    for (int m = 0; m < channels; m++) {
+        // Delay the early microphones until they line up with the last one
+        double delay = (projection(bfConfig.mics[m], azimuthDeg) - minProjection) / bfConfig.speedOfSound * bfRate;
+        intDelay[m] = (int)floor(delay);
+        designFractionalDelay(delay - intDelay[m], &taps[m * FD_TAPS]);
+        for (int k = 0; k < FD_TAPS; k++) {
+            taps[m * FD_TAPS + k] /= channels;
+        }
+    }
+    currentSteer = azimuthDeg;
+}
+
+bool initBeamformer(const BeamformerConfig& config, int sampleRate) {
+    shutdownBeamformer();
+    if (config.mics.size() < 2 || sampleRate <= 0 || config.speedOfSound <= 0.0f) {
+        std::cerr << "[ERROR] Beamformer: Need at least two microphones" << std::endl;
+        return false;
+    }
+    if (!initFFTPlan(doaPlan, config.doaFrame) || config.doaFrame < 64) {
+        std::cerr << "[ERROR] Beamformer: DOA frame must be a power of two >= 64" << std::endl;
+        return false;
+    }
+
+    double aperture = 0.0;
+    for (size_t i = 0; i < config.mics.size(); i++) {
+        for (size_t j = i + 1; j < config.mics.size(); j++) {
+            aperture = std::max(aperture, (double)hypotf(config.mics[i].x - config.mics[j].x, config.mics[i].y - config.mics[j].y));
+        }
+    }
+    double maxDelay = aperture / config.speedOfSound * sampleRate;
+    if (2 * (maxDelay + INTERP_TAPS) >= config.doaFrame / 2) {
+        std::cerr << "[ERROR] Beamformer: Array aperture " << aperture << " m is too wide for the DOA frame" << std::endl;
+        return false;
+    }
+
+    bfConfig = config;
+    bfRate = sampleRate;
+    channels = (int)config.mics.size();
+    historyLen = (int)ceil(maxDelay) + FD_TAPS;
+    lines.assign(channels * (historyLen + CHUNK_FRAMES), 0.0f);
+    taps.assign(channels * FD_TAPS, 0.0f);
+    intDelay.assign(channels, 0);
+    accum.assign(CHUNK_FRAMES, 0.0f);
+    steer(config.steerDeg >= 0.0f ? config.steerDeg : 0.0f);
+
+    int n = config.doaFrame;
+    doaWindow.resize(n);
+    for (int i = 0; i < n; i++) {
+        doaWindow[i] = (float)(0.5 - 0.5 * cos(2.0 * PI * i / n));
+    }
+    doaFrames.assign(channels * n, 0.0f);
+    doaFill = 0;
+    spectraRe.assign(channels * n, 0.0f);
+    spectraIm.assign(channels * n, 0.0f);
+    crossRe.assign(n, 0.0f);
+    crossIm.assign(n, 0.0f);
+    maxLag = (int)ceil(maxDelay) + INTERP_TAPS / 2 + 1;
+    pairs.clear();
+    for (int i = 0; i < channels; i++) {
+        for (int j = i + 1; j < channels; j++) {
+            pairs.push_back(std::make_pair(i, j));
+        }
+    }
+    pairLagBase.resize(pairs.size() * DOA_GRID);
+    pairLagWeights.resize(pairs.size() * DOA_GRID * INTERP_TAPS);
+    for (size_t p = 0; p < pairs.size(); p++) {
+        for (int g = 0; g < DOA_GRID; g++) {
+            // x_i(t) ~ s(t + proj_i / c): the correlation peaks at proj_j - proj_i
+            double lag = (projection(config.mics[pairs[p].second], g) - projection(config.mics[pairs[p].first], g)) /
+                         config.speedOfSound * sampleRate;
+            double position = lag + maxLag;
+            int base = (int)floor(position) - INTERP_TAPS / 2 + 1;
+            pairLagBase[p * DOA_GRID + g] = base;
+            float* weights = &pairLagWeights[(p * DOA_GRID + g) * INTERP_TAPS];
+            for (int k = 0; k < INTERP_TAPS; k++) {
+                double t = base + k - position;
+                double sinc = fabs(t) < 1e-9 ? 1.0 : sin(PI * t) / (PI * t);
+                weights[k] = (float)(sinc * 0.5 * (1.0 + cos(PI * t / (INTERP_TAPS / 2))));
+            }
+        }
+    }
+    pairCorr.assign(pairs.size() * (2 * maxLag + 1), 0.0f);
+    phaseRe.assign(pairs.size() * n, 0.0f);
+    phaseIm.assign(pairs.size() * n, 0.0f);
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        bfStats = BeamformerStats();
+        bfStats.channels = channels;
+        bfStats.steerDeg = currentSteer;
+        bfStats.doaDeg = -1.0f;
+        totalBlockUs = 0.0;
+        totalAudioSeconds = 0.0;
+        blockCount = 0;
+    }
+    active = true;
+    std::cout << "[DEBUG] Beamformer: " << channels << " mics, aperture " << aperture * 100.0 << " cm, "
+              << (config.steerDeg >= 0.0f ? "fixed at " + std::to_string((int)config.steerDeg) + " deg" : std::string("tracking DOA"))
+              << (BF_SSE2 ? " (SSE2)" : " (scalar)") << std::endl;
+    return true;
+}
+
+void shutdownBeamformer() {
+    active = false;
+    channels = 0;
+}
+
+int getBeamformerChannels() {
+    return active ? channels : 0;
+}
+
+// acc[i] += src[i] * gain
+static void accumulateScaled(float* acc, const float* src, float gain, size_t count) {
+    size_t i = 0;
+#if BF_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    }
+#endif
+    for (; i < count; i++) {
+        acc[i] += src[i] * gain;
+    }
+}
+
+static void floatToPCM(const float* input, short* output, size_t count) {
+    size_t i = 0;
+#if BF_SSE2
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(input + i), scale));
+        __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(input + i + 4), scale));
+        _mm_storeu_si128((__m128i*)(output + i), _mm_packs_epi32(low, high)); // Saturating
+    }
+#endif
+    for (; i < count; i++) {
+        float value = std::max(-32768.0f, std::min(32767.0f, input[i] * 32768.0f));
+        output[i] = (short)lrintf(value);
+    }
+}
+
+// Phase-transform cross-correlation of spectra a and b, kept for lags -maxLag..maxLag
+// The unit cross-spectra are averaged over frames: bins holding the talker keep a
+// steady phase and add up, bins holding only noise wander and cancel out
+static void gccPhat(const float* aRe, const float* aIm, const float* bRe, const float* bIm, int n,
+                    float* averageRe, float* averageIm, float* correlation) {
+    for (int k = 0; k < n; k++) {
+        float re = aRe[k] * bRe[k] + aIm[k] * bIm[k];
+        float im = aIm[k] * bRe[k] - aRe[k] * bIm[k];
+        float inverseMagnitude = (1.0f - DOA_SMOOTHING) / (sqrtf(re * re + im * im) + 1e-12f);
+        averageRe[k] = averageRe[k] * DOA_SMOOTHING + re * inverseMagnitude;
+        averageIm[k] = averageIm[k] * DOA_SMOOTHING + im * inverseMagnitude;
+        // Inverse transform as conj(FFT(conj(X))) / n; only the real part is needed
+        crossRe[k] = averageRe[k];
+        crossIm[k] = -averageIm[k];
+    }
+    fftForward(doaPlan, crossRe.data(), crossIm.data());
+    for (int lag = -maxLag; lag <= maxLag; lag++) {
+        correlation[lag + maxLag] = crossRe[(lag + n) % n] / n;
+    }
+}
+
+static void estimateDirection() {
+    int n = bfConfig.doaFrame;
+    double energy = 0.0;
+    for (float x : doaFrames) {
+        energy += x * x;
+    }
+    if (10.0 * log10(energy / doaFrames.size() + 1e-20) < bfConfig.doaMinDbfs) {
+        return; // Too quiet to locate anything; keep the current beam
+    }
+
+    for (int m = 0; m < channels; m++) {
+        float* re = &spectraRe[m * n];
+        float* im = &spectraIm[m * n];
+        for (int i = 0; i < n; i++) {
+            re[i] = doaFrames[m * n + i] * doaWindow[i];
+            im[i] = 0.0f;
+        }
+        fftForward(doaPlan, re, im);
+    }
+    int span = 2 * maxLag + 1;
+    for (size_t p = 0; p < pairs.size(); p++) {
+        int i = pairs[p].first, j = pairs[p].second;
+        gccPhat(&spectraRe[i * n], &spectraIm[i * n], &spectraRe[j * n], &spectraIm[j * n], n,
+                &phaseRe[p * n], &phaseIm[p * n], &pairCorr[p * span]);
+    }
+
+    // Steered response: sum each pair's correlation at the lag the azimuth predicts
+    int bestAzimuth = 0;
+    float bestScore = -1e9f;
+    for (int g = 0; g < DOA_GRID; g++) {
+        float score = 0.0f;
+        for (size_t p = 0; p < pairs.size(); p++) {
+            // The correlation is band-limited: interpolate it with a short sinc
+            const float* r = &pairCorr[p * span + pairLagBase[p * DOA_GRID + g]];
+            const float* weights = &pairLagWeights[(p * DOA_GRID + g) * INTERP_TAPS];
+            for (int k = 0; k < INTERP_TAPS; k++) {
+                score += r[k] * weights[k];
+            }
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestAzimuth = g;
+        }
+    }
+    float confidence = bestScore / pairs.size();
+    if (bfConfig.steerDeg < 0.0f && confidence >= bfConfig.doaMinConfidence && bestAzimuth != (int)currentSteer) {
+        steer((float)bestAzimuth);
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    bfStats.doaDeg = (float)bestAzimuth;
+    bfStats.doaConfidence = confidence;
+    bfStats.doaUpdates++;
+    bfStats.steerDeg = currentSteer;
+}
+
+void beamformBlock(const short* interleaved, size_t frames, short* output) {
+    if (!active || !interleaved || !output) return;
+    auto start = std::chrono::steady_clock::now();
+    const size_t stride = historyLen + CHUNK_FRAMES;
+    const float scale = 1.0f / 32768.0f;
+
+    for (size_t offset = 0; offset < frames; offset += CHUNK_FRAMES) {
+        size_t n = std::min(CHUNK_FRAMES, frames - offset);
+        const short* in = interleaved + offset * channels;
+        for (int m = 0; m < channels; m++) {
+            float* line = &lines[m * stride + historyLen];
+            for (size_t i = 0; i < n; i++) {
+                line[i] = in[i * channels + m] * scale;
+            }
+        }
+
+        std::fill(accum.begin(), accum.begin() + n, 0.0f);
+        for (int m = 0; m < channels; m++) {
+            const float* line = &lines[m * stride + historyLen - intDelay[m]];
+            for (int k = 0; k < FD_TAPS; k++) {
+                accumulateScaled(accum.data(), line - k, taps[m * FD_TAPS + k], n);
+            }
+        }
+        floatToPCM(accum.data(), output + offset, n);
+
+        // Collect raw channels for the next DOA frame; re-steering waits for a chunk boundary
+        size_t consumed = 0;
+        while (consumed < n) {
+            size_t take = std::min(n - consumed, (size_t)(bfConfig.doaFrame - doaFill));
+            for (int m = 0; m < channels; m++) {
+                memcpy(&doaFrames[m * bfConfig.doaFrame + doaFill], &lines[m * stride + historyLen + consumed], take * sizeof(float));
+            }
+            doaFill += (int)take;
+            consumed += take;
+            if (doaFill == bfConfig.doaFrame) {
+                estimateDirection();
+                doaFill = 0;
+            }
+        }
+
+        for (int m = 0; m < channels; m++) {
+            float* line = &lines[m * stride];
+            memmove(line, line + n, historyLen * sizeof(float));
+        }
+    }
+
+    double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    bfStats.frames += frames;
+    bfStats.lastBlockUs = elapsedUs;
+    totalBlockUs += elapsedUs;
+    totalAudioSeconds += (double)frames / bfRate;
+    blockCount++;
+    bfStats.meanBlockUs = totalBlockUs / blockCount;
+    bfStats.usPerAudioSecond = totalAudioSeconds > 0.0 ? totalBlockUs / totalAudioSeconds : 0.0;
+}
+
+BeamformerStats getBeamformerStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return bfStats;
+}
+
+float estimateTDOA(const float* a, const float* b, size_t count, int maxLagSamples) {
+    int n = 4;
+    while ((size_t)n < 2 * count) n *= 2; // Zero-pad so the correlation does not wrap
+    FFTPlan plan;
+    initFFTPlan(plan, n);
+    std::vector<float> aRe(n, 0.0f), aIm(n, 0.0f), bRe(n, 0.0f), bIm(n, 0.0f);
+    std::copy(a, a + count, aRe.begin());
+    std::copy(b, b + count, bRe.begin());
+    fftForward(plan, aRe.data(), aIm.data());
+    fftForward(plan, bRe.data(), bIm.data());
+    for (int k = 0; k < n; k++) {
+        float re = aRe[k] * bRe[k] + aIm[k] * bIm[k];
+        float im = aIm[k] * bRe[k] - aRe[k] * bIm[k];
+        float inverseMagnitude = 1.0f / (sqrtf(re * re + im * im) + 1e-12f);
+        aRe[k] = re * inverseMagnitude;
+        aIm[k] = -im * inverseMagnitude;
+    }
+    fftForward(plan, aRe.data(), aIm.data());
+
+    maxLagSamples = std::min(maxLagSamples, n / 2 - 1);
+    auto at = [&](int lag) { return aRe[(lag + n) % n]; };
+    int best = 0;
+    for (int lag = -maxLagSamples; lag <= maxLagSamples; lag++) {
+        if (at(lag) > at(best)) best = lag;
+    }
+    // Parabolic interpolation around the peak
+    float left = at(best - 1), centre = at(best), right = at(best + 1);
+    float denominator = left - 2.0f * centre + right;
+    float offset = fabsf(denominator) > 1e-12f ? 0.5f * (left - right) / denominator : 0.0f;
+    return -(best + offset); // r peaks at -delay when b lags a
+}
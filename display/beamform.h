@@ -0,0 +1,59 @@
+#ifndef BEAMFORM_H
+#define BEAMFORM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Microphone-array front end: one enhanced mono stream from N channels
+// Delay-and-sum: each channel is delayed by a windowed-sinc fractional-delay
+// FIR so a plane wave from the look direction lines up across the array,
+// then the channels are averaged (SSE2 accumulation where available).
+// Direction of arrival comes from GCC-PHAT: every microphone pair's
+// phase-transform cross-correlation is evaluated at the lags each candidate
+// azimuth predicts, and the best-scoring azimuth wins (SRP-PHAT). With no
+// fixed look direction the beam follows that estimate.
+
+struct MicPosition {
+    float x, y; // Metres, in the array plane
+};
+
+struct BeamformerConfig {
+    std::vector<MicPosition> mics;
+    float steerDeg = -1.0f;          // Fixed look direction; negative follows the DOA estimate
+    int doaFrame = 2048;             // Samples per GCC-PHAT analysis (power of two)
+    float doaMinDbfs = -50.0f;       // Quieter frames do not move the beam
+    float doaMinConfidence = 0.2f;   // Mean pair correlation needed to re-steer
+    float speedOfSound = 343.0f;
+};
+
+struct BeamformerStats {
+    int channels;
+    uint64_t frames;
+    float steerDeg;                  // Current look direction
+    float doaDeg;                    // Latest DOA estimate
+    float doaConfidence;
+    uint64_t doaUpdates;
+    double lastBlockUs;              // Beamforming + DOA time of the last block
+    double meanBlockUs;
+    double usPerAudioSecond;         // Processing cost per second of capture
+};
+
+// "x,y; x,y; ..." in metres; false unless at least two microphones parse
+bool parseMicArray(const std::string& spec, std::vector<MicPosition>& mics);
+
+// Configure before capture starts (not thread-safe against beamformBlock)
+bool initBeamformer(const BeamformerConfig& config, int sampleRate);
+void shutdownBeamformer();
+int getBeamformerChannels(); // 0 while inactive
+
+// Capture thread: interleaved frames in (one sample per microphone), one mono sample per frame out
+void beamformBlock(const short* interleaved, size_t frames, short* output);
+
+BeamformerStats getBeamformerStats();
+
+// GCC-PHAT delay of b relative to a in samples (positive when b lags), searched within +-maxLag
+float estimateTDOA(const float* a, const float* b, size_t count, int maxLag);
+
+#endif // BEAMFORM_H
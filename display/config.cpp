@@ -0,0 +1,80 @@
+#include "config.h"
+#include <cstdio>  // For FILE, fopen, fclose, fgets
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <iostream>
+
+static std::map<std::string, std::string> configValues;
+static std::mutex configMutex;
+
+static std::string trimConfig(const std::string& str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+bool loadConfig(const std::string& filename) {
+    // C file I/O for consistency with loadAudioSeed/loadScene
+    FILE* file = fopen(filename.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    
+    char buffer[1024];
+    int loaded = 0;
+    std::lock_guard<std::mutex> lock(configMutex);
+    while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+        std::string line(buffer);
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        
+        std::string key = trimConfig(line.substr(0, eq));
+        std::string value = trimConfig(line.substr(eq + 1));
+        if (key.empty()) continue;
+        configValues[key] = value;
+        loaded++;
+    }
+    fclose(file);
+    
+    std::cout << "[DEBUG] Config: Loaded " << loaded << " value(s) from " << filename << std::endl;
+    return true;
+}
+
+void setConfigValue(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    configValues[key] = value;
+}
+
+std::string getConfigString(const std::string& key, const std::string& defaultValue) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    auto it = configValues.find(key);
+    return (it != configValues.end()) ? it->second : defaultValue;
+}
+
+int getConfigInt(const std::string& key, int defaultValue) {
+    std::string value = getConfigString(key);
+    if (value.empty()) return defaultValue;
+    char* end = nullptr;
+    long parsed = strtol(value.c_str(), &end, 10);
+    return (end && *end == '\0') ? (int)parsed : defaultValue;
+}
+
+float getConfigFloat(const std::string& key, float defaultValue) {
+    std::string value = getConfigString(key);
+    if (value.empty()) return defaultValue;
+    char* end = nullptr;
+    float parsed = strtof(value.c_str(), &end);
+    return (end && *end == '\0') ? parsed : defaultValue;
+}
+
+bool getConfigBool(const std::string& key, bool defaultValue) {
+    std::string value = getConfigString(key);
+    if (value.empty()) return defaultValue;
+    return value == "true" || value == "1" || value == "yes" || value == "on";
+}
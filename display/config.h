@@ -0,0 +1,16 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+
+// Application settings loaded from config/app.conf
+// One "key = value" pair per line, '#' starts a comment
+// Missing keys fall back to the default passed by the caller
+bool loadConfig(const std::string& filename);
+void setConfigValue(const std::string& key, const std::string& value);
+std::string getConfigString(const std::string& key, const std::string& defaultValue = "");
+int getConfigInt(const std::string& key, int defaultValue);
+float getConfigFloat(const std::string& key, float defaultValue);
+bool getConfigBool(const std::string& key, bool defaultValue);
+
+#endif // CONFIG_H
@@ -0,0 +1,222 @@
+#include "dsp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DSP_SSE2 1
+#include <emmintrin.h>
+#else
+#define DSP_SSE2 0
+#endif
+
+static const double PI = 3.14159265358979323846;
+
+static bool dspInitialized = false;
+static CaptureDSPConfig dspConfig;
+static int dspSampleRate = 44100;
+static Biquad highpass;
+static bool gateOpen = true;
+static double gateHoldRemaining = 0.0;  // Seconds below the close level before the gate shuts
+static float gainDb = 0.0f;
+static float appliedGain = 1.0f;        // Linear gain at the end of the previous sub-block
+static float scratch[DSP_SUB_BLOCK];
+
+static std::mutex statsMutex;
+static CaptureDSPStats dspStats;
+static double totalBlockUs = 0.0;
+
+void designHighpass(Biquad& filter, float cutoffHz, float q, int sampleRate) {
+    double w0 = 2.0 * PI * cutoffHz / sampleRate;
+    double cosW = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    filter.b0 = (float)((1.0 + cosW) / 2.0 / a0);
+    filter.b1 = (float)(-(1.0 + cosW) / a0);
+    filter.b2 = filter.b0;
+    filter.a1 = (float)(-2.0 * cosW / a0);
+    filter.a2 = (float)((1.0 - alpha) / a0);
+    filter.z1 = 0.0f;
+    filter.z2 = 0.0f;
+}
+
+void processBiquad(Biquad& filter, float* samples, size_t count) {
+    // Coefficients and state in locals so the loop stays in registers
+    const float b0 = filter.b0, b1 = filter.b1, b2 = filter.b2, a1 = filter.a1, a2 = filter.a2;
+    float z1 = filter.z1, z2 = filter.z2;
+    for (size_t i = 0; i < count; i++) {
+        float x = samples[i];
+        float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        samples[i] = y;
+    }
+    filter.z1 = z1;
+    filter.z2 = z2;
+}
+
+float biquadMagnitudeDb(const Biquad& filter, float frequencyHz, int sampleRate) {
+    double w = 2.0 * PI * frequencyHz / sampleRate;
+    double c1 = cos(w), s1 = sin(w), c2 = cos(2.0 * w), s2 = sin(2.0 * w);
+    double numRe = filter.b0 + filter.b1 * c1 + filter.b2 * c2;
+    double numIm = -(filter.b1 * s1 + filter.b2 * s2);
+    double denRe = 1.0 + filter.a1 * c1 + filter.a2 * c2;
+    double denIm = -(filter.a1 * s1 + filter.a2 * s2);
+    double magnitude = sqrt((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+    return (float)(20.0 * log10(std::max(magnitude, 1e-12)));
+}
+
+float computeRMS(const float* samples, size_t count) {
+    if (count == 0) return 0.0f;
+    size_t i = 0;
+    float sumSquared = 0.0f;
+#if DSP_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(samples + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(x, x));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sumSquared = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; i++) {
+        sumSquared += samples[i] * samples[i];
+    }
+    return sqrtf(sumSquared / count);
+}
+
+static void pcmToFloat(const short* input, float* output, size_t count) {
+    const float scale = 1.0f / 32768.0f;
+    size_t i = 0;
+#if DSP_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i pcm = _mm_loadu_si128((const __m128i*)(input + i));
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16); // Sign-extend
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), vscale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = input[i] * scale;
+    }
+}
+
+// Apply a gain ramping linearly from startGain to endGain, then convert back with saturation
+static void applyGainToPCM(const float* input, short* output, size_t count, float startGain, float endGain) {
+    const float step = (endGain - startGain) / count;
+    size_t i = 0;
+#if DSP_SSE2
+    const __m128 vscale = _mm_set1_ps(32768.0f);
+    __m128 gain = _mm_add_ps(_mm_set1_ps(startGain), _mm_mul_ps(_mm_set_ps(4.0f, 3.0f, 2.0f, 1.0f), _mm_set1_ps(step)));
+    const __m128 gainStep = _mm_set1_ps(4.0f * step);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(input + i), gain), vscale);
+        gain = _mm_add_ps(gain, gainStep);
+        __m128 b = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), gain), vscale);
+        gain = _mm_add_ps(gain, gainStep);
+        // cvtps rounds to nearest; packs saturates to [-32768, 32767]
+        _mm_storeu_si128((__m128i*)(output + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#endif
+    for (; i < count; i++) {
+        float value = input[i] * (startGain + step * (float)(i + 1)) * 32768.0f;
+        value = std::max(-32768.0f, std::min(32767.0f, value));
+        output[i] = (short)lrintf(value);
+    }
+}
+
+static float dbToLinear(float db) {
+    return powf(10.0f, db / 20.0f);
+}
+
+void initCaptureDSP(const CaptureDSPConfig& config, int sampleRate) {
+    dspConfig = config;
+    dspInitialized = true;
+    dspSampleRate = sampleRate > 0 ? sampleRate : 44100;
+    float nyquist = dspSampleRate * 0.5f;
+    if (config.highpassHz > 0.0f && config.highpassHz < nyquist) {
+        designHighpass(highpass, config.highpassHz, std::max(0.1f, config.highpassQ), dspSampleRate);
+    } else {
+        highpass = Biquad(); // Pass-through
+    }
+    gateOpen = !config.gate;
+    gateHoldRemaining = 0.0;
+    gainDb = 0.0f;
+    appliedGain = config.gate ? dbToLinear(config.gateFloorDb) : 1.0f;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    dspStats = CaptureDSPStats();
+    dspStats.gateOpen = gateOpen;
+    totalBlockUs = 0.0;
+}
+
+bool isCaptureDSPEnabled() {
+    return dspInitialized && dspConfig.enabled;
+}
+
+// Gate and AGC decisions for one sub-block at the given (post high-pass) level
+static float updateGain(float levelDbfs, double seconds) {
+    if (dspConfig.gate) {
+        if (levelDbfs >= dspConfig.gateOpenDbfs) {
+            gateOpen = true;
+            gateHoldRemaining = dspConfig.gateHoldMs / 1000.0;
+        } else if (gateOpen && levelDbfs >= dspConfig.gateCloseDbfs) {
+            gateHoldRemaining = dspConfig.gateHoldMs / 1000.0; // Between the thresholds: stay open
+        } else if (gateOpen) {
+            gateHoldRemaining -= seconds;
+            if (gateHoldRemaining <= 0.0) gateOpen = false;
+        }
+    }
+
+    // The AGC holds its gain while the gate is closed so it never chases the noise floor
+    if (dspConfig.agc && gateOpen) {
+        float desired = std::max(dspConfig.agcMinGainDb, std::min(dspConfig.agcMaxGainDb, dspConfig.agcTargetDbfs - levelDbfs));
+        float timeMs = desired < gainDb ? dspConfig.agcAttackMs : dspConfig.agcReleaseMs;
+        float alpha = 1.0f - expf(-(float)(seconds * 1000.0) / std::max(1.0f, timeMs));
+        gainDb += (desired - gainDb) * alpha;
+    }
+
+    float gain = dspConfig.agc ? dbToLinear(gainDb) : 1.0f;
+    if (!gateOpen) gain *= dbToLinear(dspConfig.gateFloorDb);
+    return gain;
+}
+
+void processCaptureBlock(short* samples, size_t count) {
+    if (!isCaptureDSPEnabled() || !samples || count == 0) return;
+    auto start = std::chrono::steady_clock::now();
+
+    float levelDbfs = -120.0f;
+    for (size_t offset = 0; offset < count; offset += DSP_SUB_BLOCK) {
+        size_t n = std::min((size_t)DSP_SUB_BLOCK, count - offset);
+        pcmToFloat(samples + offset, scratch, n);
+        processBiquad(highpass, scratch, n);
+        levelDbfs = 20.0f * log10f(computeRMS(scratch, n) + 1e-9f);
+        float gain = updateGain(levelDbfs, (double)n / dspSampleRate);
+        applyGainToPCM(scratch, samples + offset, n, appliedGain, gain);
+        appliedGain = gain;
+    }
+
+    double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    double budgetUs = 1e6 * count / dspSampleRate;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    dspStats.blocks++;
+    dspStats.lastBlockUs = elapsedUs;
+    dspStats.maxBlockUs = std::max(dspStats.maxBlockUs, elapsedUs);
+    totalBlockUs += elapsedUs;
+    dspStats.meanBlockUs = totalBlockUs / dspStats.blocks;
+    dspStats.lastBudgetUse = elapsedUs / budgetUs;
+    dspStats.maxBudgetUse = std::max(dspStats.maxBudgetUse, dspStats.lastBudgetUse);
+    if (elapsedUs > budgetUs) dspStats.overBudgetBlocks++;
+    dspStats.gateOpen = gateOpen;
+    dspStats.gainDb = dspConfig.agc ? gainDb : 0.0f;
+    dspStats.inputDbfs = levelDbfs;
+}
+
+CaptureDSPStats getCaptureDSPStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return dspStats;
+}
@@ -0,0 +1,70 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Capture-side DSP chain, run in place on each captured PCM16 block
+// before it reaches the waveform, the wake gate and the STT uploads:
+//   biquad high-pass (rumble, DC) -> level meter -> noise gate with
+//   hysteresis -> RMS-driven AGC -> saturating conversion back to PCM16
+// Blocks are processed in fixed sub-blocks of DSP_SUB_BLOCK samples, so the
+// gate/AGC react at the same rate whatever buffer size the driver uses and
+// nothing is allocated on the capture thread. Gain changes are ramped
+// linearly across each sub-block to avoid zipper noise.
+
+const int DSP_SUB_BLOCK = 512;
+
+struct CaptureDSPConfig {
+    bool enabled = true;
+    float highpassHz = 80.0f;      // 0 disables the high-pass
+    float highpassQ = 0.7071f;     // Butterworth
+    bool agc = true;
+    float agcTargetDbfs = -20.0f;  // RMS level the AGC steers towards
+    float agcMaxGainDb = 24.0f;
+    float agcMinGainDb = -12.0f;
+    float agcAttackMs = 20.0f;     // Gain falling (input got louder)
+    float agcReleaseMs = 800.0f;   // Gain rising (input got quieter)
+    bool gate = true;
+    float gateOpenDbfs = -50.0f;   // Opens at or above this level...
+    float gateCloseDbfs = -56.0f;  // ...and closes once below this for gateHoldMs
+    float gateHoldMs = 200.0f;
+    float gateFloorDb = -40.0f;    // Attenuation while closed
+};
+
+struct CaptureDSPStats {
+    uint64_t blocks;
+    double lastBlockUs;            // Processing time of the most recent block
+    double maxBlockUs;
+    double meanBlockUs;
+    double lastBudgetUse;          // Processing time / audio duration of the last block
+    double maxBudgetUse;
+    uint64_t overBudgetBlocks;     // Blocks that took longer than the audio they held
+    bool gateOpen;
+    float gainDb;                  // Current AGC gain
+    float inputDbfs;               // Level after the high-pass, before gain (last sub-block)
+};
+
+// Second-order section, transposed direct form II
+struct Biquad {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    float z1 = 0.0f, z2 = 0.0f;
+};
+
+void designHighpass(Biquad& filter, float cutoffHz, float q, int sampleRate);
+void processBiquad(Biquad& filter, float* samples, size_t count);
+float biquadMagnitudeDb(const Biquad& filter, float frequencyHz, int sampleRate); // Analytic response
+
+// RMS of a float block (the waveform meter and the AGC share it)
+float computeRMS(const float* samples, size_t count);
+
+// Configure before capture starts (not thread-safe against processCaptureBlock)
+void initCaptureDSP(const CaptureDSPConfig& config, int sampleRate);
+bool isCaptureDSPEnabled();
+
+// Capture thread: process one block in place
+void processCaptureBlock(short* samples, size_t count);
+
+CaptureDSPStats getCaptureDSPStats();
+
+#endif // DSP_H
@@ -0,0 +1,115 @@
+#include "fft.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FFT_SSE2 1
+#include <emmintrin.h>
+#else
+#define FFT_SSE2 0
+#endif
+
+static const double PI = 3.14159265358979323846;
+
+bool initFFTPlan(FFTPlan& plan, int size) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        return false;
+    }
+    int bits = 0;
+    while ((1 << bits) < size) bits++;
+
+    plan.size = size;
+    plan.bitReverse.resize(size);
+    for (int i = 0; i < size; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        plan.bitReverse[i] = reversed;
+    }
+
+    plan.twiddleRe.clear();
+    plan.twiddleIm.clear();
+    for (int half = 1; half < size; half *= 2) {
+        for (int k = 0; k < half; k++) {
+            double angle = -PI * k / half;
+            plan.twiddleRe.push_back((float)cos(angle));
+            plan.twiddleIm.push_back((float)sin(angle));
+        }
+    }
+    return true;
+}
+
+void fftForward(const FFTPlan& plan, float* re, float* im) {
+    const int n = plan.size;
+    for (int i = 0; i < n; i++) {
+        int j = plan.bitReverse[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    const float* stageRe = plan.twiddleRe.data();
+    const float* stageIm = plan.twiddleIm.data();
+    for (int half = 1; half < n; half *= 2) {
+        for (int block = 0; block < n; block += 2 * half) {
+            float* topRe = re + block;
+            float* topIm = im + block;
+            float* botRe = topRe + half;
+            float* botIm = topIm + half;
+            int k = 0;
+#if FFT_SSE2
+            for (; k + 4 <= half; k += 4) {
+                __m128 wr = _mm_loadu_ps(stageRe + k);
+                __m128 wi = _mm_loadu_ps(stageIm + k);
+                __m128 br = _mm_loadu_ps(botRe + k);
+                __m128 bi = _mm_loadu_ps(botIm + k);
+                __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                __m128 ar = _mm_loadu_ps(topRe + k);
+                __m128 ai = _mm_loadu_ps(topIm + k);
+                _mm_storeu_ps(topRe + k, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(topIm + k, _mm_add_ps(ai, ti));
+                _mm_storeu_ps(botRe + k, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(botIm + k, _mm_sub_ps(ai, ti));
+            }
+#endif
+            for (; k < half; k++) {
+                float tr = botRe[k] * stageRe[k] - botIm[k] * stageIm[k];
+                float ti = botRe[k] * stageIm[k] + botIm[k] * stageRe[k];
+                botRe[k] = topRe[k] - tr;
+                botIm[k] = topIm[k] - ti;
+                topRe[k] += tr;
+                topIm[k] += ti;
+            }
+        }
+        stageRe += half;
+        stageIm += half;
+    }
+}
+
+void fftPowerSpectrum(const FFTPlan& plan, const float* input, float* power, float* re, float* im) {
+    const int n = plan.size;
+    for (int i = 0; i < n; i++) {
+        re[i] = input[i];
+        im[i] = 0.0f;
+    }
+    fftForward(plan, re, im);
+
+    const int bins = n / 2 + 1;
+    int k = 0;
+#if FFT_SSE2
+    for (; k + 4 <= bins; k += 4) {
+        __m128 r = _mm_loadu_ps(re + k);
+        __m128 i = _mm_loadu_ps(im + k);
+        _mm_storeu_ps(power + k, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(i, i)));
+    }
+#endif
+    for (; k < bins; k++) {
+        power[k] = re[k] * re[k] + im[k] * im[k];
+    }
+}
+
+bool fftUsesSIMD() {
+    return FFT_SSE2 != 0;
+}
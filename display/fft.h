@@ -0,0 +1,29 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+// Radix-2 complex FFT on split real/imaginary float arrays
+// Butterflies use SSE2 where the compiler targets it (x86-64 always does)
+// and plain C++ elsewhere; both paths give the same result within float
+// rounding. Plans are built once and shared read-only between threads.
+
+struct FFTPlan {
+    int size = 0;                  // Power of two
+    std::vector<int> bitReverse;
+    std::vector<float> twiddleRe;  // Per stage, contiguous: stage with half-size h holds h entries
+    std::vector<float> twiddleIm;
+};
+
+bool initFFTPlan(FFTPlan& plan, int size); // False unless size is a power of two >= 4
+
+// In-place forward transform of size complex values
+void fftForward(const FFTPlan& plan, float* re, float* im);
+
+// Power spectrum |X[k]|^2 for k = 0..size/2 of a real input (size samples)
+// re/im are caller-owned scratch arrays of plan.size floats
+void fftPowerSpectrum(const FFTPlan& plan, const float* input, float* power, float* re, float* im);
+
+bool fftUsesSIMD(); // True when the SSE2 path is compiled in
+
+#endif // FFT_H
@@ -0,0 +1,123 @@
+#include "gesture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void initGestureRecognizer(GestureRecognizer& recognizer, const GestureRule* rules, size_t count) {
+    recognizer.rules.assign(rules, rules + count);
+    recognizer.tracks.clear();
+}
+
+static GestureTrack& trackFor(GestureRecognizer& recognizer, const void* source, int rule) {
+    for (GestureTrack& track : recognizer.tracks) {
+        if (track.source == source && track.rule == rule) return track;
+    }
+    GestureTrack track = {source, rule, 0, 0.0, 0.0, 0.0, 0.0, false};
+    recognizer.tracks.push_back(track);
+    return recognizer.tracks.back();
+}
+
+static bool inRegion(const GestureRegion& region, const InputEvent& event) {
+    double left = region.x < 0.0 ? event.width + region.x : region.x;
+    double top = region.y < 0.0 ? event.height + region.y : region.y;
+    double right = region.width > 0.0 ? left + region.width : event.width;
+    double bottom = region.height > 0.0 ? top + region.height : event.height;
+    return event.x >= left && event.x <= right && event.y >= top && event.y <= bottom;
+}
+
+// Per-axis distance, like the classic double-click rectangle
+static bool withinSlop(double slop, double x0, double y0, double x1, double y1) {
+    return slop <= 0.0 || (std::fabs(x1 - x0) < slop && std::fabs(y1 - y0) < slop);
+}
+
+// A sequence whose next press can still count
+static bool sequenceAlive(const GestureRule& rule, const GestureTrack& track, double time) {
+    return track.count > 0 && (rule.maxGap <= 0.0 || time - track.lastTime <= rule.maxGap) &&
+           (rule.maxSpan <= 0.0 || time - track.firstTime <= rule.maxSpan);
+}
+
+static void emit(const GestureRule& rule, const GestureTrack& track, double time, std::vector<Gesture>& gestures) {
+    Gesture gesture = {rule.name, track.rule, track.source, time, track.x, track.y};
+    gestures.push_back(gesture);
+}
+
+static void feedClicks(const GestureRule& rule, GestureTrack& track, const InputEvent& event, std::vector<Gesture>& gestures) {
+    if (event.type != InputEventType::PRESS) return;
+    if (!inRegion(rule.region, event)) {
+        track.count = 0; // A press elsewhere breaks the sequence
+        return;
+    }
+    if (!sequenceAlive(rule, track, event.time) || !withinSlop(rule.slop, track.x, track.y, event.x, event.y)) {
+        track.count = 0;
+    }
+    if (track.count == 0) {
+        track.firstTime = event.time;
+        track.x = event.x;
+        track.y = event.y;
+    }
+    track.count++;
+    track.lastTime = event.time;
+    if (track.count >= rule.clicks) {
+        emit(rule, track, event.time, gestures);
+        track.count = 0;
+    }
+}
+
+static void feedLongPress(const GestureRule& rule, GestureTrack& track, const InputEvent& event, std::vector<Gesture>& gestures) {
+    if (event.type == InputEventType::PRESS) {
+        track.pressed = inRegion(rule.region, event);
+        track.firstTime = event.time;
+        track.x = event.x;
+        track.y = event.y;
+        return;
+    }
+    if (!track.pressed) return;
+    track.pressed = false;
+    // Released after the hold time but before anyone advanced past it: still a long-press, at press + hold
+    if (event.time - track.firstTime >= rule.holdSeconds && withinSlop(rule.slop, track.x, track.y, event.x, event.y)) {
+        emit(rule, track, track.firstTime + rule.holdSeconds, gestures);
+    }
+}
+
+void feedGestureEvent(GestureRecognizer& recognizer, const InputEvent& event, std::vector<Gesture>& gestures) {
+    for (size_t i = 0; i < recognizer.rules.size(); i++) {
+        const GestureRule& rule = recognizer.rules[i];
+        if (rule.button != event.button) continue;
+        GestureTrack& track = trackFor(recognizer, event.source, (int)i);
+        if (rule.kind == GestureKind::CLICKS) {
+            feedClicks(rule, track, event, gestures);
+        } else {
+            feedLongPress(rule, track, event, gestures);
+        }
+    }
+}
+
+void advanceGestures(GestureRecognizer& recognizer, double now, std::vector<Gesture>& gestures) {
+    for (GestureTrack& track : recognizer.tracks) {
+        const GestureRule& rule = recognizer.rules[track.rule];
+        if (rule.kind == GestureKind::LONG_PRESS && track.pressed && now - track.firstTime >= rule.holdSeconds) {
+            track.pressed = false;
+            emit(rule, track, track.firstTime + rule.holdSeconds, gestures);
+        }
+    }
+}
+
+void updateGestures(GestureRecognizer& recognizer, double now, std::vector<Gesture>& gestures) {
+    InputEvent event;
+    while (popInputEvent(event)) {
+        // A long-press due before this event resolves first, as it would have in real time
+        advanceGestures(recognizer, event.time, gestures);
+        feedGestureEvent(recognizer, event, gestures);
+    }
+    advanceGestures(recognizer, now, gestures);
+}
+
+int getGestureProgress(const GestureRecognizer& recognizer, const void* source, const char* name, double now) {
+    for (const GestureTrack& track : recognizer.tracks) {
+        const GestureRule& rule = recognizer.rules[track.rule];
+        if (track.source == source && std::strcmp(rule.name, name) == 0) {
+            return sequenceAlive(rule, track, now) ? track.count : 0;
+        }
+    }
+    return 0;
+}
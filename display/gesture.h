@@ -0,0 +1,75 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include "input.h"
+#include <vector>
+
+// Table-driven gesture recognizer
+// Each GestureRule describes one gesture: N presses of a button within a
+// region (click, double-click, tetra-click...) or a press held in place
+// (long-press). Recognition runs on event timestamps only, so the same input
+// resolves to the same gestures, at the same times, whatever the frame rate.
+// State is kept per rule and per source window.
+
+enum class GestureKind {
+    CLICKS,      // `clicks` presses, each within maxGap of the previous and maxSpan of the first
+    LONG_PRESS   // Held for holdSeconds without the release drifting past slop
+};
+
+// Region in window pixels (origin top-left); negative x/y count from the
+// right/bottom edge, width/height <= 0 extend to the window edge
+struct GestureRegion {
+    double x;
+    double y;
+    double width;
+    double height;
+};
+
+struct GestureRule {
+    const char* name;
+    GestureKind kind;
+    int button;
+    int clicks;          // CLICKS: presses needed
+    double maxGap;       // CLICKS: seconds between consecutive presses (<= 0: any)
+    double maxSpan;      // CLICKS: seconds from the first press to the last (<= 0: any)
+    double slop;         // Pixels a later press (or the release) may stray from the first (<= 0: any)
+    double holdSeconds;  // LONG_PRESS
+    GestureRegion region;
+};
+
+struct Gesture {
+    const char* name;    // Rule name
+    int rule;            // Index into the rule table
+    const void* source;
+    double time;         // When it was recognized on the event clock (last press, or press + hold)
+    double x, y;         // Position of the first press
+};
+
+struct GestureTrack {
+    const void* source;
+    int rule;
+    int count;           // Presses in the current sequence
+    double firstTime, lastTime;
+    double x, y;         // First press of the sequence (or the held press)
+    bool pressed;        // LONG_PRESS: button down, not yet recognized
+};
+
+struct GestureRecognizer {
+    std::vector<GestureRule> rules;
+    std::vector<GestureTrack> tracks;
+};
+
+void initGestureRecognizer(GestureRecognizer& recognizer, const GestureRule* rules, size_t count);
+
+// Feed one event (events must arrive in time order)
+void feedGestureEvent(GestureRecognizer& recognizer, const InputEvent& event, std::vector<Gesture>& gestures);
+// Recognize gestures that complete by time `now` without a further event (long-press)
+void advanceGestures(GestureRecognizer& recognizer, double now, std::vector<Gesture>& gestures);
+// Drain the input queue, then advance to `now`
+void updateGestures(GestureRecognizer& recognizer, double now, std::vector<Gesture>& gestures);
+
+// Presses counted so far toward a CLICKS rule for a window (0 when idle or
+// when the sequence can no longer complete at time `now`)
+int getGestureProgress(const GestureRecognizer& recognizer, const void* source, const char* name, double now);
+
+#endif // GESTURE_H
@@ -0,0 +1,232 @@
+#include "gl_state.h"
+#include <cmath>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+enum GLStateBit : unsigned int {
+    GL_STATE_BLEND = 1u << 0,
+    GL_STATE_BLEND_FUNC = 1u << 1,
+    GL_STATE_TEXTURE_2D = 1u << 2,
+    GL_STATE_TEXTURE = 1u << 3,
+    GL_STATE_VIEWPORT = 1u << 4,
+    GL_STATE_PROJECTION = 1u << 5,
+    GL_STATE_LINE_WIDTH = 1u << 6,
+    GL_STATE_POINT_SIZE = 1u << 7,
+};
+
+static GLStateCache* currentCache = nullptr;
+static bool validation = false;
+static const uint64_t MAX_MISMATCH_LOGS = 20;
+
+void bindGLStateCache(GLStateCache* cache) {
+    currentCache = cache;
+}
+
+GLStateCache* getGLStateCache() {
+    return currentCache;
+}
+
+void invalidateGLState() {
+    if (currentCache) currentCache->known = 0;
+}
+
+void setGLStateValidation(bool enabled) {
+    validation = enabled;
+}
+
+static bool closeTo(double a, double b) {
+    return std::fabs(a - b) <= 1e-6 * (1.0 + std::fabs(b));
+}
+
+// What GL reports for `bit` agrees with the shadow
+static bool queryMatches(const GLStateCache& cache, unsigned int bit) {
+    GLint values[4] = {0, 0, 0, 0};
+    GLfloat value = 0.0f;
+    switch (bit) {
+    case GL_STATE_BLEND:
+        return (glIsEnabled(GL_BLEND) == GL_TRUE) == cache.blend;
+    case GL_STATE_BLEND_FUNC:
+        glGetIntegerv(GL_BLEND_SRC, &values[0]);
+        glGetIntegerv(GL_BLEND_DST, &values[1]);
+        return (unsigned int)values[0] == cache.blendSrc && (unsigned int)values[1] == cache.blendDst;
+    case GL_STATE_TEXTURE_2D:
+        return (glIsEnabled(GL_TEXTURE_2D) == GL_TRUE) == cache.texture2D;
+    case GL_STATE_TEXTURE:
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &values[0]);
+        return (unsigned int)values[0] == cache.texture;
+    case GL_STATE_VIEWPORT:
+        glGetIntegerv(GL_VIEWPORT, values);
+        for (int i = 0; i < 4; i++) {
+            if (values[i] != cache.viewport[i]) return false;
+        }
+        return true;
+    case GL_STATE_PROJECTION: {
+        glGetIntegerv(GL_MATRIX_MODE, &values[0]);
+        if (values[0] != GL_MODELVIEW) return false;
+        GLdouble projection[16], modelview[16];
+        glGetDoublev(GL_PROJECTION_MATRIX, projection);
+        glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+        double expected[16] = {2.0 / cache.orthoWidth, 0, 0, 0, 0, 2.0 / cache.orthoHeight, 0, 0,
+                               0, 0, -1, 0, -1, -1, 0, 1};
+        for (int i = 0; i < 16; i++) {
+            if (!closeTo(projection[i], expected[i]) || !closeTo(modelview[i], i % 5 == 0 ? 1.0 : 0.0)) return false;
+        }
+        return true;
+    }
+    case GL_STATE_LINE_WIDTH:
+        glGetFloatv(GL_LINE_WIDTH, &value);
+        return value == cache.lineWidth;
+    case GL_STATE_POINT_SIZE:
+        glGetFloatv(GL_POINT_SIZE, &value);
+        return value == cache.pointSize;
+    }
+    return true;
+}
+
+// Whether a change to `bit` that matches the shadow can be dropped; counts it if so
+static bool elide(GLStateCache& cache, unsigned int bit, bool same) {
+    if (!(cache.known & bit) || !same) return false;
+    if (validation && !cache.offline && !queryMatches(cache, bit)) {
+        cache.frame.mismatches++;
+        static uint64_t logged = 0;
+        if (logged++ < MAX_MISMATCH_LOGS) {
+            std::cerr << "[WARNING] GL state: shadow of state 0x" << std::hex << bit << std::dec
+                      << " disagrees with glGet (changed outside the shadow?), reissuing" << std::endl;
+        }
+        return false;
+    }
+    cache.frame.elided++;
+    return true;
+}
+
+static bool issue(GLStateCache& cache, unsigned int bit) {
+    cache.known |= bit;
+    cache.frame.issued++;
+    return !cache.offline;
+}
+
+void setGLBlend(bool enabled) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_BLEND, cache->blend == enabled)) return;
+        cache->blend = enabled;
+        if (!issue(*cache, GL_STATE_BLEND)) return;
+    }
+    if (enabled) {
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+}
+
+void setGLBlendFunc(unsigned int src, unsigned int dst) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_BLEND_FUNC, cache->blendSrc == src && cache->blendDst == dst)) return;
+        cache->blendSrc = src;
+        cache->blendDst = dst;
+        if (!issue(*cache, GL_STATE_BLEND_FUNC)) return;
+    }
+    glBlendFunc(src, dst);
+}
+
+void setGLAlphaBlend() {
+    setGLBlend(true);
+    setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void setGLTexture2D(bool enabled) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_TEXTURE_2D, cache->texture2D == enabled)) return;
+        cache->texture2D = enabled;
+        if (!issue(*cache, GL_STATE_TEXTURE_2D)) return;
+    }
+    if (enabled) {
+        glEnable(GL_TEXTURE_2D);
+    } else {
+        glDisable(GL_TEXTURE_2D);
+    }
+}
+
+void bindGLTexture(unsigned int texture) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_TEXTURE, cache->texture == texture)) return;
+        cache->texture = texture;
+        if (!issue(*cache, GL_STATE_TEXTURE)) return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void deleteGLTexture(unsigned int& texture) {
+    if (texture == 0) return;
+    GLStateCache* cache = currentCache;
+    if (cache && cache->texture == texture) cache->texture = 0;
+    if (!cache || !cache->offline) glDeleteTextures(1, &texture);
+    texture = 0;
+}
+
+void setGLViewport(int x, int y, int width, int height) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        int* viewport = cache->viewport;
+        bool same = viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height;
+        if (elide(*cache, GL_STATE_VIEWPORT, same)) return;
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+        if (!issue(*cache, GL_STATE_VIEWPORT)) return;
+    }
+    glViewport(x, y, width, height);
+}
+
+void setGLOrtho2D(int width, int height) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        bool same = cache->orthoWidth == width && cache->orthoHeight == height;
+        if (elide(*cache, GL_STATE_PROJECTION, same)) return;
+        cache->orthoWidth = width;
+        cache->orthoHeight = height;
+        if (!issue(*cache, GL_STATE_PROJECTION)) return;
+    }
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, width, 0.0, height, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+void setGLLineWidth(float width) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_LINE_WIDTH, cache->lineWidth == width)) return;
+        cache->lineWidth = width;
+        if (!issue(*cache, GL_STATE_LINE_WIDTH)) return;
+    }
+    glLineWidth(width);
+}
+
+void setGLPointSize(float size) {
+    GLStateCache* cache = currentCache;
+    if (cache) {
+        if (elide(*cache, GL_STATE_POINT_SIZE, cache->pointSize == size)) return;
+        cache->pointSize = size;
+        if (!issue(*cache, GL_STATE_POINT_SIZE)) return;
+    }
+    glPointSize(size);
+}
+
+void finishGLStateFrame(GLStateCache& cache) {
+    cache.lastFrame = cache.frame;
+    cache.frame = GLStateCounters();
+}
@@ -0,0 +1,66 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <cstdint>
+
+// GL state shadow
+// Each window's context keeps a copy of the fixed-function state the
+// renderers change per primitive: blending and its function, 2D texturing
+// and the bound texture, the viewport, the 2D ortho projection (with an
+// identity modelview), line width and point size. The setters below only
+// reach GL when the value differs from the shadow, and count issued and
+// elided changes per frame.
+//
+// Renderers call them instead of glEnable/glBlendFunc/glOrtho... for these
+// states; code that changes them behind the shadow's back must call
+// invalidateGLState. With validation on (display.gl_state_validate), every
+// elided change is first cross-checked against glGet and a stale shadow is
+// reported and repaired.
+
+struct GLStateCounters {
+    uint64_t issued = 0;       // State changes that reached GL
+    uint64_t elided = 0;       // Redundant changes dropped
+    uint64_t mismatches = 0;   // Validation: shadow disagreed with glGet
+};
+
+struct GLStateCache {
+    unsigned int known = 0;    // GL_STATE_* bits whose shadow value is trustworthy
+    bool blend = false;
+    unsigned int blendSrc = 0;
+    unsigned int blendDst = 0;
+    bool texture2D = false;
+    unsigned int texture = 0;
+    int viewport[4] = {0, 0, 0, 0};
+    int orthoWidth = 0;        // Projection is glOrtho(0, w, 0, h, -1, 1), modelview current and identity
+    int orthoHeight = 0;
+    float lineWidth = 1.0f;
+    float pointSize = 1.0f;
+    bool offline = false;      // Shadow and count only, never call GL (no context, tests)
+    GLStateCounters frame;     // Since the last finishGLStateFrame
+    GLStateCounters lastFrame;
+};
+
+// Make `cache` the shadow of the context that is current now (null: pass every call through)
+void bindGLStateCache(GLStateCache* cache);
+GLStateCache* getGLStateCache();
+// Forget what the shadow knows about the current context; the next change of each state issues
+void invalidateGLState();
+void setGLStateValidation(bool enabled);
+
+void setGLBlend(bool enabled);
+void setGLBlendFunc(unsigned int src, unsigned int dst);
+void setGLTexture2D(bool enabled);
+void bindGLTexture(unsigned int texture);  // GL_TEXTURE_2D
+// glDeleteTextures one texture and zero `texture`; a deleted binding reverts to 0 in the shadow too
+void deleteGLTexture(unsigned int& texture);
+void setGLViewport(int x, int y, int width, int height);
+void setGLOrtho2D(int width, int height);  // Pixel projection, origin bottom-left; leaves GL_MODELVIEW current
+void setGLLineWidth(float width);
+void setGLPointSize(float size);
+// Blending with GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA (what every renderer here uses)
+void setGLAlphaBlend();
+
+// Close the frame's counters (after a window's buffers are swapped)
+void finishGLStateFrame(GLStateCache& cache);
+
+#endif // GL_STATE_H
@@ -0,0 +1,80 @@
+#include "hittest.h"
+#include <algorithm>
+#include <cmath>
+
+// Cells [first, last] that the span [start, start + size) touches, clamped to the grid
+static bool cellSpan(float start, float size, float cellSize, int cells, int& first, int& last) {
+    first = std::max(0, (int)std::floor(start / cellSize));
+    last = std::min(cells - 1, (int)std::ceil((start + size) / cellSize) - 1);
+    return first <= last;
+}
+
+void buildHitIndex(HitIndex& index, const Scene& scene, int windowWidth, int windowHeight) {
+    index.scene = &scene;
+    index.windowWidth = windowWidth;
+    index.windowHeight = windowHeight;
+    index.cols = std::max(scene.cols, 0);
+    index.rows = std::max(scene.rows, 0);
+    index.rects.clear();
+    index.cellWidgets.clear();
+    index.cellStart.assign((size_t)index.cols * index.rows + 1, 0);
+    if (index.cols == 0 || index.rows == 0 || windowWidth <= 0 || windowHeight <= 0) {
+        index.cellStart.assign(1, 0);
+        index.cols = index.rows = 0;
+        return;
+    }
+    index.cellWidth = (float)windowWidth / index.cols;
+    index.cellHeight = (float)windowHeight / index.rows;
+
+    index.rects.resize(scene.widgets.size());
+    for (size_t i = 0; i < scene.widgets.size(); i++) {
+        HitRect& rect = index.rects[i];
+        computeWidgetRect(scene, scene.widgets[i], index.cellWidth, index.cellHeight, rect.x, rect.y, rect.w, rect.h);
+    }
+
+    // Counting sort into cells: count, prefix-sum, then fill from the top of
+    // the z-order down so each cell's list is topmost first
+    auto forEachCell = [&](size_t widget, auto&& visit) {
+        const HitRect& rect = index.rects[widget];
+        int c0, c1, r0, r1;
+        if (rect.w <= 0.0f || rect.h <= 0.0f) return;
+        if (!cellSpan(rect.x, rect.w, index.cellWidth, index.cols, c0, c1)) return;
+        if (!cellSpan(rect.y, rect.h, index.cellHeight, index.rows, r0, r1)) return;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) visit((size_t)r * index.cols + c);
+        }
+    };
+    for (size_t i = 0; i < index.rects.size(); i++) {
+        forEachCell(i, [&](size_t cell) { index.cellStart[cell + 1]++; });
+    }
+    for (size_t cell = 1; cell < index.cellStart.size(); cell++) {
+        index.cellStart[cell] += index.cellStart[cell - 1];
+    }
+    index.cellWidgets.resize(index.cellStart.back());
+    std::vector<uint32_t> cursor(index.cellStart.begin(), index.cellStart.end() - 1);
+    for (size_t i = index.rects.size(); i-- > 0;) {
+        forEachCell(i, [&](size_t cell) { index.cellWidgets[cursor[cell]++] = (uint32_t)i; });
+    }
+}
+
+bool hitIndexMatches(const HitIndex& index, const Scene& scene, int windowWidth, int windowHeight) {
+    return index.scene == &scene && index.windowWidth == windowWidth && index.windowHeight == windowHeight &&
+           index.rects.size() == scene.widgets.size();
+}
+
+int hitTestWidget(const HitIndex& index, double x, double y) {
+    if (index.cols == 0) return -1;
+    float px = (float)x;
+    float py = (float)(index.windowHeight - y); // Rects are bottom-up
+    int col = (int)std::floor(px / index.cellWidth);
+    int row = (int)std::floor(py / index.cellHeight);
+    if (col < 0 || col >= index.cols || row < 0 || row >= index.rows) return -1;
+
+    size_t cell = (size_t)row * index.cols + col;
+    for (uint32_t i = index.cellStart[cell]; i < index.cellStart[cell + 1]; i++) {
+        uint32_t widget = index.cellWidgets[i];
+        const HitRect& rect = index.rects[widget];
+        if (px >= rect.x && px < rect.x + rect.w && py >= rect.y && py < rect.y + rect.h) return (int)widget;
+    }
+    return -1;
+}
@@ -0,0 +1,38 @@
+#ifndef HITTEST_H
+#define HITTEST_H
+
+#include "scene.h"
+#include <cstdint>
+#include <vector>
+
+// Widget hit testing
+// A HitIndex buckets a scene's widgets by the grid cells their rects cover,
+// so a point resolves by checking one cell's short list instead of every
+// widget. Each list is ordered topmost first (later widgets draw over earlier
+// ones) and holds the same margin-inset rects renderScene draws, so a click
+// in a widget's margin falls through to whatever is underneath.
+
+struct HitRect {
+    float x, y, w, h;     // Window pixels, origin bottom-left (as computeWidgetRect)
+};
+
+struct HitIndex {
+    const Scene* scene;   // Scene the index was built from (nullptr: not built)
+    int windowWidth;
+    int windowHeight;
+    int cols, rows;
+    float cellWidth, cellHeight;
+    std::vector<HitRect> rects;          // One per widget
+    std::vector<uint32_t> cellStart;     // cols * rows + 1 offsets into cellWidgets
+    std::vector<uint32_t> cellWidgets;   // Widget indices per cell, topmost first
+};
+
+void buildHitIndex(HitIndex& index, const Scene& scene, int windowWidth, int windowHeight);
+// False when the index is for another scene or window size (rebuild it); a
+// scene reloaded in place must be rebuilt by the caller
+bool hitIndexMatches(const HitIndex& index, const Scene& scene, int windowWidth, int windowHeight);
+// Topmost widget under a point in window coordinates (origin top-left, as
+// InputEvent and Gesture), or -1
+int hitTestWidget(const HitIndex& index, double x, double y);
+
+#endif // HITTEST_H
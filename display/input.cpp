@@ -0,0 +1,41 @@
+#include "input.h"
+#include <algorithm>
+
+static InputEvent queue[INPUT_QUEUE_CAPACITY];
+static size_t head = 0;   // Next event to pop
+static size_t count = 0;
+static InputQueueStats stats = {0, 0, 0};
+
+bool pushInputEvent(const InputEvent& event) {
+    if (count == INPUT_QUEUE_CAPACITY) {
+        stats.dropped++;
+        return false;
+    }
+    queue[(head + count) % INPUT_QUEUE_CAPACITY] = event;
+    count++;
+    stats.pushed++;
+    stats.highWater = std::max(stats.highWater, count);
+    return true;
+}
+
+bool popInputEvent(InputEvent& event) {
+    if (count == 0) return false;
+    event = queue[head];
+    head = (head + 1) % INPUT_QUEUE_CAPACITY;
+    count--;
+    return true;
+}
+
+size_t getInputQueueSize() {
+    return count;
+}
+
+void clearInputQueue() {
+    head = 0;
+    count = 0;
+    stats = InputQueueStats{0, 0, 0};
+}
+
+InputQueueStats getInputQueueStats() {
+    return stats;
+}
@@ -0,0 +1,44 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Input event queue
+// GLFW input callbacks push every button transition with the time it
+// happened (not the frame it was seen in), so a press and release that both
+// arrive between two frames are still two events. The render loop drains the
+// queue once per frame into the gesture recognizer (see gesture.h). The queue
+// has fixed capacity; when full, new events are dropped and counted. Pushing
+// and draining both happen on the main thread (glfwPollEvents runs the
+// callbacks there).
+
+enum class InputEventType {
+    PRESS,
+    RELEASE
+};
+
+struct InputEvent {
+    const void* source;   // Window the event belongs to (its GLFWwindow*)
+    InputEventType type;
+    int button;           // GLFW_MOUSE_BUTTON_* value
+    double x, y;          // Cursor position in window coordinates (origin top-left)
+    int width, height;    // Window size when the event happened
+    double time;          // Seconds on the glfwGetTime() clock
+};
+
+struct InputQueueStats {
+    uint64_t pushed;
+    uint64_t dropped;     // Pushed while the queue was full
+    size_t highWater;     // Most events queued at once
+};
+
+static const size_t INPUT_QUEUE_CAPACITY = 256;
+
+bool pushInputEvent(const InputEvent& event); // False when full
+bool popInputEvent(InputEvent& event);        // Oldest first; false when empty
+size_t getInputQueueSize();
+void clearInputQueue();
+InputQueueStats getInputQueueStats();
+
+#endif // INPUT_H
@@ -0,0 +1,351 @@
+#include "jobs.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+// Chase-Lev deque ("Correct and Efficient Work-Stealing for Weak Memory
+// Models", Le et al. 2013) with a fixed power-of-two ring; a full deque runs
+// the job inline instead of growing. Every owner store to bottom is a release
+// so a thief's acquire of any bottom value publishes the slots below it
+static const int64_t DEQUE_CAPACITY = 4096;
+
+// Slot fields are atomics so a thief reading a slot the owner is rewriting
+// is not a data race; the thief's CAS on top then fails and the copy is dropped
+struct JobSlot {
+    std::atomic<JobFunction> function;
+    std::atomic<void*> data;
+    std::atomic<size_t> begin;
+    std::atomic<size_t> end;
+    std::atomic<JobCounter*> counter;
+};
+
+struct alignas(64) JobWorker {
+    std::atomic<int64_t> top{0};       // Thieves take from here
+    alignas(64) std::atomic<int64_t> bottom{0};   // Owner pushes and pops here
+    alignas(64) std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<uint64_t> inlined{0};
+    JobSlot slots[DEQUE_CAPACITY];
+};
+
+static std::vector<std::unique_ptr<JobWorker>> workers;   // [0] belongs to the starting thread
+static std::vector<std::thread> workerThreads;
+static std::atomic<bool> jobsRunning(false);
+static std::atomic<bool> jobsStopping(false);
+static thread_local int workerIndex = -1;
+
+// Submissions from threads that own no deque
+static std::mutex injectLock;
+static std::deque<Job> injected;
+static std::atomic<size_t> injectedCount(0);
+
+// Idle workers sleep until the epoch moves
+static std::mutex sleepLock;
+static std::condition_variable sleepCondition;
+static std::atomic<uint64_t> workEpoch(0);
+static std::atomic<int> sleepers(0);
+
+// Stats for jobs run outside the workers (inline, or by external waiters)
+static std::atomic<uint64_t> externalExecuted(0);
+static std::atomic<uint64_t> externalStolen(0);
+static std::atomic<uint64_t> externalInlined(0);
+
+static void writeSlot(JobSlot& slot, const Job& job) {
+    slot.function.store(job.function, std::memory_order_relaxed);
+    slot.data.store(job.data, std::memory_order_relaxed);
+    slot.begin.store(job.begin, std::memory_order_relaxed);
+    slot.end.store(job.end, std::memory_order_relaxed);
+    slot.counter.store(job.counter, std::memory_order_relaxed);
+}
+
+static void readSlot(const JobSlot& slot, Job& job) {
+    job.function = slot.function.load(std::memory_order_relaxed);
+    job.data = slot.data.load(std::memory_order_relaxed);
+    job.begin = slot.begin.load(std::memory_order_relaxed);
+    job.end = slot.end.load(std::memory_order_relaxed);
+    job.counter = slot.counter.load(std::memory_order_relaxed);
+}
+
+static bool pushLocal(JobWorker& worker, const Job& job) {
+    int64_t b = worker.bottom.load(std::memory_order_relaxed);
+    int64_t t = worker.top.load(std::memory_order_acquire);
+    if (b - t >= DEQUE_CAPACITY) return false;
+    writeSlot(worker.slots[b & (DEQUE_CAPACITY - 1)], job);
+    worker.bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+static bool popLocal(JobWorker& worker, Job& job) {
+    int64_t b = worker.bottom.load(std::memory_order_relaxed) - 1;
+    worker.bottom.store(b, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = worker.top.load(std::memory_order_relaxed);
+    if (t > b) {
+        worker.bottom.store(b + 1, std::memory_order_release); // Empty
+        return false;
+    }
+    readSlot(worker.slots[b & (DEQUE_CAPACITY - 1)], job);
+    if (t == b) {
+        // Last job: race thieves for it
+        bool won = worker.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        worker.bottom.store(b + 1, std::memory_order_release);
+        return won;
+    }
+    return true;
+}
+
+static bool steal(JobWorker& worker, Job& job) {
+    int64_t t = worker.top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = worker.bottom.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    readSlot(worker.slots[t & (DEQUE_CAPACITY - 1)], job);
+    return worker.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+static void wakeWorker() {
+    workEpoch.fetch_add(1);
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        sleepCondition.notify_one();
+    }
+}
+
+static void submitJob(const Job& job);
+
+// Release the job's counter; the last job out queues the counter's continuations
+static void finishJob(JobCounter* counter) {
+    if (!counter) return;
+    counter->finishing.fetch_add(1);
+    if (counter->pending.fetch_sub(1) == 1) {
+        std::vector<Job> ready;
+        {
+            std::lock_guard<std::mutex> guard(counter->lock);
+            ready.swap(counter->continuations);
+        }
+        for (const Job& job : ready) submitJob(job);
+    }
+    counter->finishing.fetch_sub(1); // Last touch: waiters may now destroy the counter
+}
+
+static void executeJob(const Job& job, int self) {
+    job.function(job.data, job.begin, job.end);
+    if (self >= 0) {
+        workers[self]->executed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        externalExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+    finishJob(job.counter);
+}
+
+static void submitJob(const Job& job) {
+    int self = workerIndex;
+    if (!jobsRunning.load(std::memory_order_acquire)) {
+        externalInlined.fetch_add(1, std::memory_order_relaxed);
+        executeJob(job, -1);
+        return;
+    }
+    if (self >= 0) {
+        if (!pushLocal(*workers[self], job)) {
+            workers[self]->inlined.fetch_add(1, std::memory_order_relaxed);
+            executeJob(job, self);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> guard(injectLock);
+        injected.push_back(job);
+        injectedCount.fetch_add(1);
+    }
+    wakeWorker();
+}
+
+static uint32_t nextVictimSeed() {
+    static thread_local uint32_t state = 0x9E3779B9u ^ (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static bool findJob(int self, Job& job) {
+    if (self >= 0 && popLocal(*workers[self], job)) return true;
+    if (injectedCount.load() > 0) {
+        std::lock_guard<std::mutex> guard(injectLock);
+        if (!injected.empty()) {
+            job = injected.front();
+            injected.pop_front();
+            injectedCount.fetch_sub(1);
+            return true;
+        }
+    }
+    size_t count = workers.size();
+    size_t start = nextVictimSeed() % count;
+    for (size_t i = 0; i < count; i++) {
+        size_t victim = (start + i) % count;
+        if ((int)victim == self) continue;
+        if (steal(*workers[victim], job)) {
+            if (self >= 0) {
+                workers[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                externalStolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void workerLoop(int index) {
+    workerIndex = index;
+    while (true) {
+        uint64_t epoch = workEpoch.load();
+        Job job;
+        if (findJob(index, job)) {
+            executeJob(job, index);
+            continue;
+        }
+        if (jobsStopping.load()) break;
+        // Stay awake briefly: fine-grained work usually arrives in bursts
+        bool moved = false;
+        for (int spin = 0; spin < 64 && !moved; spin++) {
+            std::this_thread::yield();
+            moved = workEpoch.load() != epoch;
+        }
+        if (moved) continue;
+        std::unique_lock<std::mutex> guard(sleepLock);
+        sleepers.fetch_add(1);
+        sleepCondition.wait(guard, [&] { return workEpoch.load() != epoch || jobsStopping.load(); });
+        sleepers.fetch_sub(1);
+    }
+    workerIndex = -1;
+}
+
+bool startJobSystem(int workerCount) {
+    if (jobsRunning.load()) return true;
+    if (workerCount <= 0) {
+        workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    }
+    workers.clear();
+    for (int i = 0; i <= workerCount; i++) {
+        workers.push_back(std::unique_ptr<JobWorker>(new JobWorker()));
+    }
+    externalExecuted = 0;
+    externalStolen = 0;
+    externalInlined = 0;
+    jobsStopping = false;
+    workerIndex = 0;
+    jobsRunning = true;
+    for (int i = 1; i <= workerCount; i++) {
+        workerThreads.emplace_back(workerLoop, i);
+    }
+    std::cout << "[DEBUG] Jobs: Started " << workerCount << " worker threads" << std::endl;
+    return true;
+}
+
+void stopJobSystem() {
+    if (!jobsRunning.load()) return;
+    Job job;
+    while (findJob(workerIndex, job)) executeJob(job, workerIndex);
+    jobsStopping = true;
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        workEpoch.fetch_add(1);
+        sleepCondition.notify_all();
+    }
+    for (std::thread& thread : workerThreads) {
+        if (thread.joinable()) thread.join();
+    }
+    workerThreads.clear();
+    // Anything submitted by other threads while the workers exited
+    while (findJob(workerIndex, job)) executeJob(job, workerIndex);
+    jobsRunning = false;
+    workerIndex = -1;
+    std::cout << "[DEBUG] Jobs: Stopped" << std::endl;
+}
+
+bool isJobSystemRunning() {
+    return jobsRunning.load();
+}
+
+int getJobWorkerCount() {
+    return jobsRunning.load() ? (int)workers.size() - 1 : 0;
+}
+
+void runJob(JobFunction function, void* data, JobCounter* counter, size_t begin, size_t end) {
+    if (counter) counter->pending.fetch_add(1);
+    submitJob(Job{function, data, begin, end, counter});
+}
+
+void runJobAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter* counter,
+                 size_t begin, size_t end) {
+    if (counter) counter->pending.fetch_add(1);
+    Job job{function, data, begin, end, counter};
+    {
+        std::lock_guard<std::mutex> guard(dependency.lock);
+        if (dependency.pending.load() > 0) {
+            dependency.continuations.push_back(job);
+            return;
+        }
+    }
+    submitJob(job);
+}
+
+void waitForJobs(JobCounter& counter) {
+    int self = workerIndex;
+    while (counter.pending.load() > 0) {
+        Job job;
+        if (jobsRunning.load(std::memory_order_acquire) && findJob(self, job)) {
+            executeJob(job, self);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    while (counter.finishing.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+struct ParallelForTask {
+    const std::function<void(size_t, size_t)>* body;
+    size_t grain;
+    JobCounter* counter;
+};
+
+// Split off the upper half for another worker until the range fits the grain
+static void parallelForJob(void* data, size_t begin, size_t end) {
+    ParallelForTask* task = static_cast<ParallelForTask*>(data);
+    while (end - begin > task->grain) {
+        size_t mid = begin + (end - begin) / 2;
+        runJob(parallelForJob, data, task->counter, mid, end);
+        end = mid;
+    }
+    (*task->body)(begin, end);
+}
+
+void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    if (!jobsRunning.load() || count <= grain) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            body(begin, std::min(count, begin + grain));
+        }
+        return;
+    }
+    JobCounter counter;
+    ParallelForTask task = {&body, grain, &counter};
+    runJob(parallelForJob, &task, &counter, 0, count);
+    waitForJobs(counter);
+}
+
+JobSystemStats getJobSystemStats() {
+    JobSystemStats stats = {externalExecuted.load(), externalStolen.load(), externalInlined.load()};
+    for (const auto& worker : workers) { // Kept after stopJobSystem until the next start
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.inlined += worker->inlined.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
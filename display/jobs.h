@@ -0,0 +1,72 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Work-stealing job system
+// A fixed set of worker threads, each owning a Chase-Lev deque: a worker
+// pushes and pops jobs at the bottom of its own deque, idle workers steal from
+// the top of others'. The thread that starts the system (the main thread)
+// owns a deque too and runs jobs while it waits. Other threads (the audio
+// callback, the network thread) submit through a shared queue.
+//
+// Jobs are plain function pointers with a data pointer and an index range,
+// so submitting one allocates nothing. Completion is tracked by JobCounter:
+// each job submitted with a counter holds it until it finishes, waitForJobs
+// blocks (running jobs meanwhile) until it drains, and runJobAfter queues a
+// job to start only once a counter drains.
+//
+// Without startJobSystem (or after stopJobSystem) every job runs inline on
+// the submitting thread, so callers need no fallback path.
+
+typedef void (*JobFunction)(void* data, size_t begin, size_t end);
+
+struct JobCounter;
+
+struct Job {
+    JobFunction function;
+    void* data;
+    size_t begin;
+    size_t end;
+    JobCounter* counter;   // Released when the job finishes (may be null)
+};
+
+struct JobCounter {
+    std::atomic<int> pending{0};     // Jobs submitted and not yet finished
+    std::atomic<int> finishing{0};   // Workers still touching the counter after a job
+    std::mutex lock;                 // Guards continuations
+    std::vector<Job> continuations;  // runJobAfter jobs waiting for pending to drain
+};
+
+struct JobSystemStats {
+    uint64_t executed;   // Jobs run (including inline ones)
+    uint64_t stolen;     // Jobs taken from another worker's deque
+    uint64_t inlined;    // Run on submit: system stopped or deque full
+};
+
+// workers = 0: one per hardware thread, minus the calling thread
+bool startJobSystem(int workers = 0);
+void stopJobSystem(); // Runs whatever is still queued, then joins the workers
+bool isJobSystemRunning();
+int getJobWorkerCount(); // Worker threads, not counting the starting thread
+
+void runJob(JobFunction function, void* data, JobCounter* counter, size_t begin = 0, size_t end = 0);
+// Start once `dependency` drains; counter (if any) is held from now on
+void runJobAfter(JobCounter& dependency, JobFunction function, void* data, JobCounter* counter,
+                 size_t begin = 0, size_t end = 0);
+// Block until counter drains, running queued jobs meanwhile; the counter may
+// be reused or destroyed once this returns
+void waitForJobs(JobCounter& counter);
+
+// Run body over [0, count) in ranges of at most `grain` indices, split
+// recursively across workers; returns when all ranges are done
+void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+
+JobSystemStats getJobSystemStats();
+
+#endif // JOBS_H
@@ -0,0 +1,522 @@
+#include "kws.h"
+#include "fft.h"
+#include "stt_session.h"
+#include "scene_logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KWS_SSE2 1
+#include <emmintrin.h>
+#else
+#define KWS_SSE2 0
+#endif
+
+// Frontend: 25 ms Hann window every 10 ms, 512-point FFT, 24 mel bands
+// (60 Hz - 7.6 kHz), log, DCT-II coefficients 1..8 (c0 carries the level
+// and is dropped, which makes matching independent of input gain)
+static const int FRAME_SAMPLES = 400;
+static const int HOP_SAMPLES = 160;
+static const int FFT_SIZE = 512;
+static const int MEL_BANDS = 24;
+static const int SPECTRUM_BINS = FFT_SIZE / 2 + 1;
+static const float PRE_EMPHASIS = 0.97f;
+static const float HORIZONTAL_PENALTY = 0.25f; // DTW: per input frame spent on one template frame
+static const double PI = 3.14159265358979323846;
+
+struct MelFilter {
+    int firstBin;
+    std::vector<float> weights; // Padded to a multiple of 4
+};
+
+struct FrontendTables {
+    FFTPlan plan;
+    float window[FRAME_SAMPLES];
+    std::vector<MelFilter> filters;
+    float dct[KWS_FEATURE_DIM][MEL_BANDS];
+};
+
+static FrontendTables tables;
+static std::once_flag tablesOnce;
+
+static float dotProduct(const float* a, const float* b, int n) {
+    int i = 0;
+    float sum = 0.0f;
+#if KWS_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static float squaredDistance(const float* a, const float* b) {
+    float sum = 0.0f;
+    int i = 0;
+#if KWS_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= KWS_FEATURE_DIM; i += 4) {
+        __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc = _mm_add_ps(acc, _mm_mul_ps(diff, diff));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < KWS_FEATURE_DIM; i++) {
+        float diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+static double hzToMel(double hz) {
+    return 2595.0 * log10(1.0 + hz / 700.0);
+}
+
+static double melToHz(double mel) {
+    return 700.0 * (pow(10.0, mel / 2595.0) - 1.0);
+}
+
+static void buildTables() {
+    initFFTPlan(tables.plan, FFT_SIZE);
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        tables.window[i] = (float)(0.5 - 0.5 * cos(2.0 * PI * i / (FRAME_SAMPLES - 1)));
+    }
+
+    // Triangular filters evenly spaced on the mel scale
+    double lowMel = hzToMel(60.0), highMel = hzToMel(7600.0);
+    double edges[MEL_BANDS + 2];
+    for (int i = 0; i < MEL_BANDS + 2; i++) {
+        edges[i] = melToHz(lowMel + (highMel - lowMel) * i / (MEL_BANDS + 1)) * FFT_SIZE / KWS_SAMPLE_RATE;
+    }
+    tables.filters.resize(MEL_BANDS);
+    for (int band = 0; band < MEL_BANDS; band++) {
+        double left = edges[band], center = edges[band + 1], right = edges[band + 2];
+        MelFilter& filter = tables.filters[band];
+        filter.firstBin = std::max(0, (int)ceil(left));
+        int lastBin = std::min(SPECTRUM_BINS - 1, (int)floor(right));
+        int count = std::max(1, lastBin - filter.firstBin + 1);
+        filter.weights.assign((count + 3) & ~3, 0.0f);
+        filter.firstBin = std::min(filter.firstBin, SPECTRUM_BINS - (int)filter.weights.size());
+        for (size_t i = 0; i < filter.weights.size(); i++) {
+            double bin = filter.firstBin + (double)i;
+            double weight = bin <= center ? (bin - left) / (center - left) : (right - bin) / (right - center);
+            filter.weights[i] = (float)std::max(0.0, weight);
+        }
+    }
+
+    for (int c = 0; c < KWS_FEATURE_DIM; c++) {
+        for (int b = 0; b < MEL_BANDS; b++) {
+            tables.dct[c][b] = (float)(sqrt(2.0 / MEL_BANDS) * cos(PI * (c + 1) * (b + 0.5) / MEL_BANDS));
+        }
+    }
+}
+
+// Streaming frontend: any input rate -> 16 kHz -> MFCC frames
+struct Frontend {
+    int inputRate = 0;
+    double step = 1.0;         // Input samples per 16 kHz output sample
+    double filled = 0.0;       // Input samples accumulated into the current output sample
+    double accumulator = 0.0;
+    float lastSample = 0.0f;   // Pre-emphasis state
+    std::vector<float> pending; // 16 kHz samples not yet consumed by a hop
+    float logEnergy = 0.0f;    // Of the most recent frame
+};
+
+static void resetFrontend(Frontend& frontend, int inputRate) {
+    std::call_once(tablesOnce, buildTables);
+    frontend = Frontend();
+    frontend.inputRate = inputRate;
+    frontend.step = (double)inputRate / KWS_SAMPLE_RATE;
+    frontend.pending.reserve(FRAME_SAMPLES + HOP_SAMPLES * 8);
+}
+
+static void computeFrame(Frontend& frontend, const float* samples, float* features) {
+    float windowed[FFT_SIZE];
+    float power[FFT_SIZE];
+    float re[FFT_SIZE], im[FFT_SIZE];
+    static_assert(FRAME_SAMPLES % 4 == 0, "window is applied four samples at a time");
+#if KWS_SSE2
+    for (int i = 0; i < FRAME_SAMPLES; i += 4) {
+        _mm_storeu_ps(windowed + i, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(tables.window + i)));
+    }
+#else
+    for (int i = 0; i < FRAME_SAMPLES; i++) {
+        windowed[i] = samples[i] * tables.window[i];
+    }
+#endif
+    memset(windowed + FRAME_SAMPLES, 0, sizeof(float) * (FFT_SIZE - FRAME_SAMPLES));
+    fftPowerSpectrum(tables.plan, windowed, power, re, im);
+
+    float logMel[MEL_BANDS];
+    float energy = 0.0f;
+    for (int band = 0; band < MEL_BANDS; band++) {
+        const MelFilter& filter = tables.filters[band];
+        float value = dotProduct(filter.weights.data(), power + filter.firstBin, (int)filter.weights.size());
+        energy += value;
+        logMel[band] = logf(value + 1e-6f);
+    }
+    frontend.logEnergy = logf(energy + 1e-6f);
+    for (int c = 0; c < KWS_FEATURE_DIM; c++) {
+        features[c] = dotProduct(tables.dct[c], logMel, MEL_BANDS);
+    }
+}
+
+// Push capture samples; appends one feature frame per completed hop
+static void feedFrontend(Frontend& frontend, const short* samples, size_t count, std::vector<float>& frames,
+                         std::vector<float>* energies = nullptr) {
+    for (size_t n = 0; n < count; n++) {
+        // Box-filter resampler: each output sample averages the input it spans
+        double sample = samples[n] / 32768.0;
+        double take = std::min(1.0, frontend.step - frontend.filled);
+        frontend.accumulator += sample * take;
+        frontend.filled += take;
+        if (frontend.filled >= frontend.step - 1e-9) {
+            float output = (float)(frontend.accumulator / frontend.step);
+            frontend.pending.push_back(output - PRE_EMPHASIS * frontend.lastSample);
+            frontend.lastSample = output;
+            frontend.accumulator = sample * (1.0 - take);
+            frontend.filled = 1.0 - take;
+        }
+    }
+
+    size_t offset = 0;
+    while (frontend.pending.size() - offset >= (size_t)FRAME_SAMPLES) {
+        size_t first = frames.size();
+        frames.resize(first + KWS_FEATURE_DIM);
+        computeFrame(frontend, frontend.pending.data() + offset, frames.data() + first);
+        if (energies) energies->push_back(frontend.logEnergy);
+        offset += HOP_SAMPLES;
+    }
+    frontend.pending.erase(frontend.pending.begin(), frontend.pending.begin() + offset);
+}
+
+std::vector<float> computeKeywordFeatures(const std::vector<short>& samples, int sampleRate) {
+    std::vector<float> frames;
+    if (sampleRate < KWS_SAMPLE_RATE) return frames;
+    Frontend frontend;
+    resetFrontend(frontend, sampleRate);
+    feedFrontend(frontend, samples.data(), samples.size(), frames);
+    return frames;
+}
+
+// ---- WAV files ----
+
+static uint32_t readLE32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t readLE16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool loadWAVFileChannels(const std::string& path, std::vector<short>& samples, int& channels, int& sampleRate) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::vector<unsigned char> data;
+    unsigned char buffer[65536];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    int bits = 0;
+    channels = 0;
+    sampleRate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        uint32_t chunkSize = readLE32(&data[pos + 4]);
+        size_t body = pos + 8;
+        size_t available = std::min<size_t>(chunkSize, data.size() - body);
+        if (memcmp(&data[pos], "fmt ", 4) == 0 && available >= 16) {
+            uint16_t format = readLE16(&data[body]);
+            // PCM, or WAVE_FORMAT_EXTENSIBLE (multi-channel recorders) with a PCM subformat
+            bool extensiblePCM = format == 0xFFFE && available >= 40 && readLE16(&data[body + 24]) == 1;
+            if (format != 1 && !extensiblePCM) return false;
+            channels = readLE16(&data[body + 2]);
+            sampleRate = (int)readLE32(&data[body + 4]);
+            bits = readLE16(&data[body + 14]);
+        } else if (memcmp(&data[pos], "data", 4) == 0) {
+            if (channels <= 0 || bits != 16 || sampleRate <= 0) return false;
+            size_t count = available / (2 * channels) * channels; // Whole frames only
+            samples.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                samples[i] = (short)readLE16(&data[body + i * 2]);
+            }
+            return true;
+        }
+        pos = body + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+bool loadWAVFile(const std::string& path, std::vector<short>& samples, int& sampleRate) {
+    std::vector<short> interleaved;
+    int channels = 0;
+    if (!loadWAVFileChannels(path, interleaved, channels, sampleRate)) return false;
+    if (channels == 1) {
+        samples.swap(interleaved);
+        return true;
+    }
+    samples.resize(interleaved.size() / channels);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = interleaved[i * channels];
+    }
+    return true;
+}
+
+bool saveWAVFile(const std::string& path, const std::vector<short>& samples, int sampleRate, int channels) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    uint32_t dataBytes = (uint32_t)(samples.size() * sizeof(short));
+    unsigned char header[44];
+    auto put32 = [&](int offset, uint32_t value) {
+        for (int i = 0; i < 4; i++) header[offset + i] = (unsigned char)(value >> (8 * i));
+    };
+    auto put16 = [&](int offset, uint16_t value) {
+        header[offset] = (unsigned char)value;
+        header[offset + 1] = (unsigned char)(value >> 8);
+    };
+    memcpy(header, "RIFF", 4);
+    put32(4, 36 + dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1);
+    put16(22, (uint16_t)channels);
+    put32(24, (uint32_t)sampleRate);
+    put32(28, (uint32_t)(sampleRate * 2 * channels));
+    put16(32, (uint16_t)(2 * channels));
+    put16(34, 16);
+    memcpy(header + 36, "data", 4);
+    put32(40, dataBytes);
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(samples.data(), 1, dataBytes, file) == dataBytes;
+    fclose(file);
+    return ok;
+}
+
+// ---- Detector ----
+
+struct KeywordTemplate {
+    std::vector<float> frames;  // length * KWS_FEATURE_DIM
+    int length;
+    std::vector<float> cost;    // Streaming DTW column: best path cost ending at each template frame
+    std::vector<float> weight;  // ...and that path's step weight (for normalization)
+};
+
+static std::mutex spotterMutex; // Guards configuration and stats; the detector state belongs to the capture thread
+static bool spotterActive = false;
+static KWSConfig spotterConfig;
+static std::vector<KeywordTemplate> templates;
+static Frontend liveFrontend;
+static std::vector<float> liveFrames;
+static uint64_t framesSinceDetection = 0;
+static KWSStats spotterStats;
+
+static const float INF_COST = 1e30f;
+
+static double threadCPUSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Drop leading and trailing frames more than 30 dB (natural log ~6.9) below the loudest
+static bool trimmedTemplate(const std::vector<short>& samples, int sampleRate, KeywordTemplate& result) {
+    if (sampleRate < KWS_SAMPLE_RATE) return false;
+    Frontend frontend;
+    resetFrontend(frontend, sampleRate);
+    std::vector<float> frames, energies;
+    feedFrontend(frontend, samples.data(), samples.size(), frames, &energies);
+    if (energies.empty()) return false;
+    float peak = *std::max_element(energies.begin(), energies.end());
+    int first = 0, last = (int)energies.size() - 1;
+    while (first < last && energies[first] < peak - 6.9f) first++;
+    while (last > first && energies[last] < peak - 6.9f) last--;
+    result.length = last - first + 1;
+    if (result.length < 10) return false; // Under 100 ms: not a phrase
+    result.frames.assign(frames.begin() + first * KWS_FEATURE_DIM, frames.begin() + (last + 1) * KWS_FEATURE_DIM);
+    result.cost.assign(result.length, INF_COST);
+    result.weight.assign(result.length, 1.0f);
+    return true;
+}
+
+// Advance one template's subsequence DTW by one input frame; returns the normalized match cost
+// Steps: diagonal (weight 1), skip a template frame (2x speed, weight 2), stay on the
+// template frame (slower speech, weight 1 + penalty); a path may start at any input frame
+static float advanceTemplate(KeywordTemplate& keyword, const float* frame) {
+    float* cost = keyword.cost.data();
+    float* weight = keyword.weight.data();
+    const float* reference = keyword.frames.data();
+    // Descending j: cost[j-1] and cost[j-2] still hold the previous input frame's column
+    for (int j = keyword.length - 1; j >= 0; j--) {
+        float d = sqrtf(squaredDistance(frame, reference + j * KWS_FEATURE_DIM));
+        float bestCost = cost[j] < INF_COST ? cost[j] + d + HORIZONTAL_PENALTY : INF_COST;
+        float bestWeight = weight[j] + 1.0f;
+        if (j >= 1 && cost[j - 1] < INF_COST && cost[j - 1] + d < bestCost) {
+            bestCost = cost[j - 1] + d;
+            bestWeight = weight[j - 1] + 1.0f;
+        }
+        if (j >= 2 && cost[j - 2] < INF_COST && cost[j - 2] + 2.0f * d < bestCost) {
+            bestCost = cost[j - 2] + 2.0f * d;
+            bestWeight = weight[j - 2] + 2.0f;
+        }
+        if (j == 0 && d < bestCost) {
+            bestCost = d;
+            bestWeight = 1.0f;
+        }
+        cost[j] = bestCost;
+        weight[j] = bestWeight;
+    }
+    int last = keyword.length - 1;
+    return cost[last] < INF_COST ? cost[last] / weight[last] : INF_COST;
+}
+
+bool initKeywordSpotter(const KWSConfig& config, const std::vector<std::string>& templatePaths) {
+    std::vector<KeywordTemplate> loaded;
+    for (const std::string& path : templatePaths) {
+        std::vector<short> samples;
+        int sampleRate = 0;
+        KeywordTemplate keyword;
+        if (!loadWAVFile(path, samples, sampleRate)) {
+            std::cerr << "[ERROR] KWS: Cannot read wake phrase template " << path << std::endl;
+            continue;
+        }
+        if (!trimmedTemplate(samples, sampleRate, keyword)) {
+            std::cerr << "[ERROR] KWS: Template " << path << " has no speech" << std::endl;
+            continue;
+        }
+        loaded.push_back(keyword);
+    }
+    if (loaded.empty()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    spotterConfig = config;
+    templates.swap(loaded);
+    liveFrontend = Frontend();
+    liveFrames.clear();
+    framesSinceDetection = 1u << 30;
+    spotterStats = KWSStats();
+    spotterStats.lastScore = INF_COST;
+    spotterStats.minScore = INF_COST;
+    spotterActive = true;
+    std::cout << "[DEBUG] KWS: " << templates.size() << " wake phrase template(s), threshold " << config.threshold
+              << (fftUsesSIMD() ? " (SSE2)" : " (scalar)") << std::endl;
+    return true;
+}
+
+void shutdownKeywordSpotter() {
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    spotterActive = false;
+    templates.clear();
+}
+
+bool isKeywordSpotterActive() {
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    return spotterActive;
+}
+
+int feedKeywordSpotter(const short* samples, size_t count, int sampleRate) {
+    if (!samples || count == 0 || sampleRate < KWS_SAMPLE_RATE) return 0;
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    if (!spotterActive) return 0;
+    double cpuStart = threadCPUSeconds();
+
+    if (liveFrontend.inputRate != sampleRate) {
+        resetFrontend(liveFrontend, sampleRate);
+    }
+    liveFrames.clear();
+    feedFrontend(liveFrontend, samples, count, liveFrames);
+
+    int detections = 0;
+    int refractoryFrames = spotterConfig.refractoryMs / 10;
+    for (size_t offset = 0; offset < liveFrames.size(); offset += KWS_FEATURE_DIM) {
+        float best = INF_COST;
+        for (KeywordTemplate& keyword : templates) {
+            best = std::min(best, advanceTemplate(keyword, liveFrames.data() + offset));
+        }
+        framesSinceDetection++;
+        spotterStats.framesProcessed++;
+        spotterStats.lastScore = best;
+        spotterStats.minScore = std::min(spotterStats.minScore, best);
+        if (best <= spotterConfig.threshold && framesSinceDetection > (uint64_t)refractoryFrames) {
+            detections++;
+            framesSinceDetection = 0;
+            spotterStats.detections++;
+            logAudio("KWS: wake phrase detected (score " + std::to_string(best) + ")");
+        }
+    }
+
+    spotterStats.audioSeconds += (double)count / sampleRate;
+    spotterStats.cpuSeconds += threadCPUSeconds() - cpuStart;
+    return detections;
+}
+
+bool feedWakeGate(const short* samples, size_t count, int sampleRate, const CaptureTag* tag) {
+    if (!isKeywordSpotterActive()) {
+        appendSTTSessionAudio(samples, count, tag);
+        return isSTTSessionActive();
+    }
+
+    int listenMs;
+    {
+        std::lock_guard<std::mutex> lock(spotterMutex);
+        listenMs = spotterConfig.listenMs;
+    }
+    if (feedKeywordSpotter(samples, count, sampleRate) > 0) {
+        if (!isSTTSessionActive()) {
+            beginSTTSession(sampleRate);
+        }
+        extendSTTSession((uint64_t)listenMs * sampleRate / 1000);
+    }
+
+    uint64_t before = getSTTSessionStats().capturedSamples;
+    appendSTTSessionAudio(samples, count, tag);
+    STTSessionStats after = getSTTSessionStats();
+    bool open = after.sessionId != 0 && after.capturedSamples > before;
+
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    spotterStats.totalSamples += count;
+    if (open) spotterStats.gatedSamples += after.capturedSamples - before;
+    return open;
+}
+
+KWSStats getKeywordSpotterStats() {
+    std::lock_guard<std::mutex> lock(spotterMutex);
+    return spotterStats;
+}
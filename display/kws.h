@@ -0,0 +1,68 @@
+#ifndef KWS_H
+#define KWS_H
+
+#include "latency.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-device keyword spotting that gates STT uploads
+// Capture audio is resampled to 16 kHz and turned into MFCC frames (25 ms
+// window, 10 ms hop, 24-band log-mel + DCT; the FFT, filterbank and DCT
+// use SSE2 where available). Each frame advances a streaming subsequence
+// DTW against every enrolled template of the wake phrase; a match below
+// the threshold is a detection. The wake gate opens an STT session on a
+// detection and keeps it open for listenMs of audio after the last one, so
+// nothing is uploaded or streamed while nobody is addressing the display.
+
+struct KWSConfig {
+    float threshold = 5.4f;     // Mean per-frame MFCC distance along the DTW path
+    int listenMs = 8000;        // Session stays open this long after the last detection
+    int refractoryMs = 1000;    // Ignore repeats of the same utterance
+};
+
+struct KWSStats {
+    uint64_t framesProcessed;
+    uint64_t detections;
+    float lastScore;            // Best normalized DTW cost of the most recent frame
+    float minScore;             // Lowest score seen since init
+    double audioSeconds;        // Audio fed to the detector
+    double cpuSeconds;          // Thread time spent in the detector
+    uint64_t gatedSamples;      // Capture samples that went to an open STT session
+    uint64_t totalSamples;      // Capture samples seen by the wake gate
+};
+
+// MFCC frontend: 16 kHz input, one 8-coefficient frame per 160 samples
+// (capture rates of 16 kHz and above are downsampled; lower rates are not supported)
+const int KWS_SAMPLE_RATE = 16000;
+const int KWS_FEATURE_DIM = 8;
+
+// Read a 16-bit PCM WAV (mono, or the first channel); false if unsupported
+bool loadWAVFile(const std::string& path, std::vector<short>& samples, int& sampleRate);
+// All channels, interleaved frame by frame
+bool loadWAVFileChannels(const std::string& path, std::vector<short>& samples, int& channels, int& sampleRate);
+// samples are interleaved when channels > 1
+bool saveWAVFile(const std::string& path, const std::vector<short>& samples, int sampleRate, int channels = 1);
+
+// Feature frames (KWS_FEATURE_DIM floats each) of a whole utterance at any sample rate
+std::vector<float> computeKeywordFeatures(const std::vector<short>& samples, int sampleRate);
+
+// Enrol the wake phrase from WAV recordings (leading/trailing silence is trimmed)
+bool initKeywordSpotter(const KWSConfig& config, const std::vector<std::string>& templatePaths);
+void shutdownKeywordSpotter();
+bool isKeywordSpotterActive();
+
+// Capture thread: run the detector over one block; returns detections in the block
+int feedKeywordSpotter(const short* samples, size_t count, int sampleRate);
+
+// Capture thread: detector + STT session gate in one call
+// With the spotter active, audio reaches the session only while a wake
+// phrase has opened it; otherwise every block is appended as before.
+// Returns true when the block belongs to an open session (stream it too).
+// tag (optional) is passed on to the session for latency tracing.
+bool feedWakeGate(const short* samples, size_t count, int sampleRate, const CaptureTag* tag = nullptr);
+
+KWSStats getKeywordSpotterStats();
+
+#endif // KWS_H
@@ -0,0 +1,180 @@
+#include "latency.h"
+#include "scene_logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+
+// Log-spaced buckets: BUCKETS_PER_DOUBLING per octave from MIN_BUCKET_MS up
+// to about three minutes; bucket 0 holds everything below MIN_BUCKET_MS
+static const int BUCKETS_PER_DOUBLING = 8;
+static const int DOUBLINGS = 24;
+static const int BUCKET_COUNT = BUCKETS_PER_DOUBLING * DOUBLINGS + 1;
+static const double MIN_BUCKET_MS = 0.01;
+static const int STAGE_COUNT = (int)LatencyStage::COUNT;
+
+struct StageHistogram {
+    std::mutex mutex;
+    uint64_t buckets[BUCKET_COUNT] = {0};
+    uint64_t count = 0;
+    double sumMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
+
+static StageHistogram histograms[STAGE_COUNT];
+static std::atomic<uint64_t> captureClock(0);
+
+static std::mutex reportMutex;
+static double reportInterval = 0.0;
+static double lastReport = -1.0;
+
+double getLatencyClock() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CaptureTag tagCapturedBlock(int numSamples, int sampleRate) {
+    CaptureTag tag;
+    tag.sample = captureClock.fetch_add((uint64_t)std::max(0, numSamples));
+    tag.sampleRate = sampleRate;
+    tag.time = sampleRate > 0 ? getLatencyClock() - (double)numSamples / sampleRate : -1.0;
+    return tag;
+}
+
+void resetCaptureClock() {
+    captureClock = 0;
+}
+
+double captureTimeAt(const CaptureTag& tag, uint64_t offset) {
+    if (tag.time < 0.0 || tag.sampleRate <= 0) return -1.0;
+    return tag.time + (double)offset / tag.sampleRate;
+}
+
+static int bucketIndex(double ms) {
+    if (ms < MIN_BUCKET_MS) return 0;
+    int index = 1 + (int)(std::log2(ms / MIN_BUCKET_MS) * BUCKETS_PER_DOUBLING);
+    return std::min(index, BUCKET_COUNT - 1);
+}
+
+// Geometric middle of a bucket
+static double bucketMs(int index) {
+    if (index == 0) return MIN_BUCKET_MS / 2.0;
+    return MIN_BUCKET_MS * std::exp2((index - 0.5) / BUCKETS_PER_DOUBLING);
+}
+
+void recordLatency(LatencyStage stage, double latencyMs) {
+    int index = (int)stage;
+    if (index < 0 || index >= STAGE_COUNT || !std::isfinite(latencyMs)) return;
+    latencyMs = std::max(0.0, latencyMs);
+    StageHistogram& histogram = histograms[index];
+    std::lock_guard<std::mutex> lock(histogram.mutex);
+    histogram.buckets[bucketIndex(latencyMs)]++;
+    histogram.minMs = histogram.count == 0 ? latencyMs : std::min(histogram.minMs, latencyMs);
+    histogram.maxMs = histogram.count == 0 ? latencyMs : std::max(histogram.maxMs, latencyMs);
+    histogram.sumMs += latencyMs;
+    histogram.count++;
+}
+
+void recordLatencySince(LatencyStage stage, double captureTime) {
+    if (captureTime < 0.0) return;
+    recordLatency(stage, (getLatencyClock() - captureTime) * 1000.0);
+}
+
+// Caller holds the histogram's mutex
+static double percentile(const StageHistogram& histogram, double fraction) {
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(fraction * histogram.count));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= rank) return std::min(histogram.maxMs, std::max(histogram.minMs, bucketMs(i)));
+    }
+    return histogram.maxMs;
+}
+
+LatencyHistogram getLatencyHistogram(LatencyStage stage) {
+    LatencyHistogram result = {0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    int index = (int)stage;
+    if (index < 0 || index >= STAGE_COUNT) return result;
+    StageHistogram& histogram = histograms[index];
+    std::lock_guard<std::mutex> lock(histogram.mutex);
+    if (histogram.count == 0) return result;
+    result.count = histogram.count;
+    result.minMs = histogram.minMs;
+    result.maxMs = histogram.maxMs;
+    result.meanMs = histogram.sumMs / histogram.count;
+    result.p50Ms = percentile(histogram, 0.50);
+    result.p95Ms = percentile(histogram, 0.95);
+    result.p99Ms = percentile(histogram, 0.99);
+    return result;
+}
+
+void resetLatencyHistograms() {
+    for (StageHistogram& histogram : histograms) {
+        std::lock_guard<std::mutex> lock(histogram.mutex);
+        std::fill(histogram.buckets, histogram.buckets + BUCKET_COUNT, 0);
+        histogram.count = 0;
+        histogram.sumMs = 0.0;
+        histogram.minMs = 0.0;
+        histogram.maxMs = 0.0;
+    }
+}
+
+const char* getLatencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::CAPTURE: return "capture";
+        case LatencyStage::WAVEFORM_BAR: return "waveform bar";
+        case LatencyStage::SEGMENT: return "segment";
+        case LatencyStage::UPLOAD: return "upload";
+        case LatencyStage::TRANSCRIPT: return "transcript";
+        default: return "unknown";
+    }
+}
+
+std::string formatLatencyReport() {
+    std::string report;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        LatencyHistogram histogram = getLatencyHistogram((LatencyStage)i);
+        if (histogram.count == 0) continue;
+        char line[192];
+        snprintf(line, sizeof(line), "Latency %s: n=%llu p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+                 getLatencyStageName((LatencyStage)i), (unsigned long long)histogram.count, histogram.p50Ms,
+                 histogram.p95Ms, histogram.p99Ms, histogram.maxMs);
+        report += line;
+    }
+    return report;
+}
+
+void configureLatencyReport(double intervalSeconds) {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    reportInterval = std::max(0.0, intervalSeconds);
+    lastReport = getLatencyClock();
+}
+
+void updateLatencyReport() {
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        double now = getLatencyClock();
+        if (reportInterval <= 0.0 || now - lastReport < reportInterval) return;
+        lastReport = now;
+    }
+    std::string report = formatLatencyReport();
+    size_t start = 0, end;
+    while ((end = report.find('\n', start)) != std::string::npos) {
+        logAudio(report.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+std::vector<short> makeClickTrack(int sampleRate, double seconds, int intervalMs) {
+    std::vector<short> samples((size_t)std::max(0.0, seconds * sampleRate), 0);
+    size_t interval = (size_t)std::max(1, (int)((int64_t)intervalMs * sampleRate / 1000));
+    size_t clickSamples = (size_t)std::max(1, sampleRate / 500);
+    for (size_t start = interval / 2; start < samples.size(); start += interval) {
+        for (size_t i = 0; i < clickSamples && start + i < samples.size(); i++) {
+            samples[start + i] = (i % 2 == 0) ? 32767 : -32767;
+        }
+    }
+    return samples;
+}
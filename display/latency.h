@@ -0,0 +1,67 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// End-to-end capture latency tracing
+// Every captured block is tagged with its position on a monotonic capture
+// clock (samples since the first capture run) and the time its first sample
+// was recorded: the block's arrival minus its duration, since a device hands
+// a buffer over only once it is full. The tag travels with the audio through
+// waveform bars, upload segments cut by the STT session, the spool's uploads
+// and the transcripts of their replies. Each stage records how long after its
+// newest sample was recorded it got there, into a per-stage histogram.
+
+enum class LatencyStage {
+    CAPTURE,       // Block's first sample recorded -> block through beamformer and DSP
+    WAVEFORM_BAR,  // Bar's last sample recorded -> bar published
+    SEGMENT,       // Segment's last sample recorded -> segment cut from the session for upload
+    UPLOAD,        // Segment's last sample recorded -> upload accepted by the server
+    TRANSCRIPT,    // Segment's last sample recorded -> its transcript drained to the view
+    COUNT
+};
+
+struct CaptureTag {
+    uint64_t sample = 0;  // Capture clock of the block's first sample
+    double time = -1.0;   // getLatencyClock() when that sample was recorded (-1: untagged)
+    int sampleRate = 0;
+};
+
+struct LatencyHistogram {
+    uint64_t count;
+    double minMs;
+    double maxMs;
+    double meanMs;
+    double p50Ms;   // Percentiles are bucket midpoints (buckets are 2^(1/8) wide, about 9%)
+    double p95Ms;
+    double p99Ms;
+};
+
+double getLatencyClock(); // Monotonic seconds, the same clock as getTranscriptClock
+
+// Tag a block that has just arrived from the capture device (or file source)
+// and advance the capture clock past it
+CaptureTag tagCapturedBlock(int numSamples, int sampleRate);
+void resetCaptureClock();
+// Recording time of the sample `offset` samples into a tagged block (-1 if untagged)
+double captureTimeAt(const CaptureTag& tag, uint64_t offset);
+
+// Any thread; captureTime < 0 (untagged audio) is ignored
+void recordLatency(LatencyStage stage, double latencyMs);
+void recordLatencySince(LatencyStage stage, double captureTime);
+LatencyHistogram getLatencyHistogram(LatencyStage stage);
+void resetLatencyHistograms();
+const char* getLatencyStageName(LatencyStage stage);
+std::string formatLatencyReport(); // One line per stage that has samples
+
+// Log the report to audio.log every intervalSeconds (0 = never); call
+// updateLatencyReport once per frame
+void configureLatencyReport(double intervalSeconds);
+void updateLatencyReport();
+
+// Loopback probe: a click (a 2 ms full-scale burst) every intervalMs over silence
+std::vector<short> makeClickTrack(int sampleRate, double seconds, int intervalMs);
+
+#endif // LATENCY_H
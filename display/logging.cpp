@@ -2,6 +2,9 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
 #endif
 
 #include <iostream>
@@ -9,7 +12,6 @@
 #include <iomanip>
 #include <ctime>
 #include <sstream>
-#include <cstdlib>
 
 // Global log file stream
 static std::ofstream logFile;
@@ -27,11 +29,11 @@ std::string getTimestamp() {
 
 // Initialize logging
 void initLogging() {
-    // Create logs directory if it doesn't exist
+    // Create logs directory if it doesn't exist (no shell: this is on the startup path)
     #ifdef _WIN32
-    system("if not exist logs mkdir logs");
+    _mkdir("logs");
     #else
-    system("mkdir -p logs 2>/dev/null");
+    mkdir("logs", 0755);
     #endif
     
     // Create log filename with timestamp
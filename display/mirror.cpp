@@ -0,0 +1,142 @@
+#include "mirror.h"
+#include "gl_state.h"
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+struct MirrorTexture {
+    unsigned int texture;
+    int width;
+    int height;
+};
+
+static std::vector<MirrorTexture> mirrorTextures; // Shared between contexts, reused frame to frame
+
+std::string getMirrorContentKey(const WindowData& wd, float alpha) {
+    // Its own tetra-click progress is drawn over the content
+    if (!wd.sharedContext || wd.transition.active || (wd.isAdmin && !wd.adminModeActive && wd.adminClickCount > 0)) return "";
+    switch (wd.state) {
+    case DisplayState::OPENING_SCENE:
+        // A scene that is not loaded yet loads during its own render
+        if (!wd.sceneLoaded || wd.sceneLoading || !wd.openingScene) return "";
+        return "opening";
+    case DisplayState::ADMIN_SCENE:
+        return "admin:" + wd.currentAdminScene + (wd.isAdmin ? ":elevated" : "");
+    default: {
+        // A window loading its scene draws its own progress over the logo
+        if (wd.sceneLoading) return "";
+        // Logo states: the same image at the same opacity
+        char opacity[32];
+        snprintf(opacity, sizeof(opacity), ":%.4f", alpha);
+        return "logo:" + (wd.isValid ? wd.logoPath : std::string("placeholder")) + opacity;
+    }
+    }
+}
+
+std::vector<MirrorGroup> buildMirrorGroups(const std::vector<MirrorCandidate>& candidates) {
+    std::vector<MirrorGroup> groups;
+    int slots = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const MirrorCandidate& candidate = candidates[i];
+        MirrorGroup* match = nullptr;
+        if (!candidate.contentKey.empty()) {
+            for (MirrorGroup& group : groups) {
+                const MirrorCandidate& leader = candidates[group.members[0]];
+                if (leader.fbWidth == candidate.fbWidth && leader.fbHeight == candidate.fbHeight &&
+                    leader.isVertical == candidate.isVertical && leader.contentKey == candidate.contentKey) {
+                    match = &group;
+                    break;
+                }
+            }
+        }
+        if (match) {
+            if (match->slot < 0) match->slot = slots++;
+            match->members.push_back((int)i);
+            continue;
+        }
+        MirrorGroup group;
+        group.members.push_back((int)i);
+        group.fbWidth = candidate.fbWidth;
+        group.fbHeight = candidate.fbHeight;
+        group.slot = -1;
+        group.texture = 0;
+        groups.push_back(group);
+    }
+    return groups;
+}
+
+std::vector<int> getMirrorGroupIndex(const std::vector<MirrorGroup>& groups, size_t candidateCount) {
+    std::vector<int> index(candidateCount, -1);
+    for (size_t g = 0; g < groups.size(); g++) {
+        for (int member : groups[g].members) index[member] = (int)g;
+    }
+    return index;
+}
+
+void captureMirrorFrame(MirrorGroup& group) {
+    group.texture = 0;
+    if (group.slot < 0 || group.fbWidth <= 0 || group.fbHeight <= 0) return;
+    if ((int)mirrorTextures.size() <= group.slot) mirrorTextures.resize(group.slot + 1, MirrorTexture{0, 0, 0});
+    MirrorTexture& slot = mirrorTextures[group.slot];
+
+    while (glGetError() != GL_NO_ERROR) {} // Only report errors from the copy itself
+    if (slot.texture == 0) {
+        glGenTextures(1, &slot.texture);
+    }
+    bindGLTexture(slot.texture);
+    glReadBuffer(GL_BACK);
+    if (slot.width != group.fbWidth || slot.height != group.fbHeight) {
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 0, 0, group.fbWidth, group.fbHeight, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        // Same size on both ends: texels map 1:1 onto pixels
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        slot.width = group.fbWidth;
+        slot.height = group.fbHeight;
+    } else {
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, group.fbWidth, group.fbHeight);
+    }
+    bindGLTexture(0);
+    // glFlush only submits the copy; followers sample the shared texture from
+    // other contexts, so it must have completed before they present it
+    glFinish();
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "[WARNING] Mirror: Could not copy the leader's frame, followers render themselves" << std::endl;
+        return;
+    }
+    group.texture = slot.texture;
+}
+
+void presentMirrorFrame(const MirrorGroup& group) {
+    float w = (float)group.fbWidth;
+    float h = (float)group.fbHeight;
+    setGLViewport(0, 0, group.fbWidth, group.fbHeight);
+    setGLOrtho2D(group.fbWidth, group.fbHeight);
+
+    setGLBlend(false);
+    setGLTexture2D(true);
+    bindGLTexture(group.texture);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(w, 0.0f);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(w, h);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, h);
+    glEnd();
+}
+
+void releaseMirrorTextures() {
+    for (MirrorTexture& slot : mirrorTextures) {
+        deleteGLTexture(slot.texture);
+    }
+    mirrorTextures.clear();
+}
@@ -0,0 +1,50 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include "window.h"
+#include <string>
+#include <vector>
+
+// Render-once, present-many for mirrored monitors
+// Windows whose framebuffers have the same size and orientation and that
+// show the same content this frame form a mirror group. Only the first
+// member (the leader) renders; its finished back buffer is copied into a
+// texture shared between the window contexts, and every other member
+// presents that texture with one full-screen quad instead of rendering the
+// scene again. Windows that must render themselves (no shared context, a
+// scene still loading, a transition running) get an empty content key and
+// stay in groups of one. A follower's own scene is not advanced while it
+// mirrors, so its background resumes from where it was once it leaves.
+
+struct MirrorCandidate {
+    int fbWidth;
+    int fbHeight;
+    bool isVertical;
+    std::string contentKey;      // "" renders alone
+};
+
+struct MirrorGroup {
+    std::vector<int> members;    // Candidate indices in window order; members[0] renders
+    int fbWidth;
+    int fbHeight;
+    int slot;                    // Shared texture slot (-1 for a group of one)
+    unsigned int texture;        // Leader's frame, set by captureMirrorFrame
+};
+
+// What a window shows this frame (after handleDisplayState, with its alpha)
+std::string getMirrorContentKey(const WindowData& wd, float alpha);
+
+// Group candidates with equal size, orientation and non-empty content key
+std::vector<MirrorGroup> buildMirrorGroups(const std::vector<MirrorCandidate>& candidates);
+// Group of each candidate (index into groups)
+std::vector<int> getMirrorGroupIndex(const std::vector<MirrorGroup>& groups, size_t candidateCount);
+
+// Leader, context current, after the frame is drawn and before the swap:
+// copy the back buffer into the group's shared texture
+void captureMirrorFrame(MirrorGroup& group);
+// Follower, context current: draw the leader's frame over the whole framebuffer
+void presentMirrorFrame(const MirrorGroup& group);
+// Delete the shared textures (any context of the share group current)
+void releaseMirrorTextures();
+
+#endif // MIRROR_H
@@ -0,0 +1,819 @@
+#include "net_reactor.h"
+#include "network.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#ifdef __linux__
+#include <sys/epoll.h>
+#define NET_HAVE_EPOLL 1
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // Not defined on macOS
+#endif
+#endif
+
+using ReactorClock = std::chrono::steady_clock;
+
+static const NetConnId WAKE_ID = 0;             // Poller id of the wake-up socket
+static const int MAX_WAIT_MS = 1000;             // Upper bound on one poll wait
+static const size_t READ_CHUNK = 16384;
+static const int RESOLVE_CACHE_SECONDS = 60;
+static const size_t SUBMIT_QUEUE_RESERVE = 64;      // Tasks per loop iteration before the queues grow
+
+struct Connection {
+    NetConnId id = 0;
+    NetSocket sock = INVALID_NET_SOCKET;
+    bool connecting = true;
+    bool wantWrite = true;   // Interest currently registered with the poller
+    std::string out;         // Bytes not yet accepted by the kernel
+    size_t outOffset = 0;
+    NetConnHandlers handlers;
+    NetTimerId connectTimer = 0;
+};
+
+struct HTTPExchange {
+    NetRequestId id = 0;
+    NetConnId conn = 0;
+    HTTPCallback callback;
+    NetTimerId timer = 0;
+    std::string request;
+    std::string response;
+    size_t headerEnd = std::string::npos;
+    int status = 0;
+    long long contentLength = -1;
+    bool chunked = false;
+    ReactorClock::time_point start;
+};
+
+struct TimerEntry {
+    ReactorClock::time_point deadline;
+    NetTimerId id;
+    bool operator>(const TimerEntry& other) const { return deadline > other.deadline; }
+};
+
+// Shared with other threads
+static std::thread reactorThread;
+static std::thread::id reactorThreadId;
+static std::atomic<bool> reactorRunning(false);
+static std::atomic<uint64_t> nextId(1);
+static std::mutex submitMutex;
+static std::vector<std::function<void()>> submitQueue;
+static std::vector<std::function<void()>> runningTasks; // Network thread; swapped with submitQueue so both keep their capacity
+static bool acceptingTasks = false; // Guarded by submitMutex; false once shutdown has drained the queue
+
+// Network thread only
+static std::map<NetConnId, Connection> connections;
+static std::map<NetRequestId, HTTPExchange> exchanges;
+static std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timerQueue;
+static std::map<NetTimerId, std::function<void()>> timerCallbacks;
+static bool useEpoll = false;
+#ifdef NET_HAVE_EPOLL
+static int epollFd = -1;
+#endif
+
+// Wake-up channel: a pipe on Unix, a loopback UDP socket sending to itself on Windows
+static NetSocket wakeRead = INVALID_NET_SOCKET;
+static NetSocket wakeWrite = INVALID_NET_SOCKET;
+
+// Host resolution cache (resolution happens on the submitting thread)
+static std::mutex resolveMutex;
+static std::map<std::string, std::pair<in_addr, ReactorClock::time_point>> resolveCache;
+
+static bool socketWouldBlock() {
+#ifdef _WIN32
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+
+static bool setNonBlocking(NetSocket sock) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket((SOCKET)sock, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+    return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool resolveHost(const std::string& host, in_addr& address) {
+    if (inet_pton(AF_INET, host.c_str(), &address) == 1) {
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        auto it = resolveCache.find(host);
+        if (it != resolveCache.end() && ReactorClock::now() < it->second.second) {
+            address = it->second.first;
+            return true;
+        }
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+        std::cerr << "[ERROR] Network: Failed to resolve hostname: " << host << std::endl;
+        return false;
+    }
+    address = ((struct sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+
+    std::lock_guard<std::mutex> lock(resolveMutex);
+    resolveCache[host] = {address, ReactorClock::now() + std::chrono::seconds(RESOLVE_CACHE_SECONDS)};
+    return true;
+}
+
+static void wakeReactor() {
+    char byte = 1;
+#ifdef _WIN32
+    send((SOCKET)wakeWrite, &byte, 1, 0);
+#else
+    ssize_t ignored = write(wakeWrite, &byte, 1); // A full pipe already guarantees a wake-up
+    (void)ignored;
+#endif
+}
+
+static void drainWakeChannel() {
+    char buffer[256];
+#ifdef _WIN32
+    while (recv((SOCKET)wakeRead, buffer, sizeof(buffer), 0) > 0) {}
+#else
+    while (read(wakeRead, buffer, sizeof(buffer)) > 0) {}
+#endif
+}
+
+static bool createWakeChannel() {
+#ifdef _WIN32
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) return false;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int len = sizeof(addr);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(sock, (struct sockaddr*)&addr, &len) != 0 ||
+        connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        closesocket(sock);
+        return false;
+    }
+    setNonBlocking((NetSocket)sock);
+    wakeRead = wakeWrite = (NetSocket)sock;
+    return true;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    setNonBlocking(fds[0]);
+    setNonBlocking(fds[1]);
+    wakeRead = fds[0];
+    wakeWrite = fds[1];
+    return true;
+#endif
+}
+
+static void closeWakeChannel() {
+#ifdef _WIN32
+    closeNetSocket(wakeRead);
+#else
+    close(wakeRead);
+    close(wakeWrite);
+#endif
+    wakeRead = wakeWrite = INVALID_NET_SOCKET;
+}
+
+// ---- Poller (epoll on Linux, poll/WSAPoll otherwise) ----
+
+static void pollerWatch(Connection& conn, bool add) {
+#ifdef NET_HAVE_EPOLL
+    if (useEpoll) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP | (conn.wantWrite ? (uint32_t)EPOLLOUT : 0u);
+        event.data.u64 = conn.id;
+        epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, conn.sock, &event);
+    }
+#else
+    (void)conn;
+    (void)add;
+#endif
+}
+
+static void pollerForget(Connection& conn) {
+#ifdef NET_HAVE_EPOLL
+    if (useEpoll) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.sock, nullptr);
+    }
+#else
+    (void)conn;
+#endif
+}
+
+struct ReadyEvent {
+    NetConnId id;
+    bool readable;
+    bool writable;
+    bool error;
+};
+
+static void pollerWait(int timeoutMs, std::vector<ReadyEvent>& ready) {
+    ready.clear();
+#ifdef NET_HAVE_EPOLL
+    if (useEpoll) {
+        struct epoll_event events[256];
+        int count = epoll_wait(epollFd, events, 256, timeoutMs);
+        for (int i = 0; i < count; i++) {
+            uint32_t flags = events[i].events;
+            ready.push_back(ReadyEvent{events[i].data.u64, (flags & (EPOLLIN | EPOLLRDHUP)) != 0,
+                                       (flags & EPOLLOUT) != 0, (flags & (EPOLLERR | EPOLLHUP)) != 0});
+        }
+        return;
+    }
+#endif
+
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> fds;
+#else
+    std::vector<struct pollfd> fds;
+#endif
+    std::vector<NetConnId> ids;
+    fds.reserve(connections.size() + 1);
+    ids.reserve(connections.size() + 1);
+    fds.push_back({});
+    fds.back().fd = wakeRead;
+    fds.back().events = POLLIN;
+    ids.push_back(WAKE_ID);
+    for (auto& entry : connections) {
+        fds.push_back({});
+        fds.back().fd = entry.second.sock;
+        fds.back().events = POLLIN | (entry.second.wantWrite ? POLLOUT : 0);
+        ids.push_back(entry.first);
+    }
+#ifdef _WIN32
+    int count = WSAPoll(fds.data(), (ULONG)fds.size(), timeoutMs);
+#else
+    int count = poll(fds.data(), fds.size(), timeoutMs);
+#endif
+    for (size_t i = 0; count > 0 && i < fds.size(); i++) {
+        short flags = fds[i].revents;
+        if (flags == 0) continue;
+        ready.push_back(ReadyEvent{ids[i], (flags & (POLLIN | POLLHUP)) != 0, (flags & POLLOUT) != 0,
+                                   (flags & (POLLERR | POLLNVAL)) != 0});
+        count--;
+    }
+}
+
+// ---- Timers ----
+
+static NetTimerId addTimerInternal(NetTimerId id, int delayMs, std::function<void()> callback) {
+    timerCallbacks[id] = std::move(callback);
+    timerQueue.push(TimerEntry{ReactorClock::now() + std::chrono::milliseconds(std::max(0, delayMs)), id});
+    return id;
+}
+
+static int msUntilNextTimer() {
+    while (!timerQueue.empty() && timerCallbacks.find(timerQueue.top().id) == timerCallbacks.end()) {
+        timerQueue.pop(); // Cancelled
+    }
+    if (timerQueue.empty()) return MAX_WAIT_MS;
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(timerQueue.top().deadline - ReactorClock::now()).count();
+    return (int)std::max<long long>(0, std::min<long long>(wait + 1, MAX_WAIT_MS));
+}
+
+static void runDueTimers() {
+    ReactorClock::time_point now = ReactorClock::now();
+    while (!timerQueue.empty() && timerQueue.top().deadline <= now) {
+        NetTimerId id = timerQueue.top().id;
+        timerQueue.pop();
+        auto it = timerCallbacks.find(id);
+        if (it == timerCallbacks.end()) continue;
+        std::function<void()> callback = std::move(it->second);
+        timerCallbacks.erase(it);
+        callback();
+    }
+}
+
+// ---- Connections ----
+
+static void closeConnectionInternal(NetConnId id, const std::string& reason) {
+    auto it = connections.find(id);
+    if (it == connections.end()) return;
+    Connection conn = std::move(it->second);
+    connections.erase(it);
+    pollerForget(conn);
+    closeNetSocket(conn.sock);
+    if (conn.connectTimer) timerCallbacks.erase(conn.connectTimer);
+    if (conn.handlers.onClosed) conn.handlers.onClosed(reason);
+}
+
+// Write as much of the out buffer as the kernel accepts; keep the rest for the next writable event
+static void flushConnection(NetConnId id) {
+    auto it = connections.find(id);
+    if (it == connections.end() || it->second.connecting) return;
+    Connection& conn = it->second;
+    while (conn.outOffset < conn.out.size()) {
+#ifdef _WIN32
+        int sent = send((SOCKET)conn.sock, conn.out.data() + conn.outOffset, (int)(conn.out.size() - conn.outOffset), 0);
+#else
+        ssize_t sent = send(conn.sock, conn.out.data() + conn.outOffset, conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+#endif
+        if (sent < 0) {
+            if (socketWouldBlock()) break;
+            closeConnectionInternal(id, "send failed");
+            return;
+        }
+        conn.outOffset += (size_t)sent;
+    }
+    if (conn.outOffset >= conn.out.size()) {
+        conn.out.clear();
+        conn.outOffset = 0;
+    } else if (conn.outOffset > 65536) {
+        conn.out.erase(0, conn.outOffset); // Keep the buffer from growing without bound
+        conn.outOffset = 0;
+    }
+    bool wantWrite = !conn.out.empty();
+    if (wantWrite != conn.wantWrite) {
+        conn.wantWrite = wantWrite;
+        pollerWatch(conn, false);
+    }
+}
+
+static void openConnectionInternal(NetConnId id, in_addr address, int port, NetConnHandlers handlers, int connectTimeoutMs) {
+    NetSocket sock = (NetSocket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_NET_SOCKET || !setNonBlocking(sock)) {
+        closeNetSocket(sock);
+        if (handlers.onClosed) handlers.onClosed("socket creation failed");
+        return;
+    }
+    int noDelay = 1; // Small frames (STT stream) must not wait for Nagle
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    struct sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(port);
+    serverAddr.sin_addr = address;
+#ifdef _WIN32
+    int result = connect((SOCKET)sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+#else
+    int result = connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr));
+#endif
+    if (result != 0 && !socketWouldBlock()) {
+        closeNetSocket(sock);
+        if (handlers.onClosed) handlers.onClosed("connect failed");
+        return;
+    }
+
+    Connection& conn = connections[id];
+    conn.id = id;
+    conn.sock = sock;
+    conn.handlers = std::move(handlers);
+    conn.connectTimer = addTimerInternal(nextId++, connectTimeoutMs, [id] {
+        auto it = connections.find(id);
+        if (it != connections.end()) {
+            it->second.connectTimer = 0;
+            if (it->second.connecting) closeConnectionInternal(id, "connect timeout");
+        }
+    });
+    pollerWatch(conn, true); // Writable once the non-blocking connect completes
+}
+
+static void handleEvent(const ReadyEvent& event) {
+    if (event.id == WAKE_ID) {
+        drainWakeChannel();
+        return;
+    }
+    auto it = connections.find(event.id);
+    if (it == connections.end()) return;
+
+    if (it->second.connecting) {
+        if (!event.writable && !event.error) return;
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(it->second.sock, SOL_SOCKET, SO_ERROR, (char*)&error, &length);
+        if (error != 0 || (event.error && !event.writable)) {
+            closeConnectionInternal(event.id, "connect failed");
+            return;
+        }
+        it->second.connecting = false;
+        if (it->second.connectTimer) {
+            timerCallbacks.erase(it->second.connectTimer);
+            it->second.connectTimer = 0;
+        }
+        if (it->second.handlers.onConnected) it->second.handlers.onConnected();
+        flushConnection(event.id);
+        it = connections.find(event.id);
+        if (it == connections.end()) return;
+    }
+
+    if (event.writable && !it->second.out.empty()) {
+        flushConnection(event.id);
+        it = connections.find(event.id);
+        if (it == connections.end()) return;
+    }
+
+    if (event.readable || event.error) {
+        char buffer[READ_CHUNK];
+        while (true) {
+            auto current = connections.find(event.id);
+            if (current == connections.end()) return; // Closed by a handler
+#ifdef _WIN32
+            int received = recv((SOCKET)current->second.sock, buffer, sizeof(buffer), 0);
+#else
+            ssize_t received = recv(current->second.sock, buffer, sizeof(buffer), 0);
+#endif
+            if (received > 0) {
+                if (current->second.handlers.onData) current->second.handlers.onData(buffer, (size_t)received);
+                continue;
+            }
+            if (received == 0) {
+                closeConnectionInternal(event.id, "closed by peer");
+            } else if (!socketWouldBlock()) {
+                closeConnectionInternal(event.id, "recv failed");
+            }
+            return;
+        }
+    }
+}
+
+// ---- HTTP on top of connections ----
+
+static void finishExchange(NetRequestId id, bool cancelled, const std::string& error) {
+    auto it = exchanges.find(id);
+    if (it == exchanges.end()) return;
+    HTTPExchange exchange = std::move(it->second);
+    exchanges.erase(it);
+    if (exchange.timer) timerCallbacks.erase(exchange.timer);
+    closeConnectionInternal(exchange.conn, "request finished"); // onClosed finds no exchange: no-op
+
+    HTTPResult result;
+    result.cancelled = cancelled;
+    result.status = exchange.status;
+    result.error = error;
+    result.ok = !cancelled && error.empty() && exchange.status >= 200 && exchange.status < 300;
+    result.latencyMs = std::chrono::duration<double, std::milli>(ReactorClock::now() - exchange.start).count();
+    if (exchange.headerEnd != std::string::npos) {
+        result.body = exchange.response.substr(exchange.headerEnd);
+    }
+    if (exchange.callback) exchange.callback(result);
+}
+
+// Decode a complete chunked body in place; returns false if more bytes are needed
+static bool decodeChunked(const std::string& raw, std::string& decoded) {
+    decoded.clear();
+    size_t pos = 0;
+    while (true) {
+        size_t lineEnd = raw.find("\r\n", pos);
+        if (lineEnd == std::string::npos) return false;
+        unsigned long size = strtoul(raw.c_str() + pos, nullptr, 16);
+        pos = lineEnd + 2;
+        if (size == 0) return true;
+        if (raw.size() < pos + size + 2) return false;
+        decoded.append(raw, pos, size);
+        pos += size + 2;
+    }
+}
+
+static void parseHTTPResponse(NetRequestId id) {
+    auto it = exchanges.find(id);
+    if (it == exchanges.end()) return;
+    HTTPExchange& exchange = it->second;
+
+    if (exchange.headerEnd == std::string::npos) {
+        size_t end = exchange.response.find("\r\n\r\n");
+        if (end == std::string::npos) return;
+        exchange.headerEnd = end + 4;
+        std::string headers = exchange.response.substr(0, end);
+        size_t space = headers.find(' ');
+        exchange.status = (headers.compare(0, 5, "HTTP/") == 0 && space != std::string::npos) ? atoi(headers.c_str() + space + 1) : 0;
+        std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+        size_t lengthPos = headers.find("\r\ncontent-length:");
+        if (lengthPos != std::string::npos) exchange.contentLength = atoll(headers.c_str() + lengthPos + 17);
+        exchange.chunked = headers.find("\r\ntransfer-encoding: chunked") != std::string::npos;
+    }
+
+    size_t bodyBytes = exchange.response.size() - exchange.headerEnd;
+    if (exchange.chunked) {
+        std::string decoded;
+        if (decodeChunked(exchange.response.substr(exchange.headerEnd), decoded)) {
+            exchange.response.resize(exchange.headerEnd);
+            exchange.response += decoded;
+            finishExchange(id, false, "");
+        }
+    } else if (exchange.contentLength >= 0 && bodyBytes >= (size_t)exchange.contentLength) {
+        exchange.response.resize(exchange.headerEnd + (size_t)exchange.contentLength);
+        finishExchange(id, false, "");
+    }
+    // Otherwise the body runs until the server closes the connection
+}
+
+static void startExchange(NetRequestId id, in_addr address, int port, int timeoutMs) {
+    auto it = exchanges.find(id);
+    if (it == exchanges.end()) return;
+    NetConnId conn = nextId++;
+    it->second.conn = conn;
+    it->second.timer = addTimerInternal(nextId++, timeoutMs, [id] {
+        auto current = exchanges.find(id);
+        if (current != exchanges.end()) {
+            current->second.timer = 0;
+            finishExchange(id, false, "timeout");
+        }
+    });
+
+    NetConnHandlers handlers;
+    handlers.onConnected = [id, conn] {
+        auto current = exchanges.find(id);
+        auto connection = connections.find(conn);
+        if (current == exchanges.end() || connection == connections.end()) return;
+        connection->second.out.swap(current->second.request);
+    };
+    handlers.onData = [id](const char* data, size_t length) {
+        auto current = exchanges.find(id);
+        if (current == exchanges.end()) return;
+        current->second.response.append(data, length);
+        parseHTTPResponse(id);
+    };
+    handlers.onClosed = [id](const std::string& reason) {
+        auto current = exchanges.find(id);
+        if (current == exchanges.end()) return;
+        HTTPExchange& exchange = current->second;
+        bool readToClose = exchange.headerEnd != std::string::npos && exchange.contentLength < 0 && !exchange.chunked;
+        if (readToClose && reason == "closed by peer") {
+            finishExchange(id, false, "");
+        } else {
+            finishExchange(id, false, exchange.headerEnd == std::string::npos ? reason : "truncated response");
+        }
+    };
+    openConnectionInternal(conn, address, port, handlers, std::min(timeoutMs, 5000));
+}
+
+// ---- Event loop ----
+
+// Posting a plain function pointer does not allocate once both queues have
+// grown to the usual burst (std::function stores it in place)
+static void drainSubmitQueue() {
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        runningTasks.swap(submitQueue);
+    }
+    for (std::function<void()>& task : runningTasks) {
+        task();
+    }
+    runningTasks.clear();
+}
+
+static void reactorLoop() {
+    reactorThreadId = std::this_thread::get_id();
+    std::vector<ReadyEvent> ready;
+    while (reactorRunning) {
+        // Tasks posted from the network thread itself do not wake the poller
+        bool tasksPending;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            tasksPending = !submitQueue.empty();
+        }
+        pollerWait(tasksPending ? 0 : msUntilNextTimer(), ready);
+        for (const ReadyEvent& event : ready) {
+            handleEvent(event);
+        }
+        drainSubmitQueue();
+        runDueTimers();
+    }
+
+    // Shutdown: stop accepting work, run what was queued (cancels, closes), then fail whatever is left
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        acceptingTasks = false;
+    }
+    drainSubmitQueue();
+    while (!exchanges.empty()) {
+        finishExchange(exchanges.begin()->first, true, "shutdown");
+    }
+    while (!connections.empty()) {
+        closeConnectionInternal(connections.begin()->first, "shutdown");
+    }
+    timerCallbacks.clear();
+    timerQueue = decltype(timerQueue)();
+    reactorThreadId = std::thread::id();
+}
+
+bool startNetReactor(NetReactorBackend backend) {
+    if (reactorRunning) {
+        return true;
+    }
+    if (!createWakeChannel()) {
+        std::cerr << "[ERROR] Network: Failed to create reactor wake-up channel" << std::endl;
+        return false;
+    }
+
+    useEpoll = false;
+#ifdef NET_HAVE_EPOLL
+    if (backend == NET_BACKEND_DEFAULT) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd >= 0) {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.u64 = WAKE_ID;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeRead, &event);
+            useEpoll = true;
+        }
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        acceptingTasks = true;
+        submitQueue.reserve(SUBMIT_QUEUE_RESERVE);
+        runningTasks.reserve(SUBMIT_QUEUE_RESERVE);
+    }
+    reactorRunning = true;
+    reactorThread = std::thread(reactorLoop);
+    std::cout << "[DEBUG] Network: Reactor started (" << getNetReactorBackendName() << ")" << std::endl;
+    return true;
+}
+
+void stopNetReactor() {
+    if (!reactorRunning) {
+        return;
+    }
+    reactorRunning = false;
+    wakeReactor();
+    if (reactorThread.joinable()) {
+        reactorThread.join();
+    }
+#ifdef NET_HAVE_EPOLL
+    if (epollFd >= 0) {
+        close(epollFd);
+        epollFd = -1;
+    }
+#endif
+    closeWakeChannel();
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        submitQueue.clear();
+    }
+    std::cout << "[DEBUG] Network: Reactor stopped" << std::endl;
+}
+
+bool isNetReactorRunning() {
+    return reactorRunning;
+}
+
+bool isNetworkThread() {
+    return std::this_thread::get_id() == reactorThreadId;
+}
+
+const char* getNetReactorBackendName() {
+    if (useEpoll) return "epoll";
+#ifdef _WIN32
+    return "WSAPoll";
+#else
+    return "poll";
+#endif
+}
+
+bool postToNetReactor(std::function<void()> task) {
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        if (!acceptingTasks) {
+            return false;
+        }
+        wasEmpty = submitQueue.empty();
+        submitQueue.push_back(std::move(task));
+    }
+    if (wasEmpty && !isNetworkThread()) {
+        wakeReactor(); // Tasks posted from the network thread run at the end of this iteration
+    }
+    return true;
+}
+
+NetTimerId addNetTimer(int delayMs, std::function<void()> callback) {
+    NetTimerId id = nextId++;
+    if (!postToNetReactor([id, delayMs, callback] { addTimerInternal(id, delayMs, callback); })) {
+        return 0;
+    }
+    return id;
+}
+
+void cancelNetTimer(NetTimerId id) {
+    postToNetReactor([id] { timerCallbacks.erase(id); });
+}
+
+NetConnId openNetConnection(const std::string& host, int port, const NetConnHandlers& handlers, int connectTimeoutMs) {
+    NetConnId id = nextId++;
+    in_addr address;
+    bool resolved = resolveHost(host, address);
+    bool posted = postToNetReactor([id, resolved, address, port, handlers, connectTimeoutMs] {
+        if (!resolved) {
+            if (handlers.onClosed) handlers.onClosed("resolve failed");
+            return;
+        }
+        openConnectionInternal(id, address, port, handlers, connectTimeoutMs);
+    });
+    return posted ? id : 0;
+}
+
+void sendOnNetConnection(NetConnId id, std::string data) {
+    postToNetReactor([id, data = std::move(data)]() mutable {
+        auto it = connections.find(id);
+        if (it == connections.end()) return;
+        if (it->second.out.empty()) {
+            it->second.out.swap(data);
+            it->second.outOffset = 0;
+        } else {
+            it->second.out += data;
+        }
+        flushConnection(id);
+    });
+}
+
+void closeNetConnection(NetConnId id) {
+    postToNetReactor([id] { closeConnectionInternal(id, "closed locally"); });
+}
+
+size_t getNetConnectionBacklog(NetConnId id) {
+    auto it = connections.find(id);
+    return it == connections.end() ? 0 : it->second.out.size() - it->second.outOffset;
+}
+
+NetRequestId submitHTTPRequest(const HTTPRequest& request, HTTPCallback callback) {
+    in_addr address;
+    if (!reactorRunning || !resolveHost(request.host, address)) {
+        HTTPResult result;
+        result.ok = false;
+        result.cancelled = false;
+        result.status = 0;
+        result.error = reactorRunning ? "resolve failed" : "network not running";
+        result.latencyMs = 0.0;
+        if (callback) callback(result);
+        return 0;
+    }
+
+    std::ostringstream head;
+    head << request.method << " " << request.path << " HTTP/1.1\r\n";
+    head << "Host: " << request.host << ":" << request.port << "\r\n";
+    for (const auto& header : request.headers) {
+        head << header.first << ": " << header.second << "\r\n";
+    }
+    head << "Content-Length: " << request.body.size() << "\r\n";
+    head << "Connection: close\r\n\r\n";
+
+    NetRequestId id = nextId++;
+    HTTPExchange exchange;
+    exchange.id = id;
+    exchange.callback = std::move(callback);
+    exchange.request = head.str() + request.body;
+    exchange.start = ReactorClock::now();
+    int port = request.port;
+    int timeoutMs = request.timeoutMs;
+    auto shared = std::make_shared<HTTPExchange>(std::move(exchange));
+    bool posted = postToNetReactor([id, shared, address, port, timeoutMs] {
+        exchanges[id] = std::move(*shared);
+        startExchange(id, address, port, timeoutMs);
+    });
+    if (!posted) {
+        // Reactor shut down between the check above and the post
+        HTTPResult result;
+        result.ok = false;
+        result.cancelled = true;
+        result.status = 0;
+        result.error = "shutdown";
+        result.latencyMs = 0.0;
+        if (shared->callback) shared->callback(result);
+        return 0;
+    }
+    return id;
+}
+
+void cancelNetRequest(NetRequestId id) {
+    postToNetReactor([id] { finishExchange(id, true, "cancelled"); });
+}
@@ -0,0 +1,76 @@
+#ifndef NET_REACTOR_H
+#define NET_REACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Single network thread running a non-blocking event loop
+// All outbound I/O (Whisper uploads, the STT stream) runs on this thread:
+// sockets are non-blocking, readiness comes from epoll on Linux and poll()
+// elsewhere (WSAPoll on Windows). Other threads talk to it only through the
+// submit queue; every callback below runs on the network thread and must not
+// block.
+
+enum NetReactorBackend {
+    NET_BACKEND_DEFAULT = 0, // epoll on Linux, poll elsewhere
+    NET_BACKEND_POLL = 1     // Force poll() (used by tests to cover the fallback)
+};
+
+typedef uint64_t NetTimerId;
+typedef uint64_t NetConnId;
+typedef uint64_t NetRequestId;
+
+bool startNetReactor(NetReactorBackend backend = NET_BACKEND_DEFAULT);
+void stopNetReactor(); // Fails outstanding requests, closes connections, joins the thread
+bool isNetReactorRunning();
+bool isNetworkThread();
+const char* getNetReactorBackendName();
+
+// Thread-safe submit queue: run task on the network thread
+bool postToNetReactor(std::function<void()> task);
+
+// One-shot timers (callback runs on the network thread)
+NetTimerId addNetTimer(int delayMs, std::function<void()> callback);
+void cancelNetTimer(NetTimerId id);
+
+// Raw TCP connections (connection state machine: connecting -> open -> closed)
+struct NetConnHandlers {
+    std::function<void()> onConnected;
+    std::function<void(const char* data, size_t length)> onData;
+    std::function<void(const std::string& reason)> onClosed; // Called exactly once
+};
+NetConnId openNetConnection(const std::string& host, int port, const NetConnHandlers& handlers, int connectTimeoutMs = 5000);
+void sendOnNetConnection(NetConnId id, std::string data); // Partial writes are buffered and finished on writability
+void closeNetConnection(NetConnId id);
+size_t getNetConnectionBacklog(NetConnId id); // Bytes queued but not yet written (network thread only)
+
+// HTTP/1.1 requests (one connection per request, Connection: close)
+struct HTTPRequest {
+    std::string host;
+    int port = 80;
+    std::string method = "POST";
+    std::string path = "/";
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    int timeoutMs = 15000;
+};
+
+struct HTTPResult {
+    bool ok;             // Transport succeeded and status is 2xx
+    bool cancelled;
+    int status;          // 0 if no response
+    std::string body;
+    std::string error;   // Transport error ("timeout", "connect failed", ...)
+    double latencyMs;
+};
+
+typedef std::function<void(const HTTPResult& result)> HTTPCallback;
+
+NetRequestId submitHTTPRequest(const HTTPRequest& request, HTTPCallback callback);
+void cancelNetRequest(NetRequestId id); // Callback still runs, with cancelled = true
+
+#endif // NET_REACTOR_H
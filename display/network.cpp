@@ -1,6 +1,11 @@
 #include "network.h"
+#include "net_reactor.h"
+#include "transcript.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <future>
 #include <iostream>
 #include <sstream>
 
@@ -15,10 +20,16 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // Not defined on macOS
+#endif
 #endif
 
 static bool networkInitialized = false;
 
+// A slow server must not hold an upload worker forever
+static const int HTTP_TIMEOUT_MS = 15000;
+
 /**
  * Initialize network subsystem
  * On Windows, initializes WinSock2
@@ -41,6 +52,16 @@ bool initNetwork() {
     // No special initialization needed on Unix
 #endif
     
+    // All outbound I/O runs on the reactor thread; the blocking path below is the fallback
+    if (!startNetReactor()) {
+        std::cerr << "[WARNING] Network: Reactor unavailable, using blocking sockets" << std::endl;
+    }
+    static bool exitHookRegistered = false;
+    if (!exitHookRegistered) {
+        atexit(cleanupNetwork); // Join the network thread even if the caller never cleans up
+        exitHookRegistered = true;
+    }
+    
     networkInitialized = true;
     return true;
 }
@@ -54,6 +75,8 @@ void cleanupNetwork() {
         return;
     }
     
+    stopNetReactor();
+    
 #ifdef _WIN32
     WSACleanup();
     std::cout << "[DEBUG] Network: WinSock2 cleaned up" << std::endl;
@@ -113,28 +136,23 @@ static std::vector<char> audioSamplesToWAV(const std::vector<short>& samples, in
 }
 
 /**
- * Send HTTP POST request with multipart/form-data
- * Sends WAV file to Whisper STT server
+ * Open a blocking TCP connection to host:port
+ * Host may be an IPv4 address or a hostname
+ * Returns INVALID_NET_SOCKET on failure (error already logged)
  */
-static bool sendHTTPPost(const std::vector<char>& body, const std::string& host, int port, const std::string& boundary) {
-#ifdef _WIN32
-    SOCKET sock = INVALID_SOCKET;
-#else
-    int sock = -1;
-#endif
-    
+NetSocket connectTCP(const std::string& host, int port) {
     // Create socket
 #ifdef _WIN32
-    sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (sock == INVALID_SOCKET) {
         std::cerr << "[ERROR] Network: socket creation failed: " << WSAGetLastError() << std::endl;
-        return false;
+        return INVALID_NET_SOCKET;
     }
 #else
-    sock = socket(AF_INET, SOCK_STREAM, 0);
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock < 0) {
         std::cerr << "[ERROR] Network: socket creation failed" << std::endl;
-        return false;
+        return INVALID_NET_SOCKET;
     }
 #endif
     
@@ -156,7 +174,7 @@ static bool sendHTTPPost(const std::vector<char>& body, const std::string& host,
         if (!hostEntry) {
             std::cerr << "[ERROR] Network: Failed to resolve hostname: " << host << std::endl;
             closesocket(sock);
-            return false;
+            return INVALID_NET_SOCKET;
         }
         serverAddr.sin_addr = *((struct in_addr*)hostEntry->h_addr);
     }
@@ -168,7 +186,7 @@ static bool sendHTTPPost(const std::vector<char>& body, const std::string& host,
         if (!hostEntry) {
             std::cerr << "[ERROR] Network: Failed to resolve hostname: " << host << std::endl;
             close(sock);
-            return false;
+            return INVALID_NET_SOCKET;
         }
         serverAddr.sin_addr = *((struct in_addr*)hostEntry->h_addr);
     }
@@ -179,15 +197,97 @@ static bool sendHTTPPost(const std::vector<char>& body, const std::string& host,
     if (connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
         std::cerr << "[ERROR] Network: connect failed: " << WSAGetLastError() << std::endl;
         closesocket(sock);
-        return false;
+        return INVALID_NET_SOCKET;
     }
 #else
     if (connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
         std::cerr << "[ERROR] Network: connect failed" << std::endl;
         close(sock);
-        return false;
+        return INVALID_NET_SOCKET;
+    }
+#endif
+    
+    return (NetSocket)sock;
+}
+
+/**
+ * Send the whole buffer, looping over partial sends
+ * send() may accept fewer bytes than requested for large bodies
+ */
+bool sendAll(NetSocket sock, const char* data, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+#ifdef _WIN32
+        int sent = send((SOCKET)sock, data + total, (int)(length - total), 0);
+        if (sent == SOCKET_ERROR) {
+            return false;
+        }
+#else
+        ssize_t sent = send(sock, data + total, length - total, MSG_NOSIGNAL);
+        if (sent < 0) {
+            return false;
+        }
+#endif
+        total += (size_t)sent;
+    }
+    return true;
+}
+
+/**
+ * Receive up to length bytes
+ * Returns bytes read, 0 when the peer closed the connection, -1 on error
+ */
+int recvSome(NetSocket sock, char* buffer, int length) {
+#ifdef _WIN32
+    int received = recv((SOCKET)sock, buffer, length, 0);
+    return (received == SOCKET_ERROR) ? -1 : received;
+#else
+    ssize_t received = recv(sock, buffer, (size_t)length, 0);
+    return (received < 0) ? -1 : (int)received;
+#endif
+}
+
+void setNetSocketTimeout(NetSocket sock, int timeoutMs) {
+    if (sock == INVALID_NET_SOCKET) {
+        return;
     }
+#ifdef _WIN32
+    DWORD timeout = (DWORD)timeoutMs;
+    setsockopt((SOCKET)sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt((SOCKET)sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+#else
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 #endif
+}
+
+void closeNetSocket(NetSocket sock) {
+    if (sock == INVALID_NET_SOCKET) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket((SOCKET)sock);
+#else
+    close(sock);
+#endif
+}
+
+/**
+ * Send HTTP POST request with multipart/form-data
+ * Sends WAV file to Whisper STT server
+ * The result carries the reply status like a reactor request (body not kept)
+ */
+static HTTPResult sendHTTPPost(const std::vector<char>& body, const std::string& host, int port, const std::string& boundary) {
+    HTTPResult result = HTTPResult();
+    NetSocket sock = connectTCP(host, port);
+    if (sock == INVALID_NET_SOCKET) {
+        result.error = "connect failed";
+        return result;
+    }
+    setNetSocketTimeout(sock, HTTP_TIMEOUT_MS);
     
     // Build HTTP POST request
     std::ostringstream httpRequest;
@@ -201,82 +301,96 @@ static bool sendHTTPPost(const std::vector<char>& body, const std::string& host,
     std::string requestStr = httpRequest.str();
     
     // Send HTTP headers
-#ifdef _WIN32
-    int sent = send(sock, requestStr.c_str(), requestStr.length(), 0);
-    if (sent == SOCKET_ERROR) {
-        std::cerr << "[ERROR] Network: send headers failed: " << WSAGetLastError() << std::endl;
-        closesocket(sock);
-        return false;
-    }
-#else
-    ssize_t sent = send(sock, requestStr.c_str(), requestStr.length(), 0);
-    if (sent < 0) {
+    bool sent = sendAll(sock, requestStr.c_str(), requestStr.length());
+    if (!sent) {
         std::cerr << "[ERROR] Network: send headers failed" << std::endl;
-        close(sock);
-        return false;
-    }
-#endif
-    
-    // Send body
-#ifdef _WIN32
-    sent = send(sock, (const char*)body.data(), body.size(), 0);
-    if (sent == SOCKET_ERROR) {
-        std::cerr << "[ERROR] Network: send body failed: " << WSAGetLastError() << std::endl;
-        closesocket(sock);
-        return false;
+    } else {
+        // Send body
+        sent = sendAll(sock, body.data(), body.size());
+        if (!sent) {
+            std::cerr << "[ERROR] Network: send body failed" << std::endl;
+        }
     }
-#else
-    sent = send(sock, (const char*)body.data(), body.size(), 0);
-    if (sent < 0) {
-        std::cerr << "[ERROR] Network: send body failed" << std::endl;
-        close(sock);
-        return false;
+    if (!sent) {
+        closeNetSocket(sock);
+        result.error = "send failed";
+        return result;
     }
-#endif
     
-    std::cout << "[DEBUG] Network: Sent " << sent << " bytes to Whisper STT" << std::endl;
+    std::cout << "[DEBUG] Network: Sent " << body.size() << " bytes to Whisper STT" << std::endl;
     
-    // Read response (simple - just read first 4KB)
+    // Read the headers, then feed the body to the transcript parser as it arrives
+    // Anything other than 2xx means the upload did not land (the caller decides from the status whether to retry)
+    // (this fallback expects Content-Length or read-until-close, not chunked replies)
+    std::string response;
     char buffer[4096];
-#ifdef _WIN32
-    int received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    if (received > 0) {
-        buffer[received] = '\0';
-        std::cout << "[DEBUG] Network: Whisper response: " << std::string(buffer, received).substr(0, 200) << std::endl;
-    }
-    closesocket(sock);
-#else
-    ssize_t received = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    if (received > 0) {
-        buffer[received] = '\0';
-        std::cout << "[DEBUG] Network: Whisper response: " << std::string(buffer, received).substr(0, 200) << std::endl;
+    size_t headerEnd = std::string::npos;
+    while (headerEnd == std::string::npos && response.size() < 65536) {
+        int received = recvSome(sock, buffer, sizeof(buffer));
+        if (received <= 0) break;
+        response.append(buffer, received);
+        headerEnd = response.find("\r\n\r\n");
     }
-    close(sock);
-#endif
     
-    return true;
-}
-
-/**
- * Send audio samples to Whisper STT server
- * Converts samples to WAV format and sends via HTTP POST
- */
-bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost, int serverPort) {
-    if (!networkInitialized) {
-        std::cerr << "[ERROR] Network: Not initialized" << std::endl;
-        return false;
+    int status = 0;
+    if (response.compare(0, 5, "HTTP/") == 0) {
+        size_t space = response.find(' ');
+        if (space != std::string::npos) {
+            status = atoi(response.c_str() + space + 1);
+        }
     }
     
-    if (audioSamples.empty()) {
-        std::cerr << "[WARNING] Network: No audio samples to send" << std::endl;
-        return false;
+    TranscriptParser parser;
+    resetTranscriptParser(parser, nextTranscriptUtteranceId());
+    std::string preview;
+    if (headerEnd != std::string::npos && status >= 200 && status < 300) {
+        std::string headers = response.substr(0, headerEnd);
+        std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+        size_t lengthPos = headers.find("\r\ncontent-length:");
+        long long remaining = lengthPos == std::string::npos ? -1 : atoll(headers.c_str() + lengthPos + 17);
+        std::string bodyStart = response.substr(headerEnd + 4);
+        feedTranscriptParser(parser, bodyStart.data(), bodyStart.size());
+        preview = bodyStart.substr(0, 200);
+        if (remaining >= 0) remaining -= (long long)bodyStart.size();
+        while (remaining != 0) {
+            int received = recvSome(sock, buffer, sizeof(buffer));
+            if (received <= 0) break;
+            feedTranscriptParser(parser, buffer, received);
+            if (preview.size() < 200) preview.append(buffer, std::min<size_t>(received, 200 - preview.size()));
+            if (remaining > 0) remaining -= std::min<long long>(remaining, received);
+        }
     }
     
-    // Convert audio samples to WAV format
-    std::vector<char> wavData = audioSamplesToWAV(audioSamples, sampleRate);
+    closeNetSocket(sock);
+    
+    result.status = status;
+    if (status < 200 || status >= 300) {
+        std::cerr << "[ERROR] Network: Whisper upload failed: " << (response.empty() ? "no response" : response.substr(0, response.find("\r\n"))) << std::endl;
+        if (response.empty()) result.error = "no response";
+        return result;
+    }
     
-    // Create multipart/form-data body for Whisper API
-    std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+    std::cout << "[DEBUG] Network: Whisper response: " << preview << std::endl;
+    if (finishTranscriptParser(parser)) {
+        for (TranscriptEvent& event : parser.events) {
+            publishTranscriptEvent(std::move(event));
+        }
+    }
+    result.ok = true;
+    return result;
+}
+
+bool isPermanentHTTPFailure(int status) {
+    return status >= 400 && status < 500 && status != 408 && status != 429;
+}
+
+static const char* MULTIPART_BOUNDARY = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+
+/**
+ * Wrap WAV data in the multipart/form-data body the Whisper API expects
+ */
+static std::string buildWhisperMultipart(const std::vector<char>& wavData, const STTChunkInfo* chunk) {
+    std::string boundary = MULTIPART_BOUNDARY;
     std::ostringstream multipartBody;
     
     // Form field: model
@@ -285,6 +399,18 @@ bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate,
     multipartBody << "\r\n";
     multipartBody << "whisper-1\r\n";
     
+    // Form fields: upload session position (lets the server stitch chunks and skip the repeated context)
+    if (chunk && chunk->sessionId != 0) {
+        const std::pair<const char*, uint64_t> fields[] = {
+            {"session_id", chunk->sessionId}, {"sample_offset", chunk->sampleOffset}, {"context_samples", chunk->contextSamples}};
+        for (const auto& field : fields) {
+            multipartBody << "--" << boundary << "\r\n";
+            multipartBody << "Content-Disposition: form-data; name=\"" << field.first << "\"\r\n";
+            multipartBody << "\r\n";
+            multipartBody << field.second << "\r\n";
+        }
+    }
+    
     // Form field: file
     multipartBody << "--" << boundary << "\r\n";
     multipartBody << "Content-Disposition: form-data; name=\"file\"; filename=\"audio.wav\"\r\n";
@@ -299,19 +425,100 @@ bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate,
     multipartFooter << "--" << boundary << "\r\n";
     multipartFooter << "Content-Disposition: form-data; name=\"response_format\"\r\n";
     multipartFooter << "\r\n";
-    multipartFooter << "json\r\n";
+    multipartFooter << "verbose_json\r\n"; // Segments with timestamps and avg_logprob
     multipartFooter << "--" << boundary << "--\r\n";
     
-    std::string multipartTail = multipartFooter.str();
-    
     // Combine: header + WAV data + footer
-    std::vector<char> fullBody;
-    fullBody.insert(fullBody.end(), multipartHeader.begin(), multipartHeader.end());
-    fullBody.insert(fullBody.end(), wavData.begin(), wavData.end());
-    fullBody.insert(fullBody.end(), multipartTail.begin(), multipartTail.end());
+    std::string fullBody;
+    fullBody.reserve(multipartHeader.size() + wavData.size() + multipartFooter.str().size());
+    fullBody += multipartHeader;
+    fullBody.append(wavData.data(), wavData.size());
+    fullBody += multipartFooter.str();
+    return fullBody;
+}
+
+static HTTPRequest buildWhisperRequest(const std::vector<char>& wavData, const std::string& host, int port, const STTChunkInfo* chunk) {
+    HTTPRequest request;
+    request.host = host;
+    request.port = port;
+    request.method = "POST";
+    request.path = "/v1/audio/transcriptions";
+    request.headers.push_back({"Content-Type", std::string("multipart/form-data; boundary=") + MULTIPART_BOUNDARY});
+    request.body = buildWhisperMultipart(wavData, chunk);
+    request.timeoutMs = HTTP_TIMEOUT_MS;
+    return request;
+}
+
+static void logWhisperResult(const HTTPResult& result, size_t bodyBytes) {
+    if (result.cancelled) {
+        return; // Another request already won; not an upload failure
+    }
+    if (!result.ok) {
+        std::string reason = result.status != 0 ? "HTTP " + std::to_string(result.status) : (result.error.empty() ? "no response" : result.error);
+        std::cerr << "[ERROR] Network: Whisper upload failed: " << reason << std::endl;
+        return;
+    }
+    std::cout << "[DEBUG] Network: Sent " << bodyBytes << " bytes to Whisper STT" << std::endl;
+    std::cout << "[DEBUG] Network: Whisper response: " << result.body.substr(0, 200) << std::endl;
+}
+
+/**
+ * Upload WAV data and wait for the answer
+ * Goes through the reactor when it is running; a caller on the network thread
+ * itself (or a process without a reactor) falls back to blocking sockets
+ */
+static HTTPResult postWAVToWhisper(const std::vector<char>& wavData, const std::string& host, int port, const STTChunkInfo* chunk) {
+    if (!isNetReactorRunning() || isNetworkThread()) {
+        std::string body = buildWhisperMultipart(wavData, chunk);
+        return sendHTTPPost(std::vector<char>(body.begin(), body.end()), host, port, MULTIPART_BOUNDARY);
+    }
     
-    // Send HTTP POST request
-    return sendHTTPPost(fullBody, serverHost, serverPort, boundary);
+    HTTPRequest request = buildWhisperRequest(wavData, host, port, chunk);
+    size_t bodyBytes = request.body.size();
+    auto done = std::make_shared<std::promise<HTTPResult>>();
+    std::future<HTTPResult> pending = done->get_future();
+    submitHTTPRequest(request, [done](const HTTPResult& result) { done->set_value(result); });
+    HTTPResult result = pending.get();
+    logWhisperResult(result, bodyBytes);
+    if (result.ok) {
+        publishTranscriptReply(result.body, chunk ? chunk->captureTime : -1.0);
+    }
+    return result;
+}
+
+/**
+ * Send audio samples to Whisper STT server
+ * Converts samples to WAV format and sends via HTTP POST
+ */
+bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost, int serverPort, const STTChunkInfo* chunk, int* status) {
+    if (status) *status = 0;
+    if (!networkInitialized) {
+        std::cerr << "[ERROR] Network: Not initialized" << std::endl;
+        return false;
+    }
+    
+    if (audioSamples.empty()) {
+        std::cerr << "[WARNING] Network: No audio samples to send" << std::endl;
+        return false;
+    }
+    
+    HTTPResult result = postWAVToWhisper(audioSamplesToWAV(audioSamples, sampleRate), serverHost, serverPort, chunk);
+    if (status) *status = result.status;
+    return result.ok;
+}
+
+/**
+ * Start an upload on the reactor and return immediately
+ * The callback runs on the network thread (or inline if the request could not be submitted)
+ * and owns the reply: publish it with publishTranscriptReply if it should reach the display
+ */
+NetRequestId sendAudioToWhisperAsync(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost, int serverPort, HTTPCallback callback, const STTChunkInfo* chunk) {
+    HTTPRequest request = buildWhisperRequest(audioSamplesToWAV(audioSamples, sampleRate), serverHost, serverPort, chunk);
+    size_t bodyBytes = request.body.size();
+    return submitHTTPRequest(request, [callback, bodyBytes](const HTTPResult& result) {
+        logWhisperResult(result, bodyBytes);
+        if (callback) callback(result);
+    });
 }
 
 /**
@@ -329,41 +536,5 @@ bool sendWAVToWhisper(const std::vector<char>& wavData, const std::string& serve
         return false;
     }
     
-    // Create multipart/form-data body for Whisper API
-    std::string boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
-    std::ostringstream multipartBody;
-    
-    // Form field: model
-    multipartBody << "--" << boundary << "\r\n";
-    multipartBody << "Content-Disposition: form-data; name=\"model\"\r\n";
-    multipartBody << "\r\n";
-    multipartBody << "whisper-1\r\n";
-    
-    // Form field: file
-    multipartBody << "--" << boundary << "\r\n";
-    multipartBody << "Content-Disposition: form-data; name=\"file\"; filename=\"audio.wav\"\r\n";
-    multipartBody << "Content-Type: audio/wav\r\n";
-    multipartBody << "\r\n";
-    
-    std::string multipartHeader = multipartBody.str();
-    
-    // Form field: response_format
-    std::ostringstream multipartFooter;
-    multipartFooter << "\r\n";
-    multipartFooter << "--" << boundary << "\r\n";
-    multipartFooter << "Content-Disposition: form-data; name=\"response_format\"\r\n";
-    multipartFooter << "\r\n";
-    multipartFooter << "json\r\n";
-    multipartFooter << "--" << boundary << "--\r\n";
-    
-    std::string multipartTail = multipartFooter.str();
-    
-    // Combine: header + WAV data + footer
-    std::vector<char> fullBody;
-    fullBody.insert(fullBody.end(), multipartHeader.begin(), multipartHeader.end());
-    fullBody.insert(fullBody.end(), wavData.begin(), wavData.end());
-    fullBody.insert(fullBody.end(), multipartTail.begin(), multipartTail.end());
-    
-    // Send HTTP POST request
-    return sendHTTPPost(fullBody, serverHost, serverPort, boundary);
+    return postWAVToWhisper(wavData, serverHost, serverPort, nullptr).ok;
 }
@@ -1,14 +1,42 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
+#include "net_reactor.h"
+#include "stt_session.h"
+
+// Blocking TCP helpers (fallback when the network reactor is not running)
+// NetSocket matches SOCKET on Windows and a file descriptor on Unix
+#ifdef _WIN32
+typedef uintptr_t NetSocket;
+#else
+typedef int NetSocket;
+#endif
+const NetSocket INVALID_NET_SOCKET = (NetSocket)-1;
+
+NetSocket connectTCP(const std::string& host, int port);
+bool sendAll(NetSocket sock, const char* data, size_t length);
+int recvSome(NetSocket sock, char* buffer, int length); // Returns bytes read, 0 on close, -1 on error
+void setNetSocketTimeout(NetSocket sock, int timeoutMs); // Send/receive timeout so a stalled peer cannot block forever
+void closeNetSocket(NetSocket sock);
 
 // Network client for Whisper STT
 // Sends audio data to Whisper STT server on port 8070
+// The send functions return true only when the server answered with HTTP 2xx
+// initNetwork also starts the network reactor; cleanupNetwork stops it
+// chunk (optional) adds session_id/sample_offset/context_samples form fields
+// status (optional) receives the reply's HTTP status (0: no response)
 bool initNetwork();
 void cleanupNetwork();
-bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost = "localhost", int serverPort = 8070);
+bool sendAudioToWhisper(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost = "localhost", int serverPort = 8070, const STTChunkInfo* chunk = nullptr, int* status = nullptr);
+NetRequestId sendAudioToWhisperAsync(const std::vector<short>& audioSamples, int sampleRate, const std::string& serverHost, int serverPort, HTTPCallback callback, const STTChunkInfo* chunk = nullptr);
 bool sendWAVToWhisper(const std::vector<char>& wavData, const std::string& serverHost = "localhost", int serverPort = 8070);
 
+// The server rejected the upload itself (4xx other than 408 timeout / 429 rate limit):
+// sending the same request again gets the same answer
+bool isPermanentHTTPFailure(int status);
+
 #endif // NETWORK_H
@@ -4,6 +4,12 @@
 #include "texture.h"
 #include "audio.h"
 #include "admin.h"
+#include "gesture.h"
+#include "hittest.h"
+#include "config.h"
+#include "rng.h"
+#include "scene_watch.h"
+#include "gl_state.h"
 #include <cstdio>  // For FILE, fopen, fclose
 #include <GLFW/glfw3.h>
 #include <fstream>
@@ -20,22 +26,25 @@
 #endif
 
 #include <iostream>
-#include <map>
+#include <cstring>
 #include <stdexcept>
 #include <exception>
+#include <mutex>
 
 /**
  * Prepare window for rendering
  * Sets up OpenGL context for this window and gets actual framebuffer dimensions
  * Framebuffer size may differ from window size on high-DPI displays
  */
-void prepareWindowForRendering(const WindowData& wd, int& fbWidth, int& fbHeight) {
+void prepareWindowForRendering(WindowData& wd, int& fbWidth, int& fbHeight) {
     /**
      * Make this window's OpenGL context current
      * Each window has its own context, so we must switch before rendering
      * This is required for multi-monitor rendering
+     * The GL state shadow follows the context
      */
     glfwMakeContextCurrent(wd.window);
+    bindGLStateCache(&wd.glState);
     
     /**
      * Get actual framebuffer size (handles high-DPI displays)
@@ -64,6 +73,128 @@ void prepareWindowForRendering(const WindowData& wd, int& fbWidth, int& fbHeight
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
+/**
+ * Gestures the display responds to
+ * Double-click: two clicks within 0.5 seconds, less than 10 pixels apart
+ * Tetra-click: four clicks in the top-right 64x64 area within 2 seconds
+ */
+static const GestureRule DISPLAY_GESTURES[] = {
+    {"click", GestureKind::CLICKS, GLFW_MOUSE_BUTTON_LEFT, 1, 0.0, 0.0, 0.0, 0.0, {0.0, 0.0, 0.0, 0.0}},
+    {"double_click", GestureKind::CLICKS, GLFW_MOUSE_BUTTON_LEFT, 2, 0.5, 0.5, 10.0, 0.0, {0.0, 0.0, 0.0, 0.0}},
+    {"tetra_click", GestureKind::CLICKS, GLFW_MOUSE_BUTTON_LEFT, 4, 2.0, 2.0, 0.0, 0.0, {-64.0, 0.0, 64.0, 64.0}},
+};
+
+static GestureRecognizer displayGestures;
+static std::vector<Gesture> frameGestures; // Recognized this frame, for every window
+
+void updateInputGestures(double currentTime) {
+    if (displayGestures.rules.empty()) {
+        initGestureRecognizer(displayGestures, DISPLAY_GESTURES, sizeof(DISPLAY_GESTURES) / sizeof(DISPLAY_GESTURES[0]));
+    }
+    frameGestures.clear();
+    updateGestures(displayGestures, currentTime, frameGestures);
+}
+
+static bool isGesture(const Gesture& gesture, const WindowData& wd, const char* name) {
+    return gesture.source == wd.window && std::strcmp(gesture.name, name) == 0;
+}
+
+/**
+ * Admin scene shown in ADMIN_SCENE state (shared by all windows)
+ * Reloaded by renderContentForState when the current admin scene file changes
+ */
+static Scene adminScene;
+static bool adminSceneLoaded = false;
+static std::string lastAdminSceneFile;
+
+/**
+ * Hit index for the scene last clicked
+ * Rebuilt only when the clicked scene or window size changes, so resolving a
+ * click is a single grid-cell lookup
+ */
+static HitIndex sceneHitIndex;
+
+/**
+ * Dispatch a click to the widget under it
+ * Language cards select the display language; admin tabs switch admin scenes
+ */
+static void dispatchWidgetClick(WindowData& wd, const Scene& scene, const Gesture& gesture) {
+    int windowWidth = 0, windowHeight = 0;
+    glfwGetWindowSize(wd.window, &windowWidth, &windowHeight);
+    if (!hitIndexMatches(sceneHitIndex, scene, windowWidth, windowHeight)) {
+        buildHitIndex(sceneHitIndex, scene, windowWidth, windowHeight);
+    }
+    int hit = hitTestWidget(sceneHitIndex, gesture.x, gesture.y);
+    if (hit < 0) return;
+    
+    const Widget& widget = scene.widgets[hit];
+    if (widget.type == "language_card") {
+        auto language = widget.properties.find("language");
+        if (language != widget.properties.end()) {
+            wd.selectedLanguage = language->second;
+            std::cout << "[DEBUG] Language selected: " << wd.selectedLanguage << std::endl;
+        }
+    } else if (wd.state == DisplayState::ADMIN_SCENE) {
+        handleAdminClick(wd, widget);
+    }
+}
+
+/**
+ * Patch one live scene from a re-parsed copy
+ * Only the parts that changed are replaced; the hit index is dropped only when
+ * widget rects or stacking changed
+ */
+static void patchLiveScene(Scene& live, const Scene& updated, const std::string& path) {
+    SceneDiff diff = diffScenes(live, updated);
+    if (isSceneDiffEmpty(diff)) return;
+    if (sceneDiffMovesWidgets(diff) && sceneHitIndex.scene == &live) {
+        sceneHitIndex.scene = nullptr;
+    }
+    applySceneDiff(live, updated, diff);
+    std::cout << "[DEBUG] Hot reload: " << path << " - " << diff.added.size() << " added, "
+              << diff.removed.size() << " removed, " << diff.moved.size() << " moved, "
+              << diff.changed.size() << " changed" << (diff.backgroundChanged ? ", new background" : "") << std::endl;
+}
+
+/**
+ * Opening scene parsed ahead of time by prefetchOpeningScene (startup worker)
+ * Windows copy it when they enter the opening scene instead of parsing the file
+ */
+static const char* const OPENING_SCENE_FILE = "scenes/opening.scene.json";
+static std::mutex prefetchMutex;
+static Scene prefetchedScene;
+static bool scenePrefetched = false;
+
+void prefetchOpeningScene() {
+    Scene scene;
+    if (!loadScene(OPENING_SCENE_FILE, scene)) {
+        std::cerr << "[WARNING] Could not prefetch " << OPENING_SCENE_FILE << ", it loads on first use" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(prefetchMutex);
+    prefetchedScene = scene;
+    scenePrefetched = true;
+}
+
+void applySceneUpdates(std::vector<WindowData>& windows) {
+    std::string path;
+    Scene updated;
+    while (takeSceneUpdate(path, updated)) {
+        if (path == OPENING_SCENE_FILE) {
+            {
+                std::lock_guard<std::mutex> lock(prefetchMutex);
+                if (scenePrefetched) prefetchedScene = updated; // Windows entering the scene later get the edit
+            }
+            for (WindowData& wd : windows) {
+                if (wd.sceneLoaded && wd.openingScene) patchLiveScene(*wd.openingScene, updated, path);
+            }
+        }
+        if (adminSceneLoaded && path == lastAdminSceneFile) {
+            patchLiveScene(adminScene, updated, path);
+        }
+    }
+}
+
 /**
  * Handle logo fade-in state
  * Logo gradually appears from transparent to fully opaque
@@ -109,72 +240,45 @@ float handleLogoShowing(WindowData& wd, double currentTime) {
     const double MIN_SHOW_DURATION = 0.5;   // Minimum brief show
     
     /**
-     * Track mouse button state for click detection
-     * We need to detect button press transitions (not held state)
-     * Static map persists across frames to track previous state
+     * Respond to this frame's gestures for this window
+     * Clicks are recognized from timestamped input events (see updateInputGestures),
+     * so a click shorter than a frame is never missed
      */
-    static std::map<GLFWwindow*, bool> lastMouseState;
-    int mouseButton = glfwGetMouseButton(wd.window, GLFW_MOUSE_BUTTON_LEFT);
-    bool currentMouseState = (mouseButton == GLFW_PRESS);
-    bool wasPressed = lastMouseState[wd.window];
-    
-    /**
-     * Detect click event (button press transition)
-     * A click occurs when button was not pressed, now is pressed
-     * Get cursor position for double-click detection and logging
-     */
-    if (currentMouseState && !wasPressed) {
-        double xpos, ypos;
-        glfwGetCursorPos(wd.window, &xpos, &ypos);
-        double clickTime = currentTime;
-        
-        /**
-         * Check for double-click pattern
-         * Double-click: two clicks within 0.5 seconds at similar position
-         * Distance threshold is 10 pixels to allow slight mouse movement
-         * Double-click changes audio seed for variety in procedural audio
-         */
-        const double DOUBLE_CLICK_TIME = 0.5;
-        const double DOUBLE_CLICK_DISTANCE = 10.0; // pixels
-        
-        if (clickTime - wd.lastClickTime < DOUBLE_CLICK_TIME &&
-            std::abs(xpos - wd.lastClickX) < DOUBLE_CLICK_DISTANCE &&
-            std::abs(ypos - wd.lastClickY) < DOUBLE_CLICK_DISTANCE) {
+    for (const Gesture& gesture : frameGestures) {
+        if (isGesture(gesture, wd, "double_click")) {
             /**
              * Double-click detected - change audio seed
              * Generate new random seed based on current seed
+             * Drawn from the AUDIO_SEED stream, so a run with a fixed rng.seed
+             * walks through the same seeds
              * Save to config file so change persists across sessions
              * This allows users to "randomize" the audio by double-clicking logo
              */
-            int newSeed = getAudioSeed() + (rand() % 10000);
+            static RandomStream seedStream = makeRandomStream(getRandomSeed(), RandomStreamId::AUDIO_SEED);
+            int newSeed = getAudioSeed() + (int)randomBelow(seedStream, 10000);
             setAudioSeed(newSeed);
             saveAudioSeed("config/audio_seed.txt");
             std::cout << "[DEBUG] Double-click detected - Audio seed changed to: " << newSeed << std::endl;
-        }
-        
-        /**
-         * Any click (single or double) triggers scene loading
-         * Store click information for double-click detection next time
-         * Start loading scene immediately on click/touch
-         * Scene loading happens while logo is still visible
-         */
-        wd.clickDetected = true;
-        wd.lastClickTime = clickTime;
-        wd.lastClickX = xpos;
-        wd.lastClickY = ypos;
-        std::cout << "[DEBUG] Click detected at (" << xpos << ", " << ypos 
-                  << ") - starting scene loading" << std::endl;
-        
-        /**
-         * Start lazy loading scene immediately on click
-         * This happens while logo is still visible
-         * Loading indicator will be shown over the logo
-         */
-        if (!wd.sceneLoading && !wd.sceneLoaded) {
-            loadOpeningSceneLazy(wd);
+        } else if (isGesture(gesture, wd, "click")) {
+            /**
+             * Any click (single or double) triggers scene loading
+             * Start loading scene immediately on click/touch
+             * Scene loading happens while logo is still visible
+             */
+            wd.clickDetected = true;
+            std::cout << "[DEBUG] Click detected at (" << gesture.x << ", " << gesture.y
+                      << ") - starting scene loading" << std::endl;
+            
+            /**
+             * Start lazy loading scene immediately on click
+             * This happens while logo is still visible
+             * Loading indicator will be shown over the logo
+             */
+            if (!wd.sceneLoading && !wd.sceneLoaded) {
+                loadOpeningSceneLazy(wd);
+            }
         }
     }
-    lastMouseState[wd.window] = currentMouseState;
     
     /**
      * If scene is loading, show loading indicator and wait for completion
@@ -260,22 +364,16 @@ void renderLoadingIndicator(int fbWidth, int fbHeight, float progress, const std
      * Use orthographic projection with origin at bottom-left
      * This matches the scene rendering coordinate system
      */
-    glViewport(0, 0, fbWidth, fbHeight);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(0.0, fbWidth, 0.0, fbHeight, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+    setGLViewport(0, 0, fbWidth, fbHeight);
+    setGLOrtho2D(fbWidth, fbHeight);
     
     /**
      * Enable alpha blending for smooth transparency
      * Needed for semi-transparent progress bars and text
      * Standard alpha blending formula
      */
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     /**
      * Render dark background overlay
@@ -360,17 +458,6 @@ void renderLoadingIndicator(int fbWidth, int fbHeight, float progress, const std
     }
     glEnd();
     
-    /**
-     * Restore matrices and disable blending
-     * Clean up OpenGL state after rendering
-     * Prevents affecting subsequent rendering operations
-     */
-    glDisable(GL_BLEND);
-    glPopMatrix();
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    
     // Note: Status text rendering would require a font/text rendering system
     // For now, we just show the progress bar and spinner
 }
@@ -425,7 +512,7 @@ void loadOpeningSceneLazy(WindowData& wd) {
      * Use C file I/O to avoid potential C++ stream issues
      * This prevents crashes that occurred with std::ifstream
      */
-    std::string filename = "scenes/opening.scene.json";
+    std::string filename = OPENING_SCENE_FILE;
     FILE* file = nullptr;
     
     /**
@@ -473,7 +560,17 @@ void loadOpeningSceneLazy(WindowData& wd) {
      * loadScene handles file I/O and JSON parsing
      * Returns true if scene loaded successfully
      */
-    bool loaded = loadScene(filename, *wd.openingScene);
+    bool loaded = false;
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex);
+        if (scenePrefetched) {
+            *wd.openingScene = prefetchedScene;
+            loaded = true;
+        }
+    }
+    if (!loaded) {
+        loaded = loadScene(filename, *wd.openingScene);
+    }
     
     /**
      * Update progress based on load result
@@ -576,7 +673,11 @@ void handleOpeningScene(WindowData& wd, int fbWidth, int fbHeight, double& lastF
          * Render the loaded scene
          * Scene rendering includes background graphics, widgets, and waveform
          * All rendering operations are wrapped in try-catch for safety
+         * Widget animations are evaluated for every widget first, in one pass,
+         * and the scene's image atlas is uploaded if it changed
          */
+        evaluateWidgetAnimations(wd.openingScene->animations, currentFrameTime);
+        syncTextureAtlas(wd.openingScene->images);
         renderScene(*wd.openingScene, fbWidth, fbHeight, deltaTime, frameCount);
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] Exception during OPENING_SCENE rendering: " << e.what() << std::endl;
@@ -596,6 +697,27 @@ void handleDisplayState(WindowData& wd, double currentTime, float& alpha) {
      * This is used for fade timing and automatic transitions
      */
     double elapsed = currentTime - wd.fadeStartTime;
+    DisplayState previousState = wd.state;
+    std::string previousAdminScene = wd.currentAdminScene;
+    
+    /**
+     * Clicks go to the widget under them in scene states
+     * Admin tetra-click works in every state; its last click is dispatched
+     * first, in the state it was made in
+     * The click count drives the indicator in the top-right corner
+     */
+    for (const Gesture& gesture : frameGestures) {
+        if (isGesture(gesture, wd, "click")) {
+            if (wd.state == DisplayState::OPENING_SCENE && wd.sceneLoaded && wd.openingScene) {
+                dispatchWidgetClick(wd, *wd.openingScene, gesture);
+            } else if (wd.state == DisplayState::ADMIN_SCENE && adminSceneLoaded) {
+                dispatchWidgetClick(wd, adminScene, gesture);
+            }
+        } else if (isGesture(gesture, wd, "tetra_click")) {
+            checkTetraClick(wd, gesture);
+        }
+    }
+    wd.adminClickCount = getGestureProgress(displayGestures, wd.window, "tetra_click", currentTime);
     
     std::cout << "[DEBUG] Current state: " << (int)wd.state << std::endl;
     
@@ -630,6 +752,28 @@ void handleDisplayState(WindowData& wd, double currentTime, float& alpha) {
      * OPENING_SCENE state is handled separately in renderContentForState
      * because it doesn't affect alpha (it renders a different scene entirely)
      */
+    
+    /**
+     * Entering a scene (or switching admin tabs) starts a transition
+     * The outgoing frame is the last one presented; see captureTransitionFrame
+     */
+    bool sceneChanged = wd.state != previousState || wd.currentAdminScene != previousAdminScene;
+    if (sceneChanged && (wd.state == DisplayState::OPENING_SCENE || wd.state == DisplayState::ADMIN_SCENE)) {
+        int fbWidth = 0, fbHeight = 0;
+        glfwGetFramebufferSize(wd.window, &fbWidth, &fbHeight);
+        beginSceneTransition(wd.transition, parseTransitionEffect(getConfigString("display.transition", "fade")),
+                             getConfigInt("display.transition_ms", 400) / 1000.0, fbWidth, fbHeight, currentTime);
+    }
+}
+
+/**
+ * Show how far an admin window's tetra-click has got
+ * The count comes from the gesture recognizer (see handleDisplayState)
+ */
+static void renderTetraClickProgress(const WindowData& wd, int fbWidth, int fbHeight) {
+    if (wd.isAdmin && !wd.adminModeActive && wd.adminClickCount > 0) {
+        renderTetraClickIndicator(fbWidth, fbHeight, wd.adminClickCount);
+    }
 }
 
 /**
@@ -646,6 +790,7 @@ void renderContentForState(WindowData& wd, int fbWidth, int fbHeight, float alph
      */
     if (wd.state == DisplayState::OPENING_SCENE) {
         handleOpeningScene(wd, fbWidth, fbHeight, lastFrameTime, frameCount);
+        renderTetraClickProgress(wd, fbWidth, fbHeight);
         return; // Skip logo texture rendering for scene state
     }
     
@@ -670,10 +815,6 @@ void renderContentForState(WindowData& wd, int fbWidth, int fbHeight, float alph
              * Admin scene file is set when user enters admin mode via tetra-click
              * Static scene data persists across frames for performance
              */
-            static Scene adminScene;
-            static bool adminSceneLoaded = false;
-            static std::string lastAdminSceneFile;
-            
             /**
              * Reload admin scene if scene file changed
              * This happens when user clicks different tabs in admin mode
@@ -683,6 +824,7 @@ void renderContentForState(WindowData& wd, int fbWidth, int fbHeight, float alph
                 try {
                     adminSceneLoaded = loadAdminScene(wd.currentAdminScene, adminScene);
                     lastAdminSceneFile = wd.currentAdminScene;
+                    sceneHitIndex.scene = nullptr; // Reloaded in place: widgets changed
                     if (!adminSceneLoaded) {
                         std::cerr << "Error: Failed to load admin scene: " << wd.currentAdminScene << std::endl;
                         wd.state = DisplayState::LOGO_SHOWING; // Fallback to logo
@@ -702,6 +844,8 @@ void renderContentForState(WindowData& wd, int fbWidth, int fbHeight, float alph
              * Scene is rendered using same renderer as opening scene
              */
             if (adminSceneLoaded) {
+                evaluateWidgetAnimations(adminScene.animations, currentFrameTime);
+                syncTextureAtlas(adminScene.images);
                 renderScene(adminScene, fbWidth, fbHeight, deltaTime, frameCount);
             }
             
@@ -748,6 +892,7 @@ void renderContentForState(WindowData& wd, int fbWidth, int fbHeight, float alph
          */
         renderErrorPlaceholder(fbWidth, fbHeight);
     }
+    renderTetraClickProgress(wd, fbWidth, fbHeight);
 }
 
 /**
@@ -761,18 +906,16 @@ void renderErrorPlaceholder(int fbWidth, int fbHeight) {
      * Viewport matches framebuffer size
      * Orthographic projection with origin at bottom-left
      */
-    glViewport(0, 0, fbWidth, fbHeight);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(0.0, fbWidth, 0.0, fbHeight, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    setGLViewport(0, 0, fbWidth, fbHeight);
+    setGLOrtho2D(fbWidth, fbHeight);
     
     /**
      * Draw red rectangle in center quarter of screen
      * This visually indicates an error condition
      * Red is a standard error color that stands out
      */
+    setGLBlend(false);
+    setGLTexture2D(false);
     glColor3f(1.0f, 0.0f, 0.0f);
     glBegin(GL_QUADS);
         glVertex2f(fbWidth * 0.25f, fbHeight * 0.25f);
@@ -28,7 +28,23 @@ void renderWindow(WindowData& wd, int frameCount);
  * @param fbWidth Output: framebuffer width in pixels
  * @param fbHeight Output: framebuffer height in pixels
  */
-void prepareWindowForRendering(const WindowData& wd, int& fbWidth, int& fbHeight);
+void prepareWindowForRendering(WindowData& wd, int& fbWidth, int& fbHeight);
+
+/**
+ * Recognize gestures from the input events queued since the last call
+ * Call once per frame after polling events; the state handlers below act on
+ * the gestures recognized for their window until the next call
+ * @param currentTime Current time from GLFW (resolves timed gestures)
+ */
+void updateInputGestures(double currentTime);
+
+/**
+ * Apply scene files re-parsed by the scene watcher since the last call
+ * Live scenes (each window's opening scene, the admin scene) are diffed against
+ * the new version and patched in place; call once per frame before rendering
+ * @param windows All windows (their opening scenes are patched)
+ */
+void applySceneUpdates(std::vector<WindowData>& windows);
 
 /**
  * Handle display state transitions and rendering
@@ -104,6 +120,13 @@ void handleOpeningScene(WindowData& wd, int fbWidth, int fbHeight, double& lastF
  */
 void loadOpeningSceneLazy(WindowData& wd);
 
+/**
+ * Parse the opening scene ahead of time (safe on any thread)
+ * Called during startup; loadOpeningSceneLazy then copies the parsed scene
+ * instead of reading the file when a window enters the opening scene
+ */
+void prefetchOpeningScene();
+
 /**
  * Render loading indicator with progress bar and status text
  * Shows animated loading spinner, progress bar, and status messages
@@ -0,0 +1,105 @@
+#include "resample.h"
+#include <algorithm>
+#include <cmath>
+
+static const double PI = 3.14159265358979323846;
+static const int MAX_PHASES = 4096;
+
+static int greatestCommonDivisor(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool initResampler(Resampler& resampler, int inRate, int outRate, int tapsPerSide) {
+    if (inRate <= 0 || outRate <= 0 || tapsPerSide <= 0) return false;
+    int divisor = greatestCommonDivisor(inRate, outRate);
+    if (outRate / divisor > MAX_PHASES) return false;
+
+    resampler.inRate = inRate;
+    resampler.outRate = outRate;
+    resampler.up = outRate / divisor;
+    resampler.down = inRate / divisor;
+
+    // Cutoff just below the lower Nyquist; when decimating the kernel widens
+    // with the ratio so the transition band stays the same at the output rate
+    double ratio = std::min(1.0, (double)outRate / inRate);
+    double cutoff = 0.46 * ratio; // Cycles per input sample
+    int half = (int)std::ceil(tapsPerSide / ratio);
+    resampler.taps = 2 * half + 1;
+    double width = half + 1.0;
+
+    resampler.bank.assign((size_t)resampler.up * resampler.taps, 0.0f);
+    for (int p = 0; p < resampler.up; p++) {
+        float* coefficients = &resampler.bank[(size_t)p * resampler.taps];
+        double fraction = (double)p / resampler.up;
+        double sum = 0.0;
+        for (int j = 0; j < resampler.taps; j++) {
+            // Distance from the output instant to input sample j of the window
+            double t = fraction + half - j;
+            double x = 2.0 * cutoff * t;
+            double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(PI * x) / (PI * x);
+            double window = 0.42 + 0.5 * std::cos(PI * t / width) + 0.08 * std::cos(2.0 * PI * t / width);
+            coefficients[j] = (float)(sinc * window);
+            sum += coefficients[j];
+        }
+        for (int j = 0; j < resampler.taps; j++) {
+            coefficients[j] = (float)(coefficients[j] / sum); // Unity gain at DC for every phase
+        }
+    }
+    resetResampler(resampler);
+    return true;
+}
+
+void resetResampler(Resampler& resampler) {
+    size_t half = (size_t)resampler.taps / 2;
+    resampler.input.assign(half, 0.0f); // Silence before the first sample
+    resampler.center = half;
+    resampler.phase = 0;
+}
+
+// Produce every output whose window lies within the buffered input
+static void drain(Resampler& resampler, std::vector<short>& output) {
+    const size_t half = (size_t)resampler.taps / 2;
+    const float* input = resampler.input.data();
+    while (resampler.center + half < resampler.input.size()) {
+        const float* coefficients = &resampler.bank[(size_t)resampler.phase * resampler.taps];
+        const float* window = input + (resampler.center - half);
+        float acc = 0.0f;
+        for (int j = 0; j < resampler.taps; j++) {
+            acc += coefficients[j] * window[j];
+        }
+        long value = std::lround(acc);
+        output.push_back((short)std::max(-32768L, std::min(32767L, value)));
+
+        resampler.phase += resampler.down;
+        resampler.center += (size_t)(resampler.phase / resampler.up);
+        resampler.phase %= resampler.up;
+    }
+    // Keep only the history the next output needs
+    size_t consumed = std::min(resampler.center - half, resampler.input.size());
+    resampler.input.erase(resampler.input.begin(), resampler.input.begin() + consumed);
+    resampler.center -= consumed;
+}
+
+void resample(Resampler& resampler, const short* samples, size_t count, std::vector<short>& output) {
+    if (resampler.taps == 0 || !samples) return;
+    resampler.input.reserve(resampler.input.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        resampler.input.push_back((float)samples[i]);
+    }
+    drain(resampler, output);
+}
+
+void flushResampler(Resampler& resampler, std::vector<short>& output) {
+    if (resampler.taps == 0) return;
+    // Outputs centered before the end of the input, with silence after it
+    size_t end = resampler.input.size();
+    size_t half = (size_t)resampler.taps / 2;
+    resampler.input.resize(end + half, 0.0f);
+    drain(resampler, output);
+    resetResampler(resampler);
+}
@@ -0,0 +1,36 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <cstddef>
+#include <vector>
+
+// Streaming rational-ratio resampler for PCM16
+// Polyphase windowed sinc (Blackman): the ratio outRate/inRate is reduced to
+// up/down and each output sample is the dot product of one of `up` phase
+// filters with the input around its position, so blocks of any size can be
+// fed and the output does not depend on how the input was split. Output
+// sample k is centered on input time k * inRate / outRate (no added delay).
+
+struct Resampler {
+    int inRate = 0;
+    int outRate = 0;
+    int up = 0;                  // outRate / gcd
+    int down = 0;                // inRate / gcd
+    int taps = 0;                // Odd: taps/2 input samples either side
+    std::vector<float> bank;     // up phases of taps coefficients
+    std::vector<float> input;    // Unconsumed input, preceded by taps/2 samples of history
+    size_t center = 0;           // Input index of the next output's center
+    int phase = 0;               // Its fractional position, in 1/up input samples
+};
+
+// tapsPerSide: zero crossings either side of the center at the lower of the
+// two rates (more = sharper cutoff, more work). False for unsupported ratios.
+bool initResampler(Resampler& resampler, int inRate, int outRate, int tapsPerSide = 16);
+void resetResampler(Resampler& resampler); // Drop history (e.g. after a gap in the input)
+
+// Appends the output made available by count more input samples
+void resample(Resampler& resampler, const short* samples, size_t count, std::vector<short>& output);
+// Emits the remaining output for the input fed so far, then resets
+void flushResampler(Resampler& resampler, std::vector<short>& output);
+
+#endif // RESAMPLE_H
@@ -0,0 +1,179 @@
+#include "rng.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RNG_SSE2 1
+#include <emmintrin.h>
+#else
+#define RNG_SSE2 0
+#endif
+
+// Multipliers and Weyl key increments from the Philox paper
+static const uint32_t PHILOX_M0 = 0xD2511F53u;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+static const uint32_t PHILOX_W0 = 0x9E3779B9u;
+static const uint32_t PHILOX_W1 = 0xBB67AE85u;
+static const int PHILOX_ROUNDS = 10;
+
+static uint64_t randomSeed = 0;
+
+void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+static void advanceBlock(RandomStream& stream, uint32_t blocks) {
+    uint32_t before = stream.counter[0];
+    stream.counter[0] += blocks;
+    if (stream.counter[0] < before) stream.counter[1]++;
+}
+
+#if RNG_SSE2
+// 32x32 -> 64 multiply of all four lanes by one constant, split into high and low words
+static inline void mulhilo4(__m128i x, __m128i multiplier, __m128i& hi, __m128i& lo) {
+    __m128i even = _mm_mul_epu32(x, multiplier);                     // lo0 hi0 lo2 hi2
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), multiplier);  // lo1 hi1 lo3 hi3
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));         // lo0 lo2 hi0 hi2
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));           // lo1 lo3 hi1 hi3
+    lo = _mm_unpacklo_epi32(even, odd);
+    hi = _mm_unpackhi_epi32(even, odd);
+}
+
+// Four consecutive blocks starting at the stream's counter, one block per lane,
+// transposed back so out[] holds them in stream order
+static void philox4x32Batch(const RandomStream& stream, uint32_t* out) {
+    uint32_t low[4], high[4];
+    for (int lane = 0; lane < 4; lane++) {
+        low[lane] = stream.counter[0] + (uint32_t)lane;
+        high[lane] = stream.counter[1] + (low[lane] < stream.counter[0] ? 1u : 0u);
+    }
+    __m128i c0 = _mm_loadu_si128((const __m128i*)low);
+    __m128i c1 = _mm_loadu_si128((const __m128i*)high);
+    __m128i c2 = _mm_set1_epi32((int)stream.counter[2]);
+    __m128i c3 = _mm_set1_epi32((int)stream.counter[3]);
+    const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32((int)PHILOX_M1);
+    uint32_t k0 = stream.key[0], k1 = stream.key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        __m128i hi0, lo0, hi1, lo1;
+        mulhilo4(c0, m0, hi0, lo0);
+        mulhilo4(c2, m1, hi1, lo1);
+        c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)k0));
+        c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)k1));
+        c1 = lo1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+    __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+    __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+    __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+    _mm_storeu_si128((__m128i*)(out + 0), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(out + 4), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(out + 8), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i*)(out + 12), _mm_unpackhi_epi64(t2, t3));
+}
+#else
+static void philox4x32Batch(const RandomStream& stream, uint32_t* out) {
+    RandomStream copy = stream;
+    for (int block = 0; block < 4; block++) {
+        philox4x32(copy.counter, copy.key, out + block * 4);
+        advanceBlock(copy, 1);
+    }
+}
+#endif
+
+RandomStream makeRandomStream(uint64_t seed, RandomStreamId subsystem, uint32_t substream) {
+    RandomStream stream;
+    stream.key[0] = (uint32_t)seed;
+    stream.key[1] = (uint32_t)(seed >> 32);
+    stream.counter[0] = 0;
+    stream.counter[1] = 0;
+    stream.counter[2] = substream;
+    stream.counter[3] = (uint32_t)subsystem;
+    stream.buffer[0] = stream.buffer[1] = stream.buffer[2] = stream.buffer[3] = 0;
+    stream.used = 4;
+    return stream;
+}
+
+uint32_t randomUint32(RandomStream& stream) {
+    if (stream.used >= 4) {
+        philox4x32(stream.counter, stream.key, stream.buffer);
+        advanceBlock(stream, 1);
+        stream.used = 0;
+    }
+    return stream.buffer[stream.used++];
+}
+
+float randomFloat(RandomStream& stream) {
+    return (randomUint32(stream) >> 8) * (1.0f / 16777216.0f);
+}
+
+float randomRange(RandomStream& stream, float low, float high) {
+    return low + (high - low) * randomFloat(stream);
+}
+
+// Lemire's multiply-shift with rejection: unbiased for any bound
+uint32_t randomBelow(RandomStream& stream, uint32_t bound) {
+    uint64_t product = (uint64_t)randomUint32(stream) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = (uint64_t)randomUint32(stream) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+void fillRandomUint32(RandomStream& stream, uint32_t* out, size_t count) {
+    // Drain the current block first so the batch starts on a block boundary
+    while (count > 0 && stream.used < 4) {
+        *out++ = stream.buffer[stream.used++];
+        count--;
+    }
+    for (; count >= 16; count -= 16, out += 16) {
+        philox4x32Batch(stream, out);
+        advanceBlock(stream, 4);
+    }
+    while (count > 0) {
+        *out++ = randomUint32(stream);
+        count--;
+    }
+}
+
+void fillRandomFloat(RandomStream& stream, float* out, size_t count) {
+    uint32_t bits[64];
+    while (count > 0) {
+        size_t chunk = count < 64 ? count : 64;
+        fillRandomUint32(stream, bits, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            out[i] = (bits[i] >> 8) * (1.0f / 16777216.0f);
+        }
+        out += chunk;
+        count -= chunk;
+    }
+}
+
+void setRandomSeed(uint64_t seed) {
+    randomSeed = seed;
+}
+
+uint64_t getRandomSeed() {
+    return randomSeed;
+}
@@ -0,0 +1,53 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counter-based random numbers for procedural generation
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"):
+// a keyed bijection from a 128-bit counter to 128 random bits, so any value
+// in a stream can be computed directly from its position. There is no hidden
+// global state, every stream is reentrant, and the output is identical on
+// every platform and compiler.
+//
+// A stream is (seed, subsystem, substream): the seed is the key, the
+// subsystem and substream fill the upper counter words and the lower 64 bits
+// count blocks of four values. Subsystems never share values, and per-particle
+// substreams stay the same however many particles draw before them.
+
+// Subsystem ids; append only, reordering changes every stream after the edit
+enum class RandomStreamId : uint32_t {
+    BACKGROUND = 1,      // Initial triangles, dots and orbs (substream = particle)
+    BACKGROUND_RESPAWN,  // Orbs re-entering from their corner (substream = orb)
+    AUDIO,               // Procedural bass waveform (keyed by the audio seed)
+    AUDIO_SEED,          // New audio seeds picked by double-click
+};
+
+struct RandomStream {
+    uint32_t key[2];
+    uint32_t counter[4];   // counter[0..1] = block index, [2] = substream, [3] = subsystem
+    uint32_t buffer[4];    // Current block
+    int used;              // Values of buffer already returned (4 = refill)
+};
+
+// One Philox4x32-10 block
+void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+RandomStream makeRandomStream(uint64_t seed, RandomStreamId subsystem, uint32_t substream = 0);
+
+uint32_t randomUint32(RandomStream& stream);
+float randomFloat(RandomStream& stream);                        // [0, 1), 24-bit resolution
+float randomRange(RandomStream& stream, float low, float high); // [low, high)
+uint32_t randomBelow(RandomStream& stream, uint32_t bound);     // [0, bound), bound > 0
+
+// Batch generation: the same values, in the same order, as that many single
+// calls, computed four blocks at a time with SSE2 where available
+void fillRandomUint32(RandomStream& stream, uint32_t* out, size_t count);
+void fillRandomFloat(RandomStream& stream, float* out, size_t count);
+
+// Process-wide seed for procedural generation (config key rng.seed)
+void setRandomSeed(uint64_t seed);
+uint64_t getRandomSeed();
+
+#endif // RNG_H
@@ -1,11 +1,14 @@
 #include "scene.h"
 #include "scene_logger.h"
 #include "audio.h"
+#include "config.h"
+#include "transcript.h"
+#include "rng.h"
+#include "gl_state.h"
 #include <cstdio>  // For FILE, fopen, fclose, fgets, feof
 #include <sstream>
 #include <algorithm>
 #include <cmath>
-#include <ctime>
 #include <cstdlib>
 #include <stdexcept>
 #include <exception>
@@ -86,6 +89,7 @@ static struct {
         float r, g, b;
         float radius;
     } orbs[10];
+    RandomStream orbRespawn[10]; // Offsets and speeds for each orb's re-entries
     
     bool initialized = false;
 } bgState;
@@ -94,50 +98,52 @@ static void initBackgroundGraphics(int width, int height) {
     if (bgState.initialized) return;
     if (width <= 0 || height <= 0) return; // Safety check
     
-    // Ensure rand() is seeded (may not be initialized yet)
-    static bool randSeeded = false;
-    if (!randSeeded) {
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
-        randSeeded = true;
-    }
+    // Every particle draws from its own stream, so the layout for a given
+    // rng.seed is the same however the particle arrays are later resized
+    uint64_t seed = getRandomSeed();
+    uint32_t particle = 0;
     
     // Initialize triangles
-    for (int i = 0; i < 100; i++) {
-        bgState.triangles[i].x = (float)(rand() % width);
-        bgState.triangles[i].y = (float)(rand() % height);
-        bgState.triangles[i].vx = (float)(rand() % 20 - 10) * 0.1f;
-        bgState.triangles[i].vy = (float)(rand() % 20 - 10) * 0.1f;
-        bgState.triangles[i].size = (float)(rand() % 20 + 10);
-        bgState.triangles[i].rotation = (float)(rand() % 360);
-        bgState.triangles[i].rotSpeed = (float)(rand() % 10 - 5) * 0.5f;
+    for (int i = 0; i < 100; i++, particle++) {
+        RandomStream random = makeRandomStream(seed, RandomStreamId::BACKGROUND, particle);
+        bgState.triangles[i].x = randomRange(random, 0.0f, (float)width);
+        bgState.triangles[i].y = randomRange(random, 0.0f, (float)height);
+        bgState.triangles[i].vx = randomRange(random, -1.0f, 1.0f);
+        bgState.triangles[i].vy = randomRange(random, -1.0f, 1.0f);
+        bgState.triangles[i].size = randomRange(random, 10.0f, 30.0f);
+        bgState.triangles[i].rotation = randomRange(random, 0.0f, 360.0f);
+        bgState.triangles[i].rotSpeed = randomRange(random, -2.5f, 2.5f);
     }
     
     // Initialize dots
-    for (int i = 0; i < 200; i++) {
-        bgState.dots[i].x = (float)(rand() % width);
-        bgState.dots[i].y = (float)(rand() % height);
-        bgState.dots[i].vx = (float)(rand() % 30 - 15) * 0.1f;
-        bgState.dots[i].vy = (float)(rand() % 30 - 15) * 0.1f;
+    for (int i = 0; i < 200; i++, particle++) {
+        RandomStream random = makeRandomStream(seed, RandomStreamId::BACKGROUND, particle);
+        bgState.dots[i].x = randomRange(random, 0.0f, (float)width);
+        bgState.dots[i].y = randomRange(random, 0.0f, (float)height);
+        bgState.dots[i].vx = randomRange(random, -1.5f, 1.5f);
+        bgState.dots[i].vy = randomRange(random, -1.5f, 1.5f);
     }
     
     // Initialize orbs
-    for (int i = 0; i < 10; i++) {
-        bgState.orbs[i].x = (float)(rand() % width);
-        bgState.orbs[i].y = (float)(rand() % height);
-        bgState.orbs[i].vx = (float)(rand() % 40 - 20) * 0.1f;
-        bgState.orbs[i].vy = (float)(rand() % 40 - 20) * 0.1f;
-        bgState.orbs[i].r = (float)(rand() % 100 + 150) / 255.0f;
-        bgState.orbs[i].g = (float)(rand() % 100 + 150) / 255.0f;
-        bgState.orbs[i].b = (float)(rand() % 100 + 150) / 255.0f;
-        bgState.orbs[i].radius = (float)(rand() % 100 + 150);
+    for (int i = 0; i < 10; i++, particle++) {
+        RandomStream random = makeRandomStream(seed, RandomStreamId::BACKGROUND, particle);
+        bgState.orbs[i].x = randomRange(random, 0.0f, (float)width);
+        bgState.orbs[i].y = randomRange(random, 0.0f, (float)height);
+        bgState.orbs[i].vx = randomRange(random, -2.0f, 2.0f);
+        bgState.orbs[i].vy = randomRange(random, -2.0f, 2.0f);
+        bgState.orbs[i].r = randomRange(random, 150.0f, 250.0f) / 255.0f;
+        bgState.orbs[i].g = randomRange(random, 150.0f, 250.0f) / 255.0f;
+        bgState.orbs[i].b = randomRange(random, 150.0f, 250.0f) / 255.0f;
+        bgState.orbs[i].radius = randomRange(random, 150.0f, 250.0f);
+        bgState.orbRespawn[i] = makeRandomStream(seed, RandomStreamId::BACKGROUND_RESPAWN, (uint32_t)i);
     }
     
     bgState.initialized = true;
 }
 
 static void renderTriangles(int width, int height, float deltaTime) {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     glColor4f(0.6f, 0.7f, 0.9f, 0.3f);
     
     for (int i = 0; i < 100; i++) {
@@ -163,8 +169,6 @@ static void renderTriangles(int width, int height, float deltaTime) {
         glEnd();
         glPopMatrix();
     }
-    
-    glDisable(GL_BLEND);
 }
 
 static void renderDotsWithLines(int width, int height, float deltaTime, float connectionRange = 100.0f) {
@@ -181,11 +185,11 @@ static void renderDotsWithLines(int width, int height, float deltaTime, float co
         if (d.y > height) d.y -= height;
     }
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     // Draw connections
-    glLineWidth(1.0f);
+    setGLLineWidth(1.0f);
     glColor4f(0.5f, 0.6f, 0.8f, 0.2f);
     glBegin(GL_LINES);
     for (int i = 0; i < 200; i++) {
@@ -205,15 +209,13 @@ static void renderDotsWithLines(int width, int height, float deltaTime, float co
     glEnd();
     
     // Draw dots
-    glPointSize(2.0f);
+    setGLPointSize(2.0f);
     glColor4f(0.7f, 0.8f, 1.0f, 0.8f);
     glBegin(GL_POINTS);
     for (int i = 0; i < 200; i++) {
         glVertex2f(bgState.dots[i].x, bgState.dots[i].y);
     }
     glEnd();
-    
-    glDisable(GL_BLEND);
 }
 
 static void renderBlurredOrbs(int width, int height, float deltaTime) {
@@ -235,8 +237,8 @@ static void renderBlurredOrbs(int width, int height, float deltaTime) {
         if (o.x < -o.radius || o.x > width + o.radius || 
             o.y < -o.radius || o.y > height + o.radius) {
             // Restart from corner with small random offset
-            o.x = corners[cornerIdx][0] + (float)(rand() % 50 - 25);
-            o.y = corners[cornerIdx][1] + (float)(rand() % 50 - 25);
+            o.x = corners[cornerIdx][0] + randomRange(bgState.orbRespawn[i], -25.0f, 25.0f);
+            o.y = corners[cornerIdx][1] + randomRange(bgState.orbRespawn[i], -25.0f, 25.0f);
             
             // Recalculate velocity toward opposite corner
             float oppositeCorners[4][2] = {
@@ -246,15 +248,15 @@ static void renderBlurredOrbs(int width, int height, float deltaTime) {
             float dy = oppositeCorners[cornerIdx][1] - o.y;
             float dist = sqrtf(dx * dx + dy * dy);
             if (dist > 0.1f) {
-                float speed = (float)(rand() % 30 + 40) * 0.1f;
+                float speed = randomRange(bgState.orbRespawn[i], 4.0f, 7.0f);
                 o.vx = (dx / dist) * speed;
                 o.vy = (dy / dist) * speed;
             }
         }
     }
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     // FIRST: Render a single full-screen linear gradient from top-left to bottom-right
     // Using light Apple-style colors (soft pastels, light greens, soft blues)
@@ -371,12 +373,10 @@ static void renderBlurredOrbs(int width, int height, float deltaTime) {
             glEnd();
         }
     }
-    
-    glDisable(GL_BLEND);
 }
 
 // Parse color string - supports hex format (#ffffff or ffffff) or comma format (r,g,b)
-static void parseColor(const std::string& colorStr, float& r, float& g, float& b) {
+void parseColor(const std::string& colorStr, float& r, float& g, float& b) {
     r = g = b = 0.1f;
     
     // Check if empty string
@@ -516,7 +516,8 @@ bool loadScene(const std::string& filename, Scene& scene) {
             std::cout << "[DEBUG] loadScene: Line " << lineCount << " (before trim): [" << line << "]" << std::endl;
             line = trim(line);
             std::cout << "[DEBUG] loadScene: Line " << lineCount << " (after trim): [" << line << "]" << std::endl;
-            if (line.empty() || line[0] == '{' || line[0] == '}') {
+            // Braces only matter inside "widgets" (one object per widget)
+            if (line.empty() || (!inWidgets && (line[0] == '{' || line[0] == '}'))) {
                 std::cout << "[DEBUG] loadScene: Line " << lineCount << " skipped (empty or brace)" << std::endl;
                 continue;
             }
@@ -562,10 +563,13 @@ bool loadScene(const std::string& filename, Scene& scene) {
             } else if (line.find("\"widgets\"") != std::string::npos) {
                 std::cout << "[DEBUG] loadScene: Found 'widgets' field, setting inWidgets=true" << std::endl;
                 inWidgets = true;
-            } else if (inWidgets && line.find("{") != std::string::npos) {
+            } else if (inWidgets && line[0] == ']') {
+                std::cout << "[DEBUG] loadScene: Found end of widgets, setting inWidgets=false" << std::endl;
+                inWidgets = false;
+            } else if (inWidgets && line[0] == '{') {
                 std::cout << "[DEBUG] loadScene: Found widget start '{', initializing currentWidget" << std::endl;
                 currentWidget = Widget();
-            } else if (inWidgets && line.find("}") != std::string::npos) {
+            } else if (inWidgets && line[0] == '}') {
                 std::cout << "[DEBUG] loadScene: Found widget end '}'" << std::endl;
                 if (currentWidget.type != "") {
                     std::cout << "[DEBUG] loadScene: Adding widget type: [" << currentWidget.type << "]" << std::endl;
@@ -574,6 +578,7 @@ bool loadScene(const std::string& filename, Scene& scene) {
                 } else {
                     std::cout << "[DEBUG] loadScene: Widget has no type, skipping" << std::endl;
                 }
+                currentWidget = Widget();
             } else if (inWidgets && line.find("\"type\"") != std::string::npos) {
                 std::cout << "[DEBUG] loadScene: Found widget 'type' field" << std::endl;
                 currentWidget.type = extractStringValue(line);
@@ -602,6 +607,11 @@ bool loadScene(const std::string& filename, Scene& scene) {
                 std::cout << "[DEBUG] loadScene: Found widget 'margin' field" << std::endl;
                 currentWidget.margin = extractFloatValue(line);
                 std::cout << "[DEBUG] loadScene: Set widget margin to: " << currentWidget.margin << std::endl;
+            } else if (inWidgets && line[0] == '"') {
+                // Any other string field ("label", "scene", "text"...) is kept as a widget property
+                std::string key = line.substr(1, line.find('"', 1) - 1);
+                currentWidget.properties[key] = extractStringValue(line);
+                std::cout << "[DEBUG] loadScene: Set widget " << key << " to: [" << currentWidget.properties[key] << "]" << std::endl;
             } else {
                 std::cout << "[DEBUG] loadScene: Line " << lineCount << " did not match any known field, ignoring" << std::endl;
             }
@@ -625,16 +635,121 @@ bool loadScene(const std::string& filename, Scene& scene) {
     fclose(file);
     std::cout << "[DEBUG] loadScene: File closed with fclose" << std::endl;
     
+    buildWidgetAnimations(scene.widgets, scene.animations);
+    buildSceneImages(scene);
+    
     std::cout << "[DEBUG] loadScene: Parsed " << lineCount << " lines, widgets: " << scene.widgets.size() << std::endl;
     std::cout << "[DEBUG] loadScene: Scene ID: [" << scene.id << "], Layout: [" << scene.layout << "]" << std::endl;
     std::cout << "[DEBUG] loadScene: Grid: " << scene.cols << "x" << scene.rows << std::endl;
     std::cout << "[DEBUG] loadScene: Background - image: [" << scene.bg.image << "], color: [" << scene.bg.color << "], graphic: [" << scene.bg.graphic << "]" << std::endl;
+    std::cout << "[DEBUG] loadScene: Animation tracks: " << scene.animations.trackSlot.size() << std::endl;
+    std::cout << "[DEBUG] loadScene: Atlas images: " << scene.images.regions.size() << std::endl;
     std::cout << "[DEBUG] loadScene: Waveform enabled: " << (scene.waveform ? "true" : "false") << std::endl;
     std::cout << "[DEBUG] loadScene: Returning true" << std::endl;
     
     return true;
 }
 
+void buildSceneImages(Scene& scene) {
+    initTextureAtlas(scene.images);
+    scene.widgetImages.assign(scene.widgets.size(), -1);
+    for (size_t i = 0; i < scene.widgets.size(); i++) {
+        auto path = scene.widgets[i].properties.find("image");
+        if (path == scene.widgets[i].properties.end() || path->second.empty()) continue;
+        int region = findAtlasImage(scene.images, path->second);
+        if (region < 0) {
+            DecodedImage image;
+            if (!decodeImage(path->second.c_str(), image)) continue;
+            if (image.width > ATLAS_MAX_IMAGE_SIZE || image.height > ATLAS_MAX_IMAGE_SIZE) {
+                std::cerr << "[WARNING] Scene image " << path->second << " is " << image.width << "x" << image.height
+                          << ", larger than " << ATLAS_MAX_IMAGE_SIZE << "px: not drawn" << std::endl;
+                continue;
+            }
+            region = addAtlasImage(scene.images, path->second, image);
+            if (region < 0) {
+                std::cerr << "[WARNING] Scene image " << path->second << " does not fit in the atlas: not drawn" << std::endl;
+                continue;
+            }
+        }
+        scene.widgetImages[i] = region;
+    }
+}
+
+// Widget position and size in pixels (grid cell units, margin as a fraction of the size)
+static void computeGridRect(int rows, float col, float row, float width, float height, float margin,
+                            float cellWidth, float cellHeight, float& x, float& y, float& w, float& h) {
+    x = col * cellWidth;
+    y = (rows - row - height) * cellHeight; // Y is from bottom
+    w = width * cellWidth;
+    h = height * cellHeight;
+    
+    // Apply margin
+    float marginX = w * margin;
+    float marginY = h * margin;
+    x += marginX;
+    y += marginY;
+    w -= marginX * 2;
+    h -= marginY * 2;
+}
+
+void computeWidgetRect(const Scene& scene, const Widget& widget, float cellWidth, float cellHeight, float& x, float& y, float& w, float& h) {
+    computeGridRect(scene.rows, (float)widget.col, (float)widget.row, (float)widget.width, (float)widget.height,
+                    widget.margin, cellWidth, cellHeight, x, y, w, h);
+}
+
+// Rect from the widget's evaluated animation values (see evaluateWidgetAnimations)
+static void computeAnimatedWidgetRect(const Scene& scene, size_t index, float cellWidth, float cellHeight, float& x, float& y, float& w, float& h) {
+    const WidgetAnimations& animations = scene.animations;
+    computeGridRect(scene.rows, getWidgetAnimationValue(animations, AnimationChannel::COL, index),
+                    getWidgetAnimationValue(animations, AnimationChannel::ROW, index),
+                    getWidgetAnimationValue(animations, AnimationChannel::WIDTH, index),
+                    getWidgetAnimationValue(animations, AnimationChannel::HEIGHT, index),
+                    scene.widgets[index].margin, cellWidth, cellHeight, x, y, w, h);
+}
+
+// Transcript widget - recent lines from the transcript view, newest at the bottom
+// Words are drawn as blocks (no font system yet); low-confidence words fade and
+// the streaming partial is dimmer than final lines
+static void renderTranscriptWidget(float x, float y, float w, float h, float opacity) {
+    setGLAlphaBlend();
+    setGLTexture2D(false);
+    glColor4f(0.0f, 0.0f, 0.0f, 0.5f * opacity);
+    glBegin(GL_QUADS);
+        glVertex2f(x, y);
+        glVertex2f(x + w, y);
+        glVertex2f(x + w, y + h);
+        glVertex2f(x, y + h);
+    glEnd();
+    
+    std::vector<TranscriptEvent> lines = getTranscriptLines();
+    float padding = 8.0f;
+    float lineHeight = 18.0f;
+    float charWidth = 7.0f;
+    float lineY = y + padding;
+    for (size_t i = lines.size(); i-- > 0 && lineY + lineHeight <= y + h - padding;) {
+        const TranscriptEvent& line = lines[i];
+        float alpha = line.isFinal ? 0.9f : 0.5f;
+        if (line.confidence >= 0.0f) alpha *= 0.4f + 0.6f * line.confidence;
+        glColor4f(1.0f, 1.0f, 1.0f, alpha * opacity);
+        
+        float wordX = x + padding;
+        std::istringstream words(line.text);
+        std::string word;
+        while (words >> word) {
+            float wordWidth = word.size() * charWidth;
+            if (wordX + wordWidth > x + w - padding) break; // Clip the rest of the line
+            glBegin(GL_QUADS);
+                glVertex2f(wordX, lineY + 3.0f);
+                glVertex2f(wordX + wordWidth, lineY + 3.0f);
+                glVertex2f(wordX + wordWidth, lineY + lineHeight - 3.0f);
+                glVertex2f(wordX, lineY + lineHeight - 3.0f);
+            glEnd();
+            wordX += wordWidth + charWidth;
+        }
+        lineY += lineHeight;
+    }
+}
+
 void renderScene(const Scene& scene, int windowWidth, int windowHeight, float deltaTime, int frameCount) {
     try {
         // Calculate grid cell size
@@ -649,12 +764,8 @@ void renderScene(const Scene& scene, int windowWidth, int windowHeight, float de
         float cellHeight = (float)windowHeight / scene.rows;
     
     // Set up viewport
-    glViewport(0, 0, windowWidth, windowHeight);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    setGLViewport(0, 0, windowWidth, windowHeight);
+    setGLOrtho2D(windowWidth, windowHeight);
     
     // Render background color - white by default
     float bgR = 1.0f, bgG = 1.0f, bgB = 1.0f; // White background by default
@@ -679,27 +790,38 @@ void renderScene(const Scene& scene, int windowWidth, int windowHeight, float de
     // Log scene render info (only on frame 0 and every 1000th frame)
     logSceneRender(frameCount, windowWidth, windowHeight, 3, deltaTime, scene.bg.graphic, scene.widgets.size());
     
-    // Render widgets
-    for (const auto& widget : scene.widgets) {
-        if (widget.type == "language_card") {
-            // Calculate widget position and size in pixels
-            float x = widget.col * cellWidth;
-            float y = (scene.rows - widget.row - widget.height) * cellHeight; // Y is from bottom
-            float w = widget.width * cellWidth;
-            float h = widget.height * cellHeight;
-            
-            // Apply margin
-            float marginX = w * widget.margin;
-            float marginY = h * widget.margin;
-            x += marginX;
-            y += marginY;
-            w -= marginX * 2;
-            h -= marginY * 2;
-            
+    // Render widgets, at the rects and colors their animations were last evaluated to
+    // Their images are collected into one batch drawn from the atlas afterwards
+    std::vector<float> imageVertices;
+    bool hasImages = scene.images.texture != 0 && scene.widgetImages.size() == scene.widgets.size();
+    bool animated = scene.animations.widgetCount == scene.widgets.size() &&
+                    scene.animations.values.size() == (size_t)AnimationChannel::COUNT * scene.widgets.size();
+    for (size_t i = 0; i < scene.widgets.size(); i++) {
+        const Widget& widget = scene.widgets[i];
+        float x, y, w, h;
+        float fillR = -1.0f, fillG = -1.0f, fillB = -1.0f, opacity = 1.0f;
+        if (animated) {
+            computeAnimatedWidgetRect(scene, i, cellWidth, cellHeight, x, y, w, h);
+            fillR = getWidgetAnimationValue(scene.animations, AnimationChannel::COLOR_R, i);
+            fillG = getWidgetAnimationValue(scene.animations, AnimationChannel::COLOR_G, i);
+            fillB = getWidgetAnimationValue(scene.animations, AnimationChannel::COLOR_B, i);
+            opacity = std::max(0.0f, std::min(1.0f, getWidgetAnimationValue(scene.animations, AnimationChannel::OPACITY, i)));
+        } else {
+            computeWidgetRect(scene, widget, cellWidth, cellHeight, x, y, w, h);
+        }
+        if (opacity <= 0.0f || w <= 0.0f || h <= 0.0f) continue;
+        
+        if (widget.type == "transcript") {
+            renderTranscriptWidget(x, y, w, h, opacity);
+        } else if (widget.type == "language_card") {
             // Draw card background
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glColor4f(0.2f, 0.25f, 0.3f, 0.8f);
+            setGLAlphaBlend();
+            setGLTexture2D(false);
+            if (fillR >= 0.0f) {
+                glColor4f(fillR, fillG, fillB, 0.8f * opacity);
+            } else {
+                glColor4f(0.2f, 0.25f, 0.3f, 0.8f * opacity);
+            }
             glBegin(GL_QUADS);
                 glVertex2f(x, y);
                 glVertex2f(x + w, y);
@@ -708,8 +830,8 @@ void renderScene(const Scene& scene, int windowWidth, int windowHeight, float de
             glEnd();
             
             // Draw card border
-            glColor4f(0.4f, 0.5f, 0.6f, 0.9f);
-            glLineWidth(2.0f);
+            glColor4f(0.4f, 0.5f, 0.6f, 0.9f * opacity);
+            setGLLineWidth(2.0f);
             glBegin(GL_LINE_LOOP);
                 glVertex2f(x, y);
                 glVertex2f(x + w, y);
@@ -720,24 +842,41 @@ void renderScene(const Scene& scene, int windowWidth, int windowHeight, float de
             // Render text (simplified - using points for "English" or Arabic text)
             std::string lang = widget.properties.count("language") ? widget.properties.at("language") : "";
             if (lang == "English") {
-                glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+                glColor4f(1.0f, 1.0f, 1.0f, opacity);
                 // Simplified text rendering - would need proper font rendering
                 // For now, draw a simple indicator
-                glPointSize(10.0f);
+                setGLPointSize(10.0f);
                 glBegin(GL_POINTS);
                     glVertex2f(x + w * 0.5f, y + h * 0.5f);
                 glEnd();
             } else if (lang == "Arabic") {
-                glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+                glColor4f(1.0f, 1.0f, 1.0f, opacity);
                 // Arabic text would be rendered here with proper font
-                glPointSize(10.0f);
+                setGLPointSize(10.0f);
                 glBegin(GL_POINTS);
                     glVertex2f(x + w * 0.5f, y + h * 0.5f);
                 glEnd();
             }
             
-            glDisable(GL_BLEND);
         }
+        
+        if (hasImages && scene.widgetImages[i] >= 0) {
+            appendAtlasQuad(scene.images.regions[scene.widgetImages[i]], x, y, w, h, opacity, imageVertices);
+        }
+        }
+        
+        // Widget images: one bind, one draw for the whole layer
+        if (!imageVertices.empty()) {
+            setGLAlphaBlend();
+            setGLTexture2D(true);
+            bindGLTexture(scene.images.texture);
+            glBegin(GL_QUADS);
+            for (size_t v = 0; v + 5 <= imageVertices.size(); v += 5) {
+                glColor4f(1.0f, 1.0f, 1.0f, imageVertices[v + 4]);
+                glTexCoord2f(imageVertices[v + 2], imageVertices[v + 3]);
+                glVertex2f(imageVertices[v], imageVertices[v + 1]);
+            }
+            glEnd();
         }
         
         // Render waveform widget - always rendered in all scenes after loading screen
@@ -759,8 +898,19 @@ void renderScene(const Scene& scene, int windowWidth, int windowHeight, float de
 
 // Render waveform widget - vertical bars showing amplitude values
 // Renders from right to left (newest on right, oldest on left) with bar spacing of 0.006
+// Bars slide left continuously by the snapshot's scroll fraction between audio bars
+// With waveform.history_seconds set, draws the whole window as min/max
+// columns instead (see renderWaveformHistory)
 void renderWaveformWidget(int windowWidth, int windowHeight) {
-    std::vector<float> barHeights = getWaveformAmplitudes();
+    float historySeconds = getConfigFloat("waveform.history_seconds", 0.0f);
+    if (historySeconds > 0.0f) {
+        renderWaveformHistory(windowWidth, windowHeight, historySeconds);
+        renderDeviceNameLabel(windowWidth, windowHeight);
+        return;
+    }
+    
+    WaveformSnapshot waveform = getWaveformSnapshot();
+    const std::vector<float>& barHeights = waveform.heights;
     if (barHeights.empty()) return;
     
     // Waveform positioned at bottom of screen
@@ -774,13 +924,13 @@ void renderWaveformWidget(int windowWidth, int windowHeight) {
     // Fixed bar width per bar - make slightly wider for visibility
     float barWidth = 3.0f; // Fixed 3px width per bar
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     // Draw waveform bars from right to left (newest on right, oldest on left)
     // barHeights[0] is newest, so it goes on the right
     glColor4f(0.2f, 0.8f, 1.0f, 0.8f); // Cyan color
-    float x = windowWidth; // Start from right edge
+    float x = windowWidth - waveform.scroll * (barWidth + barSpacing); // Start from right edge
     
     for (size_t i = 0; i < barHeights.size(); i++) {
         // Calculate bar height from normalized height (0.0 to 1.0)
@@ -806,12 +956,53 @@ void renderWaveformWidget(int windowWidth, int windowHeight) {
         if (x < 0) break;
     }
     
-    glDisable(GL_BLEND);
-    
     // Render device name at bottom right
     renderDeviceNameLabel(windowWidth, windowHeight);
 }
 
+// Render the last historySeconds of capture as one column per 2 px, newest
+// on the right: a bar from the column's peak (max of |min|, |max|) with its
+// RMS drawn brighter inside, normalized to the loudest column on screen.
+// Only one pyramid bin per column is read, whether the window is a minute or an hour
+void renderWaveformHistory(int windowWidth, int windowHeight, float historySeconds) {
+    int columns = std::max(1, windowWidth / 2);
+    WaveformView view;
+    readWaveformHistory(historySeconds, columns, view);
+    if (view.columns.empty()) return;
+    
+    // Columns are whole pyramid bins, so the view may hold a few fewer than
+    // asked; widen them to span the window once history covers it
+    float columnWidth = 2.0f;
+    if (view.seconds >= historySeconds * 0.9) columnWidth = (float)windowWidth / view.columns.size();
+    
+    float loudest = 0.001f; // Keeps silence flat instead of scaling noise up
+    for (const WaveformBin& column : view.columns) {
+        loudest = std::max(loudest, std::max(fabsf(column.min), fabsf(column.max)));
+    }
+    float maxHeight = windowHeight * 0.15f;
+    
+    setGLAlphaBlend();
+    setGLTexture2D(false);
+    glBegin(GL_QUADS);
+    float x = windowWidth - columnWidth * view.columns.size();
+    for (const WaveformBin& column : view.columns) {
+        float peak = std::max(fabsf(column.min), fabsf(column.max)) / loudest * maxHeight;
+        float rms = waveformBinRMS(column) / loudest * maxHeight;
+        glColor4f(0.2f, 0.8f, 1.0f, 0.4f); // Peak envelope
+        glVertex2f(x, 0.0f);
+        glVertex2f(x + columnWidth, 0.0f);
+        glVertex2f(x + columnWidth, peak);
+        glVertex2f(x, peak);
+        glColor4f(0.2f, 0.8f, 1.0f, 0.9f); // RMS body
+        glVertex2f(x, 0.0f);
+        glVertex2f(x + columnWidth, 0.0f);
+        glVertex2f(x + columnWidth, rms);
+        glVertex2f(x, rms);
+        x += columnWidth;
+    }
+    glEnd();
+}
+
 // Render device name label at bottom right
 void renderDeviceNameLabel(int windowWidth, int windowHeight) {
     std::string deviceName = getAudioDeviceName();
@@ -825,8 +1016,8 @@ void renderDeviceNameLabel(int windowWidth, int windowHeight) {
     float labelX = windowWidth - labelWidth - margin;
     float labelY = margin;
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
     
     // Draw semi-transparent background
     glColor4f(0.0f, 0.0f, 0.0f, 0.5f); // Dark background
@@ -849,6 +1040,4 @@ void renderDeviceNameLabel(int windowWidth, int windowHeight) {
         glVertex2f(labelX + labelWidth, labelY + labelHeight);
         glVertex2f(labelX, labelY + labelHeight);
     glEnd();
-    
-    glDisable(GL_BLEND);
 }
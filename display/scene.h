@@ -1,6 +1,8 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include "animation.h"
+#include "atlas.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -29,12 +31,22 @@ struct Scene {
     BackgroundConfig bg;
     std::vector<Widget> widgets;
     bool waveform;  // Show waveform widget (default: true)
+    WidgetAnimations animations;  // Built from the widgets' animate_* fields
+    TextureAtlas images;          // Widgets' "image" files, packed into one page
+    std::vector<int> widgetImages; // Atlas region per widget (-1: no image)
 };
 
 // Scene management
 bool loadScene(const std::string& filename, Scene& scene);
+// Pack the widgets' "image" files into scene.images (no GL; the page uploads on first render)
+void buildSceneImages(Scene& scene);
+// Hex (#rrggbb or rrggbb) or "r,g,b"; dark gray when it cannot be parsed
+void parseColor(const std::string& colorStr, float& r, float& g, float& b);
+// Widget rect in pixels, origin bottom-left, margins applied (at rest; renderScene draws the animated rect)
+void computeWidgetRect(const Scene& scene, const Widget& widget, float cellWidth, float cellHeight, float& x, float& y, float& w, float& h);
 void renderScene(const Scene& scene, int windowWidth, int windowHeight, float deltaTime, int frameCount = 0);
 void renderWaveformWidget(int windowWidth, int windowHeight); // Waveform widget rendering
+void renderWaveformHistory(int windowWidth, int windowHeight, float historySeconds); // Zoomed-out min/max/RMS view
 void renderDeviceNameLabel(int windowWidth, int windowHeight); // Render audio device name at bottom right
 
 #endif // SCENE_H
@@ -0,0 +1,305 @@
+#include "scene_watch.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+static const char* SCENE_SUFFIX = ".scene.json";
+static const char* IDENTITY_PROPERTIES[] = {"id", "scene", "language", "label"};
+
+static std::thread watchThread;
+static std::atomic<bool> watchStop(false);
+static std::atomic<bool> watchRunning(false);
+static std::atomic<bool> usingInotify(false);
+static std::string watchDirectory;
+static SceneWatchMode watchMode = SceneWatchMode::AUTO;
+static int watchPollMs = 250;
+
+static std::mutex updatesMutex;
+static std::map<std::string, Scene> updates; // Latest parse per path
+
+// Stable key for a widget across edits: type plus an identifying property,
+// numbered when several widgets share it
+static std::vector<std::string> widgetKeys(const Scene& scene) {
+    std::vector<std::string> keys;
+    std::map<std::string, int> seen;
+    for (const Widget& widget : scene.widgets) {
+        std::string base = widget.type;
+        for (const char* property : IDENTITY_PROPERTIES) {
+            auto found = widget.properties.find(property);
+            if (found != widget.properties.end()) {
+                base += std::string("|") + property + "=" + found->second;
+                break;
+            }
+        }
+        keys.push_back(base + "#" + std::to_string(seen[base]++));
+    }
+    return keys;
+}
+
+static bool samePlacement(const Widget& a, const Widget& b) {
+    return a.row == b.row && a.col == b.col && a.width == b.width && a.height == b.height && a.margin == b.margin;
+}
+
+SceneDiff diffScenes(const Scene& live, const Scene& updated) {
+    SceneDiff diff;
+    diff.gridChanged = live.layout != updated.layout || live.cols != updated.cols || live.rows != updated.rows;
+    diff.backgroundChanged = live.bg.image != updated.bg.image || live.bg.color != updated.bg.color ||
+                             live.bg.graphic != updated.bg.graphic;
+    diff.optionsChanged = live.id != updated.id || live.waveform != updated.waveform;
+
+    std::vector<std::string> liveKeys = widgetKeys(live);
+    std::vector<std::string> updatedKeys = widgetKeys(updated);
+    std::map<std::string, int> liveIndex;
+    for (size_t i = 0; i < liveKeys.size(); i++) liveIndex[liveKeys[i]] = (int)i;
+
+    std::vector<bool> kept(live.widgets.size(), false);
+    int lastLive = -1;
+    for (size_t i = 0; i < updatedKeys.size(); i++) {
+        auto found = liveIndex.find(updatedKeys[i]);
+        if (found == liveIndex.end()) {
+            diff.added.push_back((int)i);
+            continue;
+        }
+        int index = found->second;
+        kept[index] = true;
+        if (index < lastLive) diff.reordered = true;
+        lastLive = index;
+        const Widget& before = live.widgets[index];
+        const Widget& after = updated.widgets[i];
+        if (!samePlacement(before, after)) {
+            diff.moved.push_back(WidgetMatch{index, (int)i});
+        } else if (before.properties != after.properties) {
+            diff.changed.push_back(WidgetMatch{index, (int)i});
+        }
+    }
+    for (size_t i = 0; i < kept.size(); i++) {
+        if (!kept[i]) diff.removed.push_back((int)i);
+    }
+    return diff;
+}
+
+bool isSceneDiffEmpty(const SceneDiff& diff) {
+    return !diff.gridChanged && !diff.backgroundChanged && !diff.optionsChanged && !diff.reordered &&
+           diff.added.empty() && diff.removed.empty() && diff.moved.empty() && diff.changed.empty();
+}
+
+bool sceneDiffMovesWidgets(const SceneDiff& diff) {
+    return diff.gridChanged || diff.reordered || !diff.added.empty() || !diff.removed.empty() || !diff.moved.empty();
+}
+
+void applySceneDiff(Scene& live, const Scene& updated, const SceneDiff& diff) {
+    if (diff.gridChanged) {
+        live.layout = updated.layout;
+        live.cols = updated.cols;
+        live.rows = updated.rows;
+    }
+    if (diff.backgroundChanged) live.bg = updated.bg;
+    if (diff.optionsChanged) {
+        live.id = updated.id;
+        live.waveform = updated.waveform;
+    }
+    bool indicesShift = diff.reordered || !diff.added.empty() || !diff.removed.empty();
+    if (indicesShift) {
+        // Indices shift: take the new list whole
+        live.widgets = updated.widgets;
+    } else {
+        for (const WidgetMatch& match : diff.moved) live.widgets[match.liveIndex] = updated.widgets[match.updatedIndex];
+        for (const WidgetMatch& match : diff.changed) live.widgets[match.liveIndex] = updated.widgets[match.updatedIndex];
+    }
+    // Edited widgets replay their animations from the start
+    if (indicesShift || !diff.moved.empty() || !diff.changed.empty()) {
+        buildWidgetAnimations(live.widgets, live.animations);
+        // Images were packed when the edited file loaded; refill the live page's texture with them
+        unsigned int texture = live.images.texture;
+        live.images = updated.images;
+        live.images.texture = texture;
+        live.images.dirty = true;
+        live.widgetImages = updated.widgetImages;
+    }
+}
+
+static bool isSceneFile(const std::string& name) {
+    size_t suffix = std::string(SCENE_SUFFIX).size();
+    return name.size() > suffix && name.compare(name.size() - suffix, suffix, SCENE_SUFFIX) == 0;
+}
+
+static std::vector<std::string> listSceneFiles(const std::string& directory) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((directory + "\\*" + SCENE_SUFFIX).c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE) return names;
+    do {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) names.push_back(entry.cFileName);
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (isSceneFile(entry->d_name)) names.push_back(entry->d_name);
+    }
+    closedir(dir);
+#endif
+    return names;
+}
+
+// Modification time (as fine as the platform reports) and size; false if gone
+static bool fileSignature(const std::string& path, long long& mtime, long long& size) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return false;
+#ifdef __linux__
+    mtime = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#else
+    mtime = (long long)info.st_mtime;
+#endif
+    size = (long long)info.st_size;
+    return true;
+}
+
+static void parseChangedScene(const std::string& name) {
+    std::string path = watchDirectory + "/" + name;
+    Scene scene;
+    if (!loadScene(path, scene)) {
+        std::cerr << "[WARNING] Scene watch: " << path << " did not parse, keeping the live scene" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(updatesMutex);
+    updates[path] = scene;
+}
+
+struct PolledFile {
+    long long mtime;
+    long long size;
+    bool pending;   // Changed at the last poll; parsed once it holds still
+};
+
+static void pollLoop() {
+    std::map<std::string, PolledFile> files;
+    for (const std::string& name : listSceneFiles(watchDirectory)) {
+        PolledFile file{0, 0, false};
+        fileSignature(watchDirectory + "/" + name, file.mtime, file.size);
+        files[name] = file;
+    }
+    while (!watchStop.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(watchPollMs));
+        for (const std::string& name : listSceneFiles(watchDirectory)) {
+            long long mtime = 0, size = 0;
+            if (!fileSignature(watchDirectory + "/" + name, mtime, size)) continue;
+            auto found = files.find(name);
+            if (found == files.end()) {
+                files[name] = PolledFile{mtime, size, true};
+            } else if (found->second.mtime != mtime || found->second.size != size) {
+                found->second = PolledFile{mtime, size, true};
+            } else if (found->second.pending) {
+                found->second.pending = false;
+                parseChangedScene(name);
+            }
+        }
+    }
+}
+
+#ifdef __linux__
+// False if inotify is unavailable (the caller falls back to polling)
+static bool inotifyLoop() {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    // Editors either rewrite in place (close after write) or rename a temp file over it
+    if (inotify_add_watch(fd, watchDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(fd);
+        return false;
+    }
+    usingInotify = true;
+    alignas(struct inotify_event) char buffer[4096];
+    while (!watchStop.load()) {
+        struct pollfd ready = {fd, POLLIN, 0};
+        if (poll(&ready, 1, 100) <= 0) continue;
+        std::set<std::string> changed;
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + length;) {
+                struct inotify_event* event = (struct inotify_event*)at;
+                if (event->len > 0 && isSceneFile(event->name)) changed.insert(event->name);
+                at += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        for (const std::string& name : changed) parseChangedScene(name);
+    }
+    close(fd);
+    return true;
+}
+#endif
+
+static void watchLoop() {
+#ifdef __linux__
+    if (watchMode == SceneWatchMode::AUTO && inotifyLoop()) return;
+    if (watchMode == SceneWatchMode::AUTO) {
+        std::cerr << "[WARNING] Scene watch: inotify unavailable, polling every " << watchPollMs << " ms" << std::endl;
+    }
+#endif
+    pollLoop();
+}
+
+bool startSceneWatcher(const std::string& directory, SceneWatchMode mode, int pollMs) {
+    if (watchRunning.load()) return true;
+    struct stat info;
+    if (stat(directory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)) {
+        std::cerr << "[WARNING] Scene watch: " << directory << " is not a directory" << std::endl;
+        return false;
+    }
+    watchDirectory = directory;
+    watchMode = mode;
+    watchPollMs = pollMs > 0 ? pollMs : 250;
+    watchStop = false;
+    usingInotify = false;
+    try {
+        watchThread = std::thread(watchLoop);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Scene watch: Failed to start thread: " << e.what() << std::endl;
+        return false;
+    }
+    watchRunning = true;
+    std::cout << "[DEBUG] Scene watch: Watching " << directory << std::endl;
+    return true;
+}
+
+void stopSceneWatcher() {
+    if (!watchRunning.load()) return;
+    watchStop = true;
+    if (watchThread.joinable()) watchThread.join();
+    watchRunning = false;
+    usingInotify = false;
+    std::lock_guard<std::mutex> lock(updatesMutex);
+    updates.clear();
+}
+
+bool isSceneWatcherUsingInotify() {
+    return usingInotify.load();
+}
+
+bool takeSceneUpdate(std::string& path, Scene& scene) {
+    std::lock_guard<std::mutex> lock(updatesMutex);
+    if (updates.empty()) return false;
+    auto next = updates.begin();
+    path = next->first;
+    scene = std::move(next->second);
+    updates.erase(next);
+    return true;
+}
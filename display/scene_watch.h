@@ -0,0 +1,58 @@
+#ifndef SCENE_WATCH_H
+#define SCENE_WATCH_H
+
+#include "scene.h"
+#include <string>
+#include <vector>
+
+// Scene hot reload
+// A watcher thread follows the scenes directory (inotify on Linux, polling
+// stat() elsewhere or when inotify is unavailable) and re-parses a
+// *.scene.json file when it changes, off the render thread. The main thread
+// takes the parsed scenes once per frame, diffs each against the live copy
+// and patches only what changed, so caches keyed on untouched parts (the hit
+// index, background particles) survive the edit.
+//
+// Widgets are matched between versions by type plus their first identifying
+// property (id, scene, language or label), falling back to their order
+// among widgets of the same type.
+
+enum class SceneWatchMode {
+    AUTO,   // inotify where available, otherwise polling
+    POLL,   // Always poll (network shares, containers without inotify)
+};
+
+struct WidgetMatch {
+    int liveIndex;      // Index in the live scene
+    int updatedIndex;   // Index in the re-parsed scene
+};
+
+struct SceneDiff {
+    bool gridChanged = false;        // layout, cols or rows: every widget rect moves
+    bool backgroundChanged = false;  // bg image, color or graphic
+    bool optionsChanged = false;     // id or waveform
+    bool reordered = false;          // Kept widgets in a new order (changes stacking)
+    std::vector<int> added;          // Updated-scene indices of new widgets
+    std::vector<int> removed;        // Live-scene indices of widgets now gone
+    std::vector<WidgetMatch> moved;    // Same widget, new row/col/size/margin
+    std::vector<WidgetMatch> changed;  // Same widget, new properties only
+};
+
+SceneDiff diffScenes(const Scene& live, const Scene& updated);
+bool isSceneDiffEmpty(const SceneDiff& diff);
+// True when widget rects or stacking changed (hit indexes must be rebuilt)
+bool sceneDiffMovesWidgets(const SceneDiff& diff);
+// Patch live into updated, touching only the parts the diff names
+void applySceneDiff(Scene& live, const Scene& updated, const SceneDiff& diff);
+
+// pollMs: polling interval, and how long a polled file must stay unchanged
+// before it is parsed (so a half-written file is not picked up)
+bool startSceneWatcher(const std::string& directory, SceneWatchMode mode = SceneWatchMode::AUTO, int pollMs = 250);
+void stopSceneWatcher();
+bool isSceneWatcherUsingInotify();
+
+// Next re-parsed scene, as "<directory>/<file>"; the latest parse wins when
+// a file changed several times since the last call
+bool takeSceneUpdate(std::string& path, Scene& scene);
+
+#endif // SCENE_WATCH_H
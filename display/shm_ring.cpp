@@ -0,0 +1,384 @@
+#include "shm_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Segment layout: RingHeader padded to HEADER_BYTES, then capacity PCM16 samples
+// Sample at ring position p lives at samples[p & (capacity - 1)].
+// Each run of contiguous session audio starts with a mark; the newest
+// SESSION_MARKS are kept, enough to label everything a reader can still reach.
+static const int SESSION_MARKS = 16;
+
+struct SessionMark {
+    std::atomic<uint64_t> sessionId;
+    std::atomic<uint64_t> startCursor;     // Ring position of the run's first sample
+    std::atomic<uint64_t> startClock;      // Its session capture clock
+};
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t capacity;
+    uint64_t instance;                     // Random per writer run
+    std::atomic<uint64_t> sequence;        // Odd while the fields below are being updated
+    std::atomic<uint64_t> writeCursor;     // Samples ever published
+    std::atomic<uint64_t> reserveCursor;   // Set before samples are copied in (readers check for overwrites)
+    std::atomic<uint64_t> sampleClock;     // Session capture clock at writeCursor
+    std::atomic<uint64_t> markCount;       // Marks ever written
+    std::atomic<uint32_t> writerAlive;
+    SessionMark marks[SESSION_MARKS];      // Mark n lives at marks[n % SESSION_MARKS]
+};
+
+static const uint32_t RING_MAGIC = 0x4154444E; // "NDTA"
+static const uint32_t RING_VERSION = 1;
+static const size_t HEADER_BYTES = 512;
+static_assert(sizeof(RingHeader) <= HEADER_BYTES, "ring header outgrew its slot");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+static std::string segmentName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return "/" + name;
+#endif
+}
+
+// Map a segment of the given size (create: make or reuse it; otherwise it must exist, size from the segment)
+static bool mapSegment(const std::string& name, bool create, size_t& bytes, void*& view, void*& handle) {
+    std::string path = segmentName(name);
+#ifdef _WIN32
+    HANDLE mapping;
+    if (create) {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32),
+                                     (DWORD)(bytes & 0xFFFFFFFF), path.c_str());
+    } else {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+    }
+    if (!mapping) return false;
+    view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, create ? bytes : 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    if (!create) {
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(view, &info, sizeof(info));
+        bytes = info.RegionSize;
+    }
+    handle = mapping;
+    return true;
+#else
+    int fd = shm_open(path.c_str(), create ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0) return false;
+    struct stat info;
+    if (create) {
+        if (ftruncate(fd, (off_t)bytes) != 0) {
+            close(fd);
+            return false;
+        }
+    } else if (fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_BYTES) {
+        close(fd);
+        return false;
+    } else {
+        bytes = (size_t)info.st_size;
+    }
+    view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the segment alive
+    if (view == MAP_FAILED) {
+        view = nullptr;
+        return false;
+    }
+    handle = nullptr;
+    return true;
+#endif
+}
+
+static void unmapSegment(void* view, size_t bytes, void* handle) {
+    if (!view) return;
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(view);
+    if (handle) CloseHandle((HANDLE)handle);
+#else
+    (void)handle;
+    munmap(view, bytes);
+#endif
+}
+
+static short* ringSamples(void* view) {
+    return (short*)((char*)view + HEADER_BYTES);
+}
+
+// ---- Writer ----
+
+static std::mutex exportMutex; // Guards start/stop against publish and the stats
+static std::string exportName;
+static void* exportView = nullptr;
+static void* exportHandle = nullptr;
+static size_t exportBytes = 0;
+static RingHeader* header = nullptr;
+static uint64_t lastSessionId = 0;
+static uint64_t lastSessionClock = 0;
+static SharedAudioExportStats exportStats;
+
+bool startSharedAudioExport(const std::string& name, int sampleRate, uint32_t capacitySamples) {
+    stopSharedAudioExport();
+    uint32_t capacity = 4096;
+    while (capacity < capacitySamples && capacity < (1u << 30)) capacity <<= 1;
+
+    std::lock_guard<std::mutex> lock(exportMutex);
+    size_t bytes = HEADER_BYTES + (size_t)capacity * sizeof(short);
+    if (name.empty() || sampleRate <= 0 || !mapSegment(name, true, bytes, exportView, exportHandle)) {
+        std::cerr << "[ERROR] SharedAudio: Cannot create segment \"" << name << "\"" << std::endl;
+        return false;
+    }
+    exportName = name;
+    exportBytes = bytes;
+    header = (RingHeader*)exportView;
+
+    // A segment left by a crashed run may still have readers attached: reinitialize under the sequence
+    uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = RING_MAGIC;
+    header->version = RING_VERSION;
+    header->sampleRate = (uint32_t)sampleRate;
+    header->capacity = capacity;
+    uint64_t instance = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^ ((uint64_t)(uintptr_t)exportView << 16);
+    instance = (instance ^ (instance >> 30)) * 0xbf58476d1ce4e5b9ull;
+    header->instance = instance ^ (instance >> 31);
+    header->writeCursor.store(0, std::memory_order_relaxed);
+    header->reserveCursor.store(0, std::memory_order_relaxed);
+    header->sampleClock.store(0, std::memory_order_relaxed);
+    header->markCount.store(0, std::memory_order_relaxed);
+    header->writerAlive.store(1, std::memory_order_relaxed);
+    header->sequence.store((sequence | 1) + 1, std::memory_order_release);
+
+    lastSessionId = 0;
+    lastSessionClock = 0;
+    exportStats = SharedAudioExportStats();
+    std::cout << "[DEBUG] SharedAudio: Exporting capture to \"" << name << "\" (" << capacity << " samples at "
+              << sampleRate << " Hz)" << std::endl;
+    return true;
+}
+
+void stopSharedAudioExport() {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    if (!header) return;
+    header->writerAlive.store(0, std::memory_order_release);
+    unmapSegment(exportView, exportBytes, exportHandle);
+#ifndef _WIN32
+    shm_unlink(segmentName(exportName).c_str()); // Attached readers keep their mapping until they close it
+#endif
+    header = nullptr;
+    exportView = nullptr;
+    exportHandle = nullptr;
+}
+
+bool isSharedAudioExporting() {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    return header != nullptr;
+}
+
+void publishSharedAudio(const short* samples, size_t count, uint64_t sessionId, uint64_t sessionClock) {
+    std::lock_guard<std::mutex> lock(exportMutex); // Uncontended: start/stop only
+    if (!header || !samples || count == 0 || sessionId == 0) return;
+    auto start = std::chrono::steady_clock::now();
+
+    // The session may have taken only the start of the block (listen window closed)
+    bool newSession = sessionId != lastSessionId;
+    uint64_t previousClock = newSession ? 0 : lastSessionClock;
+    size_t taken = (size_t)std::min<uint64_t>(count, sessionClock > previousClock ? sessionClock - previousClock : 0);
+    // A new session, or audio the export did not see (it started mid-session), starts a new run
+    bool newRun = newSession || sessionClock - previousClock > count;
+    lastSessionId = sessionId;
+    lastSessionClock = sessionClock;
+    if (taken == 0) return;
+
+    const uint32_t capacity = header->capacity;
+    const uint64_t mask = capacity - 1;
+    uint64_t cursor = header->writeCursor.load(std::memory_order_relaxed);
+    uint64_t end = cursor + taken;
+    header->reserveCursor.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Only the newest capacity samples of an oversized block can survive
+    size_t skip = taken > capacity ? taken - capacity : 0;
+    short* ring = ringSamples(exportView);
+    for (uint64_t position = cursor + skip; position < end;) {
+        size_t index = (size_t)(position & mask);
+        size_t run = (size_t)std::min<uint64_t>(end - position, capacity - index);
+        memcpy(ring + index, samples + (position - cursor), run * sizeof(short));
+        position += run;
+    }
+
+    uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (newRun) {
+        uint64_t mark = header->markCount.load(std::memory_order_relaxed);
+        SessionMark& slot = header->marks[mark % SESSION_MARKS];
+        slot.sessionId.store(sessionId, std::memory_order_relaxed);
+        slot.startCursor.store(cursor, std::memory_order_relaxed);
+        slot.startClock.store(sessionClock - taken, std::memory_order_relaxed);
+        header->markCount.store(mark + 1, std::memory_order_relaxed);
+    }
+    if (newSession) {
+        exportStats.sessions++;
+    }
+    header->sampleClock.store(sessionClock, std::memory_order_relaxed);
+    header->writeCursor.store(end, std::memory_order_relaxed);
+    header->sequence.store(sequence + 2, std::memory_order_release);
+
+    exportStats.publishedSamples += taken;
+    exportStats.publishes++;
+    exportStats.publishUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+SharedAudioExportStats getSharedAudioExportStats() {
+    std::lock_guard<std::mutex> lock(exportMutex);
+    return exportStats;
+}
+
+// ---- Reader ----
+
+struct RingSnapshot {
+    uint64_t instance;
+    uint32_t capacity;
+    uint64_t writeCursor;
+    uint64_t markCount;
+    uint64_t markSession[SESSION_MARKS];
+    uint64_t markCursor[SESSION_MARKS];
+    uint64_t markClock[SESSION_MARKS];
+};
+
+static bool takeSnapshot(const RingHeader* ring, RingSnapshot& snapshot) {
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint64_t before = ring->sequence.load(std::memory_order_acquire);
+        if (before & 1) continue; // Writer mid-update
+        snapshot.instance = ring->instance;
+        snapshot.capacity = ring->capacity;
+        snapshot.writeCursor = ring->writeCursor.load(std::memory_order_relaxed);
+        snapshot.markCount = ring->markCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < SESSION_MARKS; i++) {
+            snapshot.markSession[i] = ring->marks[i].sessionId.load(std::memory_order_relaxed);
+            snapshot.markCursor[i] = ring->marks[i].startCursor.load(std::memory_order_relaxed);
+            snapshot.markClock[i] = ring->marks[i].startClock.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->sequence.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+bool openSharedAudio(SharedAudioReader& reader, const std::string& name) {
+    closeSharedAudio(reader);
+    size_t bytes = 0;
+    if (!mapSegment(name, false, bytes, reader.view, reader.handle)) {
+        return false;
+    }
+    const RingHeader* ring = (const RingHeader*)reader.view;
+    RingSnapshot snapshot;
+    if (ring->magic != RING_MAGIC || ring->version != RING_VERSION || !takeSnapshot(ring, snapshot) ||
+        bytes < HEADER_BYTES + (size_t)snapshot.capacity * sizeof(short)) {
+        unmapSegment(reader.view, bytes, reader.handle);
+        reader.view = nullptr;
+        reader.handle = nullptr;
+        return false;
+    }
+    reader.viewBytes = bytes;
+    reader.capacity = snapshot.capacity;
+    reader.sampleRate = (int)ring->sampleRate;
+    reader.instance = snapshot.instance;
+    reader.readCursor = snapshot.writeCursor; // Start at the writer's current position
+    return true;
+}
+
+void closeSharedAudio(SharedAudioReader& reader) {
+    unmapSegment(reader.view, reader.viewBytes, reader.handle);
+    reader = SharedAudioReader();
+}
+
+bool isSharedAudioWriterAlive(const SharedAudioReader& reader) {
+    if (!reader.view) return false;
+    const RingHeader* ring = (const RingHeader*)reader.view;
+    return ring->writerAlive.load(std::memory_order_acquire) != 0 && ring->capacity == reader.capacity;
+}
+
+bool readSharedAudio(SharedAudioReader& reader, SharedAudioBlock& block, size_t maxSamples) {
+    block.samples.clear();
+    block.droppedSamples = 0;
+    if (!reader.view || maxSamples == 0) return false;
+    const RingHeader* ring = (const RingHeader*)reader.view;
+    RingSnapshot snapshot;
+    if (!takeSnapshot(ring, snapshot) || snapshot.capacity != reader.capacity) {
+        return false;
+    }
+    if (snapshot.instance != reader.instance || snapshot.writeCursor < reader.readCursor) {
+        reader.instance = snapshot.instance; // The writer restarted
+        reader.readCursor = snapshot.writeCursor;
+        return false;
+    }
+    if (snapshot.writeCursor == reader.readCursor) {
+        return false;
+    }
+
+    // Lapped: skip to the oldest sample still in the ring (and still labelled)
+    uint64_t oldest = snapshot.writeCursor > reader.capacity ? snapshot.writeCursor - reader.capacity : 0;
+    uint64_t firstMark = snapshot.markCount > SESSION_MARKS ? snapshot.markCount - SESSION_MARKS : 0;
+    if (snapshot.markCount > 0) {
+        oldest = std::max(oldest, snapshot.markCursor[firstMark % SESSION_MARKS]);
+    }
+    if (reader.readCursor < oldest) {
+        block.droppedSamples = oldest - reader.readCursor;
+        reader.readCursor = oldest;
+    }
+    // The run holding readCursor: the newest mark at or before it
+    uint64_t mark = snapshot.markCount;
+    while (mark > firstMark && snapshot.markCursor[(mark - 1) % SESSION_MARKS] > reader.readCursor) {
+        mark--;
+    }
+    if (mark == firstMark) {
+        return block.droppedSamples > 0; // Nothing labelled to read yet
+    }
+    int slot = (int)((mark - 1) % SESSION_MARKS);
+    uint64_t end = mark < snapshot.markCount ? snapshot.markCursor[mark % SESSION_MARKS] : snapshot.writeCursor;
+    size_t count = (size_t)std::min<uint64_t>(end - reader.readCursor, maxSamples);
+
+    const short* samples = ringSamples(reader.view);
+    const uint64_t mask = reader.capacity - 1;
+    block.samples.resize(count);
+    for (size_t done = 0; done < count;) {
+        size_t index = (size_t)((reader.readCursor + done) & mask);
+        size_t run = std::min(count - done, (size_t)(reader.capacity - index));
+        memcpy(block.samples.data() + done, samples + index, run * sizeof(short));
+        done += run;
+    }
+
+    // Anything the writer began overwriting during the copy is discarded
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t reserve = ring->reserveCursor.load(std::memory_order_relaxed);
+    uint64_t overwritten = reserve > reader.capacity ? reserve - reader.capacity : 0;
+    size_t torn = overwritten > reader.readCursor ? (size_t)std::min<uint64_t>(count, overwritten - reader.readCursor) : 0;
+    block.samples.erase(block.samples.begin(), block.samples.begin() + torn);
+    block.droppedSamples += torn;
+
+    block.sessionId = snapshot.markSession[slot];
+    block.sampleClock = snapshot.markClock[slot] + (reader.readCursor + torn - snapshot.markCursor[slot]);
+    block.sampleRate = reader.sampleRate;
+    reader.readCursor += count;
+    return !block.samples.empty() || block.droppedSamples > 0;
+}
@@ -0,0 +1,68 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shared-memory capture ring for the out-of-process STT sidecar
+// The display publishes the audio its STT sessions admit into a named
+// segment (POSIX shm_open, a pagefile-backed file mapping on Windows):
+// a fixed header followed by a power-of-two ring of PCM16 samples. The
+// header is lock-free: a single writer updates write cursor, sample clock
+// and the session marks (where each session's audio starts in the ring)
+// under a sequence counter (odd while an update is in progress), so readers
+// take a consistent snapshot without ever blocking the capture thread.
+// Readers detect being lapped from the cursor alone.
+
+struct SharedAudioExportStats {
+    uint64_t publishedSamples;
+    uint64_t publishes;
+    uint64_t sessions;          // Distinct sessions published
+    double publishUs;           // Total time spent publishing (capture thread)
+};
+
+// Writer (display process)
+bool startSharedAudioExport(const std::string& name, int sampleRate, uint32_t capacitySamples = 1u << 20);
+void stopSharedAudioExport(); // Marks the segment closed and removes its name
+bool isSharedAudioExporting();
+
+// Capture thread: publish a block that was appended to STT session sessionId,
+// whose capture clock is sessionClock after the append. Only the samples the
+// session actually took (it may stop part-way through a block) are published.
+void publishSharedAudio(const short* samples, size_t count, uint64_t sessionId, uint64_t sessionClock);
+
+SharedAudioExportStats getSharedAudioExportStats();
+
+// Reader (sidecar)
+struct SharedAudioReader {
+    void* view = nullptr;
+    size_t viewBytes = 0;
+    void* handle = nullptr;      // Windows mapping handle
+    uint64_t instance = 0;       // Writer run the positions below refer to
+    uint32_t capacity = 0;
+    int sampleRate = 0;
+    uint64_t readCursor = 0;     // Next ring position to read
+};
+
+struct SharedAudioBlock {
+    uint64_t sessionId = 0;
+    uint64_t sampleClock = 0;    // Capture clock of samples[0] within the session
+    uint64_t droppedSamples = 0; // Overwritten before they could be read (reader too slow)
+    int sampleRate = 0;
+    std::vector<short> samples;
+};
+
+// Opens an existing segment and starts reading at its current write cursor
+bool openSharedAudio(SharedAudioReader& reader, const std::string& name);
+void closeSharedAudio(SharedAudioReader& reader);
+
+// Next run of unread samples from a single session, up to maxSamples
+// Returns false when nothing new has been published
+bool readSharedAudio(SharedAudioReader& reader, SharedAudioBlock& block, size_t maxSamples);
+
+// False once the writer stopped the export (the sidecar should reopen)
+bool isSharedAudioWriterAlive(const SharedAudioReader& reader);
+
+#endif // SHM_RING_H
@@ -0,0 +1,191 @@
+#include "sidecar_pump.h"
+#include "shm_ring.h"
+#include "resample.h"
+#include "stt_session.h"
+#include "stt_spool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+static const size_t READ_BLOCK_SAMPLES = 8192;
+
+static SidecarPumpConfig pumpConfig;
+static bool pumpStarted = false;
+static SharedAudioReader reader;
+static Resampler resampler;
+static std::chrono::steady_clock::time_point lastOpenAttempt;
+static std::chrono::steady_clock::time_point lastAudio;
+
+// Session being uploaded (0: none)
+static uint64_t currentSession = 0;
+static uint64_t nextClock = 0;         // Capture clock expected from the next block
+static uint64_t pendingStart = 0;      // Upload-rate clock of pending[0]
+static std::vector<short> pending;     // Resampled audio not uploaded yet
+static std::vector<short> context;     // Tail of the previous chunk, repeated in the next
+static size_t chunkSamples = 0;
+static size_t contextSamples = 0;
+
+static std::mutex statsMutex;
+static SidecarPumpStats pumpStats;
+
+// Queue pending[0, count) with the context overlap in front of it
+static void uploadChunk(size_t count) {
+    STTChunkInfo info;
+    info.sessionId = currentSession;
+    info.sampleOffset = pendingStart - context.size();
+    info.contextSamples = (uint32_t)context.size();
+    std::vector<short> samples;
+    samples.reserve(context.size() + count);
+    samples.insert(samples.end(), context.begin(), context.end());
+    samples.insert(samples.end(), pending.begin(), pending.begin() + count);
+    if (!enqueueSTTUpload(samples, pumpConfig.uploadRate, &info)) {
+        std::cerr << "[WARNING] Sidecar: STT spool not running, dropping " << samples.size() << " samples" << std::endl;
+    }
+
+    size_t keep = std::min(contextSamples, samples.size());
+    context.assign(samples.end() - keep, samples.end());
+    pending.erase(pending.begin(), pending.begin() + count);
+    pendingStart += count;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pumpStats.chunks++;
+}
+
+// Start a contiguous run of the session at capture clock `clock`
+static void beginRun(uint64_t clock) {
+    resetResampler(resampler);
+    pending.clear();
+    context.clear(); // Audio before a gap does not lead into this run
+    pendingStart = (clock * (uint64_t)pumpConfig.uploadRate + (uint64_t)resampler.inRate / 2) / (uint64_t)resampler.inRate;
+    nextClock = clock;
+}
+
+static void finishRun() {
+    size_t before = pending.size();
+    flushResampler(resampler, pending);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        pumpStats.uploadSamples += pending.size() - before;
+    }
+    if (!pending.empty()) {
+        uploadChunk(pending.size());
+    }
+    context.clear();
+}
+
+static void finishSession() {
+    if (currentSession == 0) return;
+    finishRun();
+    std::cout << "[DEBUG] Sidecar: Session " << currentSession << " uploaded" << std::endl;
+    currentSession = 0;
+}
+
+// Let go of the ring once the display stopped exporting
+static void detach() {
+    finishSession();
+    closeSharedAudio(reader);
+    std::cout << "[DEBUG] Sidecar: Display stopped exporting audio" << std::endl;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pumpStats.attached = false;
+}
+
+// Attach to the ring (again) once the display exports it
+static void attach() {
+    auto now = std::chrono::steady_clock::now();
+    if (reader.view || now - lastOpenAttempt < std::chrono::milliseconds(pumpConfig.reopenMs)) return;
+    lastOpenAttempt = now;
+    if (!openSharedAudio(reader, pumpConfig.shmName)) return;
+    if (!isSharedAudioWriterAlive(reader) ||
+        (resampler.inRate != reader.sampleRate && !initResampler(resampler, reader.sampleRate, pumpConfig.uploadRate))) {
+        closeSharedAudio(reader);
+        return;
+    }
+    std::cout << "[DEBUG] Sidecar: Attached to \"" << pumpConfig.shmName << "\" (" << reader.sampleRate
+              << " Hz, uploading at " << pumpConfig.uploadRate << " Hz)" << std::endl;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pumpStats.attached = true;
+}
+
+bool startSidecarPump(const SidecarPumpConfig& config) {
+    stopSidecarPump();
+    if (config.uploadRate <= 0 || config.chunkMs <= 0 || config.shmName.empty()) {
+        return false;
+    }
+    pumpConfig = config;
+    chunkSamples = (size_t)std::max<int64_t>(1, (int64_t)config.chunkMs * config.uploadRate / 1000);
+    contextSamples = (size_t)std::max(0, (int)((int64_t)config.contextMs * config.uploadRate / 1000));
+    resampler = Resampler();
+    currentSession = 0;
+    lastOpenAttempt = std::chrono::steady_clock::time_point();
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        pumpStats = SidecarPumpStats();
+    }
+    pumpStarted = true;
+    attach();
+    return true;
+}
+
+void stopSidecarPump() {
+    if (!pumpStarted) return;
+    finishSession();
+    closeSharedAudio(reader);
+    pumpStarted = false;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pumpStats.attached = false;
+}
+
+size_t runSidecarPump() {
+    if (!pumpStarted) return 0;
+    attach();
+    if (!reader.view) return 0;
+    // Checked before reading: the display publishes its last block before it stops
+    bool writerAlive = isSharedAudioWriterAlive(reader);
+
+    size_t consumed = 0;
+    SharedAudioBlock block;
+    while (readSharedAudio(reader, block, READ_BLOCK_SAMPLES)) {
+        if (block.sessionId != currentSession) {
+            finishSession();
+            currentSession = block.sessionId;
+            beginRun(block.sampleClock);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            pumpStats.sessions++;
+        } else if (block.sampleClock != nextClock) {
+            finishRun(); // Lapped: the server sees the gap in the offsets
+            beginRun(block.sampleClock);
+        }
+
+        size_t before = pending.size();
+        resample(resampler, block.samples.data(), block.samples.size(), pending);
+        size_t produced = pending.size() - before;
+        nextClock = block.sampleClock + block.samples.size();
+        while (pending.size() >= chunkSamples) {
+            uploadChunk(chunkSamples);
+        }
+        consumed += block.samples.size();
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        pumpStats.readSamples += block.samples.size();
+        pumpStats.droppedSamples += block.droppedSamples;
+        pumpStats.uploadSamples += produced;
+    }
+
+    if (!writerAlive) {
+        detach();
+        return consumed;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (consumed > 0) {
+        lastAudio = now;
+    } else if (currentSession != 0 && now - lastAudio >= std::chrono::milliseconds(pumpConfig.idleFlushMs)) {
+        finishSession(); // The display ended the session (or is between listen windows)
+    }
+    return consumed;
+}
+
+SidecarPumpStats getSidecarPumpStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return pumpStats;
+}
@@ -0,0 +1,42 @@
+#ifndef SIDECAR_PUMP_H
+#define SIDECAR_PUMP_H
+
+#include <cstdint>
+#include <string>
+
+// STT sidecar: moves audio from the display's shared-memory ring (see
+// shm_ring.h) to the STT servers, outside the display process. Each session
+// published by the display is resampled to the upload rate and cut into
+// chunks the way stt_session cuts them (new audio plus a context overlap,
+// tagged with the session id and the offset of the first sample at the
+// upload rate), which go to the disk spool for upload. The pump follows the
+// display across restarts by reopening the ring.
+
+struct SidecarPumpConfig {
+    std::string shmName = "ndt_audio";
+    int uploadRate = 16000;     // Whisper's native rate; the spool encodes WAV at this rate
+    int chunkMs = 3000;
+    int contextMs = 250;
+    int idleFlushMs = 500;      // Upload a session's tail after this long without new audio
+    int reopenMs = 500;         // Retry interval while the display is not exporting
+};
+
+struct SidecarPumpStats {
+    bool attached;              // Ring open and its writer alive
+    uint64_t readSamples;       // Samples taken from the ring (capture rate)
+    uint64_t droppedSamples;    // Overwritten before the pump read them
+    uint64_t uploadSamples;     // Samples after resampling
+    uint64_t chunks;            // Chunks handed to the spool
+    uint64_t sessions;
+};
+
+bool startSidecarPump(const SidecarPumpConfig& config); // Opens the ring when it exists
+void stopSidecarPump();         // Uploads the pending tail
+
+// One pass: read everything published, queue complete chunks, flush idle
+// sessions. Returns the number of ring samples consumed (0: nothing new).
+size_t runSidecarPump();
+
+SidecarPumpStats getSidecarPumpStats();
+
+#endif // SIDECAR_PUMP_H
@@ -0,0 +1,488 @@
+#include "snapshot.h"
+#include "jobs.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>  // For FILE, fopen, fwrite, rename
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#include <sys/stat.h>
+#else
+#include <GL/gl.h>
+#include <GL/glx.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+// Buffer object (GL 1.5 / 2.1 pixel pack) and sync (GL 3.2 / ARB_sync) entry
+// points are not in the GL 1.1 headers and are looked up at first use
+typedef void (APIENTRY* GenBuffersProc)(GLsizei count, GLuint* buffers);
+typedef void (APIENTRY* DeleteBuffersProc)(GLsizei count, const GLuint* buffers);
+typedef void (APIENTRY* BindBufferProc)(GLenum target, GLuint buffer);
+typedef void (APIENTRY* BufferDataProc)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+typedef void* (APIENTRY* MapBufferProc)(GLenum target, GLenum access);
+typedef GLboolean (APIENTRY* UnmapBufferProc)(GLenum target);
+typedef void* (APIENTRY* FenceSyncProc)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRY* ClientWaitSyncProc)(void* sync, GLbitfield flags, uint64_t timeout);
+typedef void (APIENTRY* DeleteSyncProc)(void* sync);
+
+static GenBuffersProc genBuffers = nullptr;
+static DeleteBuffersProc deleteBuffers = nullptr;
+static BindBufferProc bindBuffer = nullptr;
+static BufferDataProc bufferData = nullptr;
+static MapBufferProc mapBuffer = nullptr;
+static UnmapBufferProc unmapBuffer = nullptr;
+static FenceSyncProc fenceSync = nullptr;
+static ClientWaitSyncProc clientWaitSync = nullptr;
+static DeleteSyncProc deleteSync = nullptr;
+static bool glLookedUp = false;
+
+static void* lookupGL(const char* name) {
+#ifdef _WIN32
+    void* proc = (void*)wglGetProcAddress(name);
+    // wglGetProcAddress signals failure with small integers as well as null
+    if (proc == (void*)0 || proc == (void*)1 || proc == (void*)2 || proc == (void*)3 || proc == (void*)-1) return nullptr;
+    return proc;
+#elif defined(__APPLE__)
+    (void)name;
+    return nullptr; // Not wired up on macOS: capture stays off
+#else
+    return (void*)glXGetProcAddressARB((const GLubyte*)name);
+#endif
+}
+
+// Pixel pack buffers are required; fences are optional (without them a
+// readback is mapped once the ring has come round to it)
+static bool loadSnapshotGL() {
+    if (!glLookedUp) {
+        glLookedUp = true;
+        genBuffers = (GenBuffersProc)lookupGL("glGenBuffers");
+        deleteBuffers = (DeleteBuffersProc)lookupGL("glDeleteBuffers");
+        bindBuffer = (BindBufferProc)lookupGL("glBindBuffer");
+        bufferData = (BufferDataProc)lookupGL("glBufferData");
+        mapBuffer = (MapBufferProc)lookupGL("glMapBuffer");
+        unmapBuffer = (UnmapBufferProc)lookupGL("glUnmapBuffer");
+        fenceSync = (FenceSyncProc)lookupGL("glFenceSync");
+        clientWaitSync = (ClientWaitSyncProc)lookupGL("glClientWaitSync");
+        deleteSync = (DeleteSyncProc)lookupGL("glDeleteSync");
+        if (!fenceSync || !clientWaitSync || !deleteSync) {
+            fenceSync = nullptr;
+            clientWaitSync = nullptr;
+            deleteSync = nullptr;
+        }
+    }
+    return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBuffer && unmapBuffer;
+}
+
+static SnapshotConfig snapshotConfig;
+static std::atomic<bool> serviceRunning(false);
+static std::atomic<uint64_t> requestedMonitors(0); // Bit per monitor (monitors past 63 share bit 63)
+static JobCounter encodeJobs;
+
+struct PendingFrame {
+    int width;
+    int height;
+    std::vector<uint8_t> rgba;
+};
+
+static std::mutex workMutex;
+static std::map<int, PendingFrame> pendingFrames; // Newest unencoded frame per monitor
+static std::set<int> encodingMonitors;            // Monitors with an encode job queued or running
+static std::map<int, SnapshotImage> latestImages;
+static SnapshotStats stats = SnapshotStats();
+
+static uint64_t monitorBit(int monitor) {
+    return 1ull << std::min(std::max(monitor, 0), 63);
+}
+
+static bool makeSnapshotDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) return S_ISDIR(info.st_mode);
+    return mkdir(path.c_str(), 0755) == 0;
+#endif
+}
+
+// Write to a temp file and rename it over the published one, so readers
+// never see a half-written thumbnail
+static bool publishSnapshotFile(int monitor, const std::vector<uint8_t>& qoi) {
+    std::string path = snapshotConfig.directory + "/monitor_" + std::to_string(monitor) + ".qoi";
+    std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (!file) return false;
+    bool written = fwrite(qoi.data(), 1, qoi.size(), file) == qoi.size();
+    written = fclose(file) == 0 && written;
+    if (!written) return false;
+#ifdef _WIN32
+    return MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+// Encode job, one per monitor at a time: encodes the monitor's pending frame,
+// and any newer one submitted meanwhile, so thumbnails publish in order
+static void encodeSnapshotJob(void* /*data*/, size_t begin, size_t /*end*/) {
+    int monitor = (int)begin;
+    while (true) {
+        PendingFrame frame;
+        {
+            std::lock_guard<std::mutex> lock(workMutex);
+            auto next = pendingFrames.find(monitor);
+            if (next == pendingFrames.end()) {
+                encodingMonitors.erase(monitor);
+                return;
+            }
+            frame = std::move(next->second);
+            pendingFrames.erase(next);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        SnapshotImage image;
+        image.monitor = monitor;
+        fitSnapshotSize(frame.width, frame.height, snapshotConfig.maxWidth, snapshotConfig.maxHeight,
+                        image.width, image.height);
+        std::vector<uint8_t> thumbnail;
+        downscaleSnapshot(frame.rgba.data(), frame.width, frame.height, image.width, image.height, thumbnail);
+        image.qoi = encodeQOI(thumbnail.data(), image.width, image.height);
+        if (!publishSnapshotFile(monitor, image.qoi)) {
+            std::cerr << "[WARNING] Snapshot: Cannot write thumbnail for monitor " << monitor << " to "
+                      << snapshotConfig.directory << std::endl;
+        }
+        double encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(workMutex);
+        auto previous = latestImages.find(monitor);
+        image.sequence = previous == latestImages.end() ? 1 : previous->second.sequence + 1;
+        latestImages[monitor] = std::move(image);
+        stats.published++;
+        stats.lastEncodeMs = encodeMs;
+    }
+}
+
+bool startSnapshotService(const SnapshotConfig& config) {
+    if (serviceRunning) return true;
+    if (config.maxWidth <= 0 || config.maxHeight <= 0) return false;
+    snapshotConfig = config;
+    snapshotConfig.ringSize = std::min(std::max(config.ringSize, 2), SNAPSHOT_MAX_RING);
+    if (!makeSnapshotDirectory(snapshotConfig.directory)) {
+        std::cerr << "[ERROR] Snapshot: Cannot create directory " << snapshotConfig.directory << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        pendingFrames.clear();
+        latestImages.clear();
+        stats = SnapshotStats();
+    }
+    requestedMonitors = 0;
+    serviceRunning = true;
+    std::cout << "[DEBUG] Snapshot: Publishing thumbnails to " << snapshotConfig.directory << std::endl;
+    return true;
+}
+
+void stopSnapshotService() {
+    if (!serviceRunning) return;
+    serviceRunning = false;
+    waitForJobs(encodeJobs); // Encodes frames already handed over
+}
+
+bool isSnapshotServiceRunning() {
+    return serviceRunning;
+}
+
+void requestSnapshot(int monitor) {
+    requestedMonitors |= monitor < 0 ? ~0ull : monitorBit(monitor);
+}
+
+void initSnapshotTarget(SnapshotTarget& target) {
+    for (int i = 0; i < SNAPSHOT_MAX_RING; i++) {
+        target.buffers[i] = 0;
+        target.fences[i] = nullptr;
+        target.widths[i] = 0;
+        target.heights[i] = 0;
+        target.issuedFrame[i] = 0;
+        target.pending[i] = false;
+    }
+    target.next = 0;
+    target.frame = 0;
+    target.lastCapture = -1.0;
+    target.unsupported = false;
+}
+
+static bool readbackReady(const SnapshotTarget& target, int slot) {
+    if (target.fences[slot]) {
+        GLenum status = clientWaitSync(target.fences[slot], 0, 0); // Poll, never wait
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+    return target.frame - target.issuedFrame[slot] >= (uint64_t)(snapshotConfig.ringSize - 1);
+}
+
+// Map a finished readback and hand a copy of it to an encode job
+static void retireReadback(SnapshotTarget& target, int slot, int monitor) {
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = (size_t)target.widths[slot] * target.heights[slot] * 4;
+    bindBuffer(GL_PIXEL_PACK_BUFFER, target.buffers[slot]);
+    const uint8_t* mapped = (const uint8_t*)mapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    std::vector<uint8_t> pixels;
+    if (mapped) {
+        pixels.assign(mapped, mapped + bytes);
+        unmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (target.fences[slot]) {
+        deleteSync(target.fences[slot]);
+        target.fences[slot] = nullptr;
+    }
+    target.pending[slot] = false;
+    double copyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stats.lastCopyMs = copyMs;
+        stats.maxCopyMs = std::max(stats.maxCopyMs, copyMs);
+    }
+    if (!pixels.empty()) submitSnapshotFrame(monitor, target.widths[slot], target.heights[slot], std::move(pixels));
+}
+
+// Start an asynchronous copy of the back buffer into the slot's PBO
+static bool issueReadback(SnapshotTarget& target, int slot, int fbWidth, int fbHeight) {
+    while (glGetError() != GL_NO_ERROR) {} // Only report errors from the readback itself
+    if (target.buffers[slot] == 0) genBuffers(1, &target.buffers[slot]);
+    bindBuffer(GL_PIXEL_PACK_BUFFER, target.buffers[slot]);
+    if (target.widths[slot] != fbWidth || target.heights[slot] != fbHeight) {
+        bufferData(GL_PIXEL_PACK_BUFFER, (ptrdiff_t)fbWidth * fbHeight * 4, nullptr, GL_STREAM_READ);
+        target.widths[slot] = fbWidth;
+        target.heights[slot] = fbHeight;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, fbWidth, fbHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0); // Into the PBO, returns at once
+    target.fences[slot] = fenceSync ? fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "[WARNING] Snapshot: Framebuffer readback failed, thumbnails off for this window" << std::endl;
+        return false;
+    }
+    target.issuedFrame[slot] = target.frame;
+    target.pending[slot] = true;
+    return true;
+}
+
+void captureSnapshotFrame(SnapshotTarget& target, int monitor, int fbWidth, int fbHeight, double now) {
+    if (!serviceRunning || target.unsupported || fbWidth <= 0 || fbHeight <= 0) return;
+    if (!loadSnapshotGL()) {
+        std::cerr << "[WARNING] Snapshot: Pixel buffer objects unavailable, thumbnails off" << std::endl;
+        target.unsupported = true;
+        return;
+    }
+    target.frame++;
+    int ring = snapshotConfig.ringSize;
+
+    // Oldest first (the slot after the newest), stopping at one still in flight
+    for (int i = 0; i < ring; i++) {
+        int slot = (target.next + i) % ring;
+        if (!target.pending[slot]) continue;
+        if (!readbackReady(target, slot)) break;
+        retireReadback(target, slot, monitor);
+    }
+
+    uint64_t bit = monitorBit(monitor);
+    bool requested = (requestedMonitors.load() & bit) != 0;
+    bool periodic = snapshotConfig.intervalMs > 0 &&
+                    (target.lastCapture < 0.0 || (now - target.lastCapture) * 1000.0 >= snapshotConfig.intervalMs);
+    if (!requested && !periodic) return;
+    int slot = target.next;
+    if (target.pending[slot]) {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stats.skipped++; // Keep the request for a later frame
+        return;
+    }
+    if (!issueReadback(target, slot, fbWidth, fbHeight)) {
+        target.unsupported = true;
+        return;
+    }
+    target.next = (slot + 1) % ring;
+    target.lastCapture = now;
+    requestedMonitors &= ~bit;
+    std::lock_guard<std::mutex> lock(workMutex);
+    stats.readbacks++;
+}
+
+void releaseSnapshotTarget(SnapshotTarget& target) {
+    if (glLookedUp && deleteBuffers) {
+        for (int i = 0; i < SNAPSHOT_MAX_RING; i++) {
+            if (target.fences[i]) deleteSync(target.fences[i]);
+            if (target.buffers[i] != 0) deleteBuffers(1, &target.buffers[i]);
+        }
+    }
+    initSnapshotTarget(target);
+}
+
+void submitSnapshotFrame(int monitor, int width, int height, std::vector<uint8_t>&& rgba) {
+    if (!serviceRunning || monitor < 0 || width <= 0 || height <= 0 || rgba.size() < (size_t)width * height * 4) return;
+    bool startJob;
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        PendingFrame& frame = pendingFrames[monitor];
+        if (!frame.rgba.empty()) stats.superseded++;
+        frame.width = width;
+        frame.height = height;
+        frame.rgba = std::move(rgba);
+        startJob = encodingMonitors.insert(monitor).second;
+    }
+    if (startJob) runJob(encodeSnapshotJob, nullptr, &encodeJobs, (size_t)monitor, (size_t)monitor + 1);
+}
+
+bool getLatestSnapshot(int monitor, SnapshotImage& image) {
+    std::lock_guard<std::mutex> lock(workMutex);
+    auto found = latestImages.find(monitor);
+    if (found == latestImages.end()) return false;
+    image = found->second;
+    return true;
+}
+
+SnapshotStats getSnapshotStats() {
+    std::lock_guard<std::mutex> lock(workMutex);
+    return stats;
+}
+
+void fitSnapshotSize(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight) {
+    if (width <= maxWidth && height <= maxHeight) {
+        outWidth = width;
+        outHeight = height;
+        return;
+    }
+    // Scale by the tighter of the two bounds
+    if ((int64_t)width * maxHeight >= (int64_t)height * maxWidth) {
+        outWidth = maxWidth;
+        outHeight = std::max(1, (int)((int64_t)height * maxWidth / width));
+    } else {
+        outHeight = maxHeight;
+        outWidth = std::max(1, (int)((int64_t)width * maxHeight / height));
+    }
+}
+
+// Each thumbnail pixel averages the source pixels it covers. Alpha is forced
+// opaque: the window's alpha channel is not what the display shows.
+void downscaleSnapshot(const uint8_t* rgba, int width, int height, int outWidth, int outHeight,
+                       std::vector<uint8_t>& out) {
+    out.assign((size_t)outWidth * outHeight * 4, 255);
+    for (int oy = 0; oy < outHeight; oy++) {
+        int y0 = (int)((int64_t)oy * height / outHeight);
+        int y1 = std::max(y0 + 1, (int)((int64_t)(oy + 1) * height / outHeight));
+        for (int ox = 0; ox < outWidth; ox++) {
+            int x0 = (int)((int64_t)ox * width / outWidth);
+            int x1 = std::max(x0 + 1, (int)((int64_t)(ox + 1) * width / outWidth));
+            uint32_t sum[3] = {0, 0, 0};
+            for (int y = y0; y < y1; y++) {
+                const uint8_t* row = rgba + (size_t)(height - 1 - y) * width * 4; // GL rows are bottom-up
+                for (int x = x0; x < x1; x++) {
+                    sum[0] += row[x * 4];
+                    sum[1] += row[x * 4 + 1];
+                    sum[2] += row[x * 4 + 2];
+                }
+            }
+            uint32_t count = (uint32_t)(x1 - x0) * (uint32_t)(y1 - y0);
+            uint8_t* pixel = &out[((size_t)oy * outWidth + ox) * 4];
+            for (int c = 0; c < 3; c++) pixel[c] = (uint8_t)((sum[c] + count / 2) / count);
+        }
+    }
+}
+
+static void putBigEndian32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+std::vector<uint8_t> encodeQOI(const uint8_t* rgba, int width, int height) {
+    std::vector<uint8_t> out;
+    size_t pixels = (size_t)std::max(width, 0) * std::max(height, 0);
+    out.reserve(14 + pixels * 2 + 8);
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    putBigEndian32(out, (uint32_t)width);
+    putBigEndian32(out, (uint32_t)height);
+    out.push_back(4); // RGBA
+    out.push_back(0); // sRGB with linear alpha
+
+    uint8_t index[64][4];
+    memset(index, 0, sizeof(index));
+    uint8_t previous[4] = {0, 0, 0, 255};
+    int run = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        const uint8_t* px = rgba + i * 4;
+        if (memcmp(px, previous, 4) == 0) {
+            run++;
+            if (run == 62 || i == pixels - 1) {
+                out.push_back((uint8_t)(0xc0 | (run - 1))); // QOI_OP_RUN
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back((uint8_t)(0xc0 | (run - 1)));
+            run = 0;
+        }
+        int slot = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+        if (memcmp(index[slot], px, 4) == 0) {
+            out.push_back((uint8_t)slot); // QOI_OP_INDEX
+        } else {
+            memcpy(index[slot], px, 4);
+            if (px[3] == previous[3]) {
+                int dr = (int8_t)(px[0] - previous[0]);
+                int dg = (int8_t)(px[1] - previous[1]);
+                int db = (int8_t)(px[2] - previous[2]);
+                int drg = dr - dg, dbg = db - dg;
+                if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                    out.push_back((uint8_t)(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))); // QOI_OP_DIFF
+                } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                    out.push_back((uint8_t)(0x80 | (dg + 32))); // QOI_OP_LUMA
+                    out.push_back((uint8_t)((drg + 8) << 4 | (dbg + 8)));
+                } else {
+                    out.insert(out.end(), {0xfe, px[0], px[1], px[2]}); // QOI_OP_RGB
+                }
+            } else {
+                out.insert(out.end(), {0xff, px[0], px[1], px[2], px[3]}); // QOI_OP_RGBA
+            }
+        }
+        memcpy(previous, px, 4);
+    }
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+    return out;
+}
@@ -0,0 +1,86 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Framebuffer thumbnails for remote monitoring
+// The render thread never waits on a readback: after a window's frame is
+// drawn it issues glReadPixels into one of a ring of pixel pack buffers
+// (PBOs), and only maps that buffer frames later, once its fence has
+// signalled (the GPU copy is done by then). Its one cost is copying the
+// mapped pixels out. A job (jobs.h) downscales the copy, encodes it as QOI
+// and publishes it as <directory>/monitor_<n>.qoi (written to a temp file
+// and renamed over the old one), keeping the latest per monitor in memory
+// as well.
+
+static const int SNAPSHOT_MAX_RING = 4;
+
+struct SnapshotConfig {
+    std::string directory = "snapshots";
+    int intervalMs = 0;    // Periodic capture per window (0: on demand only)
+    int ringSize = 3;      // PBOs per window (2..SNAPSHOT_MAX_RING)
+    int maxWidth = 320;    // Thumbnails fit this box, aspect kept
+    int maxHeight = 180;
+};
+
+// Per-window readback state (render thread, owned by WindowData)
+struct SnapshotTarget {
+    unsigned int buffers[SNAPSHOT_MAX_RING];
+    void* fences[SNAPSHOT_MAX_RING];   // GLsync per pending readback (null without ARB_sync)
+    int widths[SNAPSHOT_MAX_RING];
+    int heights[SNAPSHOT_MAX_RING];
+    uint64_t issuedFrame[SNAPSHOT_MAX_RING];
+    bool pending[SNAPSHOT_MAX_RING];
+    int next;                          // Slot the next readback goes to
+    uint64_t frame;
+    double lastCapture;                // Seconds (the `now` passed in), -1 before the first
+    bool unsupported;                  // No PBOs in this context: capture is off
+};
+
+struct SnapshotImage {
+    int monitor;
+    int width;
+    int height;
+    std::vector<uint8_t> qoi;
+    uint64_t sequence;                 // Increases with every thumbnail published for the monitor
+};
+
+struct SnapshotStats {
+    uint64_t readbacks;        // Readbacks issued
+    uint64_t published;        // Thumbnails encoded and written
+    uint64_t skipped;          // Captures due while every ring slot was still in flight
+    uint64_t superseded;       // Frames replaced by a newer one before they were encoded
+    double lastCopyMs;         // Render thread: mapped PBO -> encode buffer
+    double maxCopyMs;
+    double lastEncodeMs;       // Encode job: downscale + encode + write
+};
+
+bool startSnapshotService(const SnapshotConfig& config);
+void stopSnapshotService();
+bool isSnapshotServiceRunning();
+void requestSnapshot(int monitor = -1); // On demand (-1: every monitor) at its next frame
+
+// Render thread, window context current, after the frame is drawn and before
+// the swap: retire finished readbacks and issue a new one when one is due
+void initSnapshotTarget(SnapshotTarget& target);
+void captureSnapshotFrame(SnapshotTarget& target, int monitor, int fbWidth, int fbHeight, double now);
+void releaseSnapshotTarget(SnapshotTarget& target); // Context current
+
+// Hand a bottom-up RGBA frame (as read back from GL) to an encode job; frames
+// not yet encoded are replaced by newer ones for the same monitor
+void submitSnapshotFrame(int monitor, int width, int height, std::vector<uint8_t>&& rgba);
+
+bool getLatestSnapshot(int monitor, SnapshotImage& image);
+SnapshotStats getSnapshotStats();
+
+// Encode steps, exposed for tests
+void fitSnapshotSize(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight);
+// Box-filter a bottom-up RGBA frame into a top-down RGBA thumbnail
+void downscaleSnapshot(const uint8_t* rgba, int width, int height, int outWidth, int outHeight,
+                       std::vector<uint8_t>& out);
+// QOI (https://qoiformat.org) image of top-down RGBA pixels
+std::vector<uint8_t> encodeQOI(const uint8_t* rgba, int width, int height);
+
+#endif // SNAPSHOT_H
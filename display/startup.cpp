@@ -0,0 +1,162 @@
+#include "startup.h"
+#include "jobs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+
+static std::mutex milestoneMutex;
+static std::map<std::string, double> milestones;
+
+double getStartupClockMs() {
+    static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void markStartupMilestone(const std::string& name) {
+    double now = getStartupClockMs();
+    std::lock_guard<std::mutex> lock(milestoneMutex);
+    if (milestones.count(name) == 0) milestones[name] = now;
+}
+
+double getStartupMilestone(const std::string& name) {
+    std::lock_guard<std::mutex> lock(milestoneMutex);
+    auto found = milestones.find(name);
+    return found == milestones.end() ? -1.0 : found->second;
+}
+
+int addStartupTask(StartupGraph& graph, const std::string& name, StartupThread thread,
+                   std::function<void()> run, const std::vector<int>& after) {
+    int id = (int)graph.tasks.size();
+    if (graph.started) {
+        std::cerr << "[ERROR] Startup: Task " << name << " added after the graph started" << std::endl;
+        return -1;
+    }
+    std::unique_ptr<StartupTask> task(new StartupTask());
+    task->name = name;
+    task->thread = thread;
+    task->run = std::move(run);
+    task->dependencies = 0;
+    task->startMs = -1.0;
+    task->endMs = -1.0;
+    for (int dependency : after) {
+        // Only earlier tasks can be waited for, so the graph has no cycles
+        if (dependency < 0 || dependency >= id) continue;
+        graph.tasks[dependency]->dependents.push_back(id);
+        task->dependencies++;
+    }
+    graph.tasks.push_back(std::move(task));
+    return id;
+}
+
+static void scheduleStartupTask(StartupGraph& graph, int id);
+
+static void executeStartupTask(StartupGraph& graph, int id) {
+    StartupTask& task = *graph.tasks[id];
+    task.startMs = getStartupClockMs();
+    try {
+        if (task.run) task.run();
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Startup: Task " << task.name << " failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "[ERROR] Startup: Task " << task.name << " failed with an unknown exception" << std::endl;
+    }
+    task.endMs = getStartupClockMs();
+    for (int dependent : task.dependents) {
+        if (graph.tasks[dependent]->waiting.fetch_sub(1) == 1) scheduleStartupTask(graph, dependent);
+    }
+    {
+        std::lock_guard<std::mutex> lock(graph.lock);
+        task.done = true;
+        graph.unfinished--;
+    }
+    graph.changed.notify_all();
+}
+
+static void runStartupJob(void* data, size_t begin, size_t end) {
+    (void)end;
+    executeStartupTask(*(StartupGraph*)data, (int)begin);
+}
+
+static void scheduleStartupTask(StartupGraph& graph, int id) {
+    if (graph.tasks[id]->thread == StartupThread::WORKER) {
+        runJob(runStartupJob, &graph, nullptr, (size_t)id, (size_t)id + 1);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(graph.lock);
+        graph.mainReady.push_back(id);
+    }
+    graph.changed.notify_all();
+}
+
+void startStartupGraph(StartupGraph& graph) {
+    if (graph.started) return;
+    getStartupClockMs(); // Starts the clock if nothing has yet
+    {
+        std::lock_guard<std::mutex> lock(graph.lock);
+        graph.started = true;
+        graph.unfinished = (int)graph.tasks.size();
+    }
+    for (auto& task : graph.tasks) task->waiting = task->dependencies;
+    for (size_t id = 0; id < graph.tasks.size(); id++) {
+        if (graph.tasks[id]->dependencies == 0) scheduleStartupTask(graph, (int)id);
+    }
+}
+
+bool runStartupMainTasks(StartupGraph& graph) {
+    while (true) {
+        int id;
+        {
+            std::lock_guard<std::mutex> lock(graph.lock);
+            if (graph.mainReady.empty()) return graph.started && graph.unfinished == 0;
+            id = graph.mainReady.front();
+            graph.mainReady.pop_front();
+        }
+        executeStartupTask(graph, id);
+    }
+}
+
+void waitForStartupTask(StartupGraph& graph, int task) {
+    if (task < 0 || task >= (int)graph.tasks.size()) return;
+    while (true) {
+        runStartupMainTasks(graph);
+        std::unique_lock<std::mutex> lock(graph.lock);
+        graph.changed.wait(lock, [&] { return graph.tasks[task]->done || !graph.mainReady.empty(); });
+        if (graph.tasks[task]->done) return;
+    }
+}
+
+void waitForStartupGraph(StartupGraph& graph) {
+    if (!graph.started) return;
+    while (true) {
+        runStartupMainTasks(graph);
+        std::unique_lock<std::mutex> lock(graph.lock);
+        graph.changed.wait(lock, [&] { return graph.unfinished == 0 || !graph.mainReady.empty(); });
+        if (graph.unfinished == 0) return;
+    }
+}
+
+bool isStartupGraphDone(StartupGraph& graph) {
+    std::lock_guard<std::mutex> lock(graph.lock);
+    return graph.started && graph.unfinished == 0;
+}
+
+std::string formatStartupReport(const StartupGraph& graph) {
+    std::vector<const StartupTask*> order;
+    for (const auto& task : graph.tasks) {
+        if (task->done) order.push_back(task.get());
+    }
+    std::sort(order.begin(), order.end(), [](const StartupTask* a, const StartupTask* b) {
+        return a->startMs < b->startMs;
+    });
+    std::string report;
+    for (const StartupTask* task : order) {
+        char line[160];
+        snprintf(line, sizeof(line), "  %-16s %8.1f - %8.1f ms (%.1f ms, %s)\n", task->name.c_str(), task->startMs,
+                 task->endMs, task->endMs - task->startMs, task->thread == StartupThread::MAIN ? "main" : "worker");
+        report += line;
+    }
+    return report;
+}
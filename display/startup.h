@@ -0,0 +1,71 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Startup as a dependency graph
+// Each startup step is a task that runs once the tasks it depends on have
+// finished. Worker tasks (file decode, device open, network setup) are
+// handed to the job system as soon as they are ready, so independent steps
+// overlap; main-thread tasks (anything touching GLFW or a GL context) are
+// queued and run by whichever main-thread call pumps the graph. A task that
+// throws is logged and counted as finished, so the rest of startup goes on.
+//
+// Milestones (time to first frame, time to interactive) are measured on a
+// clock that starts at the first startup call of the process.
+
+enum class StartupThread {
+    MAIN,      // Run from runStartupMainTasks / waitForStartupTask
+    WORKER     // Run on the job system (inline if it is not running)
+};
+
+struct StartupTask {
+    std::string name;
+    StartupThread thread;
+    std::function<void()> run;
+    std::vector<int> dependents;
+    int dependencies;               // Tasks this one waits for
+    std::atomic<int> waiting{0};    // Dependencies not finished yet
+    std::atomic<bool> done{false};
+    double startMs;                 // Startup clock
+    double endMs;
+};
+
+struct StartupGraph {
+    std::vector<std::unique_ptr<StartupTask>> tasks;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<int> mainReady;      // Main-thread tasks whose dependencies finished
+    int unfinished = 0;             // Guarded by lock
+    bool started = false;
+};
+
+// Add a task before the graph starts; returns its id for use in `after`
+int addStartupTask(StartupGraph& graph, const std::string& name, StartupThread thread,
+                   std::function<void()> run, const std::vector<int>& after = {});
+// Submit every task without dependencies; nothing runs on this thread yet
+void startStartupGraph(StartupGraph& graph);
+// Main thread: run the main-thread tasks that are ready, without waiting;
+// true once every task has finished
+bool runStartupMainTasks(StartupGraph& graph);
+// Main thread: run main-thread tasks as they become ready until `task` finishes
+void waitForStartupTask(StartupGraph& graph, int task);
+// Main thread: run main-thread tasks until the whole graph has finished
+void waitForStartupGraph(StartupGraph& graph);
+bool isStartupGraphDone(StartupGraph& graph);
+// Per-task start/end on the startup clock, in start order
+std::string formatStartupReport(const StartupGraph& graph);
+
+// Milliseconds since the first call (make one first thing in main)
+double getStartupClockMs();
+void markStartupMilestone(const std::string& name); // First mark of a name wins
+double getStartupMilestone(const std::string& name); // -1 until reached
+
+#endif // STARTUP_H
@@ -0,0 +1,344 @@
+#include "stt_router.h"
+#include "network.h"
+#include "scene_logger.h"
+#include "transcript.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+using RouterClock = std::chrono::steady_clock;
+
+static const size_t LATENCY_WINDOW = 128; // Recent successful latencies used for p95
+
+struct EndpointState {
+    STTEndpoint endpoint;
+    double ewmaMs = -1.0;
+    int inFlight = 0;
+    int consecutiveFailures = 0;
+    int ejectMs = 0;                  // 0 = healthy
+    RouterClock::time_point ejectedUntil;
+    bool probing = false;             // The one half-open probe is in flight
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t wins = 0;
+};
+
+static std::mutex routerMutex;
+static std::vector<EndpointState> endpoints;
+static STTRouterConfig routerConfig;
+static std::deque<double> latencyWindow;
+static uint32_t rngState = 0;
+static STTRouterStats routerStats;
+
+std::vector<STTEndpoint> parseSTTEndpoints(const std::string& list) {
+    std::vector<STTEndpoint> result;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string entry = list.substr(start, end - start);
+        size_t first = entry.find_first_not_of(" \t");
+        size_t last = entry.find_last_not_of(" \t");
+        if (first != std::string::npos) {
+            entry = entry.substr(first, last - first + 1);
+            size_t colon = entry.rfind(':');
+            int port = colon == std::string::npos ? 0 : atoi(entry.c_str() + colon + 1);
+            if (colon != std::string::npos && colon > 0 && port > 0 && port < 65536) {
+                result.push_back(STTEndpoint{entry.substr(0, colon), port});
+            } else {
+                std::cerr << "[WARNING] STT router: Ignoring invalid endpoint '" << entry << "'" << std::endl;
+            }
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+static uint32_t nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// An ejected endpoint becomes available again (half-open) once its cooldown passes,
+// for a single probe at a time
+static bool isAvailable(const EndpointState& state, RouterClock::time_point now) {
+    return state.ejectMs == 0 || (now >= state.ejectedUntil && !state.probing);
+}
+
+// Lower is better: expected latency scaled by queued work; unknown endpoints go first
+static double endpointScore(const EndpointState& state) {
+    return state.ewmaMs < 0.0 ? 0.0 : state.ewmaMs * (1 + state.inFlight);
+}
+
+// Power-of-two-choices: sample two distinct available endpoints, primary is the better one
+// The other becomes the hedge/failover target (-1 when only one endpoint is usable)
+// primary is -1 when every endpoint is ejected and already being probed
+static void pickEndpoints(int& primary, int& secondary) {
+    RouterClock::time_point now = RouterClock::now();
+    std::vector<int> available;
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        if (isAvailable(endpoints[i], now)) available.push_back((int)i);
+    }
+    if (available.empty()) {
+        // Everything is ejected - probe the endpoint whose cooldown ends first
+        int soonest = -1;
+        for (size_t i = 0; i < endpoints.size(); i++) {
+            if (endpoints[i].probing) continue;
+            if (soonest < 0 || endpoints[i].ejectedUntil < endpoints[soonest].ejectedUntil) soonest = (int)i;
+        }
+        primary = soonest;
+        secondary = -1;
+        return;
+    }
+    if (available.size() == 1) {
+        primary = available[0];
+        secondary = -1;
+        return;
+    }
+    size_t a = nextRandom() % available.size();
+    size_t b = nextRandom() % (available.size() - 1);
+    if (b >= a) b++;
+    primary = available[a];
+    secondary = available[b];
+    if (endpointScore(endpoints[secondary]) < endpointScore(endpoints[primary])) {
+        std::swap(primary, secondary);
+    }
+}
+
+static double latencyPercentile(double fraction) {
+    if (latencyWindow.empty()) return -1.0;
+    std::vector<double> sorted(latencyWindow.begin(), latencyWindow.end());
+    size_t index = (size_t)(fraction * (sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+// Hedge delay in ms, or -1 while there is not enough history to trust p95
+static int hedgeDelayMs() {
+    if (!routerConfig.hedging || (int)latencyWindow.size() < routerConfig.hedgeWarmupSamples) {
+        return -1;
+    }
+    return std::max(routerConfig.minHedgeMs, (int)latencyPercentile(0.95));
+}
+
+static void updateEWMA(EndpointState& state, double latencyMs) {
+    state.ewmaMs = state.ewmaMs < 0.0 ? latencyMs : state.ewmaMs + routerConfig.ewmaAlpha * (latencyMs - state.ewmaMs);
+}
+
+// Passive health check: record the outcome of one attempt
+// While an endpoint is ejected only its probe decides: success closes the
+// breaker, failure ejects it again for twice as long. Late outcomes of
+// attempts sent before the ejection are counted but change nothing.
+static void recordAttempt(int index, bool probe, bool success, bool cancelled, double latencyMs) {
+    EndpointState& state = endpoints[index];
+    state.inFlight--;
+    if (probe) state.probing = false; // A cancelled probe is inconclusive; the next request probes again
+    if (cancelled) {
+        // Lost the race: latency is at least this long, so only ever push the estimate up
+        if (latencyMs > state.ewmaMs) updateEWMA(state, latencyMs);
+        return;
+    }
+    if (success) {
+        updateEWMA(state, latencyMs);
+        latencyWindow.push_back(latencyMs);
+        if (latencyWindow.size() > LATENCY_WINDOW) latencyWindow.pop_front();
+        if (state.ejectMs > 0 && !probe) return;
+        if (state.ejectMs > 0) {
+            logAudio("STT router: " + state.endpoint.host + ":" + std::to_string(state.endpoint.port) + " healthy again");
+        }
+        state.consecutiveFailures = 0;
+        state.ejectMs = 0;
+        return;
+    }
+
+    state.failures++;
+    state.consecutiveFailures++;
+    if (probe || (state.ejectMs == 0 && state.consecutiveFailures >= routerConfig.failureThreshold)) {
+        state.ejectMs = state.ejectMs == 0 ? routerConfig.ejectMs : std::min(state.ejectMs * 2, routerConfig.maxEjectMs);
+        state.ejectedUntil = RouterClock::now() + std::chrono::milliseconds(state.ejectMs);
+        logAudio("STT router: ejecting " + state.endpoint.host + ":" + std::to_string(state.endpoint.port) +
+                 " for " + std::to_string(state.ejectMs) + "ms");
+    }
+}
+
+// Shared between the caller and the attempt callbacks on the network thread
+struct RouteRace {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int endpoint[2] = {-1, -1};
+    NetRequestId request[2] = {0, 0};
+    int status[2] = {0, 0};
+    int winner = -1; // Slot of the first successful attempt
+    int rejected = 0; // Status of a permanent rejection (see isPermanentHTTPFailure)
+    int finished = 0;
+};
+
+bool initSTTRouter(const std::vector<STTEndpoint>& endpointList, const STTRouterConfig& config) {
+    std::lock_guard<std::mutex> lock(routerMutex);
+    endpoints.clear();
+    for (const STTEndpoint& endpoint : endpointList) {
+        EndpointState state;
+        state.endpoint = endpoint;
+        endpoints.push_back(state);
+    }
+    routerConfig = config;
+    latencyWindow.clear();
+    routerStats = STTRouterStats();
+    rngState = config.seed != 0 ? config.seed : (uint32_t)RouterClock::now().time_since_epoch().count() | 1u;
+
+    std::cout << "[DEBUG] STT router: " << endpoints.size() << " endpoint(s)";
+    for (const STTEndpoint& endpoint : endpointList) {
+        std::cout << " " << endpoint.host << ":" << endpoint.port;
+    }
+    std::cout << std::endl;
+    return !endpoints.empty();
+}
+
+void shutdownSTTRouter() {
+    std::lock_guard<std::mutex> lock(routerMutex);
+    endpoints.clear();
+    latencyWindow.clear();
+}
+
+bool isSTTRouterActive() {
+    std::lock_guard<std::mutex> lock(routerMutex);
+    return !endpoints.empty();
+}
+
+bool routeAudioToWhisper(const std::vector<short>& samples, int sampleRate, const STTChunkInfo* chunk, int* status) {
+    if (status) *status = 0;
+    int primary, secondary, hedgeMs;
+    {
+        std::lock_guard<std::mutex> lock(routerMutex);
+        if (endpoints.empty()) {
+            return false;
+        }
+        pickEndpoints(primary, secondary);
+        if (primary < 0) {
+            return false;
+        }
+        hedgeMs = hedgeDelayMs();
+        routerStats.requests++;
+    }
+
+    auto race = std::make_shared<RouteRace>();
+    // Attempts run on the network reactor; their callbacks record the outcome and wake us
+    auto launch = [&](int slot, int endpoint) {
+        STTEndpoint target;
+        bool probe;
+        {
+            std::lock_guard<std::mutex> lock(routerMutex);
+            if (endpoint >= (int)endpoints.size()) return false; // Router shut down underneath us
+            EndpointState& state = endpoints[endpoint];
+            // Picked while half-open: this attempt is its probe, unless another request got there first
+            probe = state.ejectMs > 0;
+            if (probe && state.probing) return false;
+            state.probing = probe;
+            target = state.endpoint;
+            state.inFlight++;
+            state.requests++;
+        }
+        {
+            std::lock_guard<std::mutex> raceLock(race->mutex);
+            race->endpoint[slot] = endpoint;
+        }
+        double captureTime = chunk ? chunk->captureTime : -1.0;
+        NetRequestId id = sendAudioToWhisperAsync(samples, sampleRate, target.host, target.port, [race, slot, endpoint, probe, captureTime](const HTTPResult& result) {
+            // A permanent rejection is about the request, not the endpoint: it answered
+            bool rejected = !result.ok && isPermanentHTTPFailure(result.status);
+            {
+                std::lock_guard<std::mutex> lock(routerMutex);
+                if (endpoint < (int)endpoints.size()) {
+                    recordAttempt(endpoint, probe, result.ok || rejected, result.cancelled, result.latencyMs);
+                }
+            }
+            std::lock_guard<std::mutex> raceLock(race->mutex);
+            race->status[slot] = result.status;
+            if (rejected) race->rejected = result.status;
+            if (result.ok && race->winner < 0) {
+                race->winner = slot;
+                publishTranscriptReply(result.body, captureTime); // Only the winning reply reaches the display
+            }
+            race->finished++;
+            race->cv.notify_all();
+        }, chunk);
+        std::lock_guard<std::mutex> raceLock(race->mutex);
+        race->request[slot] = id;
+        return true;
+    };
+
+    int launched = launch(0, primary) ? 1 : 0;
+    if (launched == 0 && secondary >= 0 && launch(0, secondary)) {
+        // Lost the probe to another request; the other choice takes it
+        launched = 1;
+        secondary = -1;
+    }
+    bool hedged = false;
+    if (launched == 1 && secondary >= 0) {
+        // Wait for the primary up to the hedge delay; a fast failure fails over immediately
+        std::unique_lock<std::mutex> lock(race->mutex);
+        if (hedgeMs >= 0) {
+            race->cv.wait_for(lock, std::chrono::milliseconds(hedgeMs), [&] { return race->finished > 0; });
+        } else {
+            race->cv.wait(lock, [&] { return race->finished > 0; });
+        }
+        bool needSecond = race->winner < 0 && race->rejected == 0; // Another endpoint would reject it too
+        hedged = needSecond && race->finished == 0;
+        lock.unlock();
+        if (needSecond && launch(1, secondary)) {
+            launched++;
+        }
+    }
+
+    int winner;
+    int winnerEndpoint = -1;
+    {
+        std::unique_lock<std::mutex> lock(race->mutex);
+        race->cv.wait(lock, [&] { return race->winner >= 0 || race->finished == launched; });
+        // First success wins; the loser is cancelled on the network thread and reports back
+        for (int slot = 0; slot < launched; slot++) {
+            if (slot != race->winner && race->request[slot] != 0) {
+                cancelNetRequest(race->request[slot]);
+            }
+        }
+        race->cv.wait(lock, [&] { return race->finished == launched; });
+        winner = race->winner;
+        if (winner >= 0) winnerEndpoint = race->endpoint[winner];
+        if (status) *status = winner >= 0 ? race->status[winner] : race->rejected != 0 ? race->rejected : race->status[0];
+    }
+
+    std::lock_guard<std::mutex> lock(routerMutex);
+    if (hedged) routerStats.hedged++;
+    if (winner >= 0) {
+        routerStats.succeeded++;
+        if (hedged && winner == 1) routerStats.hedgeWins++;
+        if (winnerEndpoint < (int)endpoints.size()) endpoints[winnerEndpoint].wins++;
+    }
+    return winner >= 0;
+}
+
+STTRouterStats getSTTRouterStats() {
+    std::lock_guard<std::mutex> lock(routerMutex);
+    STTRouterStats result = routerStats;
+    result.p95Ms = (int)latencyWindow.size() >= routerConfig.hedgeWarmupSamples ? latencyPercentile(0.95) : -1.0;
+    RouterClock::time_point now = RouterClock::now();
+    for (const EndpointState& state : endpoints) {
+        STTEndpointStats entry;
+        entry.host = state.endpoint.host;
+        entry.port = state.endpoint.port;
+        entry.ewmaMs = state.ewmaMs;
+        entry.healthy = state.ejectMs == 0 || now >= state.ejectedUntil;
+        entry.requests = state.requests;
+        entry.failures = state.failures;
+        entry.wins = state.wins;
+        result.endpoints.push_back(entry);
+    }
+    return result;
+}
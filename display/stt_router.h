@@ -0,0 +1,67 @@
+#ifndef STT_ROUTER_H
+#define STT_ROUTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "stt_session.h"
+
+// Latency-aware routing across several Whisper STT servers
+// Endpoints come from config key stt.endpoints ("host:port, host:port").
+// Each endpoint keeps an EWMA of its upload latency and a passive health
+// state (ejected after consecutive failures; after a cooldown one request
+// probes it, and only that probe's success brings it back).
+// Requests pick the better of two random endpoints (power-of-two-choices);
+// if the first attempt is still running after the observed p95, a hedged
+// duplicate goes to the other choice and the loser is cancelled.
+
+struct STTEndpoint {
+    std::string host;
+    int port;
+};
+
+struct STTRouterConfig {
+    double ewmaAlpha = 0.2;       // Weight of the newest latency sample
+    int failureThreshold = 3;     // Consecutive failures before an endpoint is ejected
+    int ejectMs = 5000;           // First ejection; doubles per repeat up to maxEjectMs
+    int maxEjectMs = 60000;
+    bool hedging = true;
+    int minHedgeMs = 50;          // Never hedge sooner than this
+    int hedgeWarmupSamples = 20;  // Latency samples needed before p95 is trusted
+    uint32_t seed = 0;            // Endpoint sampling (0: seeded from the clock)
+};
+
+struct STTEndpointStats {
+    std::string host;
+    int port;
+    double ewmaMs;          // -1 until the first completed request
+    bool healthy;
+    uint64_t requests;      // Attempts sent to this endpoint (including hedges)
+    uint64_t failures;
+    uint64_t wins;          // Attempts whose response was used
+};
+
+struct STTRouterStats {
+    uint64_t requests;      // routeAudioToWhisper calls
+    uint64_t succeeded;
+    uint64_t hedged;        // Requests that sent a hedged duplicate
+    uint64_t hedgeWins;     // ...where the duplicate answered first
+    double p95Ms;           // Current hedge threshold source (-1 during warm-up)
+    std::vector<STTEndpointStats> endpoints;
+};
+
+// Parse "host:port, host:port" (invalid entries are skipped)
+std::vector<STTEndpoint> parseSTTEndpoints(const std::string& list);
+
+bool initSTTRouter(const std::vector<STTEndpoint>& endpoints, const STTRouterConfig& config = STTRouterConfig());
+void shutdownSTTRouter();
+bool isSTTRouterActive();
+
+// Blocking upload through the router (call from a worker thread, not the render thread)
+// status (optional) receives the HTTP status of the answer used (0: no response);
+// a permanent rejection (isPermanentHTTPFailure) is not failed over to another endpoint
+bool routeAudioToWhisper(const std::vector<short>& samples, int sampleRate, const STTChunkInfo* chunk = nullptr, int* status = nullptr);
+
+STTRouterStats getSTTRouterStats();
+
+#endif // STT_ROUTER_H
@@ -0,0 +1,288 @@
+#include "stt_session.h"
+#include "scene_logger.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// The buffer holds capture-clock positions [bufferStart, bufferEnd): the
+// unsent audio plus the context tail of the last chunk. The capture callback
+// and the render thread share it under sessionMutex. It is a ring sized when
+// the session begins (maxBufferedMs plus the context), position p at
+// buffer[p % buffer.size()], so appending a block never allocates.
+
+static std::mutex sessionMutex;
+static STTSessionConfig sessionConfig;
+static bool sessionActive = false;
+static int sessionRate = 0;
+static std::vector<short> buffer;
+static uint64_t bufferStart = 0;
+static uint64_t bufferEnd = 0;
+static uint64_t sentUpTo = 0;
+static uint64_t clockLimit = 0; // 0: open-ended
+static size_t chunkSamples = 0;
+static size_t contextSamples = 0;
+static size_t maxUnsentSamples = 0;
+static STTSessionStats stats;
+static uint64_t sessionCounter = 0;
+// Session-clock position of each tagged block still buffered, with its capture tag
+// (a fixed ring; with very small blocks the oldest tags are forgotten)
+static const size_t MAX_BLOCK_TAGS = 1024;
+static std::pair<uint64_t, CaptureTag> blockTags[MAX_BLOCK_TAGS];
+static size_t blockTagFirst = 0;
+static size_t blockTagCount = 0;
+// CaptureTag::sample of session-clock position 0 (from the first tagged block)
+static bool haveClockOrigin = false;
+static uint64_t clockOrigin = 0;
+
+// Session-clock range another transport carried (see coverSTTSessionAudio)
+struct CoveredRange {
+    uint64_t source; // The `from` it was reported with
+    uint64_t start;
+    uint64_t end;
+    bool open;
+};
+static std::deque<CoveredRange> coveredRanges;
+
+// Unique per session and per process run, never 0
+static uint64_t newSessionId() {
+    uint64_t x = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count() + (++sessionCounter << 32);
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x != 0 ? x : 1;
+}
+
+static uint64_t captureClock() {
+    return bufferEnd;
+}
+
+// i = 0 is the oldest tag still kept
+static const std::pair<uint64_t, CaptureTag>& blockTagAt(size_t i) {
+    return blockTags[(blockTagFirst + i) % MAX_BLOCK_TAGS];
+}
+
+static void addBlockTag(uint64_t position, const CaptureTag& tag) {
+    if (blockTagCount == MAX_BLOCK_TAGS) {
+        blockTagFirst = (blockTagFirst + 1) % MAX_BLOCK_TAGS;
+        blockTagCount--;
+    }
+    blockTags[(blockTagFirst + blockTagCount) % MAX_BLOCK_TAGS] = std::make_pair(position, tag);
+    blockTagCount++;
+}
+
+static void clearBuffer() {
+    bufferStart = 0;
+    bufferEnd = 0;
+    blockTagFirst = 0;
+    blockTagCount = 0;
+}
+
+// Drop buffered audio before position
+static void trimBufferTo(uint64_t position) {
+    position = std::min(position, bufferEnd);
+    if (position <= bufferStart) return;
+    bufferStart = position;
+    while (blockTagCount > 1 && blockTagAt(1).first <= bufferStart) {
+        blockTagFirst = (blockTagFirst + 1) % MAX_BLOCK_TAGS;
+        blockTagCount--;
+    }
+}
+
+// Copy buffered positions [start, end) out of the ring
+static void copyBuffered(uint64_t start, uint64_t end, std::vector<short>& out) {
+    size_t count = (size_t)(end - start);
+    size_t first = (size_t)(start % buffer.size());
+    size_t head = std::min(count, buffer.size() - first);
+    out.assign(buffer.begin() + first, buffer.begin() + first + head);
+    out.insert(out.end(), buffer.begin(), buffer.begin() + (count - head));
+}
+
+static void keepContextOnly() {
+    trimBufferTo(sentUpTo > contextSamples ? sentUpTo - contextSamples : 0);
+}
+
+// Skip covered ranges once everything before them has been handed out
+static void skipCoveredAudio() {
+    while (!coveredRanges.empty() && sentUpTo >= coveredRanges.front().start) {
+        const CoveredRange& range = coveredRanges.front();
+        if (range.end > sentUpTo) {
+            stats.skippedSamples += range.end - sentUpTo;
+            sentUpTo = range.end;
+            keepContextOnly();
+            stats.sentSamples = sentUpTo;
+        }
+        if (range.open) break; // The rest is still on its way
+        coveredRanges.pop_front();
+    }
+}
+
+// Recording time of the sample just before position (-1 if its block was untagged)
+static double captureTimeBefore(uint64_t position) {
+    for (size_t i = blockTagCount; i > 0; i--) {
+        const std::pair<uint64_t, CaptureTag>& tag = blockTagAt(i - 1);
+        if (tag.first < position) return captureTimeAt(tag.second, position - tag.first);
+    }
+    return -1.0;
+}
+
+void configureSTTSessions(const STTSessionConfig& config) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    sessionConfig = config;
+}
+
+void beginSTTSession(int sampleRate) {
+    if (sampleRate <= 0) return;
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    sessionActive = true;
+    sessionRate = sampleRate;
+    chunkSamples = (size_t)std::max(1, (int)((int64_t)sessionConfig.chunkMs * sampleRate / 1000));
+    contextSamples = (size_t)std::max(0, (int)((int64_t)sessionConfig.contextMs * sampleRate / 1000));
+    maxUnsentSamples = std::max(chunkSamples, (size_t)((int64_t)sessionConfig.maxBufferedMs * sampleRate / 1000));
+    size_t capacity = maxUnsentSamples + contextSamples;
+    if (buffer.size() != capacity) {
+        buffer.assign(capacity, 0); // Kept across sessions at the same rate
+    }
+    clearBuffer();
+    sentUpTo = 0;
+    clockLimit = 0;
+    haveClockOrigin = false;
+    coveredRanges.clear();
+    stats = STTSessionStats();
+    stats.sessionId = newSessionId();
+    logAudio("STT session " + std::to_string(stats.sessionId) + " started at " + std::to_string(sampleRate) + " Hz");
+}
+
+// Caller holds sessionMutex
+static void finishSession() {
+    sessionActive = false;
+    clearBuffer();
+    coveredRanges.clear();
+    if (stats.droppedSamples > 0) {
+        std::cerr << "[WARNING] STT session: " << stats.droppedSamples << " unsent samples were dropped" << std::endl;
+    }
+    logAudio("STT session ended after " + std::to_string(stats.chunks) + " chunk(s)");
+    stats.sessionId = 0;
+}
+
+void endSTTSession() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (sessionActive) finishSession();
+}
+
+bool isSTTSessionActive() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return sessionActive;
+}
+
+void extendSTTSession(uint64_t samples) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (sessionActive) clockLimit = captureClock() + samples;
+}
+
+void appendSTTSessionAudio(const short* samples, size_t count, const CaptureTag* tag) {
+    if (!samples || count == 0) return;
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (!sessionActive) return;
+    if (clockLimit != 0) {
+        count = (size_t)std::min<uint64_t>(count, clockLimit - std::min(clockLimit, captureClock()));
+        if (count == 0) return;
+    }
+    if (tag) {
+        if (!haveClockOrigin && tag->sample >= captureClock()) {
+            clockOrigin = tag->sample - captureClock();
+            haveClockOrigin = true;
+        }
+        addBlockTag(captureClock(), *tag);
+    }
+    // Only the newest buffer.size() samples of a block can be kept
+    size_t keep = std::min(count, buffer.size());
+    uint64_t clock = bufferEnd + count;
+    uint64_t position = clock - keep;
+    for (size_t i = count - keep; i < count; i++) {
+        buffer[(size_t)(position++ % buffer.size())] = samples[i];
+    }
+    bufferEnd = clock;
+    stats.capturedSamples = clock;
+
+    // Nobody is taking chunks (render thread stalled): keep the newest audio
+    if (clock - sentUpTo > maxUnsentSamples) {
+        uint64_t drop = clock - sentUpTo - maxUnsentSamples;
+        sentUpTo += drop;
+        stats.droppedSamples += drop;
+        trimBufferTo(sentUpTo); // No context across a gap
+    }
+}
+
+bool takeSTTSessionChunk(STTUploadChunk& chunk, bool flush) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (!sessionActive) return false;
+    skipCoveredAudio();
+    // A covered range ahead ends the chunk early; an open one holds the rest back
+    uint64_t limit = captureClock();
+    if (!coveredRanges.empty()) {
+        limit = std::min(limit, std::max(sentUpTo, coveredRanges.front().start));
+    }
+    uint64_t unsent = limit - sentUpTo;
+    bool closed = clockLimit != 0 && captureClock() >= clockLimit;
+    if (closed && unsent == 0) {
+        finishSession(); // Listen window over and everything handed out (or carried)
+        return false;
+    }
+    bool cut = limit < captureClock();
+    if (unsent == 0 || (unsent < chunkSamples && !flush && !closed && !cut)) {
+        return false;
+    }
+
+    uint64_t end = sentUpTo + std::min<uint64_t>(unsent, chunkSamples);
+    uint64_t start = std::max(bufferStart, sentUpTo > contextSamples ? sentUpTo - contextSamples : 0);
+    chunk.info.sessionId = stats.sessionId;
+    chunk.info.sampleOffset = start;
+    chunk.info.contextSamples = (uint32_t)(sentUpTo - start);
+    chunk.info.captureTime = captureTimeBefore(end);
+    recordLatencySince(LatencyStage::SEGMENT, chunk.info.captureTime);
+    chunk.sampleRate = sessionRate;
+    copyBuffered(start, end, chunk.samples);
+
+    sentUpTo = end;
+    keepContextOnly();
+    stats.sentSamples = sentUpTo;
+    stats.chunks++;
+    return true;
+}
+
+void skipSTTSessionAudio() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (!sessionActive) return;
+    uint64_t clock = captureClock();
+    stats.skippedSamples += clock - sentUpTo;
+    sentUpTo = clock;
+    keepContextOnly();
+    stats.sentSamples = sentUpTo;
+}
+
+void coverSTTSessionAudio(uint64_t from, uint64_t to, bool open) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (!sessionActive || !haveClockOrigin) return;
+    // Session-clock positions; audio from before the session clamps to its start
+    uint64_t clock = captureClock();
+    uint64_t start = std::min(clock, from - std::min(from, clockOrigin));
+    uint64_t end = std::max(start, std::min(clock, to - std::min(to, clockOrigin)));
+    if (!coveredRanges.empty() && coveredRanges.back().source == from) {
+        CoveredRange& range = coveredRanges.back();
+        range.end = std::max(range.end, end);
+        range.open = open;
+    } else {
+        coveredRanges.push_back(CoveredRange{from, start, end, open});
+    }
+    skipCoveredAudio();
+}
+
+STTSessionStats getSTTSessionStats() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return stats;
+}
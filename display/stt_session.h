@@ -0,0 +1,76 @@
+#ifndef STT_SESSION_H
+#define STT_SESSION_H
+
+#include "latency.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Upload sessions for batch STT
+// A session spans one capture run. The capture callback appends every block
+// to the session, advancing a capture clock (samples since the session
+// began). The render thread takes chunks once enough unsent audio exists:
+// each chunk holds only audio not uploaded yet, preceded by a short context
+// overlap, and is tagged with the session id and the capture-clock offset of
+// its first sample so the server can stitch consecutive chunks together.
+
+// Position of an upload within its session (sessionId 0: not part of a session)
+struct STTChunkInfo {
+    uint64_t sessionId = 0;
+    uint64_t sampleOffset = 0;    // Capture-clock position of the first sample
+    uint32_t contextSamples = 0;  // Leading samples already sent with the previous chunk
+    double captureTime = -1.0;    // getLatencyClock() when the newest sample was recorded (-1: unknown; not spooled to disk)
+};
+
+struct STTSessionConfig {
+    int chunkMs = 3000;        // New audio per chunk
+    int contextMs = 250;       // Overlap repeated from the previous chunk
+    int maxBufferedMs = 30000; // Unsent audio kept if chunks are not taken; older audio is dropped
+};
+
+struct STTUploadChunk {
+    STTChunkInfo info;
+    int sampleRate;
+    std::vector<short> samples;
+};
+
+struct STTSessionStats {
+    uint64_t sessionId;        // 0 when no session is active
+    uint64_t capturedSamples;  // Capture clock
+    uint64_t sentSamples;      // Capture-clock position up to which audio has been handed out
+    uint64_t droppedSamples;   // Unsent audio discarded past maxBufferedMs
+    uint64_t skippedSamples;   // Audio marked as covered by another transport
+    uint64_t chunks;
+};
+
+void configureSTTSessions(const STTSessionConfig& config); // Applies from the next session
+void beginSTTSession(int sampleRate); // New session id, capture clock back to 0
+void endSTTSession();
+bool isSTTSessionActive();
+
+// Close the session once the capture clock is `samples` past its current
+// position (calling again extends it). Audio past the limit is not kept; the
+// last chunk is flushed by takeSTTSessionChunk, which then ends the session.
+void extendSTTSession(uint64_t samples);
+
+// Capture thread: append one block of PCM16 samples (tag: the block's capture
+// tag, carried to the chunks cut from it for latency tracing)
+void appendSTTSessionAudio(const short* samples, size_t count, const CaptureTag* tag = nullptr);
+
+// Render thread: take the next chunk once chunkMs of unsent audio exists
+// (flush: take whatever is unsent). Call in a loop to catch up after a stall.
+bool takeSTTSessionChunk(STTUploadChunk& chunk, bool flush = false);
+
+// Mark everything captured so far as covered (e.g. the sidecar uploads it)
+void skipSTTSessionAudio();
+
+// Mark audio another transport carried as covered (from/to: CaptureTag::sample
+// positions; needs tagged blocks). Audio before `from` is still handed out,
+// then [from, to) is skipped. While open, the transport is carrying
+// everything from `from` on, so nothing past it is handed out. Ranges arrive
+// in capture order; reporting the same `from` again updates that range.
+void coverSTTSessionAudio(uint64_t from, uint64_t to, bool open);
+
+STTSessionStats getSTTSessionStats();
+
+#endif // STT_SESSION_H
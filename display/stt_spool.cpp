@@ -0,0 +1,482 @@
+#include "stt_spool.h"
+#include "network.h"
+#include "stt_router.h"
+#include "scene_logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>  // For FILE, fopen, fread, fwrite, rename, remove
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// On-disk layout (inside STTSpoolConfig::directory):
+//   seg_000001.bin ...  append-only segments of records
+//   spool.idx           checkpoint: "<segment> <offset>" of the next record to upload
+// Record = header (magic, sample rate, sample count, FNV-1a of the payload;
+// version 2 adds the chunk's context samples, session id and sample offset
+// as 32-bit halves) followed by PCM16 samples. Version 1 records (16-byte
+// header, no session) left by an older build still upload. A torn tail record
+// (crash mid-append) fails the magic/checksum test and is skipped.
+
+static const uint32_t RECORD_MAGIC_V1 = 0x52545453; // "STTR"
+static const uint32_t RECORD_MAGIC = 0x32545453;    // "STT2"
+static const size_t RECORD_HEADER_V1_BYTES = 16;
+static const size_t RECORD_HEADER_BYTES = 36;
+static const size_t MAX_MEMORY_RECORDS = 16; // Render-side queue bound if the uploader falls behind
+
+struct SpoolRecord {
+    int sampleRate;
+    std::vector<short> samples;
+    STTChunkInfo chunk;
+};
+
+static STTSpoolConfig spoolConfig;
+static std::thread uploaderThread;
+static std::atomic<bool> spoolRunning(false);
+
+// Render thread -> uploader thread hand-off
+static std::mutex queueMutex;
+static std::condition_variable queueCv;
+static std::deque<SpoolRecord> memoryQueue;
+
+// Disk state (owned by the uploader thread)
+static uint32_t readSegment = 1;
+static uint64_t readOffset = 0;
+static uint32_t writeSegment = 1;
+static uint64_t writeOffset = 0;
+static FILE* writeFile = nullptr;
+
+// Capture times of session chunks spooled by this run, by (session id, sample
+// offset); the disk format does not carry them, and times from an earlier run
+// would be on another clock anyway (owned by the uploader thread)
+static const size_t MAX_TRACED_RECORDS = 1024;
+static std::deque<std::pair<std::pair<uint64_t, uint64_t>, double>> captureTimes;
+
+static std::mutex statsMutex;
+static STTSpoolStats stats;
+
+static uint32_t fnv1a(const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static std::string segmentPath(uint32_t segment) {
+    char name[32];
+    snprintf(name, sizeof(name), "/seg_%06u.bin", segment);
+    return spoolConfig.directory + name;
+}
+
+static std::string indexPath() {
+    return spoolConfig.directory + "/spool.idx";
+}
+
+static bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) return S_ISDIR(info.st_mode);
+    return mkdir(path.c_str(), 0755) == 0;
+#endif
+}
+
+static bool fileSize(const std::string& path, uint64_t& size) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fclose(file);
+    size = end > 0 ? (uint64_t)end : 0;
+    return true;
+}
+
+// Write the checkpoint to a temp file and rename it over the old one,
+// so a crash leaves either the old or the new checkpoint, never half of one
+static void saveCheckpoint() {
+    std::string tmpPath = indexPath() + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "w");
+    if (!file) {
+        std::cerr << "[ERROR] STT spool: Failed to write checkpoint" << std::endl;
+        return;
+    }
+    fprintf(file, "%u %llu\n", readSegment, (unsigned long long)readOffset);
+    fflush(file);
+    fclose(file);
+#ifdef _WIN32
+    MoveFileExA(tmpPath.c_str(), indexPath().c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    rename(tmpPath.c_str(), indexPath().c_str());
+#endif
+}
+
+static void loadCheckpoint() {
+    readSegment = 1;
+    readOffset = 0;
+    FILE* file = fopen(indexPath().c_str(), "r");
+    if (!file) return;
+    unsigned int segment = 1;
+    unsigned long long offset = 0;
+    if (fscanf(file, "%u %llu", &segment, &offset) == 2 && segment > 0) {
+        readSegment = segment;
+        readOffset = offset;
+    }
+    fclose(file);
+}
+
+// Read the record at offset; returns false at end of data or on a torn record
+static bool readRecord(uint32_t segment, uint64_t offset, SpoolRecord* record, uint64_t& recordBytes) {
+    FILE* file = fopen(segmentPath(segment).c_str(), "rb");
+    if (!file) return false;
+    long segmentBytes = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+
+    bool ok = false;
+    uint32_t header[RECORD_HEADER_BYTES / 4] = {0};
+    size_t headerBytes = 0;
+    if (fseek(file, (long)offset, SEEK_SET) == 0 && fread(header, 1, RECORD_HEADER_V1_BYTES, file) == RECORD_HEADER_V1_BYTES) {
+        if (header[0] == RECORD_MAGIC_V1) {
+            headerBytes = RECORD_HEADER_V1_BYTES;
+        } else if (header[0] == RECORD_MAGIC &&
+                   fread(header + 4, 1, RECORD_HEADER_BYTES - RECORD_HEADER_V1_BYTES, file) == RECORD_HEADER_BYTES - RECORD_HEADER_V1_BYTES) {
+            headerBytes = RECORD_HEADER_BYTES;
+        }
+    }
+    // A sample count the segment cannot hold is a corrupt header, not an allocation size
+    uint64_t payloadLeft = 0;
+    if (segmentBytes > 0 && (uint64_t)segmentBytes > offset + headerBytes) {
+        payloadLeft = (uint64_t)segmentBytes - offset - headerBytes;
+    }
+    if (headerBytes > 0 && header[1] > 0 && (uint64_t)header[2] * sizeof(short) <= payloadLeft) {
+        std::vector<short> samples(header[2]);
+        size_t payloadBytes = samples.size() * sizeof(short);
+        if (fread(samples.data(), 1, payloadBytes, file) == payloadBytes && fnv1a(samples.data(), payloadBytes) == header[3]) {
+            recordBytes = headerBytes + payloadBytes;
+            if (record) {
+                record->sampleRate = (int)header[1];
+                record->samples.swap(samples);
+                record->chunk.contextSamples = header[4];
+                record->chunk.sessionId = (uint64_t)header[5] | ((uint64_t)header[6] << 32);
+                record->chunk.sampleOffset = (uint64_t)header[7] | ((uint64_t)header[8] << 32);
+            }
+            ok = true;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+// Count the valid records from offset to the end of a segment
+static void countRecords(uint32_t segment, uint64_t offset, uint64_t& records, uint64_t& bytes) {
+    records = 0;
+    bytes = 0;
+    uint64_t recordBytes = 0;
+    while (readRecord(segment, offset + bytes, nullptr, recordBytes)) {
+        records++;
+        bytes += recordBytes;
+    }
+}
+
+static bool openWriteSegment(uint32_t segment) {
+    if (writeFile) fclose(writeFile);
+    writeSegment = segment;
+    writeOffset = 0;
+    writeFile = fopen(segmentPath(segment).c_str(), "wb");
+    if (!writeFile) {
+        std::cerr << "[ERROR] STT spool: Failed to open segment " << segmentPath(segment) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Delete the read segment and move the checkpoint to the start of the next one
+static void retireReadSegment() {
+    remove(segmentPath(readSegment).c_str());
+    readSegment++;
+    readOffset = 0;
+    saveCheckpoint();
+}
+
+// Drop the oldest segment to make room (the spool is bounded by maxBytes)
+static void dropOldestSegment() {
+    if (readSegment == writeSegment) {
+        openWriteSegment(writeSegment + 1);
+    }
+    uint64_t records = 0, bytes = 0;
+    countRecords(readSegment, readOffset, records, bytes);
+    uint64_t size = 0;
+    fileSize(segmentPath(readSegment), size);
+    uint64_t remaining = size > readOffset ? size - readOffset : 0;
+    retireReadSegment();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.droppedRecords += records;
+    stats.queuedRecords -= std::min(stats.queuedRecords, records);
+    stats.queuedBytes -= std::min(stats.queuedBytes, remaining);
+    logAudio("STT spool: full, dropped " + std::to_string(records) + " oldest record(s)");
+}
+
+static bool appendRecord(const SpoolRecord& record) {
+    uint64_t payloadBytes = record.samples.size() * sizeof(short);
+    uint64_t recordBytes = RECORD_HEADER_BYTES + payloadBytes;
+    if (recordBytes > spoolConfig.maxBytes) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.droppedRecords++;
+        return false;
+    }
+    while (true) {
+        uint64_t queuedBytes;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            queuedBytes = stats.queuedBytes;
+        }
+        if (queuedBytes + recordBytes <= spoolConfig.maxBytes) break;
+        if (readSegment == writeSegment && writeOffset <= readOffset) {
+            // Nothing left on disk - the counters drifted (e.g. files removed externally)
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.queuedBytes = 0;
+            stats.queuedRecords = 0;
+            break;
+        }
+        dropOldestSegment();
+    }
+
+    if (!writeFile || writeOffset >= spoolConfig.segmentBytes) {
+        if (!openWriteSegment(writeFile ? writeSegment + 1 : writeSegment)) return false;
+    }
+
+    const STTChunkInfo& chunk = record.chunk;
+    uint32_t header[RECORD_HEADER_BYTES / 4] = {RECORD_MAGIC, (uint32_t)record.sampleRate, (uint32_t)record.samples.size(),
+                                                fnv1a(record.samples.data(), payloadBytes), chunk.contextSamples,
+                                                (uint32_t)chunk.sessionId, (uint32_t)(chunk.sessionId >> 32),
+                                                (uint32_t)chunk.sampleOffset, (uint32_t)(chunk.sampleOffset >> 32)};
+    if (fwrite(header, 1, RECORD_HEADER_BYTES, writeFile) != RECORD_HEADER_BYTES ||
+        fwrite(record.samples.data(), 1, payloadBytes, writeFile) != payloadBytes || fflush(writeFile) != 0) {
+        std::cerr << "[ERROR] STT spool: Write failed, rolling to a new segment" << std::endl;
+        openWriteSegment(writeSegment + 1); // Leave the torn record behind
+        return false;
+    }
+    writeOffset += recordBytes;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.queuedRecords++;
+    stats.queuedBytes += recordBytes;
+    return true;
+}
+
+// Find the next record to upload, retiring finished segments on the way
+static bool nextRecord(SpoolRecord& record, uint64_t& recordBytes) {
+    while (true) {
+        if (readRecord(readSegment, readOffset, &record, recordBytes)) {
+            return true;
+        }
+        if (readSegment >= writeSegment) {
+            return false; // Caught up with the writer
+        }
+        retireReadSegment(); // End of segment (or torn tail left by a crash)
+    }
+}
+
+// Flush records queued by the render thread to disk
+static void drainMemoryQueue() {
+    std::deque<SpoolRecord> pending;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.swap(memoryQueue);
+    }
+    for (const SpoolRecord& record : pending) {
+        if (appendRecord(record) && record.chunk.sessionId != 0 && record.chunk.captureTime >= 0.0) {
+            captureTimes.push_back(std::make_pair(std::make_pair(record.chunk.sessionId, record.chunk.sampleOffset),
+                                                  record.chunk.captureTime));
+            if (captureTimes.size() > MAX_TRACED_RECORDS) captureTimes.pop_front();
+        }
+    }
+}
+
+// Restore the capture time of a record read back from disk (consumed once uploaded)
+static bool findCaptureTime(SpoolRecord& record, bool consume) {
+    for (auto it = captureTimes.begin(); it != captureTimes.end(); ++it) {
+        if (it->first.first == record.chunk.sessionId && it->first.second == record.chunk.sampleOffset) {
+            record.chunk.captureTime = it->second;
+            if (consume) captureTimes.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void uploaderLoop() {
+    int backoffMs = 0;
+    auto nextAttempt = std::chrono::steady_clock::now();
+
+    while (true) {
+        drainMemoryQueue();
+        if (!spoolRunning) break;
+
+        SpoolRecord record;
+        uint64_t recordBytes = 0;
+        bool haveRecord = std::chrono::steady_clock::now() >= nextAttempt && nextRecord(record, recordBytes);
+        if (!haveRecord) {
+            // Sleep until new audio arrives, the backoff expires, or stop is requested
+            std::unique_lock<std::mutex> lock(queueMutex);
+            auto wake = backoffMs > 0 ? nextAttempt : std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            queueCv.wait_until(lock, wake, [] { return !spoolRunning || !memoryQueue.empty(); });
+            continue;
+        }
+
+        findCaptureTime(record, false);
+        int status = 0;
+        bool uploaded = (spoolConfig.useRouter && isSTTRouterActive())
+            ? routeAudioToWhisper(record.samples, record.sampleRate, &record.chunk, &status)
+            : sendAudioToWhisper(record.samples, record.sampleRate, spoolConfig.host, spoolConfig.port, &record.chunk, &status);
+        // A record the server rejects outright would fail the same way forever and block the queue
+        bool rejected = !uploaded && isPermanentHTTPFailure(status);
+        if (uploaded || rejected) {
+            readOffset += recordBytes;
+            saveCheckpoint();
+            if (findCaptureTime(record, true) && uploaded) {
+                recordLatencySince(LatencyStage::UPLOAD, record.chunk.captureTime);
+            }
+            if (rejected) {
+                std::cerr << "[WARNING] STT spool: server rejected record (session " << record.chunk.sessionId
+                          << ", offset " << record.chunk.sampleOffset << ") with HTTP " << status << ", dropping it" << std::endl;
+            } else if (backoffMs > 0) {
+                logAudio("STT spool: server reachable again, draining spool");
+            }
+            backoffMs = 0;
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            (uploaded ? stats.uploadedRecords : stats.droppedRecords)++;
+            stats.queuedRecords -= std::min<uint64_t>(stats.queuedRecords, 1);
+            stats.queuedBytes -= std::min(stats.queuedBytes, recordBytes);
+            stats.currentBackoffMs = 0;
+        } else {
+            backoffMs = backoffMs == 0 ? spoolConfig.initialBackoffMs : std::min(backoffMs * 2, spoolConfig.maxBackoffMs);
+            nextAttempt = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoffMs);
+            logAudio("STT spool: upload failed, retrying in " + std::to_string(backoffMs) + "ms");
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.failedAttempts++;
+            stats.currentBackoffMs = backoffMs;
+        }
+    }
+
+    if (writeFile) {
+        fclose(writeFile);
+        writeFile = nullptr;
+    }
+}
+
+bool startSTTSpool(const STTSpoolConfig& config) {
+    if (spoolRunning) {
+        return true;
+    }
+    if (config.maxBytes == 0 || config.segmentBytes == 0 || config.initialBackoffMs <= 0) {
+        return false;
+    }
+    spoolConfig = config;
+    if (!makeDirectory(spoolConfig.directory)) {
+        std::cerr << "[ERROR] STT spool: Cannot create directory " << spoolConfig.directory << std::endl;
+        return false;
+    }
+
+    // Recover: everything from the checkpoint to the last existing segment is still queued
+    loadCheckpoint();
+    STTSpoolStats recovered = STTSpoolStats();
+    uint32_t lastSegment = readSegment;
+    uint64_t size = 0;
+    for (uint32_t segment = readSegment; fileSize(segmentPath(segment), size); segment++) {
+        uint64_t records = 0, bytes = 0;
+        countRecords(segment, segment == readSegment ? readOffset : 0, records, bytes);
+        recovered.queuedRecords += records;
+        recovered.queuedBytes += bytes;
+        lastSegment = segment;
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = recovered;
+    }
+
+    // Never append to a segment from a previous run - it may end in a torn record
+    writeFile = nullptr;
+    writeSegment = lastSegment;
+    writeOffset = 0;
+    if (fileSize(segmentPath(lastSegment), size)) {
+        writeSegment = lastSegment + 1;
+    }
+    if (!openWriteSegment(writeSegment)) {
+        return false;
+    }
+
+    if (recovered.queuedRecords > 0) {
+        std::cout << "[DEBUG] STT spool: Recovered " << recovered.queuedRecords << " queued record(s) from " << spoolConfig.directory << std::endl;
+        logAudio("STT spool: recovered " + std::to_string(recovered.queuedRecords) + " record(s)");
+    }
+
+    spoolRunning = true;
+    uploaderThread = std::thread(uploaderLoop);
+    return true;
+}
+
+void stopSTTSpool() {
+    if (!spoolRunning) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        spoolRunning = false;
+    }
+    queueCv.notify_all();
+    if (uploaderThread.joinable()) {
+        uploaderThread.join(); // Writes any memory-queued audio to disk before exiting
+    }
+    std::cout << "[DEBUG] STT spool: Stopped" << std::endl;
+}
+
+bool isSTTSpoolRunning() {
+    return spoolRunning;
+}
+
+bool enqueueSTTUpload(const std::vector<short>& samples, int sampleRate, const STTChunkInfo* chunk) {
+    if (!spoolRunning || samples.empty() || sampleRate <= 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (memoryQueue.size() >= MAX_MEMORY_RECORDS) {
+            memoryQueue.pop_front(); // Uploader stuck on disk I/O - keep the newest audio
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.droppedRecords++;
+        }
+        memoryQueue.push_back(SpoolRecord{sampleRate, samples, chunk ? *chunk : STTChunkInfo()});
+    }
+    queueCv.notify_one();
+    return true;
+}
+
+STTSpoolStats getSTTSpoolStats() {
+    STTSpoolStats result;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        result = stats;
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    result.queuedRecords += memoryQueue.size();
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef STT_SPOOL_H
+#define STT_SPOOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "stt_session.h"
+
+// Disk-backed upload spool for Whisper STT
+// Utterances queued by the render thread are appended to segment files in
+// the spool directory by a background uploader thread, which drains them to
+// the server in order. A checkpoint index records the next record to send,
+// so audio queued while the server is down survives restarts. Failed uploads
+// back off exponentially, except records the server rejects (HTTP 4xx), which
+// are dropped; the render thread never touches the socket.
+
+struct STTSpoolConfig {
+    std::string directory = "spool";
+    std::string host = "localhost";
+    int port = 8070;
+    bool useRouter = false;                    // Upload through stt_router instead of host:port
+    uint64_t maxBytes = 64ull * 1024 * 1024;   // Oldest segments are dropped past this
+    uint64_t segmentBytes = 1024 * 1024;       // Roll to a new segment file after this size
+    int initialBackoffMs = 500;
+    int maxBackoffMs = 30000;
+};
+
+struct STTSpoolStats {
+    uint64_t queuedRecords;    // Records on disk (or in memory) waiting to upload
+    uint64_t queuedBytes;      // Spool bytes past the checkpoint
+    uint64_t uploadedRecords;  // Records accepted by the server since start
+    uint64_t droppedRecords;   // Records discarded to stay within maxBytes or rejected by the server (HTTP 4xx)
+    uint64_t failedAttempts;   // Upload attempts retried after backoff (connect, timeout, 5xx, 408/429)
+    int currentBackoffMs;      // Delay before the next attempt (0 while healthy)
+};
+
+bool startSTTSpool(const STTSpoolConfig& config);
+void stopSTTSpool(); // Flushes queued audio to disk and joins the uploader
+bool isSTTSpoolRunning();
+
+// Queue one utterance; returns immediately (called from the render thread)
+// chunk (optional) is stored with the audio and sent with its upload
+bool enqueueSTTUpload(const std::vector<short>& samples, int sampleRate, const STTChunkInfo* chunk = nullptr);
+
+STTSpoolStats getSTTSpoolStats();
+
+#endif // STT_SPOOL_H
@@ -0,0 +1,637 @@
+#include "stt_stream.h"
+#include "network.h"
+#include "net_reactor.h"
+#include "scene_logger.h"
+#include "transcript.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+static const char* WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const double INITIAL_RECONNECT_DELAY = 1.0;  // Seconds
+static const double MAX_RECONNECT_DELAY = 30.0;     // Seconds
+static const int PENDING_SECONDS = 5;               // Capture ring bound while the socket is slow
+static const size_t MAX_FINISHED_COVERAGE = 16;     // Closed ranges kept until the render thread takes them
+static const size_t MAX_HANDSHAKE_BYTES = 8192;
+static const int STOP_TIMEOUT_MS = 2000;
+
+// WebSocket opcodes (RFC 6455 section 5.2)
+static const int OP_CONTINUATION = 0x0;
+static const int OP_TEXT = 0x1;
+static const int OP_BINARY = 0x2;
+static const int OP_CLOSE = 0x8;
+static const int OP_PING = 0x9;
+static const int OP_PONG = 0xA;
+
+// Stream configuration (set by startSTTStream)
+static std::string streamHost;
+static int streamPort = 0;
+static std::string streamPath;
+static int streamSampleRate = 44100;
+static size_t streamFrameSamples = 4410;
+static size_t maxPendingSamples = 44100 * PENDING_SECONDS;
+static size_t maxBacklogBytes = 44100 * sizeof(short); // Unsent bytes allowed on the connection
+
+static std::atomic<bool> streamRunning(false);
+static std::atomic<bool> streamConnected(false);
+static std::atomic<bool> flushScheduled(false);
+
+// Connection state machine (network thread only)
+static NetConnId streamConn = 0;
+static uint64_t streamAttempt = 0;     // Handlers of older connections ignore their events
+static bool handshakeDone = false;
+static std::string handshakeKey;
+static std::string recvBuffer;
+static std::string message;
+static int messageOpcode = OP_TEXT;
+static double reconnectDelay = INITIAL_RECONNECT_DELAY;
+static NetTimerId reconnectTimer = 0;
+static std::shared_ptr<std::promise<void>> stopSignal;
+
+// Capture ring: filled by the capture thread, drained on the network thread
+// Sized to maxPendingSamples in startSTTStream; pushing a block never allocates
+static std::mutex ringMutex;
+static std::vector<short> pendingRing;
+static size_t pendingFirst = 0;     // Ring index of the oldest pending sample
+static size_t pendingCount = 0;
+// Capture-clock bookkeeping for the ring (under ringMutex)
+static uint64_t pendingClock = 0;   // Capture clock of the oldest pending sample
+static uint64_t sentClock = 0;      // Capture clock just past the last frame handed to the socket
+static bool coverageOpen = false;   // coverage describes the current connection
+static STTStreamCoverage coverage;
+static std::vector<STTStreamCoverage> finishedCoverage;
+
+// Latest transcript and counters
+static std::mutex statsMutex;
+static std::string latestTranscript;
+static bool latestIsFinal = false;
+static STTStreamStats stats;
+static std::chrono::steady_clock::time_point connectTime;
+static uint32_t maskState = 0;
+
+// SHA-1 (FIPS 180-1), only used for the handshake accept key
+static void sha1(const unsigned char* data, size_t length, unsigned char out[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::vector<unsigned char> msg(data, data + length);
+    uint64_t bitLength = (uint64_t)length * 8;
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) msg.push_back(0x00);
+    for (int i = 7; i >= 0; i--) msg.push_back((unsigned char)(bitLength >> (i * 8)));
+
+    auto rotl = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = ((uint32_t)msg[chunk + i * 4] << 24) | ((uint32_t)msg[chunk + i * 4 + 1] << 16) |
+                   ((uint32_t)msg[chunk + i * 4 + 2] << 8) | (uint32_t)msg[chunk + i * 4 + 3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        out[i * 4] = (unsigned char)(h[i] >> 24);
+        out[i * 4 + 1] = (unsigned char)(h[i] >> 16);
+        out[i * 4 + 2] = (unsigned char)(h[i] >> 8);
+        out[i * 4 + 3] = (unsigned char)h[i];
+    }
+}
+
+static std::string base64Encode(const unsigned char* data, size_t length) {
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) v |= data[i + 2];
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += (i + 1 < length) ? table[(v >> 6) & 0x3F] : '=';
+        out += (i + 2 < length) ? table[v & 0x3F] : '=';
+    }
+    return out;
+}
+
+std::string computeWebSocketAccept(const std::string& key) {
+    std::string combined = key + WEBSOCKET_GUID;
+    unsigned char digest[20];
+    sha1((const unsigned char*)combined.data(), combined.size(), digest);
+    return base64Encode(digest, sizeof(digest));
+}
+
+// xorshift32 - client masking keys only need to be unpredictable to intermediaries
+static uint32_t nextMaskKey() {
+    if (maskState == 0) {
+        maskState = (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count() | 1u;
+    }
+    maskState ^= maskState << 13;
+    maskState ^= maskState >> 17;
+    maskState ^= maskState << 5;
+    return maskState;
+}
+
+// Client frames must be masked (RFC 6455 section 5.3)
+static std::vector<char> encodeFrame(int opcode, const char* payload, size_t length) {
+    std::vector<char> frame;
+    frame.reserve(length + 14);
+    frame.push_back((char)(0x80 | opcode)); // FIN + opcode
+
+    if (length < 126) {
+        frame.push_back((char)(0x80 | length));
+    } else if (length < 65536) {
+        frame.push_back((char)(0x80 | 126));
+        frame.push_back((char)((length >> 8) & 0xFF));
+        frame.push_back((char)(length & 0xFF));
+    } else {
+        frame.push_back((char)(0x80 | 127));
+        for (int i = 7; i >= 0; i--) frame.push_back((char)(((uint64_t)length >> (i * 8)) & 0xFF));
+    }
+
+    uint32_t maskKey = nextMaskKey();
+    char mask[4] = {(char)(maskKey >> 24), (char)(maskKey >> 16), (char)(maskKey >> 8), (char)maskKey};
+    frame.insert(frame.end(), mask, mask + 4);
+
+    size_t offset = frame.size();
+    frame.resize(offset + length);
+    for (size_t i = 0; i < length; i++) {
+        frame[offset + i] = payload[i] ^ mask[i & 3];
+    }
+    return frame;
+}
+
+// Queue a frame on the connection; the reactor finishes partial writes
+static void sendFrame(int opcode, const char* payload, size_t length) {
+    std::vector<char> frame = encodeFrame(opcode, payload, length);
+    sendOnNetConnection(streamConn, std::string(frame.begin(), frame.end()));
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.bytesSent += frame.size();
+}
+
+// Transcript messages: {"type": "partial"|"final", "text": "..."} or {"text": "...", "is_final": true}
+// Messages without a "text" field (status, errors) are ignored
+static void handleTranscriptMessage(const std::string& json) {
+    std::vector<TranscriptEvent> events;
+    if (!parseTranscriptJSON(json, events) || events.empty()) {
+        return;
+    }
+    const TranscriptEvent& event = events.back();
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (stats.firstTranscriptTime < 0.0 && !event.text.empty()) {
+            stats.firstTranscriptTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectTime).count();
+        }
+        if (event.isFinal) stats.finalCount++;
+        else stats.partialCount++;
+        latestTranscript = event.text;
+        latestIsFinal = event.isFinal;
+    }
+
+    if (event.isFinal) {
+        logAudio("STT stream transcript (final): " + event.text);
+    }
+    for (TranscriptEvent& published : events) {
+        publishTranscriptEvent(std::move(published));
+    }
+}
+
+// Parse one complete frame from the front of buffer; returns false if more bytes are needed
+static bool parseFrame(std::string& buffer, bool& fin, int& opcode, std::string& payload) {
+    if (buffer.size() < 2) return false;
+    const unsigned char* bytes = (const unsigned char*)buffer.data();
+    fin = (bytes[0] & 0x80) != 0;
+    opcode = bytes[0] & 0x0F;
+    bool masked = (bytes[1] & 0x80) != 0;
+    uint64_t length = bytes[1] & 0x7F;
+    size_t header = 2;
+
+    if (length == 126) {
+        if (buffer.size() < 4) return false;
+        length = ((uint64_t)bytes[2] << 8) | bytes[3];
+        header = 4;
+    } else if (length == 127) {
+        if (buffer.size() < 10) return false;
+        length = 0;
+        for (int i = 0; i < 8; i++) length = (length << 8) | bytes[2 + i];
+        header = 10;
+    }
+    size_t maskOffset = header;
+    if (masked) header += 4;
+    if (buffer.size() < header + length) return false;
+
+    payload.assign(buffer, header, (size_t)length);
+    if (masked) {
+        for (size_t i = 0; i < payload.size(); i++) {
+            payload[i] ^= buffer[maskOffset + (i & 3)];
+        }
+    }
+    buffer.erase(0, header + (size_t)length);
+    return true;
+}
+
+// Caller holds ringMutex. The connection stopped carrying audio: its range is final
+static void endCoverage() {
+    if (!coverageOpen) return;
+    coverageOpen = false;
+    coverage.open = false;
+    if (finishedCoverage.size() >= MAX_FINISHED_COVERAGE) {
+        finishedCoverage.erase(finishedCoverage.begin());
+    }
+    finishedCoverage.push_back(coverage); // Capacity reserved in startSTTStream
+}
+
+// Caller holds ringMutex. Append to the ring, which must have room for count
+static void writePending(const short* samples, size_t count) {
+    size_t size = pendingRing.size();
+    size_t start = (pendingFirst + pendingCount) % size;
+    size_t head = std::min(count, size - start);
+    std::copy(samples, samples + head, pendingRing.begin() + start);
+    std::copy(samples + head, samples + count, pendingRing.begin());
+    pendingCount += count;
+}
+
+// Caller holds ringMutex. Move the oldest count samples out of the ring (out may be null to drop them)
+static void readPending(short* out, size_t count) {
+    size_t size = pendingRing.size();
+    if (out) {
+        size_t head = std::min(count, size - pendingFirst);
+        std::copy(pendingRing.begin() + pendingFirst, pendingRing.begin() + pendingFirst + head, out);
+        std::copy(pendingRing.begin(), pendingRing.begin() + (count - head), out + head);
+    }
+    pendingFirst = (pendingFirst + count) % size;
+    pendingCount -= count;
+}
+
+static void clearPending() {
+    pendingFirst = 0;
+    pendingCount = 0;
+}
+
+static void connectStream();
+
+// Send fixed-size PCM frames from the ring while the connection keeps up
+// Audio left behind when the backlog is full waits for the next capture block
+static void flushFrames() {
+    flushScheduled = false;
+    if (!streamConnected || streamConn == 0) {
+        return;
+    }
+    std::vector<short> frame(streamFrameSamples);
+    size_t backlog = getNetConnectionBacklog(streamConn);
+    while (backlog < maxBacklogBytes) {
+        {
+            std::lock_guard<std::mutex> lock(ringMutex);
+            if (pendingCount < streamFrameSamples) break;
+            readPending(frame.data(), streamFrameSamples);
+            pendingClock += streamFrameSamples;
+            sentClock = pendingClock;
+        }
+        sendFrame(OP_BINARY, (const char*)frame.data(), frame.size() * sizeof(short));
+        backlog += frame.size() * sizeof(short);
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (stats.firstFrameTime < 0.0) {
+            stats.firstFrameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectTime).count();
+        }
+        stats.framesSent++;
+        stats.samplesSent += frame.size();
+    }
+
+    // Frames still queued on the socket have not reached the server
+    uint64_t queued = getNetConnectionBacklog(streamConn) / sizeof(short);
+    std::lock_guard<std::mutex> lock(ringMutex);
+    if (coverageOpen) {
+        coverage.to = std::max(coverage.to, sentClock - std::min(queued, sentClock - coverage.from));
+    }
+}
+
+// Validate the 101 response; returns false if the upgrade was rejected
+static bool completeHandshake(size_t headerEnd) {
+    std::string headers = recvBuffer.substr(0, headerEnd);
+    recvBuffer.erase(0, headerEnd + 4);
+    if (headers.compare(0, 12, "HTTP/1.1 101") != 0) {
+        std::cerr << "[ERROR] STT stream: Upgrade rejected: " << headers.substr(0, headers.find("\r\n")) << std::endl;
+        return false;
+    }
+
+    // Header names are case-insensitive
+    std::string lower = headers;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    size_t acceptPos = lower.find("sec-websocket-accept:");
+    if (acceptPos == std::string::npos) return false;
+    size_t valueStart = headers.find_first_not_of(" \t", acceptPos + 21);
+    size_t valueEnd = headers.find("\r\n", valueStart);
+    std::string accept = headers.substr(valueStart, valueEnd == std::string::npos ? std::string::npos : valueEnd - valueStart);
+    if (accept != computeWebSocketAccept(handshakeKey)) {
+        std::cerr << "[ERROR] STT stream: Invalid Sec-WebSocket-Accept" << std::endl;
+        return false;
+    }
+
+    handshakeDone = true;
+    reconnectDelay = INITIAL_RECONNECT_DELAY;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        connectTime = std::chrono::steady_clock::now();
+    }
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        clearPending(); // Audio captured while disconnected goes through the POST path
+        streamConnected = true; // Coverage starts with the first block pushed from now on
+    }
+    std::cout << "[DEBUG] STT stream: Connected to ws://" << streamHost << ":" << streamPort << streamPath << std::endl;
+    logAudio("STT stream: connected");
+
+    // Describe the PCM format before the first audio frame
+    std::ostringstream start;
+    start << "{\"type\":\"start\",\"encoding\":\"pcm_s16le\",\"sample_rate\":" << streamSampleRate << ",\"channels\":1}";
+    std::string startStr = start.str();
+    sendFrame(OP_TEXT, startStr.data(), startStr.size());
+    return true;
+}
+
+// Receive transcript messages and answer control frames
+static void handleFrames() {
+    bool fin = false;
+    int opcode = 0;
+    std::string payload;
+    while (streamConn != 0 && parseFrame(recvBuffer, fin, opcode, payload)) {
+        if (opcode == OP_PING) {
+            sendFrame(OP_PONG, payload.data(), payload.size());
+        } else if (opcode == OP_CLOSE) {
+            sendFrame(OP_CLOSE, payload.data(), std::min<size_t>(payload.size(), 2));
+            closeNetConnection(streamConn);
+            return;
+        } else if (opcode == OP_TEXT || opcode == OP_BINARY || opcode == OP_CONTINUATION) {
+            if (opcode != OP_CONTINUATION) {
+                message.clear();
+                messageOpcode = opcode;
+            }
+            message += payload;
+            if (fin && messageOpcode == OP_TEXT) {
+                handleTranscriptMessage(message);
+            }
+        }
+        // OP_PONG: nothing to do
+    }
+}
+
+static void onStreamData(const char* data, size_t length) {
+    recvBuffer.append(data, length);
+    if (!handshakeDone) {
+        size_t headerEnd = recvBuffer.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (recvBuffer.size() > MAX_HANDSHAKE_BYTES) closeNetConnection(streamConn);
+            return;
+        }
+        if (!completeHandshake(headerEnd)) {
+            closeNetConnection(streamConn);
+            return;
+        }
+    }
+    handleFrames();
+}
+
+static void onStreamClosed() {
+    bool wasConnected = handshakeDone;
+    streamConn = 0;
+    handshakeDone = false;
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        streamConnected = false;
+        endCoverage(); // What was still pending or queued goes through the POST path
+        clearPending();
+    }
+
+    if (!streamRunning) {
+        if (stopSignal) {
+            stopSignal->set_value();
+            stopSignal.reset();
+        }
+        return;
+    }
+
+    // A dropped stream reconnects right away; failed connects back off
+    int delayMs = 0;
+    if (wasConnected) {
+        logAudio("STT stream: disconnected, falling back to POST uploads");
+    } else {
+        logAudio("STT stream: connect failed, retrying in " + std::to_string((int)reconnectDelay) + "s");
+        delayMs = (int)(reconnectDelay * 1000.0);
+        reconnectDelay = std::min(reconnectDelay * 2.0, MAX_RECONNECT_DELAY);
+    }
+    reconnectTimer = addNetTimer(delayMs, connectStream);
+}
+
+// Open the connection and send the upgrade request (network thread)
+static void connectStream() {
+    reconnectTimer = 0;
+    if (!streamRunning) {
+        return;
+    }
+
+    uint64_t attempt = ++streamAttempt;
+    handshakeDone = false;
+    recvBuffer.clear();
+    message.clear();
+    unsigned char keyBytes[16];
+    for (int i = 0; i < 16; i += 4) {
+        uint32_t r = nextMaskKey();
+        memcpy(keyBytes + i, &r, 4);
+    }
+    handshakeKey = base64Encode(keyBytes, sizeof(keyBytes));
+
+    NetConnHandlers handlers;
+    handlers.onConnected = [attempt] {
+        if (attempt != streamAttempt) return;
+        std::ostringstream request;
+        request << "GET " << streamPath << " HTTP/1.1\r\n";
+        request << "Host: " << streamHost << ":" << streamPort << "\r\n";
+        request << "Upgrade: websocket\r\n";
+        request << "Connection: Upgrade\r\n";
+        request << "Sec-WebSocket-Key: " << handshakeKey << "\r\n";
+        request << "Sec-WebSocket-Version: 13\r\n";
+        request << "\r\n";
+        std::string requestStr = request.str();
+        sendOnNetConnection(streamConn, requestStr);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.bytesSent += requestStr.size();
+    };
+    handlers.onData = [attempt](const char* data, size_t length) {
+        if (attempt == streamAttempt) onStreamData(data, length);
+    };
+    handlers.onClosed = [attempt](const std::string&) {
+        if (attempt == streamAttempt) onStreamClosed();
+    };
+    streamConn = openNetConnection(streamHost, streamPort, handlers);
+}
+
+bool startSTTStream(const std::string& host, int port, const std::string& path, int sampleRate, int frameMs) {
+    if (streamRunning) {
+        return true; // Already running
+    }
+    if (sampleRate <= 0 || frameMs <= 0) {
+        return false;
+    }
+    if (!isNetReactorRunning()) {
+        std::cerr << "[ERROR] STT stream: Network reactor not running" << std::endl;
+        return false;
+    }
+
+    streamHost = host;
+    streamPort = port;
+    streamPath = path.empty() ? "/" : path;
+    streamSampleRate = sampleRate;
+    streamFrameSamples = std::max<size_t>(1, (size_t)sampleRate * frameMs / 1000);
+    maxPendingSamples = std::max((size_t)sampleRate * PENDING_SECONDS, streamFrameSamples);
+    maxBacklogBytes = (size_t)sampleRate * sizeof(short);
+
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        pendingRing.assign(maxPendingSamples, 0);
+        clearPending();
+        finishedCoverage.reserve(MAX_FINISHED_COVERAGE);
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = STTStreamStats();
+        stats.firstFrameTime = -1.0;
+        stats.firstTranscriptTime = -1.0;
+        latestTranscript.clear();
+        latestIsFinal = false;
+    }
+
+    streamRunning = true;
+    if (!postToNetReactor([] {
+            reconnectDelay = INITIAL_RECONNECT_DELAY;
+            connectStream();
+        })) {
+        streamRunning = false;
+        return false;
+    }
+    std::cout << "[DEBUG] STT stream: Started (" << frameMs << "ms frames at " << sampleRate << "Hz)" << std::endl;
+    return true;
+}
+
+void stopSTTStream() {
+    if (!streamRunning) {
+        return;
+    }
+    streamRunning = false;
+
+    // Send the close frame and drop the connection on the network thread, then wait for onClosed
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> closed = done->get_future();
+    bool posted = postToNetReactor([done] {
+        if (reconnectTimer != 0) {
+            cancelNetTimer(reconnectTimer);
+            reconnectTimer = 0;
+        }
+        if (streamConn == 0) {
+            done->set_value();
+            return;
+        }
+        if (handshakeDone) {
+            const char normalClosure[2] = {(char)0x03, (char)0xE8}; // 1000
+            sendFrame(OP_CLOSE, normalClosure, sizeof(normalClosure));
+        }
+        stopSignal = done;
+        closeNetConnection(streamConn);
+    });
+    if (posted && closed.wait_for(std::chrono::milliseconds(STOP_TIMEOUT_MS)) != std::future_status::ready) {
+        std::cerr << "[WARNING] STT stream: Timed out waiting for the connection to close" << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(ringMutex);
+    streamConnected = false;
+    endCoverage();
+    clearPending();
+    std::cout << "[DEBUG] STT stream: Stopped" << std::endl;
+}
+
+bool isSTTStreamConnected() {
+    return streamConnected;
+}
+
+void pushSTTStreamSamples(const short* samples, int count, uint64_t clock) {
+    if (!streamConnected || !samples || count <= 0) {
+        return;
+    }
+
+    bool frameReady;
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (!streamConnected) return; // Closed since the check above
+        if (!coverageOpen) {
+            coverage.from = coverage.to = sentClock = clock;
+            coverage.open = coverageOpen = true;
+        }
+        uint64_t end = clock + count; // Capture clock just past this block
+        size_t total = pendingCount + (size_t)count;
+        bool overflow = total > pendingRing.size();
+        if (overflow) {
+            // Socket is not keeping up - drop the oldest audio rather than grow unbounded.
+            // The dropped audio never reaches the server, so coverage restarts after it
+            size_t drop = total - pendingRing.size();
+            size_t dropPending = std::min(drop, pendingCount);
+            readPending(nullptr, dropPending);
+            samples += drop - dropPending; // Only the newest part of a block larger than the ring
+            count -= (int)(drop - dropPending);
+        }
+        writePending(samples, (size_t)count);
+        if (overflow) {
+            endCoverage();
+            coverage.from = coverage.to = sentClock = end - pendingCount;
+            coverage.open = coverageOpen = true;
+        }
+        // Positions count back from the newest block (a gap between blocks falls before it)
+        pendingClock = end - pendingCount;
+        frameReady = pendingCount >= streamFrameSamples;
+    }
+    // At most one flush is queued on the reactor at a time
+    if (frameReady && !flushScheduled.exchange(true)) {
+        if (!postToNetReactor(flushFrames)) {
+            flushScheduled = false;
+        }
+    }
+}
+
+bool takeSTTStreamCoverage(std::vector<STTStreamCoverage>& ranges) {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ranges.assign(finishedCoverage.begin(), finishedCoverage.end());
+    finishedCoverage.clear();
+    if (coverageOpen) {
+        ranges.push_back(coverage);
+    }
+    return !ranges.empty();
+}
+
+std::string getLatestTranscript(bool* isFinal) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (isFinal) {
+        *isFinal = latestIsFinal;
+    }
+    return latestTranscript;
+}
+
+STTStreamStats getSTTStreamStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
@@ -0,0 +1,56 @@
+#ifndef STT_STREAM_H
+#define STT_STREAM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// WebSocket streaming transport for Whisper STT
+// Keeps one connection open to the STT server, streams small PCM16 frames
+// from the capture ring as they arrive and receives partial/final transcript
+// messages asynchronously. The connection is a state machine on the network
+// reactor (see net_reactor.h), so the stream owns no threads of its own. The
+// batch POST path in network.cpp stays as the fallback whenever the stream is
+// not connected.
+
+struct STTStreamStats {
+    uint64_t bytesSent;          // Bytes written to the socket (handshake + frames)
+    uint64_t framesSent;         // Binary PCM frames sent
+    uint64_t samplesSent;        // PCM samples carried by those frames
+    double firstFrameTime;       // Seconds from connect to first PCM frame (-1 if none)
+    double firstTranscriptTime;  // Seconds from connect to first transcript (-1 if none)
+    int partialCount;            // Partial transcript messages received
+    int finalCount;              // Final transcript messages received
+};
+
+// Capture-clock range one connection carried (CaptureTag::sample positions)
+// Audio before `to` has left the socket; while the connection is open,
+// everything from `from` on is on its way. Audio before `from` (captured
+// before the connection came up) and from `to` on once it closed (still
+// queued when it dropped) never reached the server.
+struct STTStreamCoverage {
+    uint64_t from;
+    uint64_t to;
+    bool open;
+};
+
+// Start streaming (connects in the background and reconnects with backoff)
+// Requires the network reactor (initNetwork)
+bool startSTTStream(const std::string& host, int port, const std::string& path, int sampleRate, int frameMs = 100);
+void stopSTTStream();
+bool isSTTStreamConnected();
+
+// Called from the capture thread with each new block of samples
+// (clock: CaptureTag::sample of the block's first sample)
+void pushSTTStreamSamples(const short* samples, int count, uint64_t clock);
+
+// Ranges of closed connections not taken yet, then the open one (in capture order)
+bool takeSTTStreamCoverage(std::vector<STTStreamCoverage>& ranges);
+
+std::string getLatestTranscript(bool* isFinal = nullptr);
+STTStreamStats getSTTStreamStats();
+
+// Sec-WebSocket-Accept value for a Sec-WebSocket-Key (RFC 6455 section 4.2.2)
+std::string computeWebSocketAccept(const std::string& key);
+
+#endif // STT_STREAM_H
@@ -1,4 +1,5 @@
 #include "texture.h"
+#include "gl_state.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -16,34 +17,50 @@
 
 // Load texture from image file
 TextureInfo loadTexture(const char* path) {
-    TextureInfo info = {0, 0, 0};
-    glGenTextures(1, &info.id);
-    
+    DecodedImage image;
+    if (!decodeImage(path, image)) {
+        return TextureInfo{0, 0, 0};
+    }
+    return uploadTexture(image);
+}
+
+// Decode an image file to RGBA
+bool decodeImage(const char* path, DecodedImage& image) {
     int width, height, nrComponents;
     // Force loading as RGBA to handle transparency correctly
     unsigned char* data = stbi_load(path, &width, &height, &nrComponents, STBI_rgb_alpha);
-    
-    if (data) {
-        info.width = width;
-        info.height = height;
-        
-        // Always use RGBA format for proper alpha channel support
-        glBindTexture(GL_TEXTURE_2D, info.id);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        
-        // Use OpenGL 2.1 compatible texture parameters
-        // GL_CLAMP works for OpenGL 2.1 (GL_CLAMP_TO_EDGE requires 1.2+ but may not be in headers)
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        stbi_image_free(data);
-    } else {
+    if (!data) {
         std::cerr << "Failed to load texture: " << path << std::endl;
-        stbi_image_free(data);
-        info.id = 0;
+        image.width = 0;
+        image.height = 0;
+        image.rgba.clear();
+        return false;
     }
+    image.width = width;
+    image.height = height;
+    image.rgba.assign(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+// Upload decoded RGBA pixels as a texture in the current context
+TextureInfo uploadTexture(const DecodedImage& image) {
+    TextureInfo info = {0, 0, 0};
+    if (image.width <= 0 || image.height <= 0 || image.rgba.empty()) return info;
+    glGenTextures(1, &info.id);
+    info.width = image.width;
+    info.height = image.height;
+    
+    // Always use RGBA format for proper alpha channel support
+    bindGLTexture(info.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.rgba.data());
+    
+    // Use OpenGL 2.1 compatible texture parameters
+    // GL_CLAMP works for OpenGL 2.1 (GL_CLAMP_TO_EDGE requires 1.2+ but may not be in headers)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
     return info;
 }
@@ -55,20 +72,13 @@ void renderTexture(unsigned int texture, int textureWidth, int textureHeight,
     if (texture == 0 || textureWidth == 0 || textureHeight == 0) return;
     
     // Enable alpha blending for transparency and fade-in
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    setGLAlphaBlend();
+    setGLTexture2D(true);
+    bindGLTexture(texture);
     
-    glViewport(0, 0, windowWidth, windowHeight);
+    setGLViewport(0, 0, windowWidth, windowHeight);
     
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    setGLOrtho2D(windowWidth, windowHeight);
     
     // Target size: 50% of monitor resolution
     float targetWidth = windowWidth * 0.5f;
@@ -102,7 +112,4 @@ void renderTexture(unsigned int texture, int textureWidth, int textureHeight,
         glTexCoord2f(1.0f, 0.0f); glVertex2f(x + quadWidth, y + quadHeight);
         glTexCoord2f(0.0f, 0.0f); glVertex2f(x, y + quadHeight);
     glEnd();
-    
-    glDisable(GL_TEXTURE_2D);
-    glDisable(GL_BLEND);
 }
@@ -1,13 +1,24 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <vector>
+
 struct TextureInfo {
     unsigned int id;
     int width;
     int height;
 };
 
+// RGBA pixels decoded from an image file (no GL, safe on any thread)
+struct DecodedImage {
+    int width;
+    int height;
+    std::vector<unsigned char> rgba;
+};
+
 TextureInfo loadTexture(const char* path);
+bool decodeImage(const char* path, DecodedImage& image);
+TextureInfo uploadTexture(const DecodedImage& image); // Context current
 void renderTexture(unsigned int texture, int textureWidth, int textureHeight, 
                   int windowWidth, int windowHeight, float alpha = 1.0f);
 
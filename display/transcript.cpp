@@ -0,0 +1,385 @@
+#include "transcript.h"
+#include "latency.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+
+static const size_t QUEUE_CAPACITY = 256;   // Power of two
+static const size_t VIEW_LINES = 6;         // Final lines kept for transcript widgets
+
+enum ParserState {
+    PARSE_VALUE = 0,
+    PARSE_STRING,
+    PARSE_ESCAPE,
+    PARSE_UNICODE,
+    PARSE_BARE,     // Number or true/false/null
+    PARSE_DONE,
+    PARSE_ERROR
+};
+
+// Queue slot (Vyukov bounded MPMC): the sequence tells producers and consumers whose turn it is
+// Stored relative to the slot index so the zero-initialised array is already a valid empty queue
+struct alignas(64) QueueCell {
+    std::atomic<size_t> sequence;
+    TranscriptEvent event;
+};
+
+static QueueCell queueCells[QUEUE_CAPACITY];
+alignas(64) static std::atomic<size_t> enqueuePos(0);
+alignas(64) static std::atomic<size_t> dequeuePos(0);
+static std::atomic<uint64_t> publishedCount(0);
+static std::atomic<uint64_t> droppedCount(0);
+static std::atomic<uint64_t> deliveredCount(0);
+static std::atomic<uint64_t> nextUtterance(1);
+
+// Render thread only
+static std::deque<TranscriptEvent> finalLines;
+static TranscriptEvent partialLine;
+static bool hasPartial = false;
+static double lastDeliveryMs = 0.0;
+static double maxDeliveryMs = 0.0;
+
+double getTranscriptClock() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t nextTranscriptUtteranceId() {
+    return nextUtterance++;
+}
+
+// ---- Incremental parser ----
+
+static void appendUTF8(std::string& out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += (char)codepoint;
+    } else if (codepoint < 0x800) {
+        out += (char)(0xC0 | (codepoint >> 6));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += (char)(0xE0 | (codepoint >> 12));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+        out += (char)(0xF0 | (codepoint >> 18));
+        out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    }
+}
+
+static TranscriptEvent newEvent(const TranscriptParser& parser, int segmentId) {
+    TranscriptEvent event;
+    event.utteranceId = parser.utteranceId;
+    event.segmentId = segmentId;
+    event.startSeconds = -1.0;
+    event.endSeconds = -1.0;
+    event.confidence = -1.0f;
+    event.isFinal = true;
+    event.receivedTime = 0.0;
+    return event;
+}
+
+// Inside {"segments": [ {...} ]} - the only nested objects we read
+static bool inSegment(const TranscriptParser& parser) {
+    return parser.containers.size() == 3 && parser.containers[0] == '{' && parser.containers[1] == '[' &&
+           parser.containers[2] == '{' && parser.keys[0] == "segments";
+}
+
+static void onScalar(TranscriptParser& parser, const std::string& value, bool isString) {
+    if (parser.containers.size() == 1 && parser.containers[0] == '{') {
+        const std::string& key = parser.keys[0];
+        if (key == "text" && isString) {
+            parser.text = value;
+            parser.sawText = true;
+        } else if (key == "type" && isString) {
+            parser.finalFlag = value == "final" ? 1 : 0;
+        } else if ((key == "is_final" || key == "final") && !isString) {
+            parser.finalFlag = value == "true" ? 1 : 0;
+        }
+        return;
+    }
+    if (!inSegment(parser)) {
+        return;
+    }
+    const std::string& key = parser.keys[2];
+    if (key == "text" && isString) {
+        size_t first = value.find_first_not_of(' '); // Whisper prefixes segment text with a space
+        parser.segment.text = first == std::string::npos ? "" : value.substr(first);
+    } else if (key == "start" && !isString) {
+        parser.segment.startSeconds = atof(value.c_str());
+    } else if (key == "end" && !isString) {
+        parser.segment.endSeconds = atof(value.c_str());
+    } else if (key == "avg_logprob" && !isString && parser.segment.confidence < 0.0f) {
+        parser.segment.confidence = (float)std::min(1.0, std::exp(atof(value.c_str())));
+    } else if (key == "confidence" && !isString) {
+        parser.segment.confidence = (float)atof(value.c_str());
+    } else if (key == "id" && !isString) {
+        parser.segment.segmentId = atoi(value.c_str());
+    }
+}
+
+static void onOpen(TranscriptParser& parser, char container) {
+    parser.containers.push_back(container);
+    parser.keys.push_back("");
+    parser.expectKey = container == '{';
+    if (inSegment(parser)) {
+        parser.segment = newEvent(parser, parser.segmentCount);
+    }
+}
+
+static bool onClose(TranscriptParser& parser, char container) {
+    if (parser.containers.empty() || parser.containers.back() != container) {
+        return false;
+    }
+    if (container == '{' && inSegment(parser)) {
+        parser.segment.receivedTime = getTranscriptClock();
+        parser.events.push_back(parser.segment);
+        parser.segmentCount++;
+    }
+    parser.containers.pop_back();
+    parser.keys.pop_back();
+    parser.expectKey = false;
+    if (parser.containers.empty()) {
+        parser.state = PARSE_DONE;
+    }
+    return true;
+}
+
+void resetTranscriptParser(TranscriptParser& parser, uint64_t utteranceId) {
+    parser = TranscriptParser();
+    parser.utteranceId = utteranceId;
+}
+
+bool feedTranscriptParser(TranscriptParser& parser, const char* data, size_t length) {
+    for (size_t i = 0; i < length && parser.state != PARSE_ERROR; i++) {
+        char c = data[i];
+        switch (parser.state) {
+        case PARSE_STRING:
+            if (c == '"') {
+                if (parser.tokenIsKey) {
+                    parser.keys.back() = parser.token;
+                    parser.expectKey = false;
+                } else {
+                    onScalar(parser, parser.token, true);
+                }
+                parser.state = PARSE_VALUE;
+            } else if (c == '\\') {
+                parser.state = PARSE_ESCAPE;
+            } else {
+                parser.token += c;
+            }
+            break;
+        case PARSE_ESCAPE:
+            parser.state = PARSE_STRING;
+            switch (c) {
+            case 'n': parser.token += '\n'; break;
+            case 't': parser.token += '\t'; break;
+            case 'r': parser.token += '\r'; break;
+            case 'b': parser.token += '\b'; break;
+            case 'f': parser.token += '\f'; break;
+            case 'u':
+                parser.unicode = 0;
+                parser.unicodeDigits = 0;
+                parser.state = PARSE_UNICODE;
+                break;
+            default: parser.token += c; break; // \" \\ \/
+            }
+            break;
+        case PARSE_UNICODE: {
+            int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if (digit < 0) {
+                parser.state = PARSE_ERROR;
+                break;
+            }
+            parser.unicode = (parser.unicode << 4) | (uint32_t)digit;
+            if (++parser.unicodeDigits < 4) break;
+            parser.state = PARSE_STRING;
+            if (parser.unicode >= 0xD800 && parser.unicode < 0xDC00) {
+                parser.highSurrogate = parser.unicode; // Wait for the low half
+            } else if (parser.unicode >= 0xDC00 && parser.unicode < 0xE000 && parser.highSurrogate) {
+                appendUTF8(parser.token, 0x10000 + ((parser.highSurrogate - 0xD800) << 10) + (parser.unicode - 0xDC00));
+                parser.highSurrogate = 0;
+            } else {
+                appendUTF8(parser.token, parser.unicode);
+                parser.highSurrogate = 0;
+            }
+            break;
+        }
+        case PARSE_BARE:
+            if (isalnum((unsigned char)c) || c == '-' || c == '+' || c == '.') {
+                parser.token += c;
+                break;
+            }
+            onScalar(parser, parser.token, false);
+            parser.state = PARSE_VALUE;
+            // Delimiter is handled as part of the surrounding structure
+            // fall through
+        case PARSE_VALUE:
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ':') {
+                break;
+            }
+            if (c == '{' || c == '[') {
+                onOpen(parser, c);
+            } else if (c == '}' || c == ']') {
+                if (!onClose(parser, c == '}' ? '{' : '[')) parser.state = PARSE_ERROR;
+            } else if (c == ',') {
+                if (parser.containers.empty()) parser.state = PARSE_ERROR;
+                else parser.expectKey = parser.containers.back() == '{';
+            } else if (c == '"') {
+                parser.tokenIsKey = !parser.containers.empty() && parser.containers.back() == '{' && parser.expectKey;
+                parser.token.clear();
+                parser.state = PARSE_STRING;
+            } else if (isalnum((unsigned char)c) || c == '-') {
+                parser.token.assign(1, c);
+                parser.state = PARSE_BARE;
+            } else {
+                parser.state = PARSE_ERROR;
+            }
+            break;
+        case PARSE_DONE:
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n') parser.state = PARSE_ERROR;
+            break;
+        }
+    }
+    return parser.state != PARSE_ERROR;
+}
+
+bool finishTranscriptParser(TranscriptParser& parser) {
+    if (parser.state != PARSE_DONE) {
+        return false;
+    }
+    if (parser.segmentCount == 0 && parser.sawText) {
+        TranscriptEvent event = newEvent(parser, 0);
+        event.text = parser.text;
+        event.receivedTime = getTranscriptClock();
+        parser.events.push_back(event);
+    }
+    // Segments of a batch reply are final; streaming replies say so explicitly
+    for (TranscriptEvent& event : parser.events) {
+        event.isFinal = parser.finalFlag != 0;
+    }
+    return true;
+}
+
+bool parseTranscriptJSON(const std::string& json, std::vector<TranscriptEvent>& events) {
+    TranscriptParser parser;
+    resetTranscriptParser(parser, nextTranscriptUtteranceId());
+    if (!feedTranscriptParser(parser, json.data(), json.size()) || !finishTranscriptParser(parser)) {
+        return false;
+    }
+    events.swap(parser.events);
+    return true;
+}
+
+// ---- Lock-free event queue ----
+
+bool publishTranscriptEvent(TranscriptEvent event) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        size_t index = pos & (QUEUE_CAPACITY - 1);
+        QueueCell& cell = queueCells[index];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire) + index;
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.event = std::move(event);
+                cell.sequence.store(pos + 1 - index, std::memory_order_release);
+                publishedCount++;
+                return true;
+            }
+        } else if (diff < 0) {
+            droppedCount++; // Full: the render thread is not draining (e.g. minimised)
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool pollTranscriptEvent(TranscriptEvent& event) {
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    while (true) {
+        size_t index = pos & (QUEUE_CAPACITY - 1);
+        QueueCell& cell = queueCells[index];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire) + index;
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                event = std::move(cell.event);
+                cell.sequence.store(pos + QUEUE_CAPACITY - index, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // Empty
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+int publishTranscriptReply(const std::string& json, double captureTime) {
+    std::vector<TranscriptEvent> events;
+    if (!parseTranscriptJSON(json, events)) {
+        return 0;
+    }
+    int published = 0;
+    for (TranscriptEvent& event : events) {
+        event.captureTime = captureTime;
+        if (publishTranscriptEvent(std::move(event))) published++;
+    }
+    return published;
+}
+
+TranscriptBusStats getTranscriptBusStats() {
+    TranscriptBusStats stats;
+    stats.published = publishedCount;
+    stats.dropped = droppedCount;
+    stats.delivered = deliveredCount;
+    stats.lastDeliveryMs = lastDeliveryMs;
+    stats.maxDeliveryMs = maxDeliveryMs;
+    return stats;
+}
+
+// ---- Render-thread view ----
+
+void drainTranscriptEvents() {
+    TranscriptEvent event;
+    while (pollTranscriptEvent(event)) {
+        deliveredCount++;
+        lastDeliveryMs = (getTranscriptClock() - event.receivedTime) * 1000.0;
+        maxDeliveryMs = std::max(maxDeliveryMs, lastDeliveryMs);
+        recordLatencySince(LatencyStage::TRANSCRIPT, event.captureTime);
+        if (!event.isFinal) {
+            partialLine = event;
+            hasPartial = true;
+            continue;
+        }
+        if (hasPartial && partialLine.utteranceId <= event.utteranceId) {
+            hasPartial = false; // The final supersedes the streaming partial
+        }
+        if (event.text.empty()) {
+            continue;
+        }
+        finalLines.push_back(event);
+        if (finalLines.size() > VIEW_LINES) finalLines.pop_front();
+    }
+}
+
+std::vector<TranscriptEvent> getTranscriptLines() {
+    std::vector<TranscriptEvent> lines(finalLines.begin(), finalLines.end());
+    if (hasPartial && !partialLine.text.empty()) {
+        lines.push_back(partialLine);
+    }
+    return lines;
+}
+
+void clearTranscriptView() {
+    finalLines.clear();
+    hasPartial = false;
+    lastDeliveryMs = 0.0;
+    maxDeliveryMs = 0.0;
+}
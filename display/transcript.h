@@ -0,0 +1,79 @@
+#ifndef TRANSCRIPT_H
+#define TRANSCRIPT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Transcript events from the STT server to the render thread
+// Replies are parsed incrementally as bytes arrive (Whisper verbose_json
+// segments, plain {"text": ...} replies and streaming partial/final
+// messages). Each segment becomes a TranscriptEvent published on a bounded
+// lock-free queue; the render thread drains it once per frame into the
+// transcript view that "transcript" scene widgets display.
+
+struct TranscriptEvent {
+    uint64_t utteranceId;  // One per server reply
+    int segmentId;         // Segment index within the reply (0 for a plain text reply)
+    std::string text;
+    double startSeconds;   // Segment timing within the uploaded audio (-1 if unknown)
+    double endSeconds;
+    float confidence;      // 0..1 (exp of avg_logprob, or the server's confidence), -1 if unknown
+    bool isFinal;          // False for streaming partials
+    double receivedTime;   // getTranscriptClock() when the segment was parsed
+    double captureTime = -1.0; // When the newest sample of the uploaded audio was recorded (-1 if unknown)
+};
+
+// Incremental JSON parser: feed reply bytes in any chunking
+struct TranscriptParser {
+    int state = 0;
+    std::vector<char> containers;   // '{' or '[' per nesting level
+    std::vector<std::string> keys;  // Current key at each object level
+    bool expectKey = false;
+    bool tokenIsKey = false;
+    std::string token;
+    uint32_t unicode = 0;
+    int unicodeDigits = 0;
+    uint32_t highSurrogate = 0;
+
+    uint64_t utteranceId = 0;
+    std::string text;               // Top-level "text"
+    bool sawText = false;
+    int finalFlag = -1;             // From "type"/"is_final"; -1 when the reply does not say
+    int segmentCount = 0;
+    TranscriptEvent segment;        // Segment being assembled
+    std::vector<TranscriptEvent> events;
+};
+
+void resetTranscriptParser(TranscriptParser& parser, uint64_t utteranceId);
+bool feedTranscriptParser(TranscriptParser& parser, const char* data, size_t length); // False once the JSON is malformed
+bool finishTranscriptParser(TranscriptParser& parser); // Emits the plain-text event if there were no segments
+
+// Parse a complete reply into events (new utterance id); returns false if malformed
+bool parseTranscriptJSON(const std::string& json, std::vector<TranscriptEvent>& events);
+
+// Bounded multi-producer/multi-consumer queue (no locks on either side)
+struct TranscriptBusStats {
+    uint64_t published;
+    uint64_t dropped;          // Published while the queue was full
+    uint64_t delivered;        // Drained by the render thread
+    double lastDeliveryMs;     // Parse to drain delay of the most recent event
+    double maxDeliveryMs;
+};
+
+bool publishTranscriptEvent(TranscriptEvent event); // Any thread; returns false (and drops) when full
+bool pollTranscriptEvent(TranscriptEvent& event);
+// Parse + publish; returns events published. captureTime tags the events
+// with the recording time of the audio they transcribe (see latency.h)
+int publishTranscriptReply(const std::string& json, double captureTime = -1.0);
+uint64_t nextTranscriptUtteranceId();
+double getTranscriptClock(); // Monotonic seconds
+TranscriptBusStats getTranscriptBusStats();
+
+// Render thread: drain the queue into the view (call once per frame)
+void drainTranscriptEvents();
+std::vector<TranscriptEvent> getTranscriptLines(); // Recent finals, then the current partial
+void clearTranscriptView();
+
+#endif // TRANSCRIPT_H
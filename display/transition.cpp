@@ -0,0 +1,160 @@
+#include "transition.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// Fraction of the transition over which a single dissolve tile fades
+static const float DISSOLVE_SOFTNESS = 0.25f;
+
+TransitionEffect parseTransitionEffect(const std::string& name) {
+    if (name == "fade") return TransitionEffect::FADE;
+    if (name == "slide") return TransitionEffect::SLIDE;
+    if (name == "dissolve") return TransitionEffect::DISSOLVE;
+    return TransitionEffect::NONE;
+}
+
+void initSceneTransition(SceneTransition& transition) {
+    transition.texture = 0;
+    transition.textureWidth = 0;
+    transition.textureHeight = 0;
+    transition.lastFrame = 0;
+    transition.lastFrameWidth = 0;
+    transition.lastFrameHeight = 0;
+    transition.copyUs = 0.0;
+    transition.effect = TransitionEffect::NONE;
+    transition.startTime = 0.0;
+    transition.duration = 0.0;
+    transition.active = false;
+}
+
+bool beginSceneTransition(SceneTransition& transition, TransitionEffect effect, double duration,
+                          int fbWidth, int fbHeight, double now) {
+    transition.active = false;
+    if (effect == TransitionEffect::NONE || duration <= 0.0 || fbWidth <= 0 || fbHeight <= 0) return false;
+    if (transition.lastFrame == 0 || transition.lastFrameWidth != fbWidth || transition.lastFrameHeight != fbHeight) {
+        return false; // Nothing presented at this size yet (first frame or resized)
+    }
+
+    // The last presented frame becomes the snapshot; the old snapshot texture
+    // takes the next frame copies, so the snapshot stays intact while it is drawn
+    std::swap(transition.texture, transition.lastFrame);
+    std::swap(transition.textureWidth, transition.lastFrameWidth);
+    std::swap(transition.textureHeight, transition.lastFrameHeight);
+
+    transition.effect = effect;
+    transition.startTime = now;
+    transition.duration = duration;
+    transition.active = true;
+    return true;
+}
+
+void captureTransitionFrame(SceneTransition& transition, int fbWidth, int fbHeight) {
+    if (fbWidth <= 0 || fbHeight <= 0) return;
+    auto start = std::chrono::steady_clock::now();
+    while (glGetError() != GL_NO_ERROR) {} // Only report errors from the copy itself
+    if (transition.lastFrame == 0) {
+        glGenTextures(1, &transition.lastFrame);
+    }
+    bindGLTexture(transition.lastFrame);
+    glReadBuffer(GL_BACK);
+    if (transition.lastFrameWidth != fbWidth || transition.lastFrameHeight != fbHeight) {
+        glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 0, 0, fbWidth, fbHeight, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        transition.lastFrameWidth = fbWidth;
+        transition.lastFrameHeight = fbHeight;
+    } else {
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, fbWidth, fbHeight);
+    }
+    bindGLTexture(0);
+    if (glGetError() != GL_NO_ERROR) {
+        // Scene changes cut until a copy succeeds
+        std::cerr << "[WARNING] Transition: Could not copy the presented frame" << std::endl;
+        transition.lastFrameWidth = 0;
+        transition.lastFrameHeight = 0;
+    }
+    transition.copyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+float getTransitionProgress(const SceneTransition& transition, double now) {
+    if (!transition.active || transition.duration <= 0.0) return 1.0f;
+    float t = (float)std::min(std::max((now - transition.startTime) / transition.duration, 0.0), 1.0);
+    return t * t * (3.0f - 2.0f * t); // Smoothstep: no jump at either end
+}
+
+// Each tile clears at its own point in [0, 1 - softness], from a hash of its index
+float getDissolveTileAlpha(int tile, float progress) {
+    uint32_t h = (uint32_t)tile * 2654435761u;
+    h ^= h >> 16;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    float start = (h & 0xFFFF) / 65535.0f * (1.0f - DISSOLVE_SOFTNESS);
+    return 1.0f - std::min(std::max((progress - start) / DISSOLVE_SOFTNESS, 0.0f), 1.0f);
+}
+
+static void drawSnapshotQuad(float x, float y, float w, float h, float u0, float v0, float u1, float v1) {
+    glTexCoord2f(u0, v0); glVertex2f(x, y);
+    glTexCoord2f(u1, v0); glVertex2f(x + w, y);
+    glTexCoord2f(u1, v1); glVertex2f(x + w, y + h);
+    glTexCoord2f(u0, v1); glVertex2f(x, y + h);
+}
+
+void drawSceneTransition(SceneTransition& transition, int fbWidth, int fbHeight, double now) {
+    if (!transition.active) return;
+    if (now - transition.startTime >= transition.duration) {
+        transition.active = false;
+        return;
+    }
+    float progress = getTransitionProgress(transition, now);
+    float w = (float)fbWidth;
+    float h = (float)fbHeight;
+
+    setGLViewport(0, 0, fbWidth, fbHeight);
+    setGLOrtho2D(fbWidth, fbHeight);
+
+    setGLTexture2D(true);
+    bindGLTexture(transition.texture);
+    setGLAlphaBlend();
+
+    glBegin(GL_QUADS);
+    if (transition.effect == TransitionEffect::FADE) {
+        glColor4f(1.0f, 1.0f, 1.0f, 1.0f - progress);
+        drawSnapshotQuad(0.0f, 0.0f, w, h, 0.0f, 0.0f, 1.0f, 1.0f);
+    } else if (transition.effect == TransitionEffect::SLIDE) {
+        glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+        drawSnapshotQuad(-progress * w, 0.0f, w, h, 0.0f, 0.0f, 1.0f, 1.0f);
+    } else if (transition.effect == TransitionEffect::DISSOLVE) {
+        float tileW = w / DISSOLVE_TILES_X;
+        float tileH = h / DISSOLVE_TILES_Y;
+        for (int ty = 0; ty < DISSOLVE_TILES_Y; ty++) {
+            for (int tx = 0; tx < DISSOLVE_TILES_X; tx++) {
+                float alpha = getDissolveTileAlpha(ty * DISSOLVE_TILES_X + tx, progress);
+                if (alpha <= 0.0f) continue;
+                glColor4f(1.0f, 1.0f, 1.0f, alpha);
+                drawSnapshotQuad(tx * tileW, ty * tileH, tileW, tileH,
+                                 (float)tx / DISSOLVE_TILES_X, (float)ty / DISSOLVE_TILES_Y,
+                                 (float)(tx + 1) / DISSOLVE_TILES_X, (float)(ty + 1) / DISSOLVE_TILES_Y);
+            }
+        }
+    }
+    glEnd();
+}
+
+void releaseSceneTransition(SceneTransition& transition) {
+    deleteGLTexture(transition.texture);
+    deleteGLTexture(transition.lastFrame);
+    initSceneTransition(transition);
+}
@@ -0,0 +1,62 @@
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <string>
+
+// Snapshot scene transitions
+// Each finished frame is copied from the back buffer into a texture before the
+// swap (the front and back buffers are undefined after it). When the displayed
+// scene changes, that copy of the outgoing frame becomes the snapshot without
+// another copy. For the rest of the transition only the incoming scene renders
+// live, and the snapshot is composited over it: one textured quad for fade and
+// slide, a grid of tiles for dissolve. Two scenes are never rendered in the
+// same frame.
+
+enum class TransitionEffect {
+    NONE,      // Hard cut
+    FADE,      // Snapshot fades out over the incoming scene
+    SLIDE,     // Snapshot slides off to the left, uncovering the incoming scene
+    DISSOLVE   // Snapshot breaks up tile by tile in random order
+};
+
+struct SceneTransition {
+    unsigned int texture;        // Snapshot of the outgoing frame (0 until first capture)
+    int textureWidth;
+    int textureHeight;
+    unsigned int lastFrame;      // Copy of the last presented frame (0 until first capture)
+    int lastFrameWidth;
+    int lastFrameHeight;
+    double copyUs;               // CPU time of the last frame copy (the GPU copy runs asynchronously)
+    TransitionEffect effect;
+    double startTime;
+    double duration;             // Seconds
+    bool active;
+};
+
+// Grid of tiles the dissolve effect breaks the snapshot into
+static const int DISSOLVE_TILES_X = 32;
+static const int DISSOLVE_TILES_Y = 18;
+
+// "fade", "slide" or "dissolve"; anything else is NONE
+TransitionEffect parseTransitionEffect(const std::string& name);
+
+void initSceneTransition(SceneTransition& transition);
+// Start a transition from the last presented frame (see captureTransitionFrame).
+// Returns false (hard cut) for NONE, a zero duration, or no frame of this size
+bool beginSceneTransition(SceneTransition& transition, TransitionEffect effect, double duration,
+                          int fbWidth, int fbHeight, double now);
+// Copy the finished frame from the back buffer; call after drawing, before
+// swapping (context current). Skip it while transitions are off
+void captureTransitionFrame(SceneTransition& transition, int fbWidth, int fbHeight);
+// Composite the snapshot over this frame's scene; the transition ends once
+// `duration` has passed. Call after the scene is drawn, before swapping
+void drawSceneTransition(SceneTransition& transition, int fbWidth, int fbHeight, double now);
+// Delete the snapshot and last frame textures (context current)
+void releaseSceneTransition(SceneTransition& transition);
+
+// Eased progress from 0 (all snapshot) to 1 (all incoming scene)
+float getTransitionProgress(const SceneTransition& transition, double now);
+// Snapshot opacity of one dissolve tile at a given progress
+float getDissolveTileAlpha(int tile, float progress);
+
+#endif // TRANSITION_H
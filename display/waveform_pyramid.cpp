@@ -0,0 +1,145 @@
+#include "waveform_pyramid.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static WaveformBin emptyBin() {
+    return WaveformBin{FLT_MAX, -FLT_MAX, 0.0f, 0};
+}
+
+static void mergeBin(WaveformBin& into, const WaveformBin& bin) {
+    into.min = std::min(into.min, bin.min);
+    into.max = std::max(into.max, bin.max);
+    into.sumSquares += bin.sumSquares;
+    into.count += bin.count;
+}
+
+static uint64_t levelBinSamples(const WaveformPyramid& pyramid, int level) {
+    uint64_t samples = (uint64_t)pyramid.binSamples;
+    for (int i = 0; i < level; i++) samples *= (uint64_t)pyramid.fanout;
+    return samples;
+}
+
+void initWaveformPyramid(WaveformPyramid& pyramid, int sampleRate, int binSamples, int fanout, int levels,
+                         size_t capacity) {
+    pyramid.sampleRate = std::max(1, sampleRate);
+    pyramid.binSamples = std::max(1, binSamples);
+    pyramid.fanout = std::max(2, fanout);
+    pyramid.capacity = std::max((size_t)1, capacity);
+    pyramid.levels.assign(std::max(1, levels), WaveformPyramidLevel());
+    for (WaveformPyramidLevel& level : pyramid.levels) {
+        level.ring.assign(pyramid.capacity, emptyBin());
+    }
+    resetWaveformPyramid(pyramid);
+}
+
+void resetWaveformPyramid(WaveformPyramid& pyramid) {
+    for (WaveformPyramidLevel& level : pyramid.levels) {
+        level.written = 0;
+        level.partial = emptyBin();
+        level.partialBins = 0;
+    }
+    pyramid.pending = emptyBin();
+    pyramid.samples = 0;
+}
+
+// Store a completed bin and carry it up; a level completes once per fanout bins below
+static void pushBin(WaveformPyramid& pyramid, int levelIndex, WaveformBin bin) {
+    while (true) {
+        WaveformPyramidLevel& level = pyramid.levels[levelIndex];
+        level.ring[level.written % pyramid.capacity] = bin;
+        level.written++;
+        if (levelIndex + 1 >= (int)pyramid.levels.size()) return;
+
+        WaveformPyramidLevel& parent = pyramid.levels[levelIndex + 1];
+        mergeBin(parent.partial, bin);
+        if (++parent.partialBins < pyramid.fanout) return;
+        bin = parent.partial;
+        parent.partial = emptyBin();
+        parent.partialBins = 0;
+        levelIndex++;
+    }
+}
+
+void appendWaveformSamples(WaveformPyramid& pyramid, const float* samples, size_t count) {
+    if (pyramid.levels.empty()) return;
+    size_t offset = 0;
+    while (offset < count) {
+        size_t take = std::min(count - offset, (size_t)(pyramid.binSamples - pyramid.pending.count));
+        float low = pyramid.pending.min, high = pyramid.pending.max, sumSquares = 0.0f;
+        for (size_t i = offset; i < offset + take; i++) {
+            float sample = samples[i];
+            low = std::min(low, sample);
+            high = std::max(high, sample);
+            sumSquares += sample * sample;
+        }
+        pyramid.pending.min = low;
+        pyramid.pending.max = high;
+        pyramid.pending.sumSquares += sumSquares;
+        pyramid.pending.count += (uint32_t)take;
+        offset += take;
+        if (pyramid.pending.count == (uint32_t)pyramid.binSamples) {
+            pushBin(pyramid, 0, pyramid.pending);
+            pyramid.pending = emptyBin();
+        }
+    }
+    pyramid.samples += count;
+}
+
+void readWaveformView(const WaveformPyramid& pyramid, double seconds, int columns, WaveformView& view) {
+    view.level = 0;
+    view.firstSample = 0;
+    view.samplesPerColumn = 0;
+    view.seconds = 0.0;
+    view.columns.clear();
+    if (columns <= 0 || seconds <= 0.0 || pyramid.levels.empty()) return;
+    double wanted = seconds * pyramid.sampleRate;
+
+    // Coarsest level with at least one bin per column that has any history
+    int levelIndex = 0;
+    for (int i = (int)pyramid.levels.size() - 1; i > 0; i--) {
+        if ((double)levelBinSamples(pyramid, i) * columns <= wanted && pyramid.levels[i].written > 0) {
+            levelIndex = i;
+            break;
+        }
+    }
+    const WaveformPyramidLevel& level = pyramid.levels[levelIndex];
+    uint64_t available = std::min(level.written, (uint64_t)pyramid.capacity);
+    if (available == 0) return;
+
+    double binSamples = (double)levelBinSamples(pyramid, levelIndex);
+    uint64_t binsPerColumn = std::max((uint64_t)1, (uint64_t)std::llround(wanted / columns / binSamples));
+    uint64_t wantedColumns = (uint64_t)std::ceil(wanted / (binsPerColumn * binSamples));
+    uint64_t columnCount = std::min({(uint64_t)columns, wantedColumns, available / binsPerColumn});
+    if (columnCount == 0) {
+        // Less history on this level than one column: one column of all of it
+        binsPerColumn = available;
+        columnCount = 1;
+    }
+
+    uint64_t first = level.written - columnCount * binsPerColumn;
+    view.level = levelIndex;
+    view.firstSample = first * (uint64_t)binSamples;
+    view.samplesPerColumn = binsPerColumn * (uint64_t)binSamples;
+    view.seconds = (double)(columnCount * view.samplesPerColumn) / pyramid.sampleRate;
+    view.columns.resize((size_t)columnCount);
+    for (uint64_t c = 0; c < columnCount; c++) {
+        WaveformBin column = emptyBin();
+        for (uint64_t b = 0; b < binsPerColumn; b++) {
+            mergeBin(column, level.ring[(first + c * binsPerColumn + b) % pyramid.capacity]);
+        }
+        view.columns[(size_t)c] = column;
+    }
+}
+
+float waveformBinRMS(const WaveformBin& bin) {
+    return bin.count > 0 ? sqrtf(bin.sumSquares / bin.count) : 0.0f;
+}
+
+double getWaveformPyramidSpanSeconds(const WaveformPyramid& pyramid, int level) {
+    return (double)levelBinSamples(pyramid, level) * pyramid.capacity / pyramid.sampleRate;
+}
+
+size_t getWaveformPyramidBytes(const WaveformPyramid& pyramid) {
+    return pyramid.levels.size() * pyramid.capacity * sizeof(WaveformBin);
+}
@@ -0,0 +1,62 @@
+#ifndef WAVEFORM_PYRAMID_H
+#define WAVEFORM_PYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multi-resolution waveform history
+// Level 0 summarizes every binSamples captured samples as one min/max/RMS bin;
+// each level above merges `fanout` bins of the level below. Every level is a
+// ring of `capacity` bins, so memory is fixed up front and an append costs
+// O(1) amortized (a bin reaches level k once per fanout^k level-0 bins).
+// Reading a time window picks the coarsest level that still has at least one
+// bin per output column, so a view of an hour reads about as many bins as a
+// view of a second.
+
+struct WaveformBin {
+    float min;
+    float max;
+    float sumSquares;   // Sum of squared samples (RMS = sqrt(sumSquares / count))
+    uint32_t count;     // Samples summarized
+};
+
+struct WaveformPyramidLevel {
+    std::vector<WaveformBin> ring;
+    uint64_t written;     // Bins completed on this level since reset
+    WaveformBin partial;  // Bin being merged from the level below
+    int partialBins;      // Lower-level bins merged into partial
+};
+
+struct WaveformPyramid {
+    int sampleRate;
+    int binSamples;       // Samples per level-0 bin
+    int fanout;           // Lower-level bins per bin
+    size_t capacity;      // Bins kept per level
+    std::vector<WaveformPyramidLevel> levels;
+    WaveformBin pending;  // Level-0 bin being filled from samples
+    uint64_t samples;     // Samples appended since reset
+};
+
+struct WaveformView {
+    int level;                    // Pyramid level the columns were read from
+    uint64_t firstSample;         // Stream position of the oldest column's first sample
+    uint64_t samplesPerColumn;
+    double seconds;               // Time the columns span
+    std::vector<WaveformBin> columns; // Oldest first; fewer than asked when history is short
+};
+
+void initWaveformPyramid(WaveformPyramid& pyramid, int sampleRate, int binSamples = 256, int fanout = 4,
+                         int levels = 8, size_t capacity = 16384);
+void resetWaveformPyramid(WaveformPyramid& pyramid);
+void appendWaveformSamples(WaveformPyramid& pyramid, const float* samples, size_t count);
+
+// Up to `columns` equal columns covering about the last `seconds`, ending at
+// the newest bin completed on the level read
+void readWaveformView(const WaveformPyramid& pyramid, double seconds, int columns, WaveformView& view);
+
+float waveformBinRMS(const WaveformBin& bin);
+double getWaveformPyramidSpanSeconds(const WaveformPyramid& pyramid, int level); // History a level can hold
+size_t getWaveformPyramidBytes(const WaveformPyramid& pyramid);
+
+#endif // WAVEFORM_PYRAMID_H
@@ -1,5 +1,8 @@
 #include "window.h"
 #include "texture.h"
+#include "input.h"
+#include "mirror.h"
+#include "scene.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,6 +20,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <map>
 
 // Error callback
 void error_callback(int /*error*/, const char* description) {
@@ -24,8 +28,8 @@ void error_callback(int /*error*/, const char* description) {
 }
 
 // Framebuffer size callback
-void framebuffer_size_callback(GLFWwindow* /*window*/, int width, int height) {
-    glViewport(0, 0, width, height);
+// Render paths set the viewport every frame through the GL state shadow
+void framebuffer_size_callback(GLFWwindow* /*window*/, int /*width*/, int /*height*/) {
 }
 
 // Window focus callback - only restore primary window focus
@@ -71,29 +75,35 @@ void window_iconify_callback(GLFWwindow* window, int iconified) {
     ensureWindowVisible(window, isPrimary);
 }
 
-// Mouse button callback - handle clicks for audio seed change (double-click) and fade-out trigger (any click)
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
-    if (!window || button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS) return;
-    
-    // Get isPrimary flag from user pointer
-    void* userPtr = glfwGetWindowUserPointer(window);
-    if (!userPtr) return;
-    
-    bool isPrimary = *static_cast<bool*>(userPtr);
-    
-    // Get current mouse position
-    double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
-    
-    double currentTime = glfwGetTime();
-    
-    // Find the WindowData for this window to update click state
-    // We'll need to access it from main.cpp, so for now just store in a static map
-    // or pass through user pointer - let's use a simpler approach: store in WindowData via user pointer
+// Time an input callback's event happened, on the glfwGetTime() clock
+// glfwPollEvents runs once per frame, so on Windows the message's own
+// timestamp is used to take back the time it spent waiting in the queue
+static double inputEventTime() {
+    double now = glfwGetTime();
+    #ifdef _WIN32
+    DWORD age = GetTickCount() - (DWORD)GetMessageTime();
+    if (age < 1000) {
+        now -= age / 1000.0;
+    }
+    #endif
+    return now;
+}
+
+// Mouse button callback - queue every press and release with its time; clicks,
+// double-clicks and the admin tetra-click are recognized from the queue (gesture.h)
+void mouse_button_callback(GLFWwindow* window, int button, int action, int /*mods*/) {
+    if (!window || (action != GLFW_PRESS && action != GLFW_RELEASE)) return;
     
-    // For double-click detection, we need to track last click time and position
-    // This will be handled in main.cpp where we have access to WindowData
-    std::cout << "[DEBUG] mouse_button_callback: Click at (" << xpos << ", " << ypos << "), isPrimary=" << isPrimary << std::endl;
+    InputEvent event;
+    event.source = window;
+    event.type = action == GLFW_PRESS ? InputEventType::PRESS : InputEventType::RELEASE;
+    event.button = button;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    glfwGetWindowSize(window, &event.width, &event.height);
+    event.time = inputEventTime();
+    if (!pushInputEvent(event)) {
+        std::cerr << "[WARNING] mouse_button_callback: Input queue full, event dropped" << std::endl;
+    }
 }
 
 // Ensure window is visible (and optionally focused if primary)
@@ -221,7 +231,7 @@ std::vector<WindowData> createWindows() {
             primaryAssigned = true;
         }
         
-        std::string logoPath = isVertical ? "assets/logo_dark.png" : "assets/logo_light.png";
+        std::string logoPath = isVertical ? VERTICAL_LOGO_PATH : HORIZONTAL_LOGO_PATH;
         std::string monitorType = isVertical ? "Vertical" : (isPrimary ? "Horizontal (Primary)" : "Horizontal");
         
         std::cout << "Monitor " << (i + 1) << ": " << width << "x" << height 
@@ -232,11 +242,21 @@ std::vector<WindowData> createWindows() {
         glfwGetMonitorPos(monitors[i], &xpos, &ypos);
         
         // Create fullscreen window on monitor
+        // Contexts share objects with the first window's, so mirrored monitors
+        // can present one rendered frame; fall back to a private context
+        GLFWwindow* shareWith = windows.empty() ? nullptr : windows[0].window;
         GLFWwindow* window = glfwCreateWindow(width, height, "NDT Logo Display", 
-                                               monitors[i], nullptr);
+                                               monitors[i], shareWith);
+        bool sharedContext = window != nullptr;
+        if (!window && shareWith) {
+            std::cerr << "Warning: Could not share the first window's context, monitor " << (i + 1)
+                      << " renders on its own" << std::endl;
+            window = glfwCreateWindow(width, height, "NDT Logo Display", monitors[i], nullptr);
+        }
         
         if (window) {
             glfwMakeContextCurrent(window);
+            bindGLStateCache(nullptr);  // No WindowData yet: pass straight through
             
             // Store isPrimary in window user pointer BEFORE setting callbacks
             // This prevents callbacks from accessing uninitialized pointer
@@ -301,19 +321,19 @@ std::vector<WindowData> createWindows() {
             wd.state = DisplayState::LOGO_SHOWING;
             wd.audioSeed = 12345;  // Default seed, will be loaded from config
             wd.clickDetected = false;
-            wd.lastClickTime = 0.0;
-            wd.lastClickX = 0.0;
-            wd.lastClickY = 0.0;
             wd.isAdmin = false; // Will be set in main.cpp after including admin.h
             wd.adminModeActive = false;
             wd.adminClickCount = 0;
-            wd.adminClickStartTime = 0.0;
             wd.currentAdminScene = "";
+            wd.selectedLanguage = "";
             wd.openingScene = nullptr;  // Scene will be loaded lazily when needed
             wd.sceneLoading = false;     // Not loading yet
             wd.sceneLoaded = false;      // Not loaded yet (will load on demand)
             wd.loadingProgress = 0.0f;   // No progress yet
             wd.loadingStatus = "";       // No status message yet
+            initSceneTransition(wd.transition);
+            initSnapshotTarget(wd.snapshot);
+            wd.sharedContext = sharedContext;
             windows.push_back(wd);
             
             // Only focus primary window
@@ -345,23 +365,6 @@ std::vector<WindowData> createWindows() {
         return windows;
     }
     
-    // Load textures for each window
-    for (auto& wd : windows) {
-        glfwMakeContextCurrent(wd.window);
-        TextureInfo texInfo = loadTexture(wd.logoPath.c_str());
-        wd.texture = texInfo.id;
-        wd.textureWidth = texInfo.width;
-        wd.textureHeight = texInfo.height;
-        wd.isValid = (wd.texture != 0);
-        
-        if (!wd.isValid) {
-            std::cerr << "Warning: Failed to load texture for " << wd.logoPath << std::endl;
-        } else {
-            std::cout << "Loaded texture: " << wd.logoPath << " (" << wd.textureWidth 
-                      << "x" << wd.textureHeight << ")" << std::endl;
-        }
-    }
-    
     // Ensure all windows are visible and topmost
     // Only primary window receives focus
     for (auto& wd : windows) {
@@ -384,15 +387,45 @@ std::vector<WindowData> createWindows() {
     return windows;
 }
 
+// Upload each window's logo, decoded ahead of time (see decodeImage)
+void uploadWindowLogos(std::vector<WindowData>& windows, const std::map<std::string, DecodedImage>& logos) {
+    for (auto& wd : windows) {
+        glfwMakeContextCurrent(wd.window);
+        bindGLStateCache(&wd.glState);
+        auto logo = logos.find(wd.logoPath);
+        TextureInfo texInfo = logo != logos.end() ? uploadTexture(logo->second) : TextureInfo{0, 0, 0};
+        wd.texture = texInfo.id;
+        wd.textureWidth = texInfo.width;
+        wd.textureHeight = texInfo.height;
+        wd.isValid = (wd.texture != 0);
+        
+        if (!wd.isValid) {
+            std::cerr << "Warning: Failed to load texture for " << wd.logoPath << std::endl;
+        } else {
+            std::cout << "Loaded texture: " << wd.logoPath << " (" << wd.textureWidth 
+                      << "x" << wd.textureHeight << ")" << std::endl;
+        }
+    }
+}
+
 // Cleanup windows
 void cleanupWindows(std::vector<WindowData>& windows) {
+    if (!windows.empty()) {
+        glfwMakeContextCurrent(windows[0].window);
+        bindGLStateCache(&windows[0].glState);
+        releaseMirrorTextures();
+    }
     for (auto& wd : windows) {
         glfwMakeContextCurrent(wd.window);
-        if (wd.isValid && wd.texture != 0) {
-            glDeleteTextures(1, &wd.texture);
+        bindGLStateCache(&wd.glState);
+        if (wd.isValid) {
+            deleteGLTexture(wd.texture);
         }
+        releaseSceneTransition(wd.transition);
+        releaseSnapshotTarget(wd.snapshot);
         // Clean up scene memory if allocated
         if (wd.openingScene) {
+            releaseTextureAtlas(wd.openingScene->images);
             delete wd.openingScene;
             wd.openingScene = nullptr;
         }
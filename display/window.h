@@ -4,6 +4,11 @@
 #include <GLFW/glfw3.h>
 #include <string>
 #include <vector>
+#include <map>
+#include "transition.h"
+#include "snapshot.h"
+#include "texture.h"
+#include "gl_state.h"
 
 // Forward declaration (full definition in scene.h)
 struct Scene;
@@ -16,6 +21,10 @@ enum class DisplayState {
     ADMIN_SCENE     // Showing admin scene
 };
 
+// Logo shown on horizontal / vertical monitors
+const char* const HORIZONTAL_LOGO_PATH = "assets/logo_light.png";
+const char* const VERTICAL_LOGO_PATH = "assets/logo_dark.png";
+
 struct WindowData {
     GLFWwindow* window;
     std::string logoPath;
@@ -32,25 +41,25 @@ struct WindowData {
     double stateStartTime; // Time when current state started
     int audioSeed;         // Seed for procedural audio generation
     bool clickDetected;    // True if user clicked to skip 20s wait
-    double lastClickTime;  // Time of last click for double-click detection
-    double lastClickX;     // X position of last click
-    double lastClickY;     // Y position of last click
     bool isAdmin;          // True if running as admin
     bool adminModeActive;  // True if admin mode is active
-    int adminClickCount;   // Count of clicks in top-right corner
-    double adminClickStartTime; // Time when admin click sequence started
-    std::vector<double> adminClickTimes; // Times of admin clicks
-    std::vector<std::pair<double, double>> adminClickPositions; // Positions of admin clicks
+    int adminClickCount;   // Clicks so far toward the tetra-click (for the indicator)
     std::string currentAdminScene; // Current admin scene file
+    std::string selectedLanguage;  // Language card clicked on the opening scene ("" until one is)
     struct Scene* openingScene;    // Opening scene (loaded lazily, allocated when needed)
     bool sceneLoading;             // True if scene is currently loading
     bool sceneLoaded;              // True if scene was successfully loaded
     float loadingProgress;         // Loading progress (0.0 to 1.0)
     std::string loadingStatus;     // Loading status message
+    SceneTransition transition;    // Snapshot of the previous scene while changing scenes
+    SnapshotTarget snapshot;       // Thumbnail readbacks in flight for remote monitoring
+    GLStateCache glState;          // Shadow of this window's context state (gl_state.h)
+    bool sharedContext;            // Shares textures with the first window's context (can mirror)
 };
 
 // Window management functions
-std::vector<WindowData> createWindows();
+std::vector<WindowData> createWindows();   // Logos are uploaded separately
+void uploadWindowLogos(std::vector<WindowData>& windows, const std::map<std::string, DecodedImage>& logos);
 void cleanupWindows(std::vector<WindowData>& windows);
 
 // Callbacks
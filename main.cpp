@@ -5,6 +5,7 @@
 #include "display/admin.h"
 #include "display/app.h"
 #include "display/render.h"
+#include "display/startup.h"
 #include <GLFW/glfw3.h>
 
 #ifdef _WIN32
@@ -22,6 +23,12 @@
  */
 
 int main() {
+    /**
+     * Start the startup clock first: time to first frame and time to
+     * interactive are measured from here (see startup.h)
+     */
+    getStartupClockMs();
+    
     /**
      * Initialize logging system first
      * This hides the console window on Windows and redirects output to log file
@@ -43,126 +50,77 @@ int main() {
     }
     
     /**
-     * STEP 2: Check admin status
+     * STEP 2: Start the application
+     * Windows are created and their logos shown while the admin check and logo
+     * decode run on workers; audio capture, network and the scene prefetch keep
+     * running in the background and are finished off by the main loop
      */
-    std::cout << "[DEBUG] STEP 2: Checking admin status..." << std::endl;
-    bool isAdmin = false;
-    try {
-        isAdmin = isRunningAsAdmin();
-        if (isAdmin) {
-            std::cout << "[DEBUG] STEP 2: Running as administrator - SUCCESS" << std::endl;
-        } else {
-            std::cout << "[DEBUG] STEP 2: Not running as admin - SUCCESS" << std::endl;
-        }
-    } catch (...) {
-        std::cerr << "[ERROR] STEP 2: Admin check failed" << std::endl;
-        cleanupLogging();
-        return -1;
-    }
-
-    /**
-     * STEP 3: Create windows
-     */
-    std::cout << "[DEBUG] STEP 3: Creating windows..." << std::endl;
+    std::cout << "[DEBUG] STEP 2: Starting application..." << std::endl;
     std::vector<WindowData> windows;
     try {
-        windows = createWindows();
-        std::cout << "[DEBUG] STEP 3: Windows created, count: " << windows.size() << " - SUCCESS" << std::endl;
+        startApplication(windows);
+        std::cout << "[DEBUG] STEP 2: Windows created, count: " << windows.size() << " - SUCCESS" << std::endl;
     } catch (...) {
-        std::cerr << "[ERROR] STEP 3: Window creation failed with exception" << std::endl;
-        cleanupLogging();
-        return -1;
-    }
-    
-    /**
-     * STEP 4: Set admin status for all windows
-     */
-    std::cout << "[DEBUG] STEP 4: Setting admin status for windows..." << std::endl;
-    try {
-        for (auto& wd : windows) {
-            wd.isAdmin = isAdmin;
-        }
-        std::cout << "[DEBUG] STEP 4: Admin status set - SUCCESS" << std::endl;
-    } catch (...) {
-        std::cerr << "[ERROR] STEP 4: Setting admin status failed" << std::endl;
-        cleanupWindows(windows);
-        cleanupLogging();
+        std::cerr << "[ERROR] STEP 2: Application startup failed with exception" << std::endl;
+        cleanupApplication(windows);
         return -1;
     }
     
     /**
-     * STEP 5: Validate windows
+     * STEP 3: Validate windows
      */
-    std::cout << "[DEBUG] STEP 5: Validating windows..." << std::endl;
+    std::cout << "[DEBUG] STEP 3: Validating windows..." << std::endl;
     if (windows.empty()) {
-        std::cerr << "[ERROR] STEP 5: No windows created" << std::endl;
-        cleanupLogging();
+        std::cerr << "[ERROR] STEP 3: No windows created" << std::endl;
+        cleanupApplication(windows);
         return -1;
     }
-    std::cout << "[DEBUG] STEP 5: Windows validated - SUCCESS" << std::endl;
+    std::cout << "[DEBUG] STEP 3: Windows validated - SUCCESS" << std::endl;
     
     /**
-     * STEP 6: Set VSync
+     * STEP 4: Set VSync
      */
-    std::cout << "[DEBUG] STEP 6: Setting VSync..." << std::endl;
+    std::cout << "[DEBUG] STEP 4: Setting VSync..." << std::endl;
     try {
         glfwSwapInterval(1);
-        std::cout << "[DEBUG] STEP 6: VSync set - SUCCESS" << std::endl;
+        std::cout << "[DEBUG] STEP 4: VSync set - SUCCESS" << std::endl;
     } catch (...) {
-        std::cerr << "[ERROR] STEP 6: VSync setting failed" << std::endl;
-        cleanupWindows(windows);
-        cleanupLogging();
+        std::cerr << "[ERROR] STEP 4: VSync setting failed" << std::endl;
+        cleanupApplication(windows);
         return -1;
     }
     
     /**
-     * STEP 7: Display startup messages
+     * STEP 5: Display startup messages
      */
-    std::cout << "[DEBUG] STEP 7: Displaying startup messages..." << std::endl;
+    std::cout << "[DEBUG] STEP 5: Displaying startup messages..." << std::endl;
     std::cout << "Display Running..." << std::endl;
     std::cout << "Press ESC, Alt+F4, or close windows to exit" << std::endl;
-    std::cout << "[DEBUG] STEP 7: Startup messages displayed - SUCCESS" << std::endl;
-    
-    /**
-     * STEP 8: Initialize audio system
-     */
-    std::cout << "[DEBUG] STEP 8: Initializing audio system..." << std::endl;
-    bool audioInitialized = false;
-    try {
-        audioInitialized = initializeSystems();
-        if (!audioInitialized) {
-            std::cerr << "[WARNING] STEP 8: Audio initialization failed, continuing without audio" << std::endl;
-        } else {
-            std::cout << "[DEBUG] STEP 8: Audio initialized - SUCCESS" << std::endl;
-        }
-    } catch (...) {
-        std::cerr << "[ERROR] STEP 8: Audio initialization failed with exception" << std::endl;
-        // Continue anyway
-    }
+    std::cout << "[DEBUG] STEP 5: Startup messages displayed - SUCCESS" << std::endl;
     
     /**
-     * STEP 9: Run main loop
+     * STEP 6: Run main loop
      */
-    std::cout << "[DEBUG] STEP 9: Starting main loop..." << std::endl;
+    std::cout << "[DEBUG] STEP 6: Starting main loop..." << std::endl;
     try {
         runMainLoop(windows);
-        std::cout << "[DEBUG] STEP 9: Main loop exited - SUCCESS" << std::endl;
+        std::cout << "[DEBUG] STEP 6: Main loop exited - SUCCESS" << std::endl;
     } catch (...) {
-        std::cerr << "[ERROR] STEP 9: Main loop failed with exception" << std::endl;
+        std::cerr << "[ERROR] STEP 6: Main loop failed with exception" << std::endl;
         cleanupWindows(windows);
         cleanupLogging();
         return -1;
     }
     
     /**
-     * STEP 10: Cleanup
+     * STEP 7: Cleanup
      */
-    std::cout << "[DEBUG] STEP 10: Cleaning up..." << std::endl;
+    std::cout << "[DEBUG] STEP 7: Cleaning up..." << std::endl;
     try {
         cleanupApplication(windows);
-        std::cout << "[DEBUG] STEP 10: Cleanup complete - SUCCESS" << std::endl;
+        std::cout << "[DEBUG] STEP 7: Cleanup complete - SUCCESS" << std::endl;
     } catch (...) {
-        std::cerr << "[ERROR] STEP 10: Cleanup failed with exception" << std::endl;
+        std::cerr << "[ERROR] STEP 7: Cleanup failed with exception" << std::endl;
         return -1;
     }
     
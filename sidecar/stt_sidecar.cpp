@@ -0,0 +1,110 @@
+#include "../display/config.h"
+#include "../display/network.h"
+#include "../display/sidecar_pump.h"
+#include "../display/stt_router.h"
+#include "../display/stt_spool.h"
+#include "../display/scene_logger.h"
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * STT sidecar entry point
+ * Uploads the audio the display publishes with stt.export_shm, so a hung or
+ * crashed upload never takes the display down and uploads do not compete with
+ * rendering. Reads the same config/app.conf as the display (or the file given
+ * as the first argument) and runs until interrupted.
+ */
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+int main(int argc, char** argv) {
+    std::string configPath = argc > 1 ? argv[1] : "config/app.conf";
+    if (!loadConfig(configPath)) {
+        std::cout << "[DEBUG] Sidecar: " << configPath << " not found, using defaults" << std::endl;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    initAudioLogger();
+
+    /**
+     * Network, router and spool are set up exactly as the display would for
+     * in-process uploads (same stt.* keys)
+     */
+    if (!initNetwork()) {
+        std::cerr << "[ERROR] Sidecar: Network initialization failed" << std::endl;
+        return 1;
+    }
+    std::string defaultEndpoint = getConfigString("stt.host", "localhost") + ":" + std::to_string(getConfigInt("stt.port", 8070));
+    STTRouterConfig routerConfig;
+    routerConfig.hedging = getConfigBool("stt.hedging", true);
+    routerConfig.minHedgeMs = getConfigInt("stt.hedge_min_ms", 50);
+    routerConfig.failureThreshold = getConfigInt("stt.eject_after_failures", 3);
+    routerConfig.ejectMs = getConfigInt("stt.eject_ms", 5000);
+    bool routerReady = initSTTRouter(parseSTTEndpoints(getConfigString("stt.endpoints", defaultEndpoint)), routerConfig);
+
+    STTSpoolConfig spoolConfig;
+    spoolConfig.useRouter = routerReady;
+    spoolConfig.directory = getConfigString("stt.spool_dir", "spool");
+    spoolConfig.host = getConfigString("stt.host", "localhost");
+    spoolConfig.port = getConfigInt("stt.port", 8070);
+    spoolConfig.maxBytes = (uint64_t)getConfigInt("stt.spool_max_mb", 64) * 1024 * 1024;
+    spoolConfig.segmentBytes = (uint64_t)getConfigInt("stt.spool_segment_kb", 1024) * 1024;
+    spoolConfig.maxBackoffMs = getConfigInt("stt.retry_max_ms", 30000);
+    if (!startSTTSpool(spoolConfig)) {
+        std::cerr << "[ERROR] Sidecar: STT spool failed to start" << std::endl;
+        shutdownSTTRouter();
+        cleanupNetwork();
+        return 1;
+    }
+
+    SidecarPumpConfig pumpConfig;
+    pumpConfig.shmName = getConfigString("stt.export_shm", pumpConfig.shmName);
+    pumpConfig.uploadRate = getConfigInt("stt.sidecar_rate", pumpConfig.uploadRate);
+    pumpConfig.chunkMs = getConfigInt("stt.chunk_ms", pumpConfig.chunkMs);
+    pumpConfig.contextMs = getConfigInt("stt.context_overlap_ms", pumpConfig.contextMs);
+    if (!startSidecarPump(pumpConfig)) {
+        std::cerr << "[ERROR] Sidecar: Invalid settings for \"" << pumpConfig.shmName << "\"" << std::endl;
+        stopSTTSpool();
+        shutdownSTTRouter();
+        cleanupNetwork();
+        return 1;
+    }
+    std::cout << "[DEBUG] Sidecar: Waiting for audio on \"" << pumpConfig.shmName << "\"" << std::endl;
+
+    /**
+     * The display publishes a block every ~100 ms; polling at 20 ms keeps the
+     * ring far from full while costing next to nothing when idle
+     */
+    auto lastReport = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+        if (runSidecarPump() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(10)) {
+            lastReport = now;
+            SidecarPumpStats stats = getSidecarPumpStats();
+            STTSpoolStats spool = getSTTSpoolStats();
+            logAudio("Sidecar: " + std::to_string(stats.readSamples) + " samples read, " +
+                     std::to_string(stats.droppedSamples) + " dropped, " + std::to_string(stats.chunks) +
+                     " chunks, " + std::to_string(spool.uploadedRecords) + " uploaded, " +
+                     std::to_string(spool.queuedRecords) + " queued");
+        }
+    }
+
+    std::cout << "[DEBUG] Sidecar: Shutting down" << std::endl;
+    stopSidecarPump();
+    stopSTTSpool(); // Flushes the queued tail to disk for the next run
+    shutdownSTTRouter();
+    cleanupNetwork();
+    cleanupAudioLogger();
+    return 0;
+}
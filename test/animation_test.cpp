@@ -0,0 +1,190 @@
+#include "test.h"
+#include "../display/animation.h"
+#include "../display/scene.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static Widget makeCard(int col, int row) {
+    Widget widget;
+    widget.type = "language_card";
+    widget.col = col;
+    widget.row = row;
+    widget.width = 2;
+    widget.height = 2;
+    widget.margin = 0.1f;
+    return widget;
+}
+
+// Keyframes, easings, holds before/after and channels left at their static values
+void TestWidgetAnimationKeyframes(test::TestContext& ctx) {
+    std::vector<Widget> widgets;
+    widgets.push_back(makeCard(2, 10));
+    widgets[0].properties["color"] = "#336699";
+    widgets[0].properties["animate_col"] = "0.5 0 ease_out, 1.5 4, 2.5 6 ease_in";
+    widgets[0].properties["animate_opacity"] = "0 0, 1 1";
+    widgets.push_back(makeCard(4, 10));
+    widgets[1].properties["animate_color"] = "0 #000000 ease_in_out, 2 #ffffff";
+    widgets[1].properties["animate_width"] = "0 1, 1 x";     // Bad value: not animated
+    widgets[1].properties["animate_height"] = "1 1, 0 2";    // Times go backwards: not animated
+
+    WidgetAnimations animations;
+    buildWidgetAnimations(widgets, animations);
+    ASSERT_EQ((size_t)2, animations.widgetCount);
+    ASSERT_EQ((size_t)5, animations.trackSlot.size());  // col, opacity, and three color channels
+    ASSERT_EQ((size_t)0, animations.segmentValue.size() % 4);
+
+    // Built at time 0
+    ASSERT_NEAR(0.0, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-6);
+    ASSERT_NEAR(0.0, getWidgetAnimationValue(animations, AnimationChannel::OPACITY, 0), 1e-6);
+    ASSERT_NEAR(10.0, getWidgetAnimationValue(animations, AnimationChannel::ROW, 0), 1e-6);
+    ASSERT_NEAR(0.2, getWidgetAnimationValue(animations, AnimationChannel::COLOR_R, 0), 1e-3);
+    ASSERT_NEAR(0.0, getWidgetAnimationValue(animations, AnimationChannel::COLOR_R, 1), 1e-6);
+    ASSERT_NEAR(2.0, getWidgetAnimationValue(animations, AnimationChannel::WIDTH, 1), 1e-6);
+    ASSERT_NEAR(2.0, getWidgetAnimationValue(animations, AnimationChannel::HEIGHT, 1), 1e-6);
+
+    // The first call starts the clock
+    evaluateWidgetAnimations(animations, 100.0);
+    ASSERT_NEAR(0.0, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-6);
+
+    // ease_out at t = 0.5: 1 - 0.5^3 = 0.875 of the way from 0 to 4
+    evaluateWidgetAnimations(animations, 101.0);
+    ASSERT_NEAR(3.5, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-5);
+    ASSERT_NEAR(1.0, getWidgetAnimationValue(animations, AnimationChannel::OPACITY, 0), 1e-6);
+    // Smoothstep at t = 0.5 is halfway
+    ASSERT_NEAR(0.5, getWidgetAnimationValue(animations, AnimationChannel::COLOR_G, 1), 1e-5);
+
+    // Linear second segment, then the last value holds
+    evaluateWidgetAnimations(animations, 102.0);
+    ASSERT_NEAR(5.0, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-5);
+    evaluateWidgetAnimations(animations, 110.0);
+    ASSERT_NEAR(6.0, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-6);
+    ASSERT_NEAR(1.0, getWidgetAnimationValue(animations, AnimationChannel::COLOR_B, 1), 1e-6);
+
+    // A clock that goes back rewinds the cursors
+    animations.startTime = 110.0;
+    evaluateWidgetAnimations(animations, 110.0);
+    ASSERT_NEAR(0.0, getWidgetAnimationValue(animations, AnimationChannel::COL, 0), 1e-6);
+}
+
+// The batched pass agrees with the per-track reference at every frame, for
+// looping and non-looping tracks, with segment counts not a multiple of 4
+void TestWidgetAnimationBatchMatchesReference(test::TestContext& ctx) {
+    const char* easings[] = {"linear", "ease_in", "ease_out", "ease_in_out"};
+    std::vector<Widget> widgets;
+    for (int i = 0; i < 37; i++) {
+        Widget widget = makeCard(i % 8, i % 12);
+        std::string spec;
+        int keys = 1 + i % 5;
+        for (int k = 0; k < keys; k++) {
+            if (k) spec += ", ";
+            spec += std::to_string(0.1f + k * (0.3f + 0.05f * (i % 3))) + " " + std::to_string((k * 7 + i) % 9 - 4) +
+                    " " + easings[(i + k) % 4];
+        }
+        widget.properties[i % 2 ? "animate_row" : "animate_col"] = spec;
+        widget.properties["animate_opacity"] = "0 0.2 ease_in_out, 0.9 1, 1.7 0.4";
+        if (i % 3 == 0) widget.properties["animate_loop"] = "true";
+        widgets.push_back(widget);
+    }
+
+    WidgetAnimations animations;
+    buildWidgetAnimations(widgets, animations);
+    ASSERT_EQ((size_t)74, animations.trackSlot.size());
+    evaluateWidgetAnimations(animations, 0.0);
+    for (int frame = 0; frame < 400; frame++) {
+        float time = frame / 60.0f;
+        evaluateWidgetAnimations(animations, time);
+        for (size_t k = 0; k < animations.trackSlot.size(); k++) {
+            float expected = sampleAnimationTrack(animations, k, time);
+            float actual = animations.values[animations.trackSlot[k]];
+            if (std::fabs(expected - actual) > 1e-5f) {
+                ctx.Fail("Track " + std::to_string(k) + " at " + std::to_string(time) + "s: expected " +
+                         std::to_string(expected) + ", got " + std::to_string(actual));
+                return;
+            }
+        }
+    }
+}
+
+// animate_* fields load from scene JSON into the scene's tracks
+void TestSceneLoadWithAnimations(test::TestContext& ctx) {
+    const char* path = "test_animation_scene.json";
+    FILE* file = fopen(path, "w");
+    ASSERT_NOT_NULL(file);
+    fputs("{\n"
+          "  \"id\": \"animated\",\n"
+          "  \"cols\": 8,\n"
+          "  \"rows\": 12,\n"
+          "  \"widgets\": [\n"
+          "    {\n"
+          "      \"type\": \"language_card\",\n"
+          "      \"row\": 10,\n"
+          "      \"col\": 2,\n"
+          "      \"width\": 2,\n"
+          "      \"height\": 2,\n"
+          "      \"animate_col\": \"0 -2 ease_out, 0.6 2\",\n"
+          "      \"animate_color\": \"0 #202830, 1.5 #3a6ea5\",\n"
+          "      \"animate_loop\": \"true\"\n"
+          "    }\n"
+          "  ]\n"
+          "}\n", file);
+    fclose(file);
+
+    Scene scene;
+    bool loaded = loadScene(path, scene);
+    remove(path);
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ((size_t)1, scene.widgets.size());
+    ASSERT_EQ(2, scene.widgets[0].col);
+    ASSERT_EQ((size_t)4, scene.animations.trackSlot.size());
+    ASSERT_TRUE(scene.animations.trackLoop[0] == 1);
+    ASSERT_NEAR(-2.0, getWidgetAnimationValue(scene.animations, AnimationChannel::COL, 0), 1e-6);
+    ASSERT_NEAR(0x20 / 255.0, getWidgetAnimationValue(scene.animations, AnimationChannel::COLOR_R, 0), 1e-5);
+}
+
+// Per-frame animation cost against the number of animated widgets: the
+// batched SoA pass, and the same tracks sampled one at a time as a per-widget
+// update would (key search from the first key every frame)
+void BenchmarkWidgetAnimations(test::BenchContext& b) {
+    b.RunOnce();
+    for (int count : {1000, 4000, 16000}) {
+        std::vector<Widget> widgets;
+        widgets.reserve(count);
+        for (int i = 0; i < count; i++) {
+            Widget widget = makeCard(i % 8, i % 12);
+            float phase = (i % 17) * 0.05f;
+            widget.properties["animate_col"] = std::to_string(phase) + " 0 ease_out, " + std::to_string(phase + 0.8f) +
+                                               " 6 ease_in_out, " + std::to_string(phase + 1.6f) + " 0";
+            widget.properties["animate_row"] = "0 0 ease_in_out, 1 10, 2 0";
+            widget.properties["animate_opacity"] = "0 0 ease_out, 0.5 1, 1.5 1, 2 0";
+            widget.properties["animate_color"] = "0 #202830 ease_in_out, 1 #3a6ea5, 2 #202830";
+            widget.properties["animate_loop"] = "true";
+            widgets.push_back(widget);
+        }
+        WidgetAnimations animations;
+        buildWidgetAnimations(widgets, animations);
+        size_t tracks = animations.trackSlot.size();
+
+        const int frames = 300;
+        evaluateWidgetAnimations(animations, 0.0);
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 1; frame <= frames; frame++) evaluateWidgetAnimations(animations, frame / 60.0);
+        double batchedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        volatile float sink = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (int frame = 1; frame <= frames; frame++) {
+            float time = frame / 60.0f;
+            for (size_t k = 0; k < tracks; k++) animations.values[animations.trackSlot[k]] = sampleAnimationTrack(animations, k, time);
+            sink = sink + animations.values[0];
+        }
+        double scalarNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        std::string suffix = "-" + std::to_string(count) + "w";
+        b.ReportMetric(batchedNs / 1e6, "ms/frame-batched" + suffix);
+        b.ReportMetric(scalarNs / 1e6, "ms/frame-per-track" + suffix);
+        b.ReportMetric(batchedNs / tracks, "ns/track-batched" + suffix);
+    }
+}
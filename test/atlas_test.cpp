@@ -0,0 +1,149 @@
+#include "test.h"
+#include "../display/atlas.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Image whose every texel encodes its id and position
+static DecodedImage makeImage(int id, int width, int height) {
+    DecodedImage image;
+    image.width = width;
+    image.height = height;
+    image.rgba.resize((size_t)width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* texel = &image.rgba[((size_t)y * width + x) * 4];
+            texel[0] = (unsigned char)id;
+            texel[1] = (unsigned char)x;
+            texel[2] = (unsigned char)y;
+            texel[3] = 255;
+        }
+    }
+    return image;
+}
+
+static const unsigned char* atlasTexel(const TextureAtlas& atlas, int x, int y) {
+    return &atlas.rgba[((size_t)y * atlas.width + x) * 4];
+}
+
+// Images and their gutters stay inside the page, never overlap, sit on the
+// padding grid, and the gutters repeat each image's edge texels
+void TestAtlasPacking(test::TestContext& ctx) {
+    TextureAtlas atlas;
+    initTextureAtlas(atlas, 512, 512, 3);
+    ASSERT_EQ(4, atlas.padding);
+
+    std::vector<DecodedImage> images;
+    for (int i = 0; i < 40; i++) {
+        images.push_back(makeImage(i + 1, 8 + (i * 37) % 57, 6 + (i * 23) % 49));
+        ASSERT_EQ(i, addAtlasImage(atlas, "icon" + std::to_string(i), images.back()));
+    }
+    ASSERT_EQ(7, addAtlasImage(atlas, "icon7", images[0]));  // Same name: packed once
+    ASSERT_EQ((size_t)40, atlas.regions.size());
+    ASSERT_EQ(-1, addAtlasImage(atlas, "huge", makeImage(99, 600, 20)));
+    ASSERT_EQ(-1, findAtlasImage(atlas, "huge"));
+    ASSERT_EQ(12, findAtlasImage(atlas, "icon12"));
+
+    int pad = atlas.padding;
+    for (size_t i = 0; i < atlas.regions.size(); i++) {
+        const AtlasRegion& a = atlas.regions[i];
+        ASSERT_EQ(0, (a.x - pad) % pad);
+        ASSERT_EQ(0, (a.y - pad) % pad);
+        ASSERT_TRUE(a.x - pad >= 0 && a.y - pad >= 0);
+        ASSERT_TRUE(a.x + a.width + pad <= atlas.width && a.y + a.height + pad <= atlas.height);
+        ASSERT_NEAR((double)a.x / atlas.width, a.u0, 1e-6);
+        ASSERT_NEAR((double)(a.y + a.height) / atlas.height, a.v1, 1e-6);
+        for (size_t j = i + 1; j < atlas.regions.size(); j++) {
+            const AtlasRegion& b = atlas.regions[j];
+            bool apart = a.x + a.width + pad <= b.x - pad || b.x + b.width + pad <= a.x - pad ||
+                         a.y + a.height + pad <= b.y - pad || b.y + b.height + pad <= a.y - pad;
+            if (!apart) {
+                ctx.Fail("Regions " + std::to_string(i) + " and " + std::to_string(j) + " overlap");
+                return;
+            }
+        }
+
+        const DecodedImage& image = images[i];
+        for (int y = -pad; y < image.height + pad; y++) {
+            for (int x = -pad; x < image.width + pad; x++) {
+                int sx = std::min(std::max(x, 0), image.width - 1);
+                int sy = std::min(std::max(y, 0), image.height - 1);
+                const unsigned char* texel = atlasTexel(atlas, a.x + x, a.y + y);
+                if (texel[0] != i + 1 || texel[1] != sx || texel[2] != sy) {
+                    ctx.Fail("Region " + std::to_string(i) + " texel " + std::to_string(x) + "," + std::to_string(y) +
+                             " does not match its image");
+                    return;
+                }
+            }
+        }
+    }
+
+    // Re-init keeps the texture for the next sync to refill
+    atlas.texture = 7;
+    initTextureAtlas(atlas, 256, 256);
+    ASSERT_EQ(7u, atlas.texture);
+    ASSERT_TRUE(atlas.regions.empty());
+    ASSERT_TRUE(atlas.dirty);
+}
+
+// Quads fit the image into the widget rect, centered, with the image's top
+// row on the upper edge
+void TestAtlasQuad(test::TestContext& ctx) {
+    AtlasRegion region = {8, 16, 40, 20, 0.25f, 0.5f, 0.75f, 1.0f};
+    std::vector<float> vertices;
+    appendAtlasQuad(region, 100.0f, 200.0f, 80.0f, 80.0f, 0.5f, vertices);
+    ASSERT_EQ((size_t)20, vertices.size());
+    // 40x20 scaled by 2 to 80x40, centered vertically
+    ASSERT_NEAR(100.0, vertices[0], 1e-4);
+    ASSERT_NEAR(220.0, vertices[1], 1e-4);
+    ASSERT_NEAR(0.25, vertices[2], 1e-6);
+    ASSERT_NEAR(1.0, vertices[3], 1e-6);
+    ASSERT_NEAR(0.5, vertices[4], 1e-6);
+    ASSERT_NEAR(180.0, vertices[10], 1e-4);
+    ASSERT_NEAR(260.0, vertices[11], 1e-4);
+    ASSERT_NEAR(0.75, vertices[12], 1e-6);
+    ASSERT_NEAR(0.5, vertices[13], 1e-6);
+
+    appendAtlasQuad(region, 0.0f, 0.0f, 0.0f, 10.0f, 1.0f, vertices);
+    ASSERT_EQ((size_t)20, vertices.size());
+}
+
+// An image-heavy scene: a 12x8 grid of icon widgets over 32 distinct small
+// images. Before, each image is its own texture, bound and drawn per widget
+// as renderTexture does; with the atlas the layer is one bind and one draw
+void BenchmarkSceneAtlas(test::BenchContext& b) {
+    b.RunOnce();
+    const int distinct = 32;
+    const int widgets = 96;
+    std::vector<DecodedImage> images;
+    for (int i = 0; i < distinct; i++) images.push_back(makeImage(i, 24 + (i * 29) % 105, 24 + (i * 53) % 105));
+
+    const int builds = 50;
+    TextureAtlas atlas;
+    auto start = std::chrono::steady_clock::now();
+    for (int build = 0; build < builds; build++) {
+        initTextureAtlas(atlas);
+        for (int i = 0; i < distinct; i++) addAtlasImage(atlas, "icon" + std::to_string(i), images[i]);
+    }
+    double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / builds;
+
+    std::vector<float> vertices;
+    const int frames = 2000;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        vertices.clear();
+        for (int w = 0; w < widgets; w++) {
+            appendAtlasQuad(atlas.regions[w % distinct], (w % 12) * 160.0f, (w / 12) * 135.0f, 160.0f, 135.0f, 1.0f, vertices);
+        }
+    }
+    double batchUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    b.ReportMetric(widgets, "binds/frame-before");
+    b.ReportMetric(widgets, "draws/frame-before");
+    b.ReportMetric(1, "binds/frame-atlas");
+    b.ReportMetric(1, "draws/frame-atlas");
+    b.ReportMetric(100.0 * atlas.usedArea / (atlas.width * atlas.height), "%-page-used");
+    b.ReportMetric(packMs, "ms/pack-32-images");
+    b.ReportMetric(batchUs, "us/frame-batch");
+}
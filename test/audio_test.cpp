@@ -1,10 +1,18 @@
 #include "test.h"
 #include "../display/audio.h"
+#include "../display/dsp.h"
+#include "../display/kws.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 void TestAudioInit(test::TestContext& ctx) {
-    initAudio(12345);
+    initAudioGeneration(12345);
     int seed = getAudioSeed();
     ASSERT_EQ(12345, seed);
     cleanupAudio();
@@ -12,7 +20,7 @@ void TestAudioInit(test::TestContext& ctx) {
 
 void TestAudioSeedPersistence(test::TestContext& ctx) {
     // Test seed save/load
-    initAudio(99999);
+    initAudioGeneration(99999);
     setAudioSeed(88888);
     bool saved = saveAudioSeed("test_audio_seed.txt");
     ASSERT_TRUE(saved);
@@ -30,7 +38,7 @@ void TestAudioSeedPersistence(test::TestContext& ctx) {
 }
 
 void TestAudioWaveformAmplitudes(test::TestContext& ctx) {
-    initAudio(12345);
+    initAudioGeneration(12345);
     
     // Get waveform amplitudes
     auto amplitudes = getWaveformAmplitudes();
@@ -43,11 +51,85 @@ void TestAudioWaveformAmplitudes(test::TestContext& ctx) {
 }
 
 void TestAudioUpdate(test::TestContext& ctx) {
-    initAudio(12345);
+    initAudioGeneration(12345);
     
     // Test audio update doesn't crash
     updateAudio(0.016f); // ~60fps delta time
     ASSERT_TRUE(true); // Function executed successfully
     
     cleanupAudio();
-}
\ No newline at end of file
+}
+
+// Half a second of a 440 Hz tone whose level steps every 1/30 s bar
+static std::vector<short> steppedTone(int rate) {
+    const int samplesPerBar = rate / 30;
+    std::vector<short> samples(rate / 2);
+    for (size_t i = 0; i < samples.size(); i++) {
+        float level = 0.1f + 0.2f * (float)((i / samplesPerBar) % 5);
+        samples[i] = (short)(level * 32767.0f * std::sin(2.0 * 3.14159265358979 * 440.0 * i / rate));
+    }
+    return samples;
+}
+
+// Bars come from the sample clock: the same file yields the same bars whether
+// the display polls at 144, 60 or 30 Hz, and the scroll position advances
+// smoothly between the file source's 100 ms blocks
+void TestWaveformFollowsAudioClock(test::TestContext& ctx) {
+    const int rate = 44100;
+    const std::string path = "test_waveform_clock.wav";
+    ASSERT_TRUE(saveWAVFile(path, steppedTone(rate), rate));
+    CaptureDSPConfig dsp;
+    dsp.enabled = false; // Gate and AGC state would carry over between runs
+    initCaptureDSP(dsp, rate);
+
+    // As fast as the file can be read: exactly one bar per 1470 samples. Bars
+    // are scaled by the loudest of the last 30, so the reference is the second
+    // run, once that window holds only this file
+    uint64_t before = 0;
+    for (int run = 0; run < 2; run++) {
+        ASSERT_TRUE(initAudioCaptureFromFile(path, rate, false));
+        before = getWaveformBarCount();
+        startAudioCapture();
+        for (int i = 0; i < 500 && isAudioCapturing(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        stopAudioCapture();
+        ASSERT_EQ((uint64_t)15, getWaveformBarCount() - before);
+    }
+    std::vector<float> reference = getWaveformAmplitudes();
+    reference.resize(15);
+
+    for (int refreshHz : {144, 60, 30}) {
+        ASSERT_TRUE(initAudioCaptureFromFile(path, rate, true));
+        before = getWaveformBarCount();
+        double previous = getWaveformSnapshot().position;
+        double largestStep = 0.0;
+        bool backwards = false;
+        startAudioCapture();
+        auto frame = std::chrono::steady_clock::now();
+        while (isAudioCapturing()) {
+            frame += std::chrono::microseconds(1000000 / refreshHz);
+            std::this_thread::sleep_until(frame);
+            WaveformSnapshot snapshot = getWaveformSnapshot();
+            if (snapshot.position < previous - 1e-9) backwards = true;
+            largestStep = std::max(largestStep, snapshot.position - previous);
+            previous = snapshot.position;
+        }
+        stopAudioCapture();
+        ASSERT_EQ((uint64_t)15, getWaveformBarCount() - before);
+        std::vector<float> heights = getWaveformAmplitudes();
+        heights.resize(15);
+        for (size_t i = 0; i < heights.size(); i++) ASSERT_NEAR(reference[i], heights[i], 1e-6);
+        ASSERT_FALSE(backwards);
+        // A 100 ms block holds 3 bars; interpolation spreads them over the frames
+        double expectedStep = 30.0 / refreshHz;
+        if (largestStep > expectedStep + 1.0) {
+            ctx.Fail("Waveform jumped " + std::to_string(largestStep) + " bars in one frame at " +
+                     std::to_string(refreshHz) + " Hz");
+        }
+    }
+
+    cleanupAudioCapture();
+    initCaptureDSP(CaptureDSPConfig(), rate);
+    std::remove(path.c_str());
+}
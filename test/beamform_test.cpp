@@ -0,0 +1,252 @@
+#include "test.h"
+#include "../display/beamform.h"
+#include "../display/audio.h"
+#include "../display/dsp.h"
+#include "../display/kws.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Array fixtures are synthesized: a broadband talker (a few hundred tones
+// with random phases) reaches each microphone with its exact plane-wave
+// delay, plus independent white noise per channel
+
+static const double PI = 3.14159265358979323846;
+static const int RATE = 44100;
+static const double SPEED_OF_SOUND = 343.0;
+
+static double uniform(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) / 16777216.0;
+}
+
+// Interleaved float frames; either part can be left out to measure it alone
+static std::vector<float> synthesizeArray(const std::vector<MicPosition>& mics, float azimuthDeg, float seconds,
+                                          float signalRms, float noiseRms, uint32_t seed) {
+    const int tones = 240;
+    size_t frames = (size_t)(seconds * RATE);
+    size_t channels = mics.size();
+    std::vector<float> out(frames * channels, 0.0f);
+    double azimuth = azimuthDeg * PI / 180.0;
+    double amplitude = signalRms * sqrt(2.0 / tones);
+    for (int t = 0; t < tones && signalRms > 0.0f; t++) {
+        double frequency = 200.0 + uniform(seed) * 5800.0;
+        double phase = uniform(seed) * 2.0 * PI;
+        double step = 2.0 * PI * frequency / RATE;
+        for (size_t m = 0; m < channels; m++) {
+            // Microphones further along the arrival direction hear the talker earlier
+            double lead = (mics[m].x * cos(azimuth) + mics[m].y * sin(azimuth)) / SPEED_OF_SOUND;
+            double startRe = cos(phase + 2.0 * PI * frequency * lead), startIm = sin(phase + 2.0 * PI * frequency * lead);
+            double re = startRe, im = startIm, rotRe = cos(step), rotIm = sin(step);
+            for (size_t i = 0; i < frames; i++) {
+                out[i * channels + m] += (float)(amplitude * im);
+                double nextRe = re * rotRe - im * rotIm;
+                im = re * rotIm + im * rotRe;
+                re = nextRe;
+            }
+        }
+    }
+    if (noiseRms > 0.0f) {
+        double scale = noiseRms * sqrt(12.0);
+        for (float& x : out) {
+            x += (float)((uniform(seed) - 0.5) * scale);
+        }
+    }
+    return out;
+}
+
+static std::vector<short> toPCM(const std::vector<float>& samples) {
+    std::vector<short> pcm(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        pcm[i] = (short)lrint(std::max(-1.0f, std::min(32767.0f / 32768.0f, samples[i])) * 32768.0f);
+    }
+    return pcm;
+}
+
+static std::vector<short> beamformAll(const std::vector<short>& interleaved, size_t channels) {
+    size_t frames = interleaved.size() / channels;
+    std::vector<short> out(frames);
+    for (size_t pos = 0; pos < frames; pos += 4410) {
+        beamformBlock(&interleaved[pos * channels], std::min<size_t>(4410, frames - pos), &out[pos]);
+    }
+    return out;
+}
+
+static double power(const std::vector<short>& pcm, size_t from) {
+    double sum = 0.0;
+    for (size_t i = from; i < pcm.size(); i++) {
+        sum += (double)pcm[i] * pcm[i];
+    }
+    return sum / (pcm.size() - from);
+}
+
+static float angleError(float a, float b) {
+    float d = fmodf(fabsf(a - b), 360.0f);
+    return std::min(d, 360.0f - d);
+}
+
+static std::vector<MicPosition> squareArray(float side) {
+    float h = side / 2;
+    return {{-h, -h}, {h, -h}, {h, h}, {-h, h}};
+}
+
+static std::vector<MicPosition> circularArray(int count, float radius) {
+    std::vector<MicPosition> mics;
+    for (int i = 0; i < count; i++) {
+        mics.push_back({(float)(radius * cos(2.0 * PI * i / count)), (float)(radius * sin(2.0 * PI * i / count))});
+    }
+    return mics;
+}
+
+void TestGCCPHATDelay(test::TestContext& ctx) {
+    // Integer delays of a noise burst, either way round
+    uint32_t seed = 7;
+    std::vector<float> a(4096), b(4096, 0.0f), c(4096, 0.0f);
+    for (float& x : a) x = (float)(uniform(seed) - 0.5);
+    for (size_t i = 7; i < a.size(); i++) b[i] = a[i - 7];
+    for (size_t i = 0; i + 5 < a.size(); i++) c[i] = a[i + 5];
+    ASSERT_NEAR(7.0f, estimateTDOA(a.data(), b.data(), a.size(), 32), 0.3f);
+    ASSERT_NEAR(-5.0f, estimateTDOA(a.data(), c.data(), a.size(), 32), 0.3f);
+
+    // Fractional delay between two microphones 4 cm apart along the arrival direction
+    std::vector<MicPosition> pair = {{0.04f, 0.0f}, {0.0f, 0.0f}};
+    std::vector<float> frames = synthesizeArray(pair, 0.0f, 0.2f, 0.1f, 0.001f, 11);
+    std::vector<float> first(frames.size() / 2), second(frames.size() / 2);
+    for (size_t i = 0; i < first.size(); i++) {
+        first[i] = frames[2 * i];
+        second[i] = frames[2 * i + 1];
+    }
+    float expected = (float)(0.04 / SPEED_OF_SOUND * RATE); // ~5.14 samples
+    ASSERT_NEAR(expected, estimateTDOA(first.data(), second.data(), first.size(), 16), 0.5f);
+
+    std::vector<MicPosition> parsed;
+    ASSERT_TRUE(parseMicArray("-0.03,0; 0.03, 0 ;0,0.05", parsed));
+    ASSERT_EQ(3, (int)parsed.size());
+    ASSERT_NEAR(0.05f, parsed[2].y, 1e-6f);
+    ASSERT_FALSE(parseMicArray("0.03,0", parsed));
+    ASSERT_FALSE(parseMicArray("0.03;0,0", parsed));
+}
+
+void TestBeamformerLocatesTalker(test::TestContext& ctx) {
+    BeamformerConfig config;
+    config.mics = squareArray(0.06f);
+    const float azimuths[] = {60.0f, 200.0f, 315.0f};
+    for (float azimuth : azimuths) {
+        ASSERT_TRUE(initBeamformer(config, RATE));
+        std::vector<short> pcm = toPCM(synthesizeArray(config.mics, azimuth, 0.5f, 0.05f, 0.005f, 3));
+        beamformAll(pcm, config.mics.size());
+        BeamformerStats stats = getBeamformerStats();
+        ASSERT_TRUE(stats.doaUpdates >= 5);
+        ASSERT_TRUE(angleError(stats.doaDeg, azimuth) <= 5.0f);
+        ASSERT_TRUE(angleError(stats.steerDeg, azimuth) <= 5.0f); // The beam followed
+        ASSERT_TRUE(stats.doaConfidence >= config.doaMinConfidence);
+    }
+
+    // Silence does not move the beam
+    ASSERT_TRUE(initBeamformer(config, RATE));
+    beamformAll(std::vector<short>(RATE * 4 / 2, 0), config.mics.size());
+    ASSERT_EQ(0u, (unsigned)getBeamformerStats().doaUpdates);
+    shutdownBeamformer();
+}
+
+void TestBeamformerImprovesSNR(test::TestContext& ctx) {
+    // Four microphones in a line, talker 30 degrees off the array axis
+    BeamformerConfig config;
+    config.mics = {{-0.06f, 0.0f}, {-0.02f, 0.0f}, {0.02f, 0.0f}, {0.06f, 0.0f}};
+    config.steerDeg = 30.0f;
+    std::vector<short> talker = toPCM(synthesizeArray(config.mics, 30.0f, 1.0f, 0.05f, 0.0f, 5));
+    std::vector<short> noise = toPCM(synthesizeArray(config.mics, 0.0f, 1.0f, 0.0f, 0.02f, 9));
+
+    ASSERT_TRUE(initBeamformer(config, RATE));
+    std::vector<short> talkerOut = beamformAll(talker, 4);
+    ASSERT_TRUE(initBeamformer(config, RATE));
+    std::vector<short> noiseOut = beamformAll(noise, 4);
+
+    // The aligned talker keeps its level while uncorrelated noise averages down (ideal: 6 dB)
+    std::vector<short> talkerIn(talker.size() / 4), noiseIn(noise.size() / 4);
+    for (size_t i = 0; i < talkerIn.size(); i++) {
+        talkerIn[i] = talker[i * 4];
+        noiseIn[i] = noise[i * 4];
+    }
+    size_t settled = 2048;
+    double talkerGainDb = 10.0 * log10(power(talkerOut, settled) / power(talkerIn, settled));
+    double snrGainDb = 10.0 * log10(power(talkerOut, settled) / power(noiseOut, settled)) -
+                       10.0 * log10(power(talkerIn, settled) / power(noiseIn, settled));
+    ASSERT_NEAR(0.0, talkerGainDb, 0.5);
+    ASSERT_TRUE(snrGainDb >= 5.5);
+
+    // Steered the wrong way, the talker's high frequencies no longer add up
+    config.steerDeg = 150.0f;
+    ASSERT_TRUE(initBeamformer(config, RATE));
+    std::vector<short> misSteered = beamformAll(talker, 4);
+    ASSERT_TRUE(10.0 * log10(power(misSteered, settled) / power(talkerIn, settled)) < -2.0);
+    shutdownBeamformer();
+}
+
+void TestFileCaptureBeamformsArray(test::TestContext& ctx) {
+    BeamformerConfig config;
+    config.mics = squareArray(0.06f);
+    std::string path = "test_array_capture.wav";
+    std::vector<short> fixture = toPCM(synthesizeArray(config.mics, 120.0f, 2.0f, 0.05f, 0.005f, 21));
+    ASSERT_TRUE(saveWAVFile(path, fixture, RATE, 4));
+
+    CaptureDSPConfig dsp;
+    dsp.enabled = false; // Compare levels against the fixture
+    initCaptureDSP(dsp, RATE);
+
+    // A fixture that does not match the array is refused
+    BeamformerConfig triple = config;
+    triple.mics.pop_back();
+    ASSERT_TRUE(initBeamformer(triple, RATE));
+    ASSERT_FALSE(initAudioCaptureFromFile(path, RATE, false));
+    ASSERT_FALSE(initAudioCaptureFromFile(path, 48000, false));
+
+    ASSERT_TRUE(initBeamformer(config, RATE));
+    ASSERT_TRUE(initAudioCaptureFromFile(path, RATE, false));
+    ASSERT_TRUE(getAudioDeviceName().find(path) != std::string::npos);
+    startAudioCapture();
+    for (int i = 0; i < 500 && isAudioCapturing(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_FALSE(isAudioCapturing()); // Ended with the file
+    stopAudioCapture();
+
+    // One enhanced mono stream, at the talker's level, with the talker located
+    std::vector<short> captured = getCapturedAudioSamples();
+    ASSERT_EQ((size_t)(2 * RATE), captured.size());
+    std::vector<short> firstChannel(captured.size());
+    for (size_t i = 0; i < firstChannel.size(); i++) {
+        firstChannel[i] = fixture[i * 4];
+    }
+    ASSERT_NEAR(0.0, 10.0 * log10(power(captured, RATE) / power(firstChannel, RATE)), 1.0);
+    BeamformerStats stats = getBeamformerStats();
+    ASSERT_EQ((uint64_t)(2 * RATE), stats.frames);
+    ASSERT_TRUE(angleError(stats.doaDeg, 120.0f) <= 5.0f);
+
+    cleanupAudioCapture();
+    shutdownBeamformer();
+    initCaptureDSP(CaptureDSPConfig(), RATE);
+    std::remove(path.c_str());
+}
+
+void BenchmarkBeamformer(test::BenchContext& b) {
+    b.RunOnce();
+    const int counts[] = {2, 4, 8};
+    for (int count : counts) {
+        BeamformerConfig config;
+        config.mics = circularArray(count, 0.05f);
+        std::vector<short> pcm = toPCM(synthesizeArray(config.mics, 75.0f, 2.0f, 0.05f, 0.005f, 33));
+        initBeamformer(config, RATE);
+        beamformAll(pcm, count);
+        BeamformerStats stats = getBeamformerStats();
+        std::string suffix = "@" + std::to_string(count) + "ch";
+        b.ReportMetric(stats.usPerAudioSecond, "us/audio-s" + suffix);
+        b.ReportMetric(stats.usPerAudioSecond / count, "us/audio-s/ch" + suffix);
+        b.ReportMetric(angleError(stats.doaDeg, 75.0f), "doa-err-deg" + suffix);
+    }
+    shutdownBeamformer();
+}
@@ -0,0 +1,133 @@
+#include "test.h"
+#include "../display/dsp.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static const double PI = 3.14159265358979323846;
+static const int RATE = 44100;
+static const size_t BLOCK = 4410; // 100 ms capture buffers
+
+static float levelDbfs(const std::vector<short>& pcm, size_t from) {
+    double sumSquared = 0.0;
+    for (size_t i = from; i < pcm.size(); i++) {
+        double x = pcm[i] / 32768.0;
+        sumSquared += x * x;
+    }
+    return (float)(10.0 * log10(sumSquared / (pcm.size() - from) + 1e-18));
+}
+
+// Run a sine at the given RMS level through the capture chain; returns the processed PCM
+static std::vector<short> captureSine(double& phase, float seconds, float frequencyHz, float rmsDbfs) {
+    std::vector<short> pcm((size_t)(seconds * RATE));
+    double amplitude = 32768.0 * sqrt(2.0) * pow(10.0, rmsDbfs / 20.0);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (short)lrint(amplitude * sin(phase));
+        phase += 2.0 * PI * frequencyHz / RATE;
+    }
+    for (size_t pos = 0; pos < pcm.size(); pos += BLOCK) {
+        processCaptureBlock(pcm.data() + pos, std::min(BLOCK, pcm.size() - pos));
+    }
+    return pcm;
+}
+
+void TestDSPHighpassResponse(test::TestContext& ctx) {
+    Biquad filter;
+    designHighpass(filter, 80.0f, 0.7071f, RATE);
+    ASSERT_NEAR(biquadMagnitudeDb(filter, 80.0f, RATE), -3.01f, 0.05f);
+    ASSERT_TRUE(biquadMagnitudeDb(filter, 20.0f, RATE) < -20.0f);
+    ASSERT_NEAR(biquadMagnitudeDb(filter, 1000.0f, RATE), 0.0f, 0.05f);
+
+    // Simulated response matches the analytic one once the transient has settled
+    const float frequencies[] = {20.0f, 50.0f, 80.0f, 200.0f, 1000.0f, 8000.0f};
+    for (float frequency : frequencies) {
+        designHighpass(filter, 80.0f, 0.7071f, RATE);
+        std::vector<float> signal(RATE);
+        for (size_t i = 0; i < signal.size(); i++) {
+            signal[i] = (float)sin(2.0 * PI * frequency * i / RATE);
+        }
+        for (size_t pos = 0; pos < signal.size(); pos += 441) {
+            processBiquad(filter, signal.data() + pos, std::min<size_t>(441, signal.size() - pos));
+        }
+        size_t settled = signal.size() / 2;
+        float measuredDb = 20.0f * log10f(computeRMS(signal.data() + settled, signal.size() - settled) / (float)sqrt(0.5));
+        ASSERT_NEAR(measuredDb, biquadMagnitudeDb(filter, frequency, RATE), 0.1f);
+    }
+
+    // DC offset is removed
+    designHighpass(filter, 80.0f, 0.7071f, RATE);
+    std::vector<float> dc(RATE, 0.25f);
+    processBiquad(filter, dc.data(), dc.size());
+    ASSERT_TRUE(fabsf(dc.back()) < 1e-4f);
+}
+
+void TestDSPAGCConverges(test::TestContext& ctx) {
+    CaptureDSPConfig config;
+    config.gate = false;
+    initCaptureDSP(config, RATE);
+    double phase = 0.0;
+
+    // Quiet talker at -40 dBFS is brought up to the -20 dBFS target
+    std::vector<short> out = captureSine(phase, 6.0f, 1000.0f, -40.0f);
+    ASSERT_NEAR(levelDbfs(out, out.size() - RATE), config.agcTargetDbfs, 2.0f);
+    ASSERT_NEAR(getCaptureDSPStats().gainDb, 20.0f, 2.0f);
+
+    // Very quiet input is only raised by the maximum gain
+    out = captureSine(phase, 6.0f, 1000.0f, -60.0f);
+    ASSERT_NEAR(getCaptureDSPStats().gainDb, config.agcMaxGainDb, 0.5f);
+    ASSERT_NEAR(levelDbfs(out, out.size() - RATE), -60.0f + config.agcMaxGainDb, 1.0f);
+
+    // Loud input is attenuated quickly (attack) and never clips
+    out = captureSine(phase, 1.0f, 1000.0f, -6.0f);
+    ASSERT_TRUE(getCaptureDSPStats().gainDb < 0.0f);
+    ASSERT_NEAR(levelDbfs(out, out.size() / 2), -6.0f + config.agcMinGainDb, 1.5f);
+}
+
+void TestDSPNoiseGateHysteresis(test::TestContext& ctx) {
+    CaptureDSPConfig config;
+    config.agc = false;
+    initCaptureDSP(config, RATE);
+    double phase = 0.0;
+
+    // Background noise below the open threshold stays gated and is attenuated
+    std::vector<short> out = captureSine(phase, 1.0f, 1000.0f, -70.0f);
+    ASSERT_FALSE(getCaptureDSPStats().gateOpen);
+    ASSERT_TRUE(levelDbfs(out, out.size() / 2) < -70.0f + config.gateFloorDb + 3.0f);
+
+    // Speech opens it
+    captureSine(phase, 0.5f, 1000.0f, -30.0f);
+    ASSERT_TRUE(getCaptureDSPStats().gateOpen);
+
+    // Between the close and open levels it stays open indefinitely
+    out = captureSine(phase, 2.0f, 1000.0f, -53.0f);
+    ASSERT_TRUE(getCaptureDSPStats().gateOpen);
+    ASSERT_NEAR(levelDbfs(out, 0), -53.0f, 0.5f);
+
+    // Below the close level it holds for gateHoldMs, then closes
+    captureSine(phase, 0.1f, 1000.0f, -70.0f);
+    ASSERT_TRUE(getCaptureDSPStats().gateOpen);
+    captureSine(phase, 0.3f, 1000.0f, -70.0f);
+    ASSERT_FALSE(getCaptureDSPStats().gateOpen);
+
+    // The same in-between level does not reopen a closed gate
+    captureSine(phase, 1.0f, 1000.0f, -53.0f);
+    ASSERT_FALSE(getCaptureDSPStats().gateOpen);
+
+    CaptureDSPStats stats = getCaptureDSPStats();
+    ASSERT_TRUE(stats.blocks > 0);
+    ASSERT_TRUE(stats.meanBlockUs > 0.0);
+}
+
+void BenchmarkCaptureDSP(test::BenchContext& b) {
+    b.RunOnce();
+    initCaptureDSP(CaptureDSPConfig(), RATE);
+    double phase = 0.0;
+    for (int i = 0; i < 20; i++) {
+        captureSine(phase, 1.0f, 440.0f + 50.0f * i, i % 2 ? -35.0f : -65.0f);
+    }
+    CaptureDSPStats stats = getCaptureDSPStats();
+    b.ReportMetric(stats.meanBlockUs, "us/block");
+    b.ReportMetric(stats.maxBlockUs, "max-us/block");
+    b.ReportMetric(100.0 * stats.meanBlockUs / (1e6 * BLOCK / RATE), "%budget");
+    b.ReportMetric((double)stats.overBudgetBlocks, "over-budget");
+}
@@ -0,0 +1,160 @@
+#include "test.h"
+#include "../display/input.h"
+#include "../display/gesture.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Synthetic input streams: events carry their real times, frames only
+// decide when the queue is drained
+
+static const int LEFT = 0;  // GLFW_MOUSE_BUTTON_LEFT
+static const int RIGHT = 1; // GLFW_MOUSE_BUTTON_RIGHT
+static const char WINDOW_A = 'a';
+
+static const GestureRule TEST_GESTURES[] = {
+    {"click", GestureKind::CLICKS, LEFT, 1, 0.0, 0.0, 0.0, 0.0, {0.0, 0.0, 0.0, 0.0}},
+    {"double_click", GestureKind::CLICKS, LEFT, 2, 0.5, 0.5, 10.0, 0.0, {0.0, 0.0, 0.0, 0.0}},
+    {"tetra_click", GestureKind::CLICKS, LEFT, 4, 2.0, 2.0, 0.0, 0.0, {-64.0, 0.0, 64.0, 64.0}},
+    {"hold", GestureKind::LONG_PRESS, RIGHT, 0, 0.0, 0.0, 10.0, 0.8, {0.0, 0.0, 0.0, 0.0}},
+};
+
+static InputEvent makeEvent(InputEventType type, int button, double time, double x, double y) {
+    InputEvent event;
+    event.source = &WINDOW_A;
+    event.type = type;
+    event.button = button;
+    event.x = x;
+    event.y = y;
+    event.width = 1920;
+    event.height = 1080;
+    event.time = time;
+    return event;
+}
+
+// Press and release 4 ms apart: far shorter than any frame
+static void click(std::vector<InputEvent>& events, int button, double time, double x, double y) {
+    events.push_back(makeEvent(InputEventType::PRESS, button, time, x, y));
+    events.push_back(makeEvent(InputEventType::RELEASE, button, time + 0.004, x, y));
+}
+
+static std::vector<InputEvent> sessionEvents() {
+    std::vector<InputEvent> events;
+    click(events, LEFT, 0.100, 500, 500);
+    click(events, LEFT, 0.300, 503, 502);   // Double-click with the previous
+    click(events, LEFT, 1.000, 1900, 10);   // Four in the top-right corner
+    click(events, LEFT, 1.200, 1890, 20);
+    click(events, LEFT, 1.400, 1895, 30);
+    click(events, LEFT, 1.600, 1880, 40);
+    events.push_back(makeEvent(InputEventType::PRESS, RIGHT, 2.000, 700, 700));
+    events.push_back(makeEvent(InputEventType::RELEASE, RIGHT, 2.950, 702, 701)); // Held 0.95 s
+    click(events, RIGHT, 3.500, 700, 700);  // Too short
+    events.push_back(makeEvent(InputEventType::PRESS, RIGHT, 5.000, 700, 700));
+    events.push_back(makeEvent(InputEventType::RELEASE, RIGHT, 6.500, 700, 700)); // Recognized while still held
+    return events;
+}
+
+// Deliver events as polled callbacks would at the given frame rate
+static std::vector<Gesture> runAtFrameRate(const std::vector<InputEvent>& events, double fps) {
+    GestureRecognizer recognizer;
+    initGestureRecognizer(recognizer, TEST_GESTURES, sizeof(TEST_GESTURES) / sizeof(TEST_GESTURES[0]));
+    clearInputQueue();
+    std::vector<Gesture> gestures;
+    size_t next = 0;
+    for (int frame = 1; frame <= (int)(7.0 * fps); frame++) {
+        double now = frame / fps;
+        while (next < events.size() && events[next].time <= now) {
+            pushInputEvent(events[next++]);
+        }
+        updateGestures(recognizer, now, gestures);
+    }
+    return gestures;
+}
+
+static std::string describe(const std::vector<Gesture>& gestures) {
+    std::string text;
+    for (const Gesture& gesture : gestures) {
+        text += std::string(gesture.name) + "@" + std::to_string(gesture.time) + " ";
+    }
+    return text;
+}
+
+void TestInputQueueOverflow(test::TestContext& ctx) {
+    clearInputQueue();
+    for (size_t i = 0; i < INPUT_QUEUE_CAPACITY + 44; i++) {
+        bool accepted = pushInputEvent(makeEvent(InputEventType::PRESS, LEFT, (double)i, 0, 0));
+        ASSERT_EQ(i < INPUT_QUEUE_CAPACITY, accepted);
+    }
+    InputQueueStats stats = getInputQueueStats();
+    ASSERT_EQ((uint64_t)INPUT_QUEUE_CAPACITY, stats.pushed);
+    ASSERT_EQ((uint64_t)44, stats.dropped);
+    ASSERT_EQ(INPUT_QUEUE_CAPACITY, stats.highWater);
+
+    InputEvent event;
+    for (size_t i = 0; i < INPUT_QUEUE_CAPACITY; i++) {
+        ASSERT_TRUE(popInputEvent(event));
+        ASSERT_NEAR((double)i, event.time, 1e-9); // Oldest first; the overflow was dropped
+    }
+    ASSERT_FALSE(popInputEvent(event));
+    clearInputQueue();
+}
+
+// The same input gives the same gestures at the same times at 24, 60 and 144 fps
+void TestGesturesIndependentOfFrameRate(test::TestContext& ctx) {
+    std::vector<InputEvent> events = sessionEvents();
+    std::vector<Gesture> reference = runAtFrameRate(events, 144.0);
+
+    const char* expectedNames[] = {"click", "click", "double_click", "click", "click", "click", "click", "tetra_click", "hold", "hold"};
+    const double expectedTimes[] = {0.1, 0.3, 0.3, 1.0, 1.2, 1.4, 1.6, 1.6, 2.8, 5.8};
+    ASSERT_EQ((size_t)10, reference.size());
+    for (size_t i = 0; i < reference.size(); i++) {
+        ASSERT_STR_EQ(std::string(expectedNames[i]), std::string(reference[i].name));
+        ASSERT_NEAR(expectedTimes[i], reference[i].time, 1e-9);
+        ASSERT_TRUE(reference[i].source == &WINDOW_A);
+    }
+
+    ASSERT_STR_EQ(describe(reference), describe(runAtFrameRate(events, 60.0)));
+    ASSERT_STR_EQ(describe(reference), describe(runAtFrameRate(events, 24.0)));
+    ASSERT_STR_EQ(describe(reference), describe(runAtFrameRate(events, 7.0))); // Even a stalled renderer
+}
+
+// Tetra-click needs four presses in the corner within 2 s; a press elsewhere restarts it
+void TestGestureTetraClickRegion(test::TestContext& ctx) {
+    GestureRecognizer recognizer;
+    initGestureRecognizer(recognizer, TEST_GESTURES, sizeof(TEST_GESTURES) / sizeof(TEST_GESTURES[0]));
+    std::vector<Gesture> gestures;
+    auto press = [&](double time, double x, double y) {
+        feedGestureEvent(recognizer, makeEvent(InputEventType::PRESS, LEFT, time, x, y), gestures);
+    };
+    auto tetras = [&]() {
+        int count = 0;
+        for (const Gesture& gesture : gestures) {
+            if (std::strcmp(gesture.name, "tetra_click") == 0) count++;
+        }
+        return count;
+    };
+
+    press(0.0, 1900, 10);
+    press(0.2, 1900, 10);
+    press(0.4, 1900, 10);
+    ASSERT_EQ(3, getGestureProgress(recognizer, &WINDOW_A, "tetra_click", 0.5));
+    press(0.6, 900, 500); // Outside the corner
+    ASSERT_EQ(0, getGestureProgress(recognizer, &WINDOW_A, "tetra_click", 0.7));
+    press(0.8, 1900, 10);
+    ASSERT_EQ(0, tetras());
+
+    // Slow presses: the sequence restarts once the 2 s window has passed
+    press(10.0, 1900, 10);
+    press(10.9, 1900, 10);
+    press(11.8, 1900, 10);
+    ASSERT_EQ(0, getGestureProgress(recognizer, &WINDOW_A, "tetra_click", 14.0));
+    press(12.7, 1900, 10);
+    ASSERT_EQ(0, tetras());
+
+    press(20.0, 1919, 0);
+    press(20.5, 1860, 63);
+    press(21.0, 1880, 30);
+    press(21.5, 1900, 40);
+    ASSERT_EQ(1, tetras());
+    ASSERT_EQ(0, getGestureProgress(recognizer, &WINDOW_A, "tetra_click", 21.6));
+}
@@ -0,0 +1,162 @@
+#include "test.h"
+#include "../display/gl_state.h"
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <GL/gl.h>
+#elif defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// Offline caches shadow and count without a GL context
+
+// A change reaches GL the first time and whenever it differs from the shadow
+void TestGLStateElision(test::TestContext& ctx) {
+    GLStateCache cache;
+    cache.offline = true;
+    bindGLStateCache(&cache);
+
+    setGLAlphaBlend();
+    ASSERT_EQ((uint64_t)2, cache.frame.issued);
+    setGLAlphaBlend();
+    setGLBlend(true);
+    ASSERT_EQ((uint64_t)2, cache.frame.issued);
+    ASSERT_EQ((uint64_t)3, cache.frame.elided);
+    setGLBlend(false);
+    ASSERT_EQ((uint64_t)3, cache.frame.issued);
+    ASSERT_TRUE(!cache.blend);
+
+    setGLViewport(0, 0, 1920, 1080);
+    setGLViewport(0, 0, 1920, 1080);
+    setGLViewport(0, 0, 1080, 1920);
+    setGLOrtho2D(1920, 1080);
+    setGLOrtho2D(1920, 1080);
+    ASSERT_EQ((uint64_t)6, cache.frame.issued);
+    ASSERT_EQ(1080, cache.viewport[2]);
+
+    // Line width and point size start at GL's defaults but are not trusted until set
+    setGLLineWidth(1.0f);
+    setGLLineWidth(1.0f);
+    setGLPointSize(2.0f);
+    ASSERT_EQ((uint64_t)8, cache.frame.issued);
+
+    bindGLTexture(7);
+    setGLTexture2D(true);
+    bindGLTexture(7);
+    unsigned int texture = 7;
+    deleteGLTexture(texture);
+    ASSERT_EQ(0u, texture);
+    ASSERT_EQ(0u, cache.texture);
+    bindGLTexture(0);  // The deleted binding already reverted to 0
+    ASSERT_EQ((uint64_t)10, cache.frame.issued);
+
+    finishGLStateFrame(cache);
+    ASSERT_EQ((uint64_t)10, cache.lastFrame.issued);
+    ASSERT_EQ((uint64_t)8, cache.lastFrame.elided);
+    ASSERT_EQ((uint64_t)0, cache.frame.issued);
+    ASSERT_EQ((uint64_t)0, cache.frame.elided);
+    bindGLStateCache(nullptr);
+}
+
+// Invalidation and switching contexts: each shadow only vouches for its own context
+void TestGLStateInvalidate(test::TestContext& ctx) {
+    GLStateCache first, second;
+    first.offline = second.offline = true;
+
+    bindGLStateCache(&first);
+    ASSERT_TRUE(getGLStateCache() == &first);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
+    bindGLStateCache(&second);
+    setGLAlphaBlend();
+    ASSERT_EQ((uint64_t)2, second.frame.issued);
+    bindGLStateCache(&first);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
+    ASSERT_EQ((uint64_t)3, first.frame.issued);
+    ASSERT_EQ((uint64_t)3, first.frame.elided);
+
+    invalidateGLState();
+    ASSERT_EQ(0u, first.known);
+    setGLAlphaBlend();
+    setGLTexture2D(false);
+    ASSERT_EQ((uint64_t)6, first.frame.issued);
+    ASSERT_EQ((uint64_t)GL_SRC_ALPHA, (uint64_t)first.blendSrc);
+    ASSERT_EQ((uint64_t)0, second.frame.elided);
+    bindGLStateCache(nullptr);
+}
+
+static const int FRAME_CARDS = 12;
+
+// The state changes of one opening scene frame (orb background, language
+// cards, transcript, atlas image layer, waveform and device label) as the
+// renderers made them before: each primitive enabled what it needed and
+// restored it afterwards
+static void replayFrameRestoring() {
+    setGLViewport(0, 0, 1920, 1080);
+    setGLOrtho2D(1920, 1080);
+    setGLBlend(true); setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); setGLBlend(false);
+    for (int card = 0; card < FRAME_CARDS; card++) {
+        setGLBlend(true); setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        setGLLineWidth(2.0f);
+        setGLPointSize(10.0f);
+        setGLBlend(false);
+    }
+    setGLBlend(true); setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); setGLBlend(false);
+    setGLBlend(true); setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setGLTexture2D(true); bindGLTexture(3);
+    bindGLTexture(0); setGLTexture2D(false); setGLBlend(false);
+    for (int label = 0; label < 2; label++) {
+        setGLBlend(true); setGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); setGLBlend(false);
+    }
+}
+
+// The same frame now: each primitive only states what it needs
+static void replayFrame() {
+    setGLViewport(0, 0, 1920, 1080);
+    setGLOrtho2D(1920, 1080);
+    setGLAlphaBlend(); setGLTexture2D(false);
+    for (int card = 0; card < FRAME_CARDS; card++) {
+        setGLAlphaBlend(); setGLTexture2D(false);
+        setGLLineWidth(2.0f);
+        setGLPointSize(10.0f);
+    }
+    setGLAlphaBlend(); setGLTexture2D(false);
+    setGLAlphaBlend(); setGLTexture2D(true); bindGLTexture(3);
+    for (int label = 0; label < 2; label++) {
+        setGLAlphaBlend(); setGLTexture2D(false);
+    }
+}
+
+// GL state calls per steady-state frame, before (every call reached GL)
+// and with the shadow, plus what a shadowed setter costs on the CPU
+void BenchmarkGLStateFrame(test::BenchContext& b) {
+    b.RunOnce();
+    GLStateCache cache;
+    cache.offline = true;
+    bindGLStateCache(&cache);
+
+    replayFrameRestoring();
+    finishGLStateFrame(cache);
+    uint64_t before = cache.lastFrame.issued + cache.lastFrame.elided;
+
+    const int frames = 20000;
+    replayFrame();
+    finishGLStateFrame(cache);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+        replayFrame();
+        finishGLStateFrame(cache);
+    }
+    double frameNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+    uint64_t calls = cache.lastFrame.issued + cache.lastFrame.elided;
+    bindGLStateCache(nullptr);
+
+    b.ReportMetric((double)before, "gl-calls/frame-before");
+    b.ReportMetric((double)cache.lastFrame.issued, "gl-calls/frame-shadowed");
+    b.ReportMetric((double)cache.lastFrame.elided, "elided/frame");
+    b.ReportMetric(frameNs / calls, "ns/setter");
+}
@@ -0,0 +1,135 @@
+#include "test.h"
+#include "../display/hittest.h"
+#include "../display/scene.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+static Widget gridWidget(const char* type, int row, int col, int width, int height, float margin) {
+    Widget widget = Widget();
+    widget.type = type;
+    widget.row = row;
+    widget.col = col;
+    widget.width = width;
+    widget.height = height;
+    widget.margin = margin;
+    return widget;
+}
+
+// Scene with `count` widgets of 1-4 cells scattered (and overlapping) over a cols x rows grid
+static Scene crowdedScene(int cols, int rows, int count) {
+    Scene scene = Scene();
+    scene.cols = cols;
+    scene.rows = rows;
+    uint32_t state = 12345;
+    auto next = [&](int range) {
+        state = state * 1664525u + 1013904223u;
+        return (int)((state >> 8) % (uint32_t)range);
+    };
+    for (int i = 0; i < count; i++) {
+        int width = 1 + next(4);
+        int height = 1 + next(4);
+        scene.widgets.push_back(gridWidget("card", next(rows), next(cols), width, height, 0.05f * next(4)));
+    }
+    return scene;
+}
+
+// Reference: every widget, topmost (last) first
+static int linearHitTest(const Scene& scene, int windowWidth, int windowHeight, double x, double y) {
+    float cellWidth = (float)windowWidth / scene.cols;
+    float cellHeight = (float)windowHeight / scene.rows;
+    float px = (float)x;
+    float py = (float)(windowHeight - y);
+    for (size_t i = scene.widgets.size(); i-- > 0;) {
+        float rx, ry, rw, rh;
+        computeWidgetRect(scene, scene.widgets[i], cellWidth, cellHeight, rx, ry, rw, rh);
+        if (px >= rx && px < rx + rw && py >= ry && py < ry + rh) return (int)i;
+    }
+    return -1;
+}
+
+// Later widgets are on top; margins are not part of a widget
+void TestHitTestZOrderAndMargins(test::TestContext& ctx) {
+    Scene scene = Scene();
+    scene.cols = 8;
+    scene.rows = 12;
+    scene.widgets.push_back(gridWidget("panel", 2, 0, 8, 4, 0.0f));   // Rows 2-5, full width
+    scene.widgets.push_back(gridWidget("card", 3, 2, 2, 2, 0.25f));   // Over the panel, inset 25%
+    scene.widgets.push_back(gridWidget("card", 10, 6, 2, 1, 0.1f));
+
+    HitIndex index = HitIndex();
+    buildHitIndex(index, scene, 800, 1200); // 100 x 100 px cells
+    ASSERT_TRUE(hitIndexMatches(index, scene, 800, 1200));
+    ASSERT_FALSE(hitIndexMatches(index, scene, 1200, 800));
+
+    ASSERT_EQ(1, hitTestWidget(index, 300.0, 400.0));  // Card centre
+    ASSERT_EQ(0, hitTestWidget(index, 210.0, 400.0));  // Card margin: falls through to the panel
+    ASSERT_EQ(0, hitTestWidget(index, 50.0, 250.0));
+    ASSERT_EQ(-1, hitTestWidget(index, 50.0, 150.0));  // Row 1
+    ASSERT_EQ(2, hitTestWidget(index, 700.0, 1050.0));
+    ASSERT_EQ(-1, hitTestWidget(index, 700.0, 1005.0)); // Top margin of the last card
+    ASSERT_EQ(-1, hitTestWidget(index, -1.0, 400.0));
+    ASSERT_EQ(-1, hitTestWidget(index, 300.0, 1200.0));
+}
+
+void TestHitTestMatchesLinearScan(test::TestContext& ctx) {
+    Scene scene = crowdedScene(40, 30, 600);
+    HitIndex index = HitIndex();
+    buildHitIndex(index, scene, 1920, 1080);
+    for (int y = 0; y < 1080; y += 7) {
+        for (int x = 0; x < 1920; x += 5) {
+            ASSERT_EQ(linearHitTest(scene, 1920, 1080, x + 0.5, y + 0.5), hitTestWidget(index, x + 0.5, y + 0.5));
+        }
+    }
+}
+
+// Admin tabs keep their "scene" property and sit in the top row
+void TestHitTestAdminTabs(test::TestContext& ctx) {
+    Scene scene;
+    ASSERT_TRUE(loadScene("scenes/admin.general.scene.json", scene));
+    ASSERT_EQ((size_t)8, scene.widgets.size());
+
+    HitIndex index = HitIndex();
+    buildHitIndex(index, scene, 1920, 1080);
+    int hit = hitTestWidget(index, 1200.0, 45.0); // Third tab (columns 4-5)
+    ASSERT_EQ(2, hit);
+    ASSERT_STR_EQ("tab", scene.widgets[hit].type);
+    ASSERT_STR_EQ("Assets", scene.widgets[hit].properties["label"]);
+    ASSERT_STR_EQ("admin.assets.scene.json", scene.widgets[hit].properties["scene"]);
+    ASSERT_STR_EQ("slider", scene.widgets[5].properties["control_type"]);
+}
+
+// Cost per lookup on a crowded scene, against scanning every widget
+void BenchmarkHitTest(test::BenchContext& b) {
+    b.RunOnce();
+    const int width = 3840, height = 2160;
+    const int points = 200000;
+    for (int count : {1000, 5000}) {
+        Scene scene = crowdedScene(96, 54, count);
+        HitIndex index = HitIndex();
+        auto start = std::chrono::steady_clock::now();
+        buildHitIndex(index, scene, width, height);
+        double buildUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        long checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < points; i++) {
+            checksum += hitTestWidget(index, (i * 7919) % width + 0.5, (i * 104729) % height + 0.5);
+        }
+        double indexedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / points;
+
+        const int linearPoints = points / 100;
+        start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < linearPoints; i++) {
+            checksum -= linearHitTest(scene, width, height, (i * 7919) % width + 0.5, (i * 104729) % height + 0.5);
+        }
+        double linearNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / linearPoints;
+
+        std::cout << "  " << count << " widgets: " << index.cellWidgets.size() / (double)(index.cols * index.rows)
+                  << " per cell (checksum " << checksum << ")" << std::endl;
+        std::string suffix = "-" + std::to_string(count);
+        b.ReportMetric(buildUs, "us/build" + suffix);
+        b.ReportMetric(indexedNs, "ns/hit" + suffix);
+        b.ReportMetric(linearNs, "ns/scan" + suffix);
+    }
+}
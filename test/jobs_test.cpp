@@ -0,0 +1,202 @@
+#include "test.h"
+#include "../display/jobs.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void countJob(void* data, size_t begin, size_t end) {
+    static_cast<std::atomic<uint64_t>*>(data)->fetch_add(end - begin + 1, std::memory_order_relaxed);
+}
+
+// Each job spawns `fanout` children until depth runs out (begin carries the depth)
+struct TreeJobs {
+    std::atomic<uint64_t> visited{0};
+    JobCounter* counter;
+    size_t fanout;
+};
+
+static void treeJob(void* data, size_t depth, size_t) {
+    TreeJobs* tree = static_cast<TreeJobs*>(data);
+    tree->visited.fetch_add(1, std::memory_order_relaxed);
+    if (depth == 0) return;
+    for (size_t i = 0; i < tree->fanout; i++) {
+        runJob(treeJob, data, tree->counter, depth - 1, 0);
+    }
+}
+
+// Hundreds of thousands of near-empty jobs: submitted flat, spawned as a
+// tree from inside jobs, and injected from threads that own no deque
+void TestJobsHammerFineGrained(test::TestContext& ctx) {
+    ASSERT_TRUE(startJobSystem(4));
+    ASSERT_EQ(4, getJobWorkerCount());
+
+    for (int round = 0; round < 3; round++) {
+        std::atomic<uint64_t> total(0);
+        JobCounter counter;
+        for (size_t i = 0; i < 100000; i++) {
+            runJob(countJob, &total, &counter, i, i);
+        }
+        waitForJobs(counter);
+        ASSERT_EQ((uint64_t)100000, total.load());
+    }
+
+    TreeJobs tree;
+    JobCounter treeCounter;
+    tree.counter = &treeCounter;
+    tree.fanout = 4;
+    runJob(treeJob, &tree, &treeCounter, 8, 0); // 1 + 4 + ... + 4^8 jobs
+    waitForJobs(treeCounter);
+    ASSERT_EQ((uint64_t)87381, tree.visited.load());
+
+    std::atomic<uint64_t> injected(0);
+    JobCounter injectedCounter;
+    std::vector<std::thread> submitters;
+    for (int t = 0; t < 3; t++) {
+        submitters.emplace_back([&]() {
+            for (size_t i = 0; i < 20000; i++) runJob(countJob, &injected, &injectedCounter, i, i);
+        });
+    }
+    for (std::thread& submitter : submitters) submitter.join();
+    waitForJobs(injectedCounter);
+    ASSERT_EQ((uint64_t)60000, injected.load());
+
+    JobSystemStats stats = getJobSystemStats();
+    ASSERT_TRUE(stats.executed >= 300000 + 87381 + 60000);
+    stopJobSystem();
+    ASSERT_FALSE(isJobSystemRunning());
+
+    // Stopped: jobs run inline on the caller
+    std::atomic<uint64_t> inlineTotal(0);
+    JobCounter inlineCounter;
+    runJob(countJob, &inlineTotal, &inlineCounter, 0, 9);
+    ASSERT_EQ(0, inlineCounter.pending.load());
+    ASSERT_EQ((uint64_t)10, inlineTotal.load());
+}
+
+void TestJobsParallelForCoversRange(test::TestContext& ctx) {
+    ASSERT_TRUE(startJobSystem(3));
+    for (size_t grain : {(size_t)1, (size_t)7, (size_t)1000, (size_t)50000}) {
+        const size_t count = 40000;
+        std::vector<std::atomic<int>> hits(count);
+        for (auto& hit : hits) hit = 0;
+        std::atomic<size_t> largest(0);
+        parallelFor(count, grain, [&](size_t begin, size_t end) {
+            size_t size = end - begin;
+            size_t seen = largest.load();
+            while (size > seen && !largest.compare_exchange_weak(seen, size)) {}
+            for (size_t i = begin; i < end; i++) hits[i].fetch_add(1);
+        });
+        for (size_t i = 0; i < count; i++) {
+            if (hits[i].load() != 1) {
+                ctx.Fail("Index " + std::to_string(i) + " visited " + std::to_string(hits[i].load()) +
+                         " times (grain " + std::to_string(grain) + ")");
+                stopJobSystem();
+                return;
+            }
+        }
+        ASSERT_TRUE(largest.load() <= grain);
+    }
+    parallelFor(0, 16, [&](size_t, size_t) { ctx.Fail("Body called for an empty range"); });
+    stopJobSystem();
+}
+
+// Three stages chained with runJobAfter: each starts only when the previous drained
+struct Pipeline {
+    std::vector<int> values;
+    std::atomic<int> stageOneDone{0};
+    std::atomic<int> stageTwoDone{0};
+    std::atomic<bool> orderBroken{false};
+    long long sum = 0;
+};
+
+static void stageOne(void* data, size_t begin, size_t end) {
+    Pipeline* pipeline = static_cast<Pipeline*>(data);
+    for (size_t i = begin; i < end; i++) pipeline->values[i] = (int)i;
+    pipeline->stageOneDone.fetch_add(1);
+}
+
+static void stageTwo(void* data, size_t begin, size_t end) {
+    Pipeline* pipeline = static_cast<Pipeline*>(data);
+    if (pipeline->stageOneDone.load() != 16) pipeline->orderBroken = true;
+    for (size_t i = begin; i < end; i++) pipeline->values[i] *= 2;
+    pipeline->stageTwoDone.fetch_add(1);
+}
+
+static void stageThree(void* data, size_t, size_t) {
+    Pipeline* pipeline = static_cast<Pipeline*>(data);
+    if (pipeline->stageTwoDone.load() != 16) pipeline->orderBroken = true;
+    for (int value : pipeline->values) pipeline->sum += value;
+}
+
+void TestJobsDependencies(test::TestContext& ctx) {
+    ASSERT_TRUE(startJobSystem(4));
+    for (int round = 0; round < 50; round++) {
+        Pipeline pipeline;
+        pipeline.values.assign(1600, -1);
+        JobCounter first, second, third;
+        for (size_t i = 0; i < 16; i++) {
+            runJob(stageOne, &pipeline, &first, i * 100, (i + 1) * 100);
+        }
+        // Later stages are queued while the earlier ones may still be running
+        for (size_t i = 0; i < 16; i++) {
+            runJobAfter(first, stageTwo, &pipeline, &second, i * 100, (i + 1) * 100);
+        }
+        runJobAfter(second, stageThree, &pipeline, &third);
+        waitForJobs(third);
+        ASSERT_FALSE(pipeline.orderBroken.load());
+        ASSERT_EQ((long long)1599 * 1600, pipeline.sum);
+    }
+
+    // A dependency with nothing pending releases the job at once
+    std::atomic<uint64_t> total(0);
+    JobCounter idle, after;
+    runJobAfter(idle, countJob, &total, &after, 0, 0);
+    waitForJobs(after);
+    ASSERT_EQ((uint64_t)1, total.load());
+    stopJobSystem();
+}
+
+// Speedup of a CPU-bound parallelFor from 1 worker up to every hardware thread,
+// and the overhead per fine-grained job
+void BenchmarkJobScaling(test::BenchContext& b) {
+    b.RunOnce();
+    const size_t count = 1 << 22;
+    std::vector<float> output(count);
+    auto body = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            float x = (float)i * 0.001f;
+            output[i] = std::sqrt(x) * std::sin(x) + std::cos(x * 0.5f);
+        }
+    };
+    int hardware = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+    double baseline = 0.0;
+    for (int threads : threadCounts) {
+        if (threads > 1) startJobSystem(threads - 1); // The caller is the remaining thread
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < 5; repeat++) parallelFor(count, 4096, body);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / 5;
+        stopJobSystem();
+        if (threads == 1) baseline = ms;
+        std::cout << "  " << threads << " threads: " << ms << " ms, speedup " << baseline / ms << "x" << std::endl;
+        b.ReportMetric(baseline / ms, "speedup-" + std::to_string(threads) + "t");
+    }
+
+    startJobSystem(0);
+    std::atomic<uint64_t> total(0);
+    JobCounter counter;
+    const size_t jobs = 500000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < jobs; i++) runJob(countJob, &total, &counter, i, i);
+    waitForJobs(counter);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / jobs;
+    stopJobSystem();
+    b.ReportMetric(ns, "ns/job");
+    b.ReportMetric((double)hardware, "hw-threads");
+}
@@ -0,0 +1,290 @@
+#include "test.h"
+#include "../display/fft.h"
+#include "../display/kws.h"
+#include "../display/stt_session.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// WAV fixtures are synthesized: formant-shaped harmonic "vowels" with a noise
+// onset, so the wake phrase, look-alike distractors and speaker variation
+// (pitch, speed, level) are reproducible without shipping recordings
+
+struct Vowel {
+    float f1, f2, f3;
+};
+static const Vowel VOWEL_A = {730, 1090, 2440};
+static const Vowel VOWEL_I = {270, 2290, 3010};
+static const Vowel VOWEL_U = {300, 870, 2240};
+static const Vowel VOWEL_E = {530, 1840, 2480};
+static const Vowel VOWEL_O = {570, 840, 2410};
+
+struct Syllable {
+    Vowel vowel;
+    float seconds;
+    bool fricative; // Noise burst before the vowel
+};
+
+struct Speaker {
+    float f0;
+    float speed;  // >1 speaks faster
+    float gain;
+};
+
+static float noiseSample(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return (float)((seed >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static void appendSilence(std::vector<float>& out, int rate, float seconds) {
+    out.insert(out.end(), (size_t)(seconds * rate), 0.0f);
+}
+
+static void appendPhrase(std::vector<float>& out, int rate, const std::vector<Syllable>& syllables, const Speaker& speaker, uint32_t& seed) {
+    double phase = 0.0;
+    float previousNoise = 0.0f;
+    for (size_t s = 0; s < syllables.size(); s++) {
+        const Syllable& syllable = syllables[s];
+        if (syllable.fricative) {
+            int count = (int)(0.07f / speaker.speed * rate);
+            for (int i = 0; i < count; i++) {
+                float noise = noiseSample(seed);
+                out.push_back((noise - previousNoise) * 0.15f * speaker.gain); // High-passed hiss
+                previousNoise = noise;
+            }
+        }
+        int count = (int)(syllable.seconds / speaker.speed * rate);
+        int harmonics = (int)(3800.0f / speaker.f0);
+        std::vector<float> amplitude(harmonics + 1);
+        for (int h = 1; h <= harmonics; h++) {
+            float frequency = h * speaker.f0;
+            float a = 0.0f;
+            const float formants[3] = {syllable.vowel.f1, syllable.vowel.f2, syllable.vowel.f3};
+            for (int k = 0; k < 3; k++) {
+                float x = (frequency - formants[k]) / (90.0f + 30.0f * k);
+                a += expf(-x * x) / (1.0f + k);
+            }
+            amplitude[h] = a / sqrtf((float)h);
+        }
+        for (int i = 0; i < count; i++) {
+            float t = (float)i / count;
+            float envelope = std::min(1.0f, std::min(t, 1.0f - t) * 8.0f);
+            float f0 = speaker.f0 * (1.0f + 0.08f * (0.5f - t)); // Falling pitch within the syllable
+            phase += f0 / rate;
+            if (phase > 1.0) phase -= 1.0;
+            float value = 0.0f;
+            for (int h = 1; h <= harmonics; h++) {
+                value += amplitude[h] * sinf((float)(2.0 * 3.14159265358979 * phase * h));
+            }
+            out.push_back(value * 0.12f * envelope * speaker.gain);
+        }
+    }
+}
+
+static const std::vector<Syllable> WAKE_PHRASE = {{VOWEL_A, 0.20f, true}, {VOWEL_I, 0.16f, false}, {VOWEL_U, 0.26f, false}};
+static const std::vector<Syllable> DISTRACTORS[] = {
+    {{VOWEL_O, 0.20f, true}, {VOWEL_E, 0.16f, false}, {VOWEL_A, 0.26f, false}},
+    {{VOWEL_U, 0.22f, false}, {VOWEL_A, 0.18f, true}, {VOWEL_I, 0.24f, false}},
+    {{VOWEL_A, 0.20f, true}, {VOWEL_I, 0.30f, false}},                       // Prefix of the wake phrase
+    {{VOWEL_E, 0.18f, false}, {VOWEL_I, 0.16f, true}, {VOWEL_U, 0.26f, false}}, // Same ending
+};
+
+static std::vector<short> toPCM(const std::vector<float>& signal, float noiseLevel, uint32_t seed) {
+    std::vector<short> pcm(signal.size());
+    for (size_t i = 0; i < signal.size(); i++) {
+        float value = signal[i] + noiseLevel * noiseSample(seed);
+        value = std::max(-1.0f, std::min(1.0f, value));
+        pcm[i] = (short)(value * 32767.0f);
+    }
+    return pcm;
+}
+
+// Two enrolment recordings of the wake phrase, written as WAV fixtures
+static std::vector<std::string> writeTemplates() {
+    const Speaker speakers[] = {{125.0f, 1.0f, 1.0f}, {180.0f, 0.95f, 0.8f}};
+    std::vector<std::string> paths;
+    for (int i = 0; i < 2; i++) {
+        std::vector<float> signal;
+        uint32_t seed = 100 + i;
+        appendSilence(signal, 16000, 0.3f);
+        appendPhrase(signal, 16000, WAKE_PHRASE, speakers[i], seed);
+        appendSilence(signal, 16000, 0.3f);
+        std::string path = "test_kws_template" + std::to_string(i) + ".wav";
+        saveWAVFile(path, toPCM(signal, 0.002f, 7 + i), 16000);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+static void removeTemplates(const std::vector<std::string>& paths) {
+    for (const std::string& path : paths) std::remove(path.c_str());
+}
+
+// Capture fixture: distractor speech with the wake phrase said by other speakers
+// at the listed times; returns the sample position where each wake phrase ends
+struct Scenario {
+    std::vector<short> pcm;
+    int rate;
+    std::vector<size_t> wakeEnds;
+};
+
+static Scenario buildScenario(int rate, int rounds, float quietSeconds = 12.0f) {
+    const Speaker speakers[] = {{110.0f, 0.88f, 0.7f}, {150.0f, 1.12f, 1.3f}, {200.0f, 1.0f, 0.5f}, {135.0f, 0.95f, 1.0f}};
+    Scenario scenario;
+    scenario.rate = rate;
+    std::vector<float> signal;
+    uint32_t seed = 42;
+    for (int round = 0; round < rounds; round++) {
+        for (int d = 0; d < 4; d++) {
+            appendSilence(signal, rate, 0.6f + 0.1f * d);
+            appendPhrase(signal, rate, DISTRACTORS[(d + round) % 4], speakers[(d + round) % 4], seed);
+        }
+        appendSilence(signal, rate, 1.5f);
+        appendPhrase(signal, rate, WAKE_PHRASE, speakers[round % 4], seed);
+        scenario.wakeEnds.push_back(signal.size());
+        appendSilence(signal, rate, 1.0f);
+    }
+    appendSilence(signal, rate, quietSeconds); // Nobody is talking to the display
+    scenario.pcm = toPCM(signal, 0.004f, 99);
+    return scenario;
+}
+
+// Feed in capture-sized blocks; returns the block end position of each detection
+static std::vector<size_t> runDetector(const Scenario& scenario) {
+    std::vector<size_t> detections;
+    const size_t block = (size_t)scenario.rate / 20; // 50 ms capture buffers
+    for (size_t pos = 0; pos < scenario.pcm.size(); pos += block) {
+        size_t count = std::min(block, scenario.pcm.size() - pos);
+        if (feedKeywordSpotter(scenario.pcm.data() + pos, count, scenario.rate) > 0) {
+            detections.push_back(pos + count);
+        }
+    }
+    return detections;
+}
+
+void TestFFTMatchesDFT(test::TestContext& ctx) {
+    FFTPlan plan;
+    ASSERT_FALSE(initFFTPlan(plan, 48));
+    ASSERT_TRUE(initFFTPlan(plan, 64));
+    std::vector<float> input(64), re(64), im(64), power(33);
+    uint32_t seed = 5;
+    for (float& value : input) value = noiseSample(seed);
+    fftPowerSpectrum(plan, input.data(), power.data(), re.data(), im.data());
+    for (int k = 0; k <= 32; k++) {
+        double sumRe = 0.0, sumIm = 0.0;
+        for (int n = 0; n < 64; n++) {
+            sumRe += input[n] * cos(-2.0 * 3.14159265358979 * k * n / 64);
+            sumIm += input[n] * sin(-2.0 * 3.14159265358979 * k * n / 64);
+        }
+        ASSERT_NEAR(sumRe * sumRe + sumIm * sumIm, power[k], 1e-3 * (1.0 + power[k]));
+    }
+}
+
+// The wake phrase from unseen speakers is found; look-alike phrases and silence are not
+void TestKWSDetectsWakePhrase(test::TestContext& ctx) {
+    std::vector<std::string> paths = writeTemplates();
+    std::vector<short> loaded;
+    int loadedRate = 0;
+    bool readBack = loadWAVFile(paths[0], loaded, loadedRate);
+    KWSConfig config;
+    std::vector<size_t> detections[2];
+    Scenario scenarios[2] = {buildScenario(16000, 4), buildScenario(44100, 4)}; // Fixture rate and capture rate
+    bool ready = true;
+    for (int i = 0; i < 2; i++) {
+        ready = ready && initKeywordSpotter(config, paths);
+        detections[i] = runDetector(scenarios[i]);
+    }
+    shutdownKeywordSpotter();
+    removeTemplates(paths);
+
+    ASSERT_TRUE(readBack);
+    ASSERT_EQ(16000, loadedRate);
+    ASSERT_TRUE(ready);
+    for (int i = 0; i < 2; i++) {
+        const Scenario& scenario = scenarios[i];
+        ASSERT_EQ(scenario.wakeEnds.size(), detections[i].size());
+        for (size_t d = 0; d < detections[i].size(); d++) {
+            // Detected near the end of the phrase, at most 300 ms after it
+            ASSERT_TRUE(detections[i][d] + (size_t)scenario.rate / 4 >= scenario.wakeEnds[d]);
+            ASSERT_TRUE(detections[i][d] <= scenario.wakeEnds[d] + (size_t)scenario.rate * 3 / 10);
+        }
+    }
+}
+
+// Nothing reaches an STT session until the wake phrase; then listenMs of audio does
+void TestKWSWakeGateOpensSession(test::TestContext& ctx) {
+    std::vector<std::string> paths = writeTemplates();
+    KWSConfig config;
+    config.listenMs = 2000;
+    ASSERT_TRUE(initKeywordSpotter(config, paths));
+    removeTemplates(paths);
+    STTSessionConfig sessionConfig;
+    sessionConfig.chunkMs = 500;
+    sessionConfig.contextMs = 0;
+    configureSTTSessions(sessionConfig);
+    endSTTSession();
+
+    Scenario scenario = buildScenario(16000, 2);
+    const size_t block = 800;
+    uint64_t uploaded = 0;
+    size_t firstChunkAt = 0;
+    std::vector<uint64_t> sessions;
+    STTUploadChunk chunk;
+    for (size_t pos = 0; pos < scenario.pcm.size(); pos += block) {
+        size_t count = std::min(block, scenario.pcm.size() - pos);
+        feedWakeGate(scenario.pcm.data() + pos, count, scenario.rate);
+        while (takeSTTSessionChunk(chunk)) { // Render thread, once per "frame"
+            if (firstChunkAt == 0) firstChunkAt = pos;
+            if (sessions.empty() || sessions.back() != chunk.info.sessionId) sessions.push_back(chunk.info.sessionId);
+            uploaded += chunk.samples.size();
+        }
+    }
+    KWSStats stats = getKeywordSpotterStats();
+    bool stillOpen = isSTTSessionActive();
+    shutdownKeywordSpotter();
+    configureSTTSessions(STTSessionConfig());
+
+    ASSERT_EQ((size_t)2, sessions.size()); // One session per wake phrase
+    ASSERT_TRUE(firstChunkAt >= scenario.wakeEnds[0]);
+    ASSERT_EQ((uint64_t)2 * 32000, uploaded); // 2 x listenMs, nothing else
+    ASSERT_EQ(uploaded, stats.gatedSamples);
+    ASSERT_EQ((uint64_t)scenario.pcm.size(), stats.totalSamples);
+    ASSERT_FALSE(stillOpen); // Closed after its listen window
+}
+
+// CPU per second of audio for the detector (44.1 kHz capture, two templates)
+// and the share of upload volume the gate saves (4 wakes in ~2.5 min, 8 s listen window)
+void BenchmarkKWSDetector(test::BenchContext& b) {
+    b.RunOnce();
+    std::vector<std::string> paths = writeTemplates();
+    KWSConfig config;
+    initKeywordSpotter(config, paths);
+    Scenario scenario = buildScenario(44100, 4, 120.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    runDetector(scenario);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    KWSStats detector = getKeywordSpotterStats();
+
+    configureSTTSessions(STTSessionConfig());
+    initKeywordSpotter(config, paths);
+    STTUploadChunk chunk;
+    for (size_t pos = 0; pos < scenario.pcm.size(); pos += 2205) {
+        feedWakeGate(scenario.pcm.data() + pos, std::min<size_t>(2205, scenario.pcm.size() - pos), scenario.rate);
+        while (takeSTTSessionChunk(chunk)) {
+        }
+    }
+    KWSStats gate = getKeywordSpotterStats();
+    shutdownKeywordSpotter();
+    endSTTSession();
+    removeTemplates(paths);
+
+    b.ReportMetric(detector.cpuSeconds * 1000.0 / detector.audioSeconds, "cpu-ms/audio-s");
+    b.ReportMetric(detector.audioSeconds / wallSeconds, "x-realtime");
+    b.ReportMetric(100.0 * (1.0 - (double)gate.gatedSamples / gate.totalSamples), "%upload-saved");
+    b.ReportMetric((double)gate.detections, "wakes");
+}
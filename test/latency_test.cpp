@@ -0,0 +1,159 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/latency.h"
+#include "../display/audio.h"
+#include "../display/dsp.h"
+#include "../display/kws.h"
+#include "../display/network.h"
+#include "../display/stt_session.h"
+#include "../display/stt_spool.h"
+#include "../display/transcript.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+void TestLatencyHistogramPercentiles(test::TestContext& ctx) {
+    resetLatencyHistograms();
+    for (int ms = 1; ms <= 1000; ms++) recordLatency(LatencyStage::UPLOAD, ms);
+    recordLatencySince(LatencyStage::UPLOAD, -1.0); // Untagged audio is not counted
+
+    LatencyHistogram histogram = getLatencyHistogram(LatencyStage::UPLOAD);
+    ASSERT_EQ((uint64_t)1000, histogram.count);
+    ASSERT_NEAR(1.0, histogram.minMs, 1e-9);
+    ASSERT_NEAR(1000.0, histogram.maxMs, 1e-9);
+    ASSERT_NEAR(500.5, histogram.meanMs, 1e-9);
+    // Buckets are 2^(1/8) wide: percentiles land within about 5% of the exact value
+    ASSERT_NEAR(500.0, histogram.p50Ms, 500.0 * 0.05);
+    ASSERT_NEAR(950.0, histogram.p95Ms, 950.0 * 0.05);
+    ASSERT_NEAR(990.0, histogram.p99Ms, 990.0 * 0.05);
+    ASSERT_EQ((uint64_t)0, getLatencyHistogram(LatencyStage::CAPTURE).count);
+
+    resetLatencyHistograms();
+    ASSERT_EQ((uint64_t)0, getLatencyHistogram(LatencyStage::UPLOAD).count);
+
+    // A block's first sample was recorded one block duration before it arrived
+    resetCaptureClock();
+    CaptureTag first = tagCapturedBlock(4410, 44100);
+    CaptureTag second = tagCapturedBlock(4410, 44100);
+    ASSERT_EQ((uint64_t)0, first.sample);
+    ASSERT_EQ((uint64_t)4410, second.sample);
+    ASSERT_NEAR(getLatencyClock() - 0.1, second.time, 0.01);
+    ASSERT_NEAR(second.time + 0.05, captureTimeAt(second, 2205), 1e-9);
+    ASSERT_NEAR(-1.0, captureTimeAt(CaptureTag(), 10), 1e-9);
+
+    std::vector<short> clicks = makeClickTrack(1000, 1.0, 250);
+    ASSERT_EQ((size_t)1000, clicks.size());
+    ASSERT_EQ(32767, (int)clicks[125]);
+    ASSERT_EQ(0, (int)clicks[200]);
+    ASSERT_EQ(32767, (int)clicks[375]);
+}
+
+static void removeLatencySpool(const std::string& dir) {
+    std::remove((dir + "/spool.idx").c_str());
+    std::remove((dir + "/spool.idx.tmp").c_str());
+    for (int segment = 1; segment <= 8; segment++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/seg_%06d.bin", segment);
+        std::remove((dir + name).c_str());
+    }
+    rmdir(dir.c_str());
+}
+
+// Loopback: a click track played through the file source in real time reaches
+// every hop, each hop records a latency per unit of audio, and the clicks sit
+// at the capture-clock positions the uploads claim for them
+void TestLatencyLoopbackClicks(test::TestContext& ctx) {
+    const int rate = 44100;
+    const int intervalMs = 250;
+    const std::string path = "test_latency_clicks.wav";
+    const std::string spoolDir = "test_latency_spool";
+    ASSERT_TRUE(saveWAVFile(path, makeClickTrack(rate, 2.0, intervalMs), rate));
+    ASSERT_TRUE(initNetwork());
+    removeLatencySpool(spoolDir);
+
+    standin::HTTPServer server;
+    server.keepBodies = true;
+    ASSERT_TRUE(standin::startHTTPServer(server, 0));
+    STTSpoolConfig spool;
+    spool.directory = spoolDir;
+    spool.host = "127.0.0.1";
+    spool.port = server.port;
+    ASSERT_TRUE(startSTTSpool(spool));
+    STTSessionConfig session;
+    session.chunkMs = 500;
+    session.contextMs = 0;
+    configureSTTSessions(session);
+    CaptureDSPConfig dsp;
+    dsp.enabled = false; // The gate would shape the clicks
+    initCaptureDSP(dsp, rate);
+    ASSERT_FALSE(isKeywordSpotterActive());
+    drainTranscriptEvents();
+    clearTranscriptView();
+
+    ASSERT_TRUE(initAudioCaptureFromFile(path, rate, true));
+    resetLatencyHistograms();
+    startAudioCapture();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(6);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // A 60 Hz render loop
+        updateAudio(0.016f);
+        drainTranscriptEvents();
+        if (!isAudioCapturing() && getLatencyHistogram(LatencyStage::TRANSCRIPT).count >= 4) break;
+    }
+    stopAudioCapture();
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    configureSTTSessions(STTSessionConfig());
+    std::remove(path.c_str());
+    removeLatencySpool(spoolDir);
+
+    LatencyHistogram capture = getLatencyHistogram(LatencyStage::CAPTURE);
+    LatencyHistogram bars = getLatencyHistogram(LatencyStage::WAVEFORM_BAR);
+    LatencyHistogram segments = getLatencyHistogram(LatencyStage::SEGMENT);
+    LatencyHistogram uploads = getLatencyHistogram(LatencyStage::UPLOAD);
+    LatencyHistogram transcripts = getLatencyHistogram(LatencyStage::TRANSCRIPT);
+    std::cout << formatLatencyReport();
+
+    // 2 s in 100 ms blocks; the first sample of each block waited a block to be handed over
+    ASSERT_EQ((uint64_t)20, capture.count);
+    ASSERT_TRUE(capture.p50Ms >= 95.0 && capture.p50Ms < 150.0);
+    // 30 bars per second; a bar is published with the block holding its last sample
+    ASSERT_EQ((uint64_t)60, bars.count);
+    ASSERT_TRUE(bars.maxMs < 150.0);
+    // Four 500 ms segments, each cut on the render frame after its last block
+    ASSERT_EQ((uint64_t)4, segments.count);
+    ASSERT_TRUE(segments.maxMs < 150.0);
+    ASSERT_EQ((uint64_t)4, uploads.count);
+    ASSERT_EQ((uint64_t)4, transcripts.count);
+    ASSERT_TRUE(uploads.minMs >= segments.minMs);
+    ASSERT_TRUE(transcripts.minMs >= segments.minMs);
+
+    // Every click reached the server where the capture clock says it was recorded
+    std::vector<std::string> bodies = server.bodies();
+    ASSERT_EQ((size_t)4, bodies.size());
+    const uint64_t interval = (uint64_t)rate * intervalMs / 1000;
+    int clicks = 0;
+    for (const std::string& body : bodies) {
+        uint64_t offset = strtoull(standin::formField(body, "sample_offset").c_str(), nullptr, 10);
+        std::vector<short> samples = standin::wavSamples(body);
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (samples[i] != 32767 || (i > 0 && samples[i - 1] == -32767)) continue; // Click onsets only
+            if ((offset + i) % interval != interval / 2) {
+                ctx.Fail("Click at capture sample " + std::to_string(offset + i) + " is off the click grid");
+            }
+            clicks++;
+        }
+    }
+    ASSERT_EQ(8, clicks);
+}
@@ -0,0 +1,146 @@
+#include "test.h"
+#include "../display/mirror.h"
+#include "../display/scene.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+static MirrorCandidate mirrorCandidate(int width, int height, bool isVertical, const std::string& key) {
+    MirrorCandidate candidate;
+    candidate.fbWidth = width;
+    candidate.fbHeight = height;
+    candidate.isVertical = isVertical;
+    candidate.contentKey = key;
+    return candidate;
+}
+
+void TestMirrorGroups(test::TestContext& ctx) {
+    std::vector<MirrorCandidate> candidates = {
+        mirrorCandidate(1920, 1080, false, "opening"),   // 0: leads group A
+        mirrorCandidate(1080, 1920, true, "opening"),    // 1: other orientation
+        mirrorCandidate(1920, 1080, false, "opening"),   // 2: follows 0
+        mirrorCandidate(1920, 1080, false, ""),          // 3: renders alone
+        mirrorCandidate(2560, 1440, false, "opening"),   // 4: other size
+        mirrorCandidate(1920, 1080, false, "admin:x"),   // 5: other scene
+        mirrorCandidate(1920, 1080, false, "opening"),   // 6: follows 0
+        mirrorCandidate(1080, 1920, true, "opening"),    // 7: follows 1
+    };
+    std::vector<MirrorGroup> groups = buildMirrorGroups(candidates);
+    ASSERT_EQ((size_t)5, groups.size());
+    ASSERT_EQ((size_t)3, groups[0].members.size());
+    ASSERT_EQ(0, groups[0].members[0]);
+    ASSERT_EQ(2, groups[0].members[1]);
+    ASSERT_EQ(6, groups[0].members[2]);
+    ASSERT_EQ(1920, groups[0].fbWidth);
+    ASSERT_EQ(1080, groups[0].fbHeight);
+    ASSERT_EQ((size_t)2, groups[1].members.size());
+    ASSERT_EQ(7, groups[1].members[1]);
+    // Only groups with followers take a shared texture slot
+    ASSERT_EQ(0, groups[0].slot);
+    ASSERT_EQ(1, groups[1].slot);
+    for (size_t g = 2; g < groups.size(); g++) {
+        ASSERT_EQ((size_t)1, groups[g].members.size());
+        ASSERT_EQ(-1, groups[g].slot);
+        ASSERT_EQ(0u, groups[g].texture);
+    }
+
+    std::vector<int> index = getMirrorGroupIndex(groups, candidates.size());
+    const int expected[] = {0, 1, 0, 2, 3, 4, 0, 1};
+    for (size_t i = 0; i < candidates.size(); i++) ASSERT_EQ(expected[i], index[i]);
+
+    // Mirroring off (every key empty): one group per window
+    for (MirrorCandidate& candidate : candidates) candidate.contentKey = "";
+    ASSERT_EQ(candidates.size(), buildMirrorGroups(candidates).size());
+}
+
+void TestMirrorContentKey(test::TestContext& ctx) {
+    WindowData wd;
+    wd.logoPath = "assets/logo_light.png";
+    wd.isValid = true;
+    wd.isAdmin = false;
+    wd.state = DisplayState::LOGO_SHOWING;
+    wd.openingScene = nullptr;
+    wd.sceneLoading = false;
+    wd.sceneLoaded = false;
+    wd.sharedContext = true;
+    wd.adminClickCount = 0;
+    wd.adminModeActive = false;
+    initSceneTransition(wd.transition);
+
+    WindowData other = wd;
+    ASSERT_FALSE(getMirrorContentKey(wd, 1.0f).empty());
+    ASSERT_STR_EQ(getMirrorContentKey(wd, 1.0f), getMirrorContentKey(other, 1.0f));
+    // Mid-fade windows only mirror at the same opacity
+    ASSERT_TRUE(getMirrorContentKey(wd, 0.5f) != getMirrorContentKey(other, 0.25f));
+    other.isValid = false; // Placeholder instead of the logo
+    ASSERT_TRUE(getMirrorContentKey(wd, 1.0f) != getMirrorContentKey(other, 1.0f));
+    other.isValid = true;
+    other.sceneLoading = true; // Its loading indicator is not in the leader's frame
+    ASSERT_TRUE(getMirrorContentKey(other, 1.0f).empty());
+    other.sceneLoading = false;
+    other.isAdmin = true;
+    other.adminClickCount = 2; // Nor is its tetra-click progress
+    ASSERT_TRUE(getMirrorContentKey(other, 1.0f).empty());
+    other.isAdmin = false;
+    other.adminClickCount = 0;
+
+    // A scene that has not loaded yet renders itself, so it loads
+    Scene scene;
+    wd.state = DisplayState::OPENING_SCENE;
+    ASSERT_TRUE(getMirrorContentKey(wd, 1.0f).empty());
+    wd.openingScene = &scene;
+    wd.sceneLoaded = true;
+    ASSERT_STR_EQ("opening", getMirrorContentKey(wd, 1.0f));
+
+    wd.transition.active = true; // Its own outgoing frame is composited
+    ASSERT_TRUE(getMirrorContentKey(wd, 1.0f).empty());
+    wd.transition.active = false;
+    wd.sharedContext = false;
+    ASSERT_TRUE(getMirrorContentKey(wd, 1.0f).empty());
+    wd.sharedContext = true;
+
+    wd.state = DisplayState::ADMIN_SCENE;
+    wd.currentAdminScene = "scenes/admin_audio.scene.json";
+    other.state = DisplayState::ADMIN_SCENE;
+    other.currentAdminScene = "scenes/admin_network.scene.json";
+    ASSERT_TRUE(getMirrorContentKey(wd, 1.0f) != getMirrorContentKey(other, 1.0f));
+    other.currentAdminScene = wd.currentAdminScene;
+    ASSERT_STR_EQ(getMirrorContentKey(wd, 1.0f), getMirrorContentKey(other, 1.0f));
+}
+
+// Render-thread cost of one frame across N identical monitors, each rendering
+// the opening scene vs. the first rendering it and the rest presenting it.
+// GL calls go to whatever context is current (none here), so this measures
+// the CPU side: scene simulation and command submission.
+void BenchmarkMirrorFrameCost(test::BenchContext& b) {
+    b.RunOnce();
+    const int frames = 120;
+    for (int monitors : {1, 2, 4, 6}) {
+        std::vector<Scene> scenes(monitors);
+        for (Scene& scene : scenes) {
+            if (!loadScene("scenes/opening.scene.json", scene)) return;
+        }
+        std::vector<MirrorCandidate> candidates(monitors, mirrorCandidate(1920, 1080, false, "opening"));
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (Scene& scene : scenes) renderScene(scene, 1920, 1080, 0.016f, frame);
+        }
+        double separateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            std::vector<MirrorGroup> groups = buildMirrorGroups(candidates);
+            renderScene(scenes[0], 1920, 1080, 0.016f, frame);
+            groups[0].texture = 1; // What captureMirrorFrame hands the followers
+            for (size_t follower = 1; follower < groups[0].members.size(); follower++) {
+                presentMirrorFrame(groups[0]);
+            }
+        }
+        double mirroredMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+        std::string label = std::to_string(monitors) + "-monitors";
+        b.ReportMetric(separateMs, "ms/frame-separate-" + label);
+        b.ReportMetric(mirroredMs, "ms/frame-mirrored-" + label);
+    }
+}
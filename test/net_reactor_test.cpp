@@ -0,0 +1,203 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/net_reactor.h"
+#include "../display/network.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts down once per callback so a test can wait for a batch of requests
+struct Latch {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int remaining;
+
+    explicit Latch(int count) : remaining(count) {}
+
+    void countDown() {
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining--;
+        cv.notify_all();
+    }
+
+    bool wait(int timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return remaining <= 0; });
+    }
+};
+
+// Restart the reactor on the requested backend (initNetwork starts the default one)
+static bool useBackend(NetReactorBackend backend) {
+    if (!initNetwork()) return false;
+    stopNetReactor();
+    return startNetReactor(backend);
+}
+
+static HTTPRequest localRequest(int port, const std::string& body = "{}") {
+    HTTPRequest request;
+    request.host = "127.0.0.1";
+    request.port = port;
+    request.path = "/v1/audio/transcriptions";
+    request.headers.push_back({"Content-Type", "application/json"});
+    request.body = body;
+    return request;
+}
+
+static HTTPResult submitAndWait(const HTTPRequest& request, bool cancelImmediately = false) {
+    auto done = std::make_shared<std::promise<HTTPResult>>();
+    std::future<HTTPResult> result = done->get_future();
+    NetRequestId id = submitHTTPRequest(request, [done](const HTTPResult& r) { done->set_value(r); });
+    if (cancelImmediately) cancelNetRequest(id);
+    return result.get();
+}
+
+// Timers, posted tasks and HTTP outcomes on one backend
+static void checkReactorBackend(test::TestContext& ctx, NetReactorBackend backend) {
+    ASSERT_TRUE(useBackend(backend));
+    ASSERT_TRUE(isNetReactorRunning());
+    ASSERT_FALSE(isNetworkThread());
+
+    // Timers fire in deadline order; a cancelled timer never fires
+    std::mutex orderMutex;
+    std::vector<int> order;
+    Latch timers(3);
+    auto record = [&](int value) {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(value);
+    };
+    addNetTimer(30, [&] { record(3); timers.countDown(); });
+    NetTimerId cancelled = addNetTimer(10, [&] { record(-1); });
+    addNetTimer(0, [&] { record(1); timers.countDown(); });
+    addNetTimer(15, [&] { record(2); timers.countDown(); });
+    cancelNetTimer(cancelled);
+    ASSERT_TRUE(timers.wait(2000));
+
+    // Posted tasks run on the network thread
+    std::promise<bool> onNetworkThread;
+    ASSERT_TRUE(postToNetReactor([&] { onNetworkThread.set_value(isNetworkThread()); }));
+    ASSERT_TRUE(onNetworkThread.get_future().get());
+
+    standin::HTTPServer server;
+    server.failFirst = 1;
+    ASSERT_TRUE(standin::startHTTPServer(server, 0));
+    HTTPResult busy = submitAndWait(localRequest(server.port));
+    HTTPResult accepted = submitAndWait(localRequest(server.port));
+
+    // Bodies larger than the socket buffer are finished over several writable events
+    std::string large(4 * 1024 * 1024, 'x');
+    HTTPResult uploaded = submitAndWait(localRequest(server.port, large));
+    size_t receivedBytes = server.bodyBytes();
+    standin::stopHTTPServer(server);
+
+    HTTPResult refused = submitAndWait(localRequest(standin::unusedPort()));
+
+    standin::HTTPServer slow;
+    slow.delayMs = [](int) { return 400; };
+    ASSERT_TRUE(standin::startHTTPServer(slow, 0));
+    HTTPRequest shortTimeout = localRequest(slow.port);
+    shortTimeout.timeoutMs = 100;
+    HTTPResult timedOut = submitAndWait(shortTimeout);
+    auto cancelStart = std::chrono::steady_clock::now();
+    HTTPResult cancelledResult = submitAndWait(localRequest(slow.port), true);
+    double cancelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cancelStart).count();
+    standin::stopHTTPServer(slow);
+
+    ASSERT_TRUE(useBackend(NET_BACKEND_DEFAULT));
+
+    ASSERT_EQ((size_t)3, order.size());
+    ASSERT_EQ(1, order[0]);
+    ASSERT_EQ(2, order[1]);
+    ASSERT_EQ(3, order[2]);
+
+    ASSERT_FALSE(busy.ok);
+    ASSERT_EQ(503, busy.status);
+    ASSERT_TRUE(accepted.ok);
+    ASSERT_EQ(200, accepted.status);
+    ASSERT_STR_EQ("{\"text\":\"ok\"}", accepted.body);
+    ASSERT_TRUE(uploaded.ok);
+    ASSERT_EQ(large.size(), receivedBytes);
+
+    ASSERT_FALSE(refused.ok);
+    ASSERT_EQ(0, refused.status);
+    ASSERT_STR_EQ("connect failed", refused.error);
+
+    ASSERT_FALSE(timedOut.ok);
+    ASSERT_STR_EQ("timeout", timedOut.error);
+    ASSERT_TRUE(cancelledResult.cancelled);
+    ASSERT_FALSE(cancelledResult.ok);
+    ASSERT_TRUE(cancelMs < 300.0);
+}
+
+void TestNetReactorEpollBackend(test::TestContext& ctx) {
+    checkReactorBackend(ctx, NET_BACKEND_DEFAULT);
+}
+
+void TestNetReactorPollBackend(test::TestContext& ctx) {
+    checkReactorBackend(ctx, NET_BACKEND_POLL);
+}
+
+// Requests still in flight at shutdown complete as cancelled instead of hanging
+void TestNetReactorShutdownFailsPending(test::TestContext& ctx) {
+    ASSERT_TRUE(useBackend(NET_BACKEND_DEFAULT));
+    standin::HTTPServer slow;
+    slow.delayMs = [](int) { return 300; };
+    ASSERT_TRUE(standin::startHTTPServer(slow, 0));
+
+    auto done = std::make_shared<std::promise<HTTPResult>>();
+    std::future<HTTPResult> pending = done->get_future();
+    submitHTTPRequest(localRequest(slow.port), [done](const HTTPResult& r) { done->set_value(r); });
+    stopNetReactor();
+    bool delivered = pending.wait_for(std::chrono::milliseconds(100)) == std::future_status::ready;
+    HTTPResult afterStop = submitAndWait(localRequest(slow.port));
+    ASSERT_TRUE(startNetReactor());
+    standin::stopHTTPServer(slow);
+
+    ASSERT_TRUE(delivered);
+    ASSERT_TRUE(pending.get().cancelled);
+    ASSERT_FALSE(afterStop.ok);
+    ASSERT_STR_EQ("network not running", afterStop.error);
+}
+
+// Hundreds of concurrent in-flight uploads on the single network thread
+// Each request carries a 1s PCM16 utterance and the stand-in replies after 20ms
+void BenchmarkNetReactorConcurrentRequests(test::BenchContext& b) {
+    b.RunOnce();
+    initNetwork();
+    const int requests = 500;
+    standin::HTTPServer server;
+    server.delayMs = [](int) { return 20; };
+    if (!standin::startHTTPServer(server, 0)) return;
+
+    std::vector<short> utterance(16000, 1000);
+    std::mutex latencyMutex;
+    std::vector<double> latencies;
+    int failures = 0;
+    Latch latch(requests);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; i++) {
+        sendAudioToWhisperAsync(utterance, 16000, "127.0.0.1", server.port, [&](const HTTPResult& result) {
+            {
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                latencies.push_back(result.latencyMs);
+                if (!result.ok) failures++;
+            }
+            latch.countDown();
+        });
+    }
+    latch.wait(30000);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    standin::stopHTTPServer(server);
+
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    std::sort(latencies.begin(), latencies.end());
+    b.ReportMetric((double)latencies.size() / seconds, "req/s");
+    if (!latencies.empty()) {
+        b.ReportMetric(latencies[latencies.size() / 2], "ms/p50");
+        b.ReportMetric(latencies[latencies.size() * 99 / 100], "ms/p99");
+    }
+    b.ReportMetric((double)failures, "failures");
+}
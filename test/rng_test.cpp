@@ -0,0 +1,187 @@
+#include "test.h"
+#include "../display/rng.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Known-answer vectors from the Random123 distribution (kat_vectors)
+void TestPhiloxKnownAnswers(test::TestContext& ctx) {
+    struct Vector {
+        uint32_t counter[4];
+        uint32_t key[2];
+        uint32_t expected[4];
+    };
+    const Vector vectors[] = {
+        {{0, 0, 0, 0}, {0, 0}, {0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}},
+        {{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu},
+         {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}},
+        {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u},
+         {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}},
+    };
+    for (const Vector& v : vectors) {
+        uint32_t out[4];
+        philox4x32(v.counter, v.key, out);
+        for (int i = 0; i < 4; i++) ASSERT_EQ(v.expected[i], out[i]);
+    }
+}
+
+// Batches return exactly what single draws would, from any starting offset,
+// across a carry out of the low counter word
+void TestRandomBatchMatchesScalar(test::TestContext& ctx) {
+    for (size_t skip : {(size_t)0, (size_t)1, (size_t)3, (size_t)4, (size_t)7}) {
+        for (size_t count : {(size_t)1, (size_t)15, (size_t)16, (size_t)17, (size_t)1000}) {
+            RandomStream single = makeRandomStream(42, RandomStreamId::BACKGROUND, 9);
+            single.counter[0] = 0xfffffffeu; // Two blocks before the carry
+            RandomStream batch = single;
+            for (size_t i = 0; i < skip; i++) {
+                randomUint32(single);
+                randomUint32(batch);
+            }
+            std::vector<uint32_t> values(count);
+            fillRandomUint32(batch, values.data(), count);
+            for (size_t i = 0; i < count; i++) {
+                uint32_t expected = randomUint32(single);
+                if (values[i] != expected) {
+                    ctx.Fail("Batch value " + std::to_string(i) + " differs (skip " + std::to_string(skip) +
+                             ", count " + std::to_string(count) + ")");
+                    return;
+                }
+            }
+            // Both streams carry on from the same place
+            ASSERT_EQ(randomUint32(single), randomUint32(batch));
+        }
+    }
+
+    RandomStream single = makeRandomStream(7, RandomStreamId::AUDIO);
+    RandomStream batch = single;
+    std::vector<float> floats(333);
+    fillRandomFloat(batch, floats.data(), floats.size());
+    for (float value : floats) ASSERT_TRUE(value == randomFloat(single));
+}
+
+void TestRandomStreamsReproducible(test::TestContext& ctx) {
+    RandomStream a = makeRandomStream(1234, RandomStreamId::BACKGROUND, 5);
+    RandomStream b = makeRandomStream(1234, RandomStreamId::BACKGROUND, 5);
+    for (int i = 0; i < 100; i++) ASSERT_EQ(randomUint32(a), randomUint32(b));
+
+    // Seed, subsystem and substream each select a different sequence
+    RandomStream base = makeRandomStream(1234, RandomStreamId::BACKGROUND, 5);
+    RandomStream otherSeed = makeRandomStream(1235, RandomStreamId::BACKGROUND, 5);
+    RandomStream otherSubsystem = makeRandomStream(1234, RandomStreamId::AUDIO, 5);
+    RandomStream otherSubstream = makeRandomStream(1234, RandomStreamId::BACKGROUND, 6);
+    int sameSeed = 0, sameSubsystem = 0, sameSubstream = 0;
+    for (int i = 0; i < 64; i++) {
+        uint32_t value = randomUint32(base);
+        if (value == randomUint32(otherSeed)) sameSeed++;
+        if (value == randomUint32(otherSubsystem)) sameSubsystem++;
+        if (value == randomUint32(otherSubstream)) sameSubstream++;
+    }
+    ASSERT_EQ(0, sameSeed);
+    ASSERT_EQ(0, sameSubsystem);
+    ASSERT_EQ(0, sameSubstream);
+
+    // A particle's values don't depend on how much other particles drew first
+    RandomStream early = makeRandomStream(99, RandomStreamId::BACKGROUND, 3);
+    float first = randomFloat(early);
+    for (uint32_t particle = 0; particle < 3; particle++) {
+        RandomStream other = makeRandomStream(99, RandomStreamId::BACKGROUND, particle);
+        for (int i = 0; i < 1000; i++) randomFloat(other);
+    }
+    RandomStream late = makeRandomStream(99, RandomStreamId::BACKGROUND, 3);
+    ASSERT_TRUE(first == randomFloat(late));
+}
+
+// Moments, bucket uniformity, per-bit balance, lag-1 and cross-stream
+// correlation over a million values; bounds are several sigma wide
+void TestRandomStatistics(test::TestContext& ctx) {
+    const size_t count = 1 << 20;
+    std::vector<float> values(count);
+    RandomStream stream = makeRandomStream(2024, RandomStreamId::BACKGROUND);
+    fillRandomFloat(stream, values.data(), count);
+
+    double sum = 0.0, sumSquared = 0.0, lagProduct = 0.0;
+    std::vector<int> buckets(256, 0);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_TRUE(values[i] >= 0.0f && values[i] < 1.0f);
+        sum += values[i];
+        sumSquared += (double)values[i] * values[i];
+        if (i > 0) lagProduct += ((double)values[i] - 0.5) * ((double)values[i - 1] - 0.5);
+        buckets[(int)(values[i] * 256.0f)]++;
+    }
+    double mean = sum / count;
+    double variance = sumSquared / count - mean * mean;
+    ASSERT_NEAR(0.5, mean, 0.002);
+    ASSERT_NEAR(1.0 / 12.0, variance, 0.001);
+    ASSERT_NEAR(0.0, lagProduct / (count - 1) / (1.0 / 12.0), 0.005);
+
+    // Chi-square with 255 degrees of freedom: mean 255, sd ~22.6
+    double expected = (double)count / 256.0;
+    double chiSquare = 0.0;
+    for (int bucket : buckets) chiSquare += (bucket - expected) * (bucket - expected) / expected;
+    ASSERT_TRUE(chiSquare > 170.0 && chiSquare < 350.0);
+
+    RandomStream bitsStream = makeRandomStream(2024, RandomStreamId::AUDIO);
+    std::vector<uint32_t> words(count);
+    fillRandomUint32(bitsStream, words.data(), count);
+    for (int bit = 0; bit < 32; bit++) {
+        size_t ones = 0;
+        for (uint32_t word : words) ones += (word >> bit) & 1u;
+        ASSERT_NEAR(0.5, (double)ones / count, 0.003);
+    }
+
+    // Neighbouring substreams (adjacent particles) are uncorrelated
+    RandomStream left = makeRandomStream(2024, RandomStreamId::BACKGROUND, 0);
+    RandomStream right = makeRandomStream(2024, RandomStreamId::BACKGROUND, 1);
+    double cross = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        cross += ((double)randomFloat(left) - 0.5) * ((double)randomFloat(right) - 0.5);
+    }
+    ASSERT_NEAR(0.0, cross / count / (1.0 / 12.0), 0.005);
+
+    // Bounded integers stay in range and hit every value evenly
+    RandomStream dice = makeRandomStream(5, RandomStreamId::AUDIO_SEED);
+    std::vector<int> faces(6, 0);
+    for (int i = 0; i < 60000; i++) {
+        uint32_t face = randomBelow(dice, 6);
+        ASSERT_TRUE(face < 6);
+        faces[face]++;
+    }
+    for (int face : faces) ASSERT_TRUE(face > 9500 && face < 10500);
+    ASSERT_EQ(0u, randomBelow(dice, 1));
+    for (int i = 0; i < 1000; i++) {
+        float value = randomRange(dice, -25.0f, 25.0f);
+        ASSERT_TRUE(value >= -25.0f && value < 25.0f);
+    }
+}
+
+// Per-value cost of single draws, batched draws and the C library rand()
+void BenchmarkRandomGeneration(test::BenchContext& b) {
+    b.RunOnce();
+    const size_t count = 1 << 22;
+    std::vector<uint32_t> out(count);
+    volatile uint32_t sink = 0; // Keeps the loops from being optimized away
+
+    RandomStream single = makeRandomStream(1, RandomStreamId::BACKGROUND);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) out[i] = randomUint32(single);
+    double singleNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    sink ^= out[count / 2];
+
+    RandomStream batch = makeRandomStream(1, RandomStreamId::BACKGROUND);
+    start = std::chrono::steady_clock::now();
+    fillRandomUint32(batch, out.data(), count);
+    double batchNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    sink ^= out[count / 2];
+
+    std::srand(1);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++) out[i] = (uint32_t)std::rand();
+    double randNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    sink ^= out[count / 2];
+
+    b.ReportMetric(singleNs, "ns/value-single");
+    b.ReportMetric(batchNs, "ns/value-batch");
+    b.ReportMetric(randNs, "ns/value-rand");
+}
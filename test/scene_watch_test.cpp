@@ -0,0 +1,192 @@
+#include "test.h"
+#include "../display/scene_watch.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static Widget makeWidget(const std::string& type, const std::string& key, const std::string& value,
+                         int row, int col) {
+    Widget widget;
+    widget.type = type;
+    if (!key.empty()) widget.properties[key] = value;
+    widget.row = row;
+    widget.col = col;
+    widget.width = 2;
+    widget.height = 2;
+    widget.margin = 0.1f;
+    return widget;
+}
+
+static Scene makeScene() {
+    Scene scene;
+    scene.id = "opening_scene";
+    scene.layout = "grid";
+    scene.cols = 8;
+    scene.rows = 12;
+    scene.bg.color = "#191926";
+    scene.bg.graphic = "blurred_orbs";
+    scene.waveform = true;
+    scene.widgets.push_back(makeWidget("language_card", "language", "English", 10, 2));
+    scene.widgets.push_back(makeWidget("language_card", "language", "Arabic", 10, 4));
+    scene.widgets.push_back(makeWidget("transcript", "", "", 2, 1));
+    return scene;
+}
+
+static bool sameScene(const Scene& a, const Scene& b) {
+    if (a.id != b.id || a.layout != b.layout || a.cols != b.cols || a.rows != b.rows || a.waveform != b.waveform) return false;
+    if (a.bg.image != b.bg.image || a.bg.color != b.bg.color || a.bg.graphic != b.bg.graphic) return false;
+    if (a.widgets.size() != b.widgets.size()) return false;
+    for (size_t i = 0; i < a.widgets.size(); i++) {
+        const Widget& x = a.widgets[i];
+        const Widget& y = b.widgets[i];
+        if (x.type != y.type || x.properties != y.properties || x.row != y.row || x.col != y.col ||
+            x.width != y.width || x.height != y.height || x.margin != y.margin) return false;
+    }
+    return true;
+}
+
+void TestSceneDiffWidgets(test::TestContext& ctx) {
+    Scene live = makeScene();
+    ASSERT_TRUE(isSceneDiffEmpty(diffScenes(live, makeScene())));
+
+    // A label edit is a property change: nothing moves, so hit indexes stay valid
+    Scene relabelled = makeScene();
+    relabelled.widgets[1].properties["label"] = "Arabic (Egypt)";
+    SceneDiff diff = diffScenes(live, relabelled);
+    ASSERT_EQ((size_t)1, diff.changed.size());
+    ASSERT_EQ(1, diff.changed[0].liveIndex);
+    ASSERT_TRUE(diff.moved.empty() && diff.added.empty() && diff.removed.empty());
+    ASSERT_FALSE(sceneDiffMovesWidgets(diff));
+    applySceneDiff(live, relabelled, diff);
+    ASSERT_TRUE(sameScene(live, relabelled));
+
+    // Move the English card, drop Arabic, add a French card and change the background
+    Scene edited = relabelled;
+    edited.widgets[0].col = 1;
+    edited.widgets.erase(edited.widgets.begin() + 1);
+    edited.widgets.push_back(makeWidget("language_card", "language", "French", 10, 5));
+    edited.bg.graphic = "triangles";
+    diff = diffScenes(live, edited);
+    ASSERT_TRUE(diff.backgroundChanged);
+    ASSERT_FALSE(diff.gridChanged);
+    ASSERT_EQ((size_t)1, diff.moved.size());
+    ASSERT_EQ(0, diff.moved[0].liveIndex);
+    ASSERT_EQ((size_t)1, diff.removed.size());
+    ASSERT_EQ(1, diff.removed[0]);
+    ASSERT_EQ((size_t)1, diff.added.size());
+    ASSERT_EQ(2, diff.added[0]);
+    ASSERT_TRUE(diff.changed.empty());
+    ASSERT_TRUE(sceneDiffMovesWidgets(diff));
+    applySceneDiff(live, edited, diff);
+    ASSERT_TRUE(sameScene(live, edited));
+
+    // Swapping two widgets changes which draws on top
+    Scene swapped = edited;
+    std::swap(swapped.widgets[0], swapped.widgets[1]);
+    diff = diffScenes(live, swapped);
+    ASSERT_TRUE(diff.reordered);
+    ASSERT_TRUE(diff.moved.empty() && diff.added.empty() && diff.removed.empty());
+    applySceneDiff(live, swapped, diff);
+    ASSERT_TRUE(sameScene(live, swapped));
+
+    // A new grid moves every rect without any widget changing
+    Scene regrid = swapped;
+    regrid.cols = 12;
+    diff = diffScenes(live, regrid);
+    ASSERT_TRUE(diff.gridChanged);
+    ASSERT_TRUE(sceneDiffMovesWidgets(diff));
+    applySceneDiff(live, regrid, diff);
+    ASSERT_TRUE(sameScene(live, regrid));
+}
+
+static void writeSceneFile(const std::string& path, const std::string& color, int englishCol) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return;
+    fprintf(file,
+            "{\n"
+            "  \"id\": \"opening_scene\",\n"
+            "  \"layout\": \"grid\",\n"
+            "  \"cols\": 8,\n"
+            "  \"rows\": 12,\n"
+            "  \"bg\": {\n"
+            "    \"color\": \"%s\",\n"
+            "    \"graphic\": \"blurred_orbs\"\n"
+            "  },\n"
+            "  \"widgets\": [\n"
+            "    {\n"
+            "      \"type\": \"language_card\",\n"
+            "      \"language\": \"English\",\n"
+            "      \"row\": 10,\n"
+            "      \"col\": %d,\n"
+            "      \"width\": 2,\n"
+            "      \"height\": 2,\n"
+            "      \"margin\": 0.1\n"
+            "    }\n"
+            "  ]\n"
+            "}\n",
+            color.c_str(), englishCol);
+    fclose(file);
+}
+
+static bool waitForSceneUpdate(std::string& path, Scene& scene, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!takeSceneUpdate(path, scene)) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// Edits land as parsed scenes within well under a second, through inotify
+// (where available) and through the polling fallback
+void TestSceneWatcherReloads(test::TestContext& ctx) {
+    const std::string dir = "test_scene_watch";
+    const std::string file = dir + "/opening.scene.json";
+#ifdef _WIN32
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+    writeSceneFile(file, "#000000", 2);
+
+    for (SceneWatchMode mode : {SceneWatchMode::AUTO, SceneWatchMode::POLL}) {
+        ASSERT_TRUE(startSceneWatcher(dir, mode, 50));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let the watcher take its baseline
+        std::string path;
+        Scene scene;
+        ASSERT_FALSE(takeSceneUpdate(path, scene)); // Existing files are not reported
+
+        auto start = std::chrono::steady_clock::now();
+        writeSceneFile(file, "#ff0000", 3);
+        ASSERT_TRUE(waitForSceneUpdate(path, scene, 2000));
+        double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        ASSERT_STR_EQ(file, path);
+        ASSERT_STR_EQ("#ff0000", scene.bg.color);
+        ASSERT_EQ((size_t)1, scene.widgets.size());
+        ASSERT_EQ(3, scene.widgets[0].col);
+        ASSERT_TRUE(latencyMs < 1000.0);
+
+        // Files that are not scenes are ignored
+        FILE* other = fopen((dir + "/notes.txt").c_str(), "w");
+        if (other) {
+            fputs("not a scene\n", other);
+            fclose(other);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        ASSERT_FALSE(takeSceneUpdate(path, scene));
+        stopSceneWatcher();
+    }
+
+    std::remove(file.c_str());
+    std::remove((dir + "/notes.txt").c_str());
+    rmdir(dir.c_str());
+}
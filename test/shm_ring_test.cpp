@@ -0,0 +1,387 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/shm_ring.h"
+#include "../display/resample.h"
+#include "../display/sidecar_pump.h"
+#include "../display/network.h"
+#include "../display/stt_session.h"
+#include "../display/stt_spool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static const double PI = 3.14159265358979323846;
+
+// Ring contents are checked against a per-session ramp of the capture clock
+static short clockSample(uint64_t sessionId, uint64_t clock) {
+    return (short)((sessionId * 1000 + clock) % 30011);
+}
+
+static void publishRamp(uint64_t sessionId, uint64_t& clock, size_t count, size_t taken) {
+    std::vector<short> block(count);
+    for (size_t i = 0; i < count; i++) {
+        block[i] = clockSample(sessionId, clock + i);
+    }
+    clock += taken;
+    publishSharedAudio(block.data(), block.size(), sessionId, clock);
+}
+
+static bool matchesClock(const SharedAudioBlock& block) {
+    for (size_t i = 0; i < block.samples.size(); i++) {
+        if (block.samples[i] != clockSample(block.sessionId, block.sampleClock + i)) return false;
+    }
+    return true;
+}
+
+static std::vector<short> tone(double hz, double amplitude, int rate, size_t count) {
+    std::vector<short> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = (short)std::lround(amplitude * std::sin(2.0 * PI * hz * i / rate));
+    }
+    return samples;
+}
+
+static double rms(const std::vector<short>& samples, size_t begin, size_t end) {
+    double sum = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        sum += (double)samples[i] * samples[i];
+    }
+    return std::sqrt(sum / std::max<size_t>(1, end - begin));
+}
+
+static void removeSpool(const std::string& dir) {
+    std::remove((dir + "/spool.idx").c_str());
+    std::remove((dir + "/spool.idx.tmp").c_str());
+    for (int segment = 1; segment <= 8; segment++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/seg_%06d.bin", segment);
+        std::remove((dir + name).c_str());
+    }
+    rmdir(dir.c_str());
+}
+
+// Sessions come out in order with their own clocks, including a partly taken block
+void TestSharedAudioRoundTrip(test::TestContext& ctx) {
+    ASSERT_TRUE(startSharedAudioExport("ndt_test_ring", 8000, 4096));
+    SharedAudioReader reader;
+    ASSERT_TRUE(openSharedAudio(reader, "ndt_test_ring"));
+    ASSERT_EQ(8000, reader.sampleRate);
+    ASSERT_TRUE(isSharedAudioWriterAlive(reader));
+
+    uint64_t clockA = 0, clockB = 0;
+    publishRamp(7, clockA, 1000, 1000);
+    publishRamp(7, clockA, 1000, 1000);
+    publishRamp(7, clockA, 1000, 300); // Listen window closed 300 samples in
+    publishRamp(8, clockB, 500, 500);
+
+    SharedAudioBlock block;
+    ASSERT_TRUE(readSharedAudio(reader, block, 1u << 16));
+    ASSERT_EQ((uint64_t)7, block.sessionId);
+    ASSERT_EQ((uint64_t)0, block.sampleClock);
+    ASSERT_EQ((size_t)2300, block.samples.size()); // Stops at the session boundary
+    ASSERT_EQ((uint64_t)0, block.droppedSamples);
+    ASSERT_TRUE(matchesClock(block));
+
+    ASSERT_TRUE(readSharedAudio(reader, block, 200));
+    ASSERT_EQ((uint64_t)8, block.sessionId);
+    ASSERT_EQ((uint64_t)0, block.sampleClock);
+    ASSERT_EQ((size_t)200, block.samples.size());
+    ASSERT_TRUE(matchesClock(block));
+    ASSERT_TRUE(readSharedAudio(reader, block, 1u << 16));
+    ASSERT_EQ((uint64_t)200, block.sampleClock);
+    ASSERT_EQ((size_t)300, block.samples.size());
+    ASSERT_TRUE(matchesClock(block));
+    ASSERT_FALSE(readSharedAudio(reader, block, 1u << 16));
+
+    // A reader that attaches later starts at the write cursor, clock included
+    SharedAudioReader late;
+    ASSERT_TRUE(openSharedAudio(late, "ndt_test_ring"));
+    ASSERT_FALSE(readSharedAudio(late, block, 1u << 16));
+    publishRamp(8, clockB, 100, 100);
+    ASSERT_TRUE(readSharedAudio(late, block, 1u << 16));
+    ASSERT_EQ((uint64_t)500, block.sampleClock);
+    ASSERT_TRUE(matchesClock(block));
+    closeSharedAudio(late);
+
+    SharedAudioExportStats stats = getSharedAudioExportStats();
+    ASSERT_EQ((uint64_t)2900, stats.publishedSamples);
+    ASSERT_EQ((uint64_t)2, stats.sessions);
+
+    stopSharedAudioExport();
+    ASSERT_FALSE(isSharedAudioWriterAlive(reader));
+    closeSharedAudio(reader);
+    ASSERT_FALSE(openSharedAudio(reader, "ndt_test_ring")); // Name removed with the export
+}
+
+// A reader that falls a ring behind loses the oldest audio, and the clock says how much
+void TestSharedAudioLappedReader(test::TestContext& ctx) {
+    ASSERT_TRUE(startSharedAudioExport("ndt_test_lapped", 8000, 4096));
+    SharedAudioReader reader;
+    ASSERT_TRUE(openSharedAudio(reader, "ndt_test_lapped"));
+    uint64_t clock = 0;
+    for (int i = 0; i < 10; i++) {
+        publishRamp(9, clock, 1000, 1000);
+    }
+
+    SharedAudioBlock block;
+    ASSERT_TRUE(readSharedAudio(reader, block, 1u << 16));
+    ASSERT_EQ((uint64_t)(10000 - 4096), block.droppedSamples);
+    ASSERT_EQ((uint64_t)(10000 - 4096), block.sampleClock);
+    ASSERT_EQ((size_t)4096, block.samples.size());
+    ASSERT_TRUE(matchesClock(block));
+    ASSERT_FALSE(readSharedAudio(reader, block, 1u << 16));
+
+    closeSharedAudio(reader);
+    stopSharedAudioExport();
+}
+
+// 44.1 kHz to 16 kHz: speech band passes, content above the new Nyquist is removed
+void TestResamplerTones(test::TestContext& ctx) {
+    const size_t count = 44100;
+    std::vector<short> speech = tone(1000.0, 10000.0, 44100, count);
+    std::vector<short> alias = tone(10000.0, 10000.0, 44100, count);
+
+    Resampler resampler;
+    ASSERT_TRUE(initResampler(resampler, 44100, 16000));
+    ASSERT_EQ(160, resampler.up);
+    ASSERT_EQ(441, resampler.down);
+
+    // Irregular blocks give the same output as one call
+    std::vector<short> whole, split;
+    resample(resampler, speech.data(), speech.size(), whole);
+    flushResampler(resampler, whole);
+    const size_t blockSizes[] = {441, 1, 1024, 37, 4410, 160};
+    for (size_t done = 0, i = 0; done < count; i++) {
+        size_t n = std::min(blockSizes[i % 6], count - done);
+        resample(resampler, speech.data() + done, n, split);
+        done += n;
+    }
+    flushResampler(resampler, split);
+    ASSERT_EQ((size_t)16000, whole.size());
+    ASSERT_TRUE(whole == split);
+
+    std::vector<short> expected = tone(1000.0, 10000.0, 16000, 16000);
+    double error = 0.0;
+    for (size_t i = 200; i < 15800; i++) {
+        error = std::max(error, std::fabs((double)whole[i] - expected[i]));
+    }
+    ASSERT_TRUE(error < 50.0); // In phase, no delay, < 0.05 dB ripple
+
+    std::vector<short> filtered;
+    resample(resampler, alias.data(), alias.size(), filtered);
+    flushResampler(resampler, filtered);
+    double attenuationDb = 20.0 * std::log10(rms(filtered, 200, 15800) / (10000.0 / std::sqrt(2.0)));
+    ASSERT_TRUE(attenuationDb < -40.0);
+}
+
+// Display publishes, pump resamples and chunks, spool uploads: offsets line up at 16 kHz
+void TestSidecarPumpUploads(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    standin::HTTPServer server;
+    server.keepBodies = true;
+    ASSERT_TRUE(standin::startHTTPServer(server, 0));
+    const std::string dir = "test_spool_sidecar";
+    STTSpoolConfig spoolConfig;
+    spoolConfig.directory = dir;
+    spoolConfig.host = "127.0.0.1";
+    spoolConfig.port = server.port;
+    ASSERT_TRUE(startSTTSpool(spoolConfig));
+
+    ASSERT_TRUE(startSharedAudioExport("ndt_test_sidecar", 44100));
+    SidecarPumpConfig pumpConfig;
+    pumpConfig.shmName = "ndt_test_sidecar";
+    pumpConfig.chunkMs = 500;  // 8000 samples at 16 kHz
+    pumpConfig.contextMs = 50; // 800
+    ASSERT_TRUE(startSidecarPump(pumpConfig));
+    ASSERT_TRUE(getSidecarPumpStats().attached);
+
+    // Two seconds of a 440 Hz tone in 100 ms capture blocks
+    const uint64_t sessionId = 42;
+    std::vector<short> capture = tone(440.0, 8000.0, 44100, 88200);
+    for (size_t done = 0; done < capture.size(); done += 4410) {
+        publishSharedAudio(capture.data() + done, 4410, sessionId, done + 4410);
+        runSidecarPump();
+    }
+    stopSharedAudioExport();
+    runSidecarPump(); // Sees the display stop and uploads the tail
+    SidecarPumpStats stats = getSidecarPumpStats();
+    stopSidecarPump();
+    ASSERT_EQ((uint64_t)88200, stats.readSamples);
+    ASSERT_EQ((uint64_t)32000, stats.uploadSamples);
+    ASSERT_EQ((uint64_t)4, stats.chunks);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (getSTTSpoolStats().uploadedRecords < stats.chunks && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    removeSpool(dir);
+
+    std::vector<std::string> bodies = server.bodies();
+    ASSERT_EQ((size_t)4, bodies.size());
+    std::vector<short> expected = tone(440.0, 8000.0, 16000, 32000);
+    std::vector<uint64_t> starts;
+    for (const std::string& body : bodies) {
+        ASSERT_STR_EQ(std::to_string(sessionId), standin::formField(body, "session_id"));
+        uint64_t offset = strtoull(standin::formField(body, "sample_offset").c_str(), nullptr, 10);
+        uint32_t context = (uint32_t)strtoul(standin::formField(body, "context_samples").c_str(), nullptr, 10);
+        std::vector<short> samples = standin::wavSamples(body);
+        ASSERT_EQ((size_t)(8000 + context), samples.size());
+        ASSERT_EQ(offset == 0 ? 0u : 800u, context);
+        // Offsets are positions on the 16 kHz clock (edges of the session excluded)
+        for (size_t i = 0; i < samples.size(); i++) {
+            uint64_t position = offset + i;
+            if (position < 200 || position >= 31800) continue;
+            ASSERT_TRUE(std::abs(samples[i] - expected[position]) < 50);
+        }
+        starts.push_back(offset + context);
+    }
+    std::sort(starts.begin(), starts.end());
+    for (size_t i = 0; i < starts.size(); i++) {
+        ASSERT_EQ((uint64_t)(i * 8000), starts[i]); // New audio covered once, no gaps
+    }
+}
+
+#ifndef _WIN32
+static double processCpuSeconds(int who) {
+    struct rusage usage;
+    getrusage(who, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+#endif
+
+// Display-process CPU for STT uploads: in-process spool vs export to the sidecar
+// Thirty seconds of capture are fed at 10x real time in 100 ms blocks; the
+// stand-in server and the sidecar run in child processes so only the
+// display's own work is counted in its CPU time
+void BenchmarkSidecarRenderCPU(test::BenchContext& b) {
+    b.RunOnce();
+#ifdef _WIN32
+    std::cout << "  (needs fork: POSIX only)" << std::endl;
+#else
+    const int rate = 44100;
+    const size_t block = 4410;
+    const int blocks = 300;
+    const double audioSeconds = (double)blocks * block / rate;
+    std::vector<short> capture = tone(220.0, 6000.0, rate, block);
+
+    cleanupNetwork(); // Children start from a process without network threads
+    int port = 0;
+    NetSocket listener = standin::listenLoopback(port);
+    if (listener == INVALID_NET_SOCKET) return;
+    pid_t serverPid = fork();
+    if (serverPid == 0) {
+        standin::HTTPServer server;
+        server.listener = listener;
+        server.port = port;
+        server.running = true;
+        standin::runHTTPServer(&server);
+        _exit(0);
+    }
+    closeNetSocket(listener);
+
+    STTSessionConfig sessionConfig;
+    configureSTTSessions(sessionConfig);
+    auto feed = [&](bool exportMode) {
+        beginSTTSession(rate);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t enqueued = 0;
+        for (int i = 0; i < blocks; i++) {
+            appendSTTSessionAudio(capture.data(), block);
+            STTSessionStats session = getSTTSessionStats();
+            STTUploadChunk chunk;
+            if (exportMode) {
+                publishSharedAudio(capture.data(), block, session.sessionId, session.capturedSamples);
+                skipSTTSessionAudio();
+            }
+            while (takeSTTSessionChunk(chunk, i == blocks - 1)) {
+                if (enqueueSTTUpload(chunk.samples, chunk.sampleRate, &chunk.info)) enqueued++;
+            }
+            std::this_thread::sleep_until(start + std::chrono::milliseconds((i + 1) * 10));
+        }
+        endSTTSession();
+        return enqueued;
+    };
+
+    // In-process: session chunks go through the spool (WAV encode + POST) in this process
+    const std::string dir = "bench_spool_inprocess";
+    initNetwork();
+    STTSpoolConfig spoolConfig;
+    spoolConfig.directory = dir;
+    spoolConfig.host = "127.0.0.1";
+    spoolConfig.port = port;
+    startSTTSpool(spoolConfig);
+    double cpuStart = processCpuSeconds(RUSAGE_SELF);
+    uint64_t enqueued = feed(false);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (getSTTSpoolStats().uploadedRecords < enqueued && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    double inProcessCpu = processCpuSeconds(RUSAGE_SELF) - cpuStart;
+    stopSTTSpool();
+    cleanupNetwork();
+    removeSpool(dir);
+
+    // Export: this process only publishes; a forked sidecar resamples and uploads
+    const std::string sidecarDir = "bench_spool_sidecar";
+    startSharedAudioExport("ndt_bench_sidecar", rate);
+    double childCpuStart = processCpuSeconds(RUSAGE_CHILDREN);
+    pid_t sidecarPid = fork();
+    if (sidecarPid == 0) {
+        initNetwork();
+        STTSpoolConfig childSpool = spoolConfig;
+        childSpool.directory = sidecarDir;
+        startSTTSpool(childSpool);
+        SidecarPumpConfig pumpConfig;
+        pumpConfig.shmName = "ndt_bench_sidecar";
+        startSidecarPump(pumpConfig);
+        while (getSidecarPumpStats().attached) {
+            if (runSidecarPump() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        uint64_t chunks = getSidecarPumpStats().chunks;
+        stopSidecarPump();
+        auto childDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (getSTTSpoolStats().uploadedRecords < chunks && std::chrono::steady_clock::now() < childDeadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        bool uploaded = getSTTSpoolStats().uploadedRecords == chunks && chunks > 0;
+        stopSTTSpool();
+        cleanupNetwork();
+        _exit(uploaded ? 0 : 1);
+    }
+    cpuStart = processCpuSeconds(RUSAGE_SELF);
+    feed(true);
+    double exportCpu = processCpuSeconds(RUSAGE_SELF) - cpuStart;
+    stopSharedAudioExport();
+    int status = 0;
+    waitpid(sidecarPid, &status, 0);
+    double sidecarCpu = processCpuSeconds(RUSAGE_CHILDREN) - childCpuStart;
+    removeSpool(sidecarDir);
+
+    kill(serverPid, SIGKILL);
+    waitpid(serverPid, nullptr, 0);
+
+    b.ReportMetric(inProcessCpu * 1000.0 / audioSeconds, "ms-cpu/audio-s-inprocess");
+    b.ReportMetric(exportCpu * 1000.0 / audioSeconds, "ms-cpu/audio-s-export");
+    b.ReportMetric(sidecarCpu * 1000.0 / audioSeconds, "ms-cpu/audio-s-sidecar");
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cout << "  (sidecar did not upload every chunk)" << std::endl;
+    }
+#endif
+}
@@ -0,0 +1,232 @@
+#include "test.h"
+#include "../display/snapshot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+static uint32_t readBigEndian32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+// Reference decoder, written from the QOI spec independently of the encoder
+static bool decodeQOI(const std::vector<uint8_t>& data, int& width, int& height, std::vector<uint8_t>& rgba) {
+    if (data.size() < 22 || memcmp(data.data(), "qoif", 4) != 0) return false;
+    width = (int)readBigEndian32(&data[4]);
+    height = (int)readBigEndian32(&data[8]);
+    size_t pixels = (size_t)width * height;
+    rgba.clear();
+    uint8_t index[64][4] = {};
+    uint8_t px[4] = {0, 0, 0, 255};
+    size_t pos = 14, end = data.size() - 8;
+    int run = 0;
+    while (rgba.size() < pixels * 4) {
+        if (run > 0) {
+            run--;
+        } else {
+            if (pos >= end) return false;
+            uint8_t op = data[pos++];
+            if (op == 0xfe) {
+                px[0] = data[pos]; px[1] = data[pos + 1]; px[2] = data[pos + 2];
+                pos += 3;
+            } else if (op == 0xff) {
+                memcpy(px, &data[pos], 4);
+                pos += 4;
+            } else if ((op & 0xc0) == 0x00) {
+                memcpy(px, index[op], 4);
+            } else if ((op & 0xc0) == 0x40) {
+                px[0] += ((op >> 4) & 3) - 2;
+                px[1] += ((op >> 2) & 3) - 2;
+                px[2] += (op & 3) - 2;
+            } else if ((op & 0xc0) == 0x80) {
+                int dg = (op & 0x3f) - 32;
+                uint8_t next = data[pos++];
+                px[0] += dg + ((next >> 4) & 0x0f) - 8;
+                px[1] += dg;
+                px[2] += dg + (next & 0x0f) - 8;
+            } else {
+                run = op & 0x3f;
+            }
+            memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+        }
+        rgba.insert(rgba.end(), px, px + 4);
+    }
+    return pos == end && memcmp(&data[end], "\0\0\0\0\0\0\0\1", 8) == 0;
+}
+
+void TestSnapshotQOIRoundTrip(test::TestContext& ctx) {
+    // Flat runs, gradients (DIFF/LUMA), noise (RGB), alpha changes (RGBA) and repeats (INDEX)
+    const int width = 97, height = 61;
+    std::vector<uint8_t> image((size_t)width * height * 4);
+    uint32_t noise = 12345;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* px = &image[((size_t)y * width + x) * 4];
+            noise = noise * 1664525u + 1013904223u;
+            if (y < 15) {
+                px[0] = 20; px[1] = 40; px[2] = 60; px[3] = 255;
+            } else if (y < 30) {
+                px[0] = (uint8_t)(x * 2); px[1] = (uint8_t)(x * 2 + y); px[2] = (uint8_t)(x * 3); px[3] = 255;
+            } else if (y < 45) {
+                px[0] = (uint8_t)(noise >> 24); px[1] = (uint8_t)(noise >> 16); px[2] = (uint8_t)(noise >> 8);
+                px[3] = (uint8_t)(x % 3 == 0 ? noise : 255);
+            } else {
+                px[0] = (uint8_t)((x % 4) * 60); px[1] = 0; px[2] = 255; px[3] = 255;
+            }
+        }
+    }
+    std::vector<uint8_t> qoi = encodeQOI(image.data(), width, height);
+    int decodedWidth = 0, decodedHeight = 0;
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(decodeQOI(qoi, decodedWidth, decodedHeight, decoded));
+    ASSERT_EQ(width, decodedWidth);
+    ASSERT_EQ(height, decodedHeight);
+    ASSERT_TRUE(decoded == image);
+    ASSERT_TRUE(qoi.size() < image.size());
+
+    // A run reaching the last pixel is flushed
+    std::vector<uint8_t> flat(200 * 4, 0);
+    for (size_t i = 3; i < flat.size(); i += 4) flat[i] = 255;
+    qoi = encodeQOI(flat.data(), 200, 1);
+    ASSERT_TRUE(decodeQOI(qoi, decodedWidth, decodedHeight, decoded));
+    ASSERT_TRUE(decoded == flat);
+}
+
+void TestSnapshotDownscale(test::TestContext& ctx) {
+    int outWidth = 0, outHeight = 0;
+    fitSnapshotSize(1920, 1080, 320, 180, outWidth, outHeight);
+    ASSERT_EQ(320, outWidth);
+    ASSERT_EQ(180, outHeight);
+    fitSnapshotSize(1080, 1920, 320, 180, outWidth, outHeight);
+    ASSERT_EQ(101, outWidth);
+    ASSERT_EQ(180, outHeight);
+    fitSnapshotSize(200, 100, 320, 180, outWidth, outHeight); // Never upscaled
+    ASSERT_EQ(200, outWidth);
+    ASSERT_EQ(100, outHeight);
+
+    // 4x2 bottom-up frame: the bottom row is dark, the top row bright
+    const uint8_t frame[] = {
+        0, 0, 0, 0,        10, 10, 10, 0,     100, 0, 0, 0,     100, 0, 0, 0,
+        200, 200, 200, 0,  210, 210, 210, 0,  0, 0, 100, 0,     0, 0, 101, 0,
+    };
+    std::vector<uint8_t> out;
+    downscaleSnapshot(frame, 4, 2, 2, 2, out);
+    ASSERT_EQ((size_t)16, out.size());
+    // Top-down output: the first row is the frame's top row
+    ASSERT_EQ(205, (int)out[0]);
+    ASSERT_EQ(205, (int)out[2]);
+    ASSERT_EQ(0, (int)out[4]);
+    ASSERT_EQ(101, (int)out[6]);  // (100 + 101) / 2 rounded
+    ASSERT_EQ(5, (int)out[8]);
+    ASSERT_EQ(100, (int)out[12]);
+    for (int i = 3; i < 16; i += 4) ASSERT_EQ(255, (int)out[i]);
+
+    downscaleSnapshot(frame, 4, 2, 1, 1, out);
+    ASSERT_EQ((0 + 10 + 100 + 100 + 200 + 210 + 0 + 0 + 4) / 8, (int)out[0]);
+}
+
+static bool readSnapshotFile(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    data.clear();
+    uint8_t buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + got);
+    fclose(file);
+    return true;
+}
+
+// A frame handed to the service shows up as a decodable thumbnail on disk and
+// in memory; frames queued while the worker is busy collapse to the newest
+void TestSnapshotServicePublishes(test::TestContext& ctx) {
+    const std::string dir = "test_snapshots";
+    const std::string path = dir + "/monitor_1.qoi";
+    std::remove(path.c_str());
+    rmdir(dir.c_str());
+
+    SnapshotConfig config;
+    config.directory = dir;
+    config.maxWidth = 64;
+    config.maxHeight = 36;
+    ASSERT_TRUE(startSnapshotService(config));
+    ASSERT_TRUE(isSnapshotServiceRunning());
+
+    const int width = 640, height = 360;
+    for (int shade = 1; shade <= 3; shade++) {
+        std::vector<uint8_t> frame((size_t)width * height * 4, (uint8_t)(shade * 50));
+        submitSnapshotFrame(1, width, height, std::move(frame));
+    }
+    SnapshotImage image;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        SnapshotStats stats = getSnapshotStats();
+        if (stats.published + stats.superseded == 3) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stopSnapshotService();
+    ASSERT_FALSE(isSnapshotServiceRunning());
+    ASSERT_FALSE(getLatestSnapshot(0, image));
+    ASSERT_TRUE(getLatestSnapshot(1, image));
+    ASSERT_EQ(64, image.width);
+    ASSERT_EQ(36, image.height);
+    SnapshotStats stats = getSnapshotStats();
+    ASSERT_EQ((uint64_t)3, stats.published + stats.superseded);
+    ASSERT_EQ(stats.published, image.sequence);
+
+    // The file is the last frame published, whole
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(readSnapshotFile(path, data));
+    ASSERT_TRUE(data == image.qoi);
+    int decodedWidth = 0, decodedHeight = 0;
+    std::vector<uint8_t> decoded;
+    ASSERT_TRUE(decodeQOI(data, decodedWidth, decodedHeight, decoded));
+    ASSERT_EQ(64, decodedWidth);
+    ASSERT_EQ(36, decodedHeight);
+    ASSERT_EQ(150, (int)decoded[0]);
+    ASSERT_EQ(255, (int)decoded[3]);
+
+    std::remove(path.c_str());
+    rmdir(dir.c_str());
+}
+
+// The render thread pays for one copy out of the mapped buffer; downscaling
+// and encoding run on the worker
+void BenchmarkSnapshot(test::BenchContext& b) {
+    b.RunOnce();
+    const int width = 1920, height = 1080;
+    std::vector<uint8_t> frame((size_t)width * height * 4);
+    for (size_t i = 0; i < frame.size(); i++) frame[i] = (uint8_t)((i / 4) % 1920 * 255 / 1920 + (i % 4) * 17);
+
+    const int runs = 10;
+    double copyMs = 0.0, downscaleMs = 0.0, encodeMs = 0.0;
+    size_t encodedBytes = 0;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> copy(frame.begin(), frame.end());
+        copyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        int outWidth, outHeight;
+        std::vector<uint8_t> thumbnail;
+        start = std::chrono::steady_clock::now();
+        fitSnapshotSize(width, height, 320, 180, outWidth, outHeight);
+        downscaleSnapshot(copy.data(), width, height, outWidth, outHeight, thumbnail);
+        downscaleMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        encodedBytes = encodeQOI(thumbnail.data(), outWidth, outHeight).size();
+        encodeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    b.ReportMetric(copyMs / runs, "ms/render-copy-1080p");
+    b.ReportMetric(downscaleMs / runs, "ms/worker-downscale");
+    b.ReportMetric(encodeMs / runs, "ms/worker-encode");
+    b.ReportMetric((double)encodedBytes / 1024.0, "KiB/thumbnail");
+}
@@ -0,0 +1,259 @@
+#ifndef STAND_IN_SERVER_H
+#define STAND_IN_SERVER_H
+
+// Loopback socket helpers for stand-in STT servers used by network tests
+// Servers bind 127.0.0.1 on an ephemeral port and run on a test-owned thread
+
+#include "../display/network.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+namespace standin {
+
+// Listen on 127.0.0.1:port; port 0 picks an ephemeral port (returned in port)
+// Passing a previous port back in brings a "crashed" server up again
+inline NetSocket listenLoopback(int& port) {
+    NetSocket sock = (NetSocket)socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == INVALID_NET_SOCKET) return INVALID_NET_SOCKET;
+
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(sock, 1024) != 0) {
+        closeNetSocket(sock);
+        return INVALID_NET_SOCKET;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (struct sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return sock;
+}
+
+// Accept one client, giving up after timeoutMs
+inline NetSocket acceptClient(NetSocket listener, int timeoutMs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(listener, &readSet);
+    struct timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    if (select((int)listener + 1, &readSet, nullptr, nullptr, &tv) <= 0) {
+        return INVALID_NET_SOCKET;
+    }
+    return (NetSocket)accept(listener, nullptr, nullptr);
+}
+
+// Read until delimiter; bytes past the delimiter are returned in extra
+inline bool readUntil(NetSocket sock, const std::string& delimiter, std::string& head, std::string& extra) {
+    std::string data = extra;
+    char chunk[4096];
+    size_t pos;
+    while ((pos = data.find(delimiter)) == std::string::npos) {
+        int received = recvSome(sock, chunk, sizeof(chunk));
+        if (received <= 0) return false;
+        data.append(chunk, received);
+    }
+    head = data.substr(0, pos);
+    extra = data.substr(pos + delimiter.size());
+    return true;
+}
+
+// Read exactly length bytes (starting with any buffered extra bytes)
+inline bool readExactly(NetSocket sock, size_t length, std::string& out, std::string& extra) {
+    out = extra.substr(0, length);
+    extra.erase(0, out.size());
+    char chunk[4096];
+    while (out.size() < length) {
+        int received = recvSome(sock, chunk, (int)std::min(sizeof(chunk), length - out.size()));
+        if (received <= 0) return false;
+        out.append(chunk, received);
+    }
+    return true;
+}
+
+// Read one HTTP request (headers + Content-Length body)
+inline bool readHTTPRequest(NetSocket sock, std::string& head, std::string& body) {
+    std::string extra;
+    if (!readUntil(sock, "\r\n\r\n", head, extra)) return false;
+    size_t length = 0;
+    std::string lower = head;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    size_t pos = lower.find("content-length:");
+    if (pos != std::string::npos) {
+        length = (size_t)strtoul(head.c_str() + pos + 15, nullptr, 10);
+    }
+    return readExactly(sock, length, body, extra);
+}
+
+// Send a minimal HTTP response and close the connection
+inline void sendHTTPResponse(NetSocket sock, int status, const std::string& body) {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Error") + "\r\n" +
+                           "Content-Type: application/json\r\n" +
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+                           "Connection: close\r\n\r\n" + body;
+    sendAll(sock, response.data(), response.size());
+}
+
+// First PCM sample of the WAV inside a Whisper upload (tests use it as an utterance id)
+inline int wavFirstSample(const std::string& body) {
+    size_t riff = body.find("RIFF");
+    if (riff == std::string::npos || riff + 46 > body.size()) return -1;
+    short sample;
+    memcpy(&sample, body.data() + riff + 44, sizeof(sample));
+    return sample;
+}
+
+// PCM samples of the WAV inside a Whisper upload (data chunk up to the next multipart boundary)
+inline std::vector<short> wavSamples(const std::string& body) {
+    size_t riff = body.find("RIFF");
+    if (riff == std::string::npos || riff + 44 > body.size()) return std::vector<short>();
+    int32_t dataBytes;
+    memcpy(&dataBytes, body.data() + riff + 40, sizeof(dataBytes));
+    size_t available = std::min((size_t)std::max(dataBytes, 0), body.size() - riff - 44);
+    std::vector<short> samples(available / sizeof(short));
+    if (!samples.empty()) memcpy(samples.data(), body.data() + riff + 44, samples.size() * sizeof(short));
+    return samples;
+}
+
+// Value of a plain multipart form field ("" when absent)
+inline std::string formField(const std::string& body, const std::string& name) {
+    size_t pos = body.find("name=\"" + name + "\"\r\n\r\n");
+    if (pos == std::string::npos) return "";
+    size_t start = pos + name.size() + 11;
+    size_t end = body.find("\r\n", start);
+    return end == std::string::npos ? "" : body.substr(start, end - start);
+}
+
+// Stand-in Whisper HTTP server that can go down and come back on the same port
+// Each connection is served on its own thread so a delayed reply does not
+// hold up the next request
+struct HTTPServer {
+    NetSocket listener = INVALID_NET_SOCKET;
+    int port = 0;
+    int failFirst = 0;                       // Answer failStatus to this many requests before accepting
+    int failStatus = 503;
+    std::function<int(int)> delayMs;         // Reply delay for the n-th request (0-based), optional
+    std::string replyBody = "{\"text\":\"ok\"}";
+    bool keepBodies = false;                 // Record accepted request bodies (see bodies())
+    std::atomic<bool> running{false};
+    std::thread thread;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    int requests = 0;
+    size_t lastBodyBytes = 0;
+    std::vector<int> receivedIds;
+    std::vector<std::string> receivedBodies;
+
+    std::vector<int> ids() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return receivedIds;
+    }
+
+    std::vector<std::string> bodies() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return receivedBodies;
+    }
+
+    int requestCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests;
+    }
+
+    size_t bodyBytes() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastBodyBytes;
+    }
+};
+
+inline void serveHTTPClient(HTTPServer* server, NetSocket client) {
+    std::string head, body;
+    if (standin::readHTTPRequest(client, head, body)) {
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(server->mutex);
+            index = server->requests++;
+            server->lastBodyBytes = body.size();
+        }
+        int delay = server->delayMs ? server->delayMs(index) : 0;
+        if (delay > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        }
+        if (index < server->failFirst) {
+            sendHTTPResponse(client, server->failStatus, "{\"error\":\"busy\"}");
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(server->mutex);
+                server->receivedIds.push_back(wavFirstSample(body));
+                if (server->keepBodies) server->receivedBodies.push_back(body);
+            }
+            sendHTTPResponse(client, 200, server->replyBody);
+        }
+    }
+    closeNetSocket(client);
+}
+
+inline void runHTTPServer(HTTPServer* server) {
+    while (server->running) {
+        NetSocket client = acceptClient(server->listener, 20);
+        if (client == INVALID_NET_SOCKET) continue;
+        server->workers.emplace_back(serveHTTPClient, server, client);
+    }
+    for (std::thread& worker : server->workers) {
+        worker.join();
+    }
+    server->workers.clear();
+}
+
+// Start serving on port (0 = ephemeral, returned in server.port)
+inline bool startHTTPServer(HTTPServer& server, int port) {
+    server.port = port;
+    server.listener = listenLoopback(server.port);
+    if (server.listener == INVALID_NET_SOCKET) return false;
+    server.running = true;
+    server.thread = std::thread(runHTTPServer, &server);
+    return true;
+}
+
+inline void stopHTTPServer(HTTPServer& server) {
+    server.running = false;
+    if (server.thread.joinable()) server.thread.join();
+    closeNetSocket(server.listener);
+    server.listener = INVALID_NET_SOCKET;
+}
+
+// A loopback port with nothing listening on it (a "down" server)
+inline int unusedPort() {
+    int port = 0;
+    NetSocket probe = listenLoopback(port);
+    closeNetSocket(probe);
+    return port;
+}
+
+} // namespace standin
+
+#endif // STAND_IN_SERVER_H
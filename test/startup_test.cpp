@@ -0,0 +1,171 @@
+#include "test.h"
+#include "../display/startup.h"
+#include "../display/jobs.h"
+#include "../display/network.h"
+#include "../display/scene.h"
+#include "../display/texture.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void TestStartupGraphOrder(test::TestContext& ctx) {
+    bool ownJobs = !isJobSystemRunning();
+    if (ownJobs) startJobSystem(2);
+
+    StartupGraph graph;
+    std::atomic<int> sequence(0);
+    int order[6] = {-1, -1, -1, -1, -1, -1};
+    std::thread::id mainThread = std::this_thread::get_id();
+    std::thread::id mainTaskThread;
+    auto record = [&](int slot) { order[slot] = sequence++; };
+
+    int a = addStartupTask(graph, "a", StartupThread::WORKER, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        record(0);
+    });
+    int b = addStartupTask(graph, "b", StartupThread::WORKER, [&]() { record(1); }, {a});
+    int m = addStartupTask(graph, "m", StartupThread::MAIN, [&]() {
+        mainTaskThread = std::this_thread::get_id();
+        record(2);
+    }, {a});
+    int c = addStartupTask(graph, "c", StartupThread::WORKER, [&]() { record(3); }, {b, m});
+    int t = addStartupTask(graph, "throws", StartupThread::WORKER, []() { throw std::runtime_error("device missing"); });
+    addStartupTask(graph, "after_throw", StartupThread::WORKER, [&]() { record(4); }, {t});
+    int late = addStartupTask(graph, "late", StartupThread::WORKER, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        record(5);
+    });
+    ASSERT_EQ(6, late);
+
+    startStartupGraph(graph);
+    ASSERT_EQ(-1, addStartupTask(graph, "too_late", StartupThread::WORKER, []() {}));
+    // Waiting for the main-thread task runs it here, without waiting for the rest
+    waitForStartupTask(graph, m);
+    ASSERT_TRUE(mainTaskThread == mainThread);
+    ASSERT_TRUE(graph.tasks[m]->done);
+    ASSERT_FALSE(isStartupGraphDone(graph));
+
+    waitForStartupGraph(graph);
+    ASSERT_TRUE(isStartupGraphDone(graph));
+    ASSERT_TRUE(runStartupMainTasks(graph));
+    for (int slot = 0; slot < 6; slot++) {
+        if (order[slot] < 0) ctx.Fail("Task in slot " + std::to_string(slot) + " never ran");
+    }
+    ASSERT_TRUE(order[1] > order[0]);
+    ASSERT_TRUE(order[2] > order[0]);
+    ASSERT_TRUE(order[3] > order[1] && order[3] > order[2]);
+    ASSERT_TRUE(graph.tasks[c]->startMs >= graph.tasks[m]->endMs);
+
+    std::string report = formatStartupReport(graph);
+    for (const char* name : {"a", "b", "m", "c", "throws", "after_throw", "late"}) {
+        if (report.find(std::string("  ") + name + " ") == std::string::npos) {
+            ctx.Fail(std::string("Report is missing task ") + name);
+        }
+    }
+
+    markStartupMilestone("test_milestone");
+    double first = getStartupMilestone("test_milestone");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    markStartupMilestone("test_milestone");
+    ASSERT_TRUE(first >= 0.0);
+    ASSERT_NEAR(first, getStartupMilestone("test_milestone"), 1e-9);
+    ASSERT_NEAR(-1.0, getStartupMilestone("never_reached"), 1e-9);
+
+    if (ownJobs) stopJobSystem();
+}
+
+// Stand-ins for the steps that need a display or a capture device
+static const int WINDOW_CREATE_MS = 150; // glfwInit + fullscreen windows on two monitors
+static const int DEVICE_OPEN_MS = 250;   // waveInOpen
+
+static void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Time to first frame (logos uploaded) and to interactive (every step done,
+// opening scene parsed too), with the steps in the old fixed order and as
+// the startup graph runs them. Logo decode, scene parse and network init are
+// the real code paths; in the old order both milestones were the same frame.
+void BenchmarkStartup(test::BenchContext& b) {
+    b.RunOnce();
+    bool ownJobs = !isJobSystemRunning();
+    if (ownJobs) startJobSystem(4);
+
+    // The log directory used to be created through the shell
+    const char* dir = "bench_startup_logs";
+    auto start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    std::system("if not exist bench_startup_logs mkdir bench_startup_logs");
+#else
+    std::system("mkdir -p bench_startup_logs 2>/dev/null");
+#endif
+    double shellMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rmdir(dir);
+    start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    _mkdir(dir);
+#else
+    mkdir(dir, 0755);
+#endif
+    double mkdirMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rmdir(dir);
+
+    const char* logoPaths[] = {"assets/logo_light.png", "assets/logo_dark.png"};
+    auto decodeLogo = [](const char* path) {
+        DecodedImage image;
+        decodeImage(path, image);
+    };
+    auto parseScene = []() {
+        Scene scene;
+        loadScene("scenes/opening.scene.json", scene);
+    };
+
+    // Sequential, as main() used to run: windows and logos, then network and
+    // the capture device, and only then the first frame (the opening scene
+    // was parsed later, on the click that entered it)
+    start = std::chrono::steady_clock::now();
+    sleepMs(WINDOW_CREATE_MS);
+    for (const char* path : logoPaths) decodeLogo(path);
+    initNetwork();
+    sleepMs(DEVICE_OPEN_MS);
+    double sequentialFirstFrame = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    cleanupNetwork(); // So the graph run pays for network init too
+
+    // Graph: the same steps, overlapped as startApplication does
+    StartupGraph graph;
+    std::vector<int> logoReady;
+    for (const char* path : logoPaths) {
+        logoReady.push_back(addStartupTask(graph, "decode", StartupThread::WORKER, [=]() { decodeLogo(path); }));
+    }
+    logoReady.push_back(addStartupTask(graph, "create_windows", StartupThread::MAIN, []() { sleepMs(WINDOW_CREATE_MS); }));
+    int logos = addStartupTask(graph, "upload_logos", StartupThread::MAIN, []() {}, logoReady);
+    addStartupTask(graph, "scene_prefetch", StartupThread::WORKER, parseScene);
+    int network = addStartupTask(graph, "network", StartupThread::WORKER, []() { initNetwork(); });
+    addStartupTask(graph, "audio_capture", StartupThread::WORKER, []() { sleepMs(DEVICE_OPEN_MS); }, {network});
+    start = std::chrono::steady_clock::now();
+    startStartupGraph(graph);
+    waitForStartupTask(graph, logos);
+    double graphFirstFrame = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    waitForStartupGraph(graph);
+    double graphInteractive = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    b.ReportMetric(shellMs, "ms/mkdir-shell");
+    b.ReportMetric(mkdirMs, "ms/mkdir");
+    b.ReportMetric(sequentialFirstFrame, "ms/first-frame-sequential");
+    b.ReportMetric(graphFirstFrame, "ms/first-frame-graph");
+    b.ReportMetric(graphInteractive, "ms/interactive-graph");
+    if (ownJobs) stopJobSystem();
+}
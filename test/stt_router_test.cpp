@@ -0,0 +1,239 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/network.h"
+#include "../display/stt_router.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static std::vector<short> utterance(int id) {
+    return std::vector<short>(800, (short)id);
+}
+
+static double routeTimedMs(int id, bool& ok) {
+    auto start = std::chrono::steady_clock::now();
+    ok = routeAudioToWhisper(utterance(id), 16000);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TestSTTRouterParseEndpoints(test::TestContext& ctx) {
+    std::vector<STTEndpoint> parsed = parseSTTEndpoints("127.0.0.1:8070, whisper-b:9000 ,bad, :1, host:0");
+    ASSERT_EQ((size_t)2, parsed.size());
+    ASSERT_STR_EQ("127.0.0.1", parsed[0].host);
+    ASSERT_EQ(8070, parsed[0].port);
+    ASSERT_STR_EQ("whisper-b", parsed[1].host);
+    ASSERT_EQ(9000, parsed[1].port);
+    ASSERT_EQ((size_t)0, parseSTTEndpoints("").size());
+    ASSERT_FALSE(initSTTRouter(parseSTTEndpoints("")));
+    ASSERT_FALSE(isSTTRouterActive());
+}
+
+// Three servers with different injected delays: P2C on EWMA favours the fastest
+void TestSTTRouterPrefersFastEndpoint(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    standin::HTTPServer fast, medium, slow;
+    fast.delayMs = [](int) { return 2; };
+    medium.delayMs = [](int) { return 25; };
+    slow.delayMs = [](int) { return 80; };
+    ASSERT_TRUE(standin::startHTTPServer(fast, 0));
+    ASSERT_TRUE(standin::startHTTPServer(medium, 0));
+    ASSERT_TRUE(standin::startHTTPServer(slow, 0));
+
+    STTRouterConfig config;
+    config.hedging = false;
+    config.seed = 1; // Same endpoint pairs every run, so the counts below do not depend on luck
+    std::vector<STTEndpoint> endpoints = {{"127.0.0.1", fast.port}, {"127.0.0.1", medium.port}, {"127.0.0.1", slow.port}};
+    ASSERT_TRUE(initSTTRouter(endpoints, config));
+
+    int failures = 0;
+    for (int i = 0; i < 40; i++) {
+        if (!routeAudioToWhisper(utterance(i), 16000)) failures++;
+    }
+    STTRouterStats stats = getSTTRouterStats();
+    shutdownSTTRouter();
+    standin::stopHTTPServer(fast);
+    standin::stopHTTPServer(medium);
+    standin::stopHTTPServer(slow);
+
+    ASSERT_EQ(0, failures);
+    ASSERT_EQ((uint64_t)40, stats.succeeded);
+    ASSERT_EQ((uint64_t)0, stats.hedged);
+    ASSERT_EQ(40, fast.requestCount() + medium.requestCount() + slow.requestCount());
+    ASSERT_TRUE(fast.requestCount() > medium.requestCount());
+    ASSERT_TRUE(medium.requestCount() > slow.requestCount());
+    ASSERT_TRUE(stats.endpoints[0].ewmaMs < stats.endpoints[1].ewmaMs);
+    ASSERT_TRUE(stats.endpoints[1].ewmaMs < stats.endpoints[2].ewmaMs);
+}
+
+// One server starts stalling after warm-up: hedged duplicates after p95 cap the tail
+void TestSTTRouterHedgesTailLatency(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    std::atomic<bool> stall{false};
+    standin::HTTPServer a, b;
+    a.delayMs = [&stall](int) { return stall ? 1000 : 1; }; // a is the preferred endpoint until it stalls
+    b.delayMs = [](int) { return 20; };
+    ASSERT_TRUE(standin::startHTTPServer(a, 0));
+    ASSERT_TRUE(standin::startHTTPServer(b, 0));
+
+    // No hedging during warm-up: a hedged attempt counts against a's estimate
+    // and could leave b preferred before a starts stalling
+    STTRouterConfig config;
+    config.minHedgeMs = 30;
+    config.hedgeWarmupSamples = 20;
+    config.seed = 1;
+    ASSERT_TRUE(initSTTRouter({{"127.0.0.1", a.port}, {"127.0.0.1", b.port}}, config));
+
+    bool ok = true;
+    for (int i = 0; i < 20 && ok; i++) {
+        routeTimedMs(i, ok);
+    }
+    double warmP95 = getSTTRouterStats().p95Ms;
+
+    stall = true;
+    int failures = 0;
+    double worstMs = 0.0;
+    for (int i = 0; i < 10; i++) {
+        bool routed = false;
+        worstMs = std::max(worstMs, routeTimedMs(100 + i, routed));
+        if (!routed) failures++;
+    }
+    STTRouterStats stats = getSTTRouterStats();
+    shutdownSTTRouter();
+    standin::stopHTTPServer(a);
+    standin::stopHTTPServer(b);
+
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(warmP95 >= 0.0 && warmP95 < 30.0);
+    ASSERT_EQ(0, failures);
+    ASSERT_TRUE(stats.hedged >= 1);
+    ASSERT_TRUE(stats.hedgeWins >= 1);
+    ASSERT_TRUE(worstMs < 500.0); // Without hedging a request routed to a would take 1s
+    ASSERT_TRUE(stats.endpoints[0].ewmaMs > 5.0); // The cancelled attempt still counts as at least the hedge delay
+}
+
+// A dead endpoint fails over immediately and is ejected after consecutive failures
+void TestSTTRouterEjectsDeadEndpoint(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    standin::HTTPServer live;
+    ASSERT_TRUE(standin::startHTTPServer(live, 0));
+    int deadPort = standin::unusedPort();
+
+    STTRouterConfig config;
+    config.failureThreshold = 2;
+    config.ejectMs = 10000;
+    ASSERT_TRUE(initSTTRouter({{"127.0.0.1", deadPort}, {"127.0.0.1", live.port}}, config));
+
+    int failures = 0;
+    for (int i = 0; i < 20; i++) {
+        if (!routeAudioToWhisper(utterance(i), 16000)) failures++;
+    }
+    STTRouterStats stats = getSTTRouterStats();
+    shutdownSTTRouter();
+    standin::stopHTTPServer(live);
+
+    ASSERT_EQ(0, failures);
+    ASSERT_EQ(20, live.requestCount());
+    ASSERT_FALSE(stats.endpoints[0].healthy);
+    ASSERT_TRUE(stats.endpoints[1].healthy);
+    ASSERT_EQ((uint64_t)2, stats.endpoints[0].failures); // Ejected, so no further attempts
+    ASSERT_EQ((uint64_t)20, stats.endpoints[1].wins);
+}
+
+// After the cooldown exactly one request probes an ejected endpoint while the
+// rest go elsewhere; a failed probe ejects it again, a successful one restores it
+void TestSTTRouterHalfOpenProbe(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    standin::HTTPServer flaky, live;
+    flaky.failFirst = 3;                                   // Two ejecting failures, then a failed probe
+    flaky.delayMs = [](int n) { return n >= 2 ? 100 : 0; }; // Probes stay in flight while the others route
+    ASSERT_TRUE(standin::startHTTPServer(flaky, 0));
+    ASSERT_TRUE(standin::startHTTPServer(live, 0));
+
+    STTRouterConfig config;
+    config.hedging = false;
+    config.failureThreshold = 2;
+    config.ejectMs = 50;
+    ASSERT_TRUE(initSTTRouter({{"127.0.0.1", flaky.port}, {"127.0.0.1", live.port}}, config));
+
+    // Until live has a latency estimate the two tie and the first pick is random.
+    // After that flaky, which only ever failed and so has no estimate, is always
+    // preferred while it is available
+    int failures = 0;
+    bool ejected = false;
+    for (int i = 0; i < 10 && !ejected; i++) {
+        if (!routeAudioToWhisper(utterance(i), 16000)) failures++;
+        ejected = !getSTTRouterStats().endpoints[0].healthy;
+    }
+    int ejectedAfter = flaky.requestCount();
+    int liveBefore = live.requestCount();
+
+    auto burst = [&](int first) {
+        std::vector<std::thread> threads;
+        std::atomic<int> failed{0};
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&failed, first, i] {
+                if (!routeAudioToWhisper(utterance(first + i), 16000)) failed++;
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        return failed.load();
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(70));
+    failures += burst(10);
+    int afterFailedProbe = flaky.requestCount();
+    bool reEjected = !getSTTRouterStats().endpoints[0].healthy;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(120)); // The cooldown doubled to 100ms
+    failures += burst(20);
+    STTRouterStats stats = getSTTRouterStats();
+    shutdownSTTRouter();
+    standin::stopHTTPServer(flaky);
+    standin::stopHTTPServer(live);
+
+    ASSERT_EQ(0, failures);
+    ASSERT_TRUE(ejected);
+    ASSERT_EQ(2, ejectedAfter);
+    ASSERT_EQ(3, afterFailedProbe);
+    ASSERT_TRUE(reEjected);
+    ASSERT_EQ(4, flaky.requestCount());
+    ASSERT_TRUE(stats.endpoints[0].healthy);
+    ASSERT_EQ((uint64_t)1, stats.endpoints[0].wins);
+    ASSERT_EQ(4 + 3, live.requestCount() - liveBefore); // The failed probe's failover included
+}
+
+// Tail latency with and without hedging against servers that stall ~3% of the time
+// (below the 5% a p95 hedge threshold can absorb); the first 20 requests warm up the estimates
+void BenchmarkSTTRouterTailLatency(test::BenchContext& bench) {
+    bench.RunOnce();
+    initNetwork();
+    auto stalls = [](int n) { return (n * 7 + 3) % 33 == 0 ? 250 : 5; };
+    for (int mode = 0; mode < 2; mode++) {
+        standin::HTTPServer a, b;
+        a.delayMs = stalls;
+        b.delayMs = [&](int n) { return stalls(n + 11); };
+        standin::startHTTPServer(a, 0);
+        standin::startHTTPServer(b, 0);
+
+        STTRouterConfig config;
+        config.hedging = (mode == 1);
+        config.minHedgeMs = 20;
+        initSTTRouter({{"127.0.0.1", a.port}, {"127.0.0.1", b.port}}, config);
+
+        std::vector<double> latencies;
+        for (int i = 0; i < 220; i++) {
+            bool ok = false;
+            double ms = routeTimedMs(i, ok);
+            if (i >= 20) latencies.push_back(ms);
+        }
+        shutdownSTTRouter();
+        standin::stopHTTPServer(a);
+        standin::stopHTTPServer(b);
+
+        std::sort(latencies.begin(), latencies.end());
+        std::string suffix = config.hedging ? "-hedged" : "-single";
+        bench.ReportMetric(latencies[50], "ms/p50" + suffix);
+        bench.ReportMetric(latencies[99 * latencies.size() / 100 - 1], "ms/p99" + suffix);
+    }
+}
@@ -0,0 +1,242 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/network.h"
+#include "../display/stt_session.h"
+#include "../display/stt_spool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+// Capture-clock ramp: the sample at position n has a value derived from n,
+// so any chunk can be checked against the offset it claims
+static short rampSample(uint64_t position) {
+    return (short)(position % 30011);
+}
+
+// Feed `total` samples in irregular block sizes, calling onBlock after each
+template <typename Callback>
+static void captureRamp(uint64_t total, Callback onBlock) {
+    const size_t blockSizes[] = {441, 1024, 37, 2205, 160, 4410, 1};
+    std::vector<short> block;
+    uint64_t position = 0;
+    for (int i = 0; position < total; i++) {
+        size_t size = (size_t)std::min<uint64_t>(blockSizes[i % 7], total - position);
+        block.resize(size);
+        for (size_t j = 0; j < size; j++) block[j] = rampSample(position + j);
+        appendSTTSessionAudio(block.data(), block.size());
+        position += size;
+        onBlock(i);
+    }
+}
+
+static bool matchesRamp(const std::vector<short>& samples, uint64_t offset) {
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (samples[i] != rampSample(offset + i)) return false;
+    }
+    return true;
+}
+
+// Chunks are driven by audio time: each holds chunkMs of new audio plus the context tail
+void TestSTTSessionChunking(test::TestContext& ctx) {
+    STTSessionConfig config;
+    config.chunkMs = 100;
+    config.contextMs = 20;
+    config.maxBufferedMs = 500;
+    configureSTTSessions(config);
+    beginSTTSession(16000); // chunk 1600, context 320, buffer 8000
+    uint64_t firstSession = getSTTSessionStats().sessionId;
+
+    std::vector<STTUploadChunk> chunks;
+    STTUploadChunk chunk;
+    bool early = takeSTTSessionChunk(chunk);
+    captureRamp(10000, [&](int block) {
+        if (block % 3 == 0) { // The "render thread" runs at its own pace
+            while (takeSTTSessionChunk(chunk)) chunks.push_back(chunk);
+        }
+    });
+    while (takeSTTSessionChunk(chunk)) chunks.push_back(chunk);
+    bool tail = takeSTTSessionChunk(chunk, true);
+    bool empty = takeSTTSessionChunk(chunk, true);
+    STTSessionStats stats = getSTTSessionStats();
+
+    ASSERT_FALSE(early);
+    ASSERT_TRUE(firstSession != 0);
+    ASSERT_EQ((size_t)6, chunks.size()); // 10000 / 1600
+    uint64_t sentUpTo = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const STTUploadChunk& c = chunks[i];
+        ASSERT_EQ(firstSession, c.info.sessionId);
+        ASSERT_EQ(16000, c.sampleRate);
+        ASSERT_EQ((uint32_t)(i == 0 ? 0 : 320), c.info.contextSamples);
+        ASSERT_EQ(sentUpTo, c.info.sampleOffset + c.info.contextSamples);
+        ASSERT_EQ((size_t)1600 + c.info.contextSamples, c.samples.size());
+        ASSERT_TRUE(matchesRamp(c.samples, c.info.sampleOffset));
+        sentUpTo = c.info.sampleOffset + c.samples.size();
+    }
+    ASSERT_TRUE(tail);
+    ASSERT_EQ((size_t)320 + 400, chunk.samples.size()); // Flush: the last 400 samples
+    ASSERT_FALSE(empty);
+    ASSERT_EQ((uint64_t)10000, stats.capturedSamples);
+    ASSERT_EQ((uint64_t)10000, stats.sentSamples);
+
+    // Streamed audio is skipped; nobody taking chunks drops the oldest unsent audio
+    captureRamp(5000, [](int) {}); // Clock 10000..15000
+    skipSTTSessionAudio();
+    STTSessionStats skipped = getSTTSessionStats();
+    captureRamp(10000, [](int) {}); // 15000..25000 (ramp restarts at 0: only offsets matter below)
+    ASSERT_TRUE(takeSTTSessionChunk(chunk));
+    STTSessionStats dropped = getSTTSessionStats();
+
+    ASSERT_EQ((uint64_t)5000, skipped.skippedSamples);
+    ASSERT_EQ((uint64_t)2000, dropped.droppedSamples); // 10000 unsent, 8000 kept
+    ASSERT_EQ((uint32_t)0, chunk.info.contextSamples); // No context across a gap
+    ASSERT_EQ((uint64_t)17000, chunk.info.sampleOffset);
+
+    // A new capture run is a new session with its own clock
+    endSTTSession();
+    ASSERT_FALSE(takeSTTSessionChunk(chunk, true));
+    beginSTTSession(16000);
+    captureRamp(1600, [](int) {});
+    ASSERT_TRUE(takeSTTSessionChunk(chunk));
+    endSTTSession();
+    configureSTTSessions(STTSessionConfig());
+    ASSERT_TRUE(chunk.info.sessionId != firstSession);
+    ASSERT_EQ((uint64_t)0, chunk.info.sampleOffset);
+}
+
+// Chunks uploaded through the spool cover the capture exactly once (beyond the declared context)
+void TestSTTSessionUploadCoverage(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    standin::HTTPServer server;
+    server.keepBodies = true;
+    ASSERT_TRUE(standin::startHTTPServer(server, 0));
+
+    const std::string dir = "test_spool_session";
+    STTSpoolConfig spoolConfig;
+    spoolConfig.directory = dir;
+    spoolConfig.host = "127.0.0.1";
+    spoolConfig.port = server.port;
+    ASSERT_TRUE(startSTTSpool(spoolConfig));
+
+    STTSessionConfig config;
+    config.chunkMs = 250;
+    config.contextMs = 50;
+    configureSTTSessions(config);
+    beginSTTSession(8000); // chunk 2000, context 400
+    uint64_t sessionId = getSTTSessionStats().sessionId;
+    const uint64_t total = 20000 + 1234;
+    int enqueued = 0;
+    STTUploadChunk chunk;
+    captureRamp(total, [&](int block) {
+        if (block % 5 == 2) {
+            while (takeSTTSessionChunk(chunk)) {
+                if (enqueueSTTUpload(chunk.samples, chunk.sampleRate, &chunk.info)) enqueued++;
+            }
+        }
+    });
+    while (takeSTTSessionChunk(chunk, true)) {
+        if (enqueueSTTUpload(chunk.samples, chunk.sampleRate, &chunk.info)) enqueued++;
+    }
+    endSTTSession();
+    configureSTTSessions(STTSessionConfig());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (getSTTSpoolStats().uploadedRecords < (uint64_t)enqueued && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    std::remove((dir + "/spool.idx").c_str());
+    std::remove((dir + "/spool.idx.tmp").c_str());
+    for (int segment = 1; segment <= 8; segment++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/seg_%06d.bin", segment);
+        std::remove((dir + name).c_str());
+    }
+    rmdir(dir.c_str());
+
+    std::vector<std::string> bodies = server.bodies();
+    ASSERT_EQ((size_t)11, bodies.size()); // 10 full chunks + the flushed tail
+    ASSERT_EQ((size_t)enqueued, bodies.size());
+
+    // Server-side view: new audio of each upload, ordered by offset
+    struct Upload {
+        uint64_t newStart, end;
+        uint32_t context;
+    };
+    std::vector<Upload> uploads;
+    for (const std::string& body : bodies) {
+        ASSERT_STR_EQ(std::to_string(sessionId), standin::formField(body, "session_id"));
+        uint64_t offset = strtoull(standin::formField(body, "sample_offset").c_str(), nullptr, 10);
+        uint32_t context = (uint32_t)strtoul(standin::formField(body, "context_samples").c_str(), nullptr, 10);
+        std::vector<short> samples = standin::wavSamples(body);
+        ASSERT_TRUE(matchesRamp(samples, offset)); // Offsets are capture-clock positions
+        uploads.push_back(Upload{offset + context, offset + samples.size(), context});
+    }
+    std::sort(uploads.begin(), uploads.end(), [](const Upload& a, const Upload& b) { return a.newStart < b.newStart; });
+    uint64_t covered = 0;
+    for (size_t i = 0; i < uploads.size(); i++) {
+        ASSERT_EQ(covered, uploads[i].newStart); // No gap, no duplicate
+        ASSERT_TRUE(uploads[i].context <= 400);
+        covered = uploads[i].end;
+    }
+    ASSERT_EQ(total, covered);
+}
+
+// Append ramp samples [position, position + count) as one block tagged at origin + position
+static void captureTagged(uint64_t origin, uint64_t position, size_t count) {
+    std::vector<short> block(count);
+    for (size_t i = 0; i < count; i++) block[i] = rampSample(position + i);
+    CaptureTag tag;
+    tag.sample = origin + position;
+    appendSTTSessionAudio(block.data(), block.size(), &tag);
+}
+
+// Only what the stream delivered is skipped: audio from before it connected
+// and audio still queued when it dropped goes out as chunks
+void TestSTTSessionStreamCoverage(test::TestContext& ctx) {
+    STTSessionConfig config;
+    config.chunkMs = 100;
+    config.contextMs = 0;
+    configureSTTSessions(config);
+    beginSTTSession(16000); // chunk 1600
+    const uint64_t origin = 50000; // Capture clock (CaptureTag::sample) when the session began
+
+    STTUploadChunk chunk;
+    captureTagged(origin, 0, 1000);
+    coverSTTSessionAudio(origin + 1000, origin + 1000, true); // Stream connected at 1000
+    captureTagged(origin, 1000, 3000);
+    bool beforeStream = takeSTTSessionChunk(chunk); // Short chunk up to where the stream took over
+    STTUploadChunk first = chunk;
+    coverSTTSessionAudio(origin + 1000, origin + 2500, true);
+    bool held = takeSTTSessionChunk(chunk, true); // The stream carries the rest
+    STTSessionStats streaming = getSTTSessionStats();
+    coverSTTSessionAudio(origin + 1000, origin + 3000, false); // Dropped with 3000..4000 undelivered
+    bool afterDrop = takeSTTSessionChunk(chunk, true);
+    STTSessionStats stats = getSTTSessionStats();
+    endSTTSession();
+    configureSTTSessions(STTSessionConfig());
+
+    ASSERT_TRUE(beforeStream);
+    ASSERT_EQ((uint64_t)0, first.info.sampleOffset);
+    ASSERT_EQ((size_t)1000, first.samples.size());
+    ASSERT_FALSE(held);
+    ASSERT_EQ((uint64_t)1500, streaming.skippedSamples);
+    ASSERT_TRUE(afterDrop);
+    ASSERT_EQ((uint64_t)3000, chunk.info.sampleOffset);
+    ASSERT_EQ((size_t)1000, chunk.samples.size());
+    ASSERT_TRUE(matchesRamp(chunk.samples, chunk.info.sampleOffset));
+    ASSERT_EQ((uint64_t)2000, stats.skippedSamples);
+    ASSERT_EQ((uint64_t)4000, stats.sentSamples);
+}
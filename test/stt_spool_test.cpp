@@ -0,0 +1,234 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/network.h"
+#include "../display/stt_spool.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
+static void removeSpoolDir(const std::string& dir) {
+    std::remove((dir + "/spool.idx").c_str());
+    std::remove((dir + "/spool.idx.tmp").c_str());
+    for (int segment = 1; segment <= 64; segment++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/seg_%06d.bin", segment);
+        std::remove((dir + name).c_str());
+    }
+    rmdir(dir.c_str());
+}
+
+template <typename Pred>
+static bool waitUntil(Pred pred, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+static STTSpoolConfig testSpoolConfig(const std::string& dir, int port) {
+    STTSpoolConfig config;
+    config.directory = dir;
+    config.host = "127.0.0.1";
+    config.port = port;
+    config.initialBackoffMs = 20;
+    config.maxBackoffMs = 100;
+    return config;
+}
+
+static void enqueueUtterance(int id) {
+    enqueueSTTUpload(std::vector<short>(1000, (short)id), 16000);
+}
+
+// Server is down, then answers 503 once, then recovers: nothing is lost and order holds
+void TestSTTSpoolDrainsInOrderAfterOutage(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    const std::string dir = "test_spool_outage";
+    removeSpoolDir(dir);
+
+    int port = standin::unusedPort();
+    ASSERT_TRUE(startSTTSpool(testSpoolConfig(dir, port)));
+    for (int id = 1; id <= 5; id++) {
+        enqueueUtterance(id);
+    }
+    bool retried = waitUntil([] { return getSTTSpoolStats().failedAttempts >= 2; }, 3000);
+    STTSpoolStats down = getSTTSpoolStats();
+
+    standin::HTTPServer server;
+    server.failFirst = 1;
+    bool serverUp = standin::startHTTPServer(server, port);
+    bool drained = serverUp && waitUntil([] { return getSTTSpoolStats().uploadedRecords == 5; }, 5000);
+    STTSpoolStats up = getSTTSpoolStats();
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    removeSpoolDir(dir);
+
+    ASSERT_TRUE(retried);
+    ASSERT_EQ((uint64_t)0, down.uploadedRecords);
+    ASSERT_EQ((uint64_t)5, down.queuedRecords);
+    ASSERT_TRUE(serverUp);
+    ASSERT_TRUE(drained);
+    ASSERT_EQ((uint64_t)0, up.queuedRecords);
+    ASSERT_EQ((uint64_t)0, up.queuedBytes);
+    ASSERT_EQ((uint64_t)0, up.droppedRecords);
+    std::vector<int> ids = server.ids();
+    ASSERT_EQ((size_t)5, ids.size());
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(i + 1, ids[i]);
+    }
+}
+
+// Queued audio is on disk: a restart (with a torn tail record) recovers it in order
+void TestSTTSpoolSurvivesRestart(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    const std::string dir = "test_spool_restart";
+    removeSpoolDir(dir);
+
+    int port = standin::unusedPort();
+    const uint64_t recordBytes = 36 + 1000 * sizeof(short); // Version 2 record header + payload
+    ASSERT_TRUE(startSTTSpool(testSpoolConfig(dir, port)));
+    for (int id = 1; id <= 3; id++) {
+        enqueueUtterance(id);
+    }
+    bool onDisk = waitUntil([&] { return getSTTSpoolStats().queuedBytes == 3 * recordBytes; }, 3000);
+    stopSTTSpool();
+
+    // Simulate a crash in the middle of appending a fourth record
+    FILE* segment = fopen((dir + "/seg_000001.bin").c_str(), "ab");
+    ASSERT_NOT_NULL(segment);
+    const char torn[10] = {'S', 'T', 'T', '2', 1, 2, 3, 4, 5, 6};
+    fwrite(torn, 1, sizeof(torn), segment);
+    fclose(segment);
+
+    ASSERT_TRUE(startSTTSpool(testSpoolConfig(dir, port)));
+    STTSpoolStats recovered = getSTTSpoolStats();
+    enqueueUtterance(4);
+
+    standin::HTTPServer server;
+    bool serverUp = standin::startHTTPServer(server, port);
+    bool drained = serverUp && waitUntil([] { return getSTTSpoolStats().uploadedRecords == 4; }, 5000);
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    removeSpoolDir(dir);
+
+    ASSERT_TRUE(onDisk);
+    ASSERT_EQ((uint64_t)3, recovered.queuedRecords);
+    ASSERT_EQ(3 * recordBytes, recovered.queuedBytes);
+    ASSERT_TRUE(drained);
+    std::vector<int> ids = server.ids();
+    ASSERT_EQ((size_t)4, ids.size());
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(i + 1, ids[i]);
+    }
+}
+
+// A header whose sample count runs past the end of the segment is corrupt:
+// recovery stops there instead of allocating what the header claims
+void TestSTTSpoolRejectsOversizedRecord(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    const std::string dir = "test_spool_oversized";
+    removeSpoolDir(dir);
+
+    int port = standin::unusedPort();
+    ASSERT_TRUE(startSTTSpool(testSpoolConfig(dir, port)));
+    enqueueUtterance(1);
+    bool onDisk = waitUntil([] { return getSTTSpoolStats().queuedRecords == 1; }, 3000);
+    stopSTTSpool();
+
+    FILE* segment = fopen((dir + "/seg_000001.bin").c_str(), "ab");
+    ASSERT_NOT_NULL(segment);
+    const uint32_t header[9] = {0x32545453, 16000, 0xfffffff0u, 0, 0, 0, 0, 0, 0}; // "STT2", ~8 GB of samples
+    fwrite(header, 1, sizeof(header), segment);
+    fwrite(header, 1, 8, segment);
+    fclose(segment);
+
+    ASSERT_TRUE(startSTTSpool(testSpoolConfig(dir, port)));
+    STTSpoolStats recovered = getSTTSpoolStats();
+    stopSTTSpool();
+    removeSpoolDir(dir);
+
+    ASSERT_TRUE(onDisk);
+    ASSERT_EQ((uint64_t)1, recovered.queuedRecords);
+}
+
+// Past maxBytes the oldest segments are dropped, newest audio is kept
+void TestSTTSpoolBoundedDropsOldest(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    const std::string dir = "test_spool_bounded";
+    removeSpoolDir(dir);
+
+    int port = standin::unusedPort();
+    const uint64_t recordBytes = 36 + 1000 * sizeof(short); // Version 2 record header + payload
+    STTSpoolConfig config = testSpoolConfig(dir, port);
+    config.segmentBytes = recordBytes; // One record per segment
+    config.maxBytes = 3 * recordBytes;
+    ASSERT_TRUE(startSTTSpool(config));
+    for (int id = 1; id <= 5; id++) {
+        enqueueUtterance(id);
+    }
+    bool settled = waitUntil([] { return getSTTSpoolStats().droppedRecords == 2; }, 3000);
+    STTSpoolStats full = getSTTSpoolStats();
+
+    standin::HTTPServer server;
+    bool serverUp = standin::startHTTPServer(server, port);
+    bool drained = serverUp && waitUntil([] { return getSTTSpoolStats().uploadedRecords == 3; }, 5000);
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    removeSpoolDir(dir);
+
+    ASSERT_TRUE(settled);
+    ASSERT_EQ((uint64_t)3, full.queuedRecords);
+    ASSERT_TRUE(full.queuedBytes <= config.maxBytes);
+    ASSERT_TRUE(drained);
+    std::vector<int> ids = server.ids();
+    ASSERT_EQ((size_t)3, ids.size());
+    ASSERT_EQ(3, ids[0]);
+    ASSERT_EQ(4, ids[1]);
+    ASSERT_EQ(5, ids[2]);
+}
+
+// A record the server rejects (4xx) is dropped instead of blocking the records behind it
+void TestSTTSpoolDropsRejectedRecord(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    const std::string dir = "test_spool_rejected";
+    removeSpoolDir(dir);
+
+    standin::HTTPServer server;
+    server.failFirst = 1;
+    server.failStatus = 400;
+    int port = standin::unusedPort();
+    ASSERT_TRUE(standin::startHTTPServer(server, port));
+    bool started = startSTTSpool(testSpoolConfig(dir, port));
+    for (int id = 1; id <= 3; id++) {
+        enqueueUtterance(id);
+    }
+    bool drained = started && waitUntil([] {
+        STTSpoolStats stats = getSTTSpoolStats();
+        return stats.uploadedRecords + stats.droppedRecords == 3;
+    }, 3000);
+    STTSpoolStats stats = getSTTSpoolStats();
+    stopSTTSpool();
+    standin::stopHTTPServer(server);
+    removeSpoolDir(dir);
+
+    ASSERT_TRUE(started);
+    ASSERT_TRUE(drained);
+    ASSERT_EQ((uint64_t)2, stats.uploadedRecords);
+    ASSERT_EQ((uint64_t)1, stats.droppedRecords);
+    ASSERT_EQ((uint64_t)0, stats.failedAttempts);
+    ASSERT_EQ((uint64_t)0, stats.queuedRecords);
+    ASSERT_EQ(3, server.requestCount());
+    std::vector<int> ids = server.ids();
+    ASSERT_EQ((size_t)2, ids.size());
+    ASSERT_EQ(2, ids[0]);
+    ASSERT_EQ(3, ids[1]);
+}
@@ -0,0 +1,266 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/network.h"
+#include "../display/stt_stream.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Stand-in WebSocket STT server: completes the upgrade, counts PCM bytes and
+// answers with a partial and then a final transcript once enough audio arrived
+struct WSStandIn {
+    NetSocket listener = INVALID_NET_SOCKET;
+    int port = 0;
+    size_t partialAfterBytes = 0;
+    size_t finalAfterBytes = 0;
+    std::atomic<size_t> audioBytes{0};
+    std::atomic<bool> handshakeOK{false};
+    std::atomic<bool> sawStartMessage{false};
+    std::thread thread;
+};
+
+static bool readWSFrame(NetSocket sock, std::string& extra, int& opcode, std::string& payload) {
+    std::string header;
+    if (!standin::readExactly(sock, 2, header, extra)) return false;
+    opcode = (unsigned char)header[0] & 0x0F;
+    bool masked = ((unsigned char)header[1] & 0x80) != 0;
+    uint64_t length = (unsigned char)header[1] & 0x7F;
+    std::string ext;
+    if (length == 126) {
+        if (!standin::readExactly(sock, 2, ext, extra)) return false;
+        length = ((unsigned char)ext[0] << 8) | (unsigned char)ext[1];
+    } else if (length == 127) {
+        if (!standin::readExactly(sock, 8, ext, extra)) return false;
+        length = 0;
+        for (int i = 0; i < 8; i++) length = (length << 8) | (unsigned char)ext[i];
+    }
+    std::string mask;
+    if (masked && !standin::readExactly(sock, 4, mask, extra)) return false;
+    if (!standin::readExactly(sock, (size_t)length, payload, extra)) return false;
+    if (masked) {
+        for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i & 3];
+    }
+    return true;
+}
+
+static void sendWSText(NetSocket sock, const std::string& text) {
+    std::string frame;
+    frame.push_back((char)0x81);
+    frame.push_back((char)text.size()); // Test messages stay under 126 bytes
+    frame += text;
+    sendAll(sock, frame.data(), frame.size());
+}
+
+static void runWSStandIn(WSStandIn* server) {
+    NetSocket client = standin::acceptClient(server->listener, 5000);
+    if (client == INVALID_NET_SOCKET) return;
+
+    std::string head, extra;
+    if (standin::readUntil(client, "\r\n\r\n", head, extra)) {
+        size_t keyPos = head.find("Sec-WebSocket-Key: ");
+        if (keyPos != std::string::npos) {
+            size_t keyEnd = head.find("\r\n", keyPos);
+            std::string key = head.substr(keyPos + 19, keyEnd == std::string::npos ? std::string::npos : keyEnd - keyPos - 19);
+            std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                                   "Upgrade: websocket\r\n"
+                                   "Connection: Upgrade\r\n"
+                                   "Sec-WebSocket-Accept: " + computeWebSocketAccept(key) + "\r\n\r\n";
+            sendAll(client, response.data(), response.size());
+            server->handshakeOK = true;
+
+            bool sentPartial = false;
+            bool sentFinal = false;
+            int opcode;
+            std::string payload;
+            while (readWSFrame(client, extra, opcode, payload)) {
+                if (opcode == 0x1 && payload.find("\"start\"") != std::string::npos) {
+                    server->sawStartMessage = true;
+                } else if (opcode == 0x2) {
+                    server->audioBytes += payload.size();
+                    if (!sentPartial && server->audioBytes >= server->partialAfterBytes) {
+                        sendWSText(client, "{\"type\":\"partial\",\"text\":\"hello\"}");
+                        sentPartial = true;
+                    }
+                    if (!sentFinal && server->audioBytes >= server->finalAfterBytes) {
+                        sendWSText(client, "{\"type\":\"final\",\"text\":\"hello world\"}");
+                        sentFinal = true;
+                    }
+                } else if (opcode == 0x8) {
+                    const char closeFrame[4] = {(char)0x88, 0x02, (char)0x03, (char)0xE8};
+                    sendAll(client, closeFrame, sizeof(closeFrame));
+                    break;
+                }
+            }
+        }
+    }
+    closeNetSocket(client);
+}
+
+static bool startWSStandIn(WSStandIn& server, size_t partialAfterBytes, size_t finalAfterBytes) {
+    server.listener = standin::listenLoopback(server.port);
+    if (server.listener == INVALID_NET_SOCKET) return false;
+    server.partialAfterBytes = partialAfterBytes;
+    server.finalAfterBytes = finalAfterBytes;
+    server.thread = std::thread(runWSStandIn, &server);
+    return true;
+}
+
+static void stopWSStandIn(WSStandIn& server) {
+    if (server.thread.joinable()) server.thread.join();
+    closeNetSocket(server.listener);
+    server.listener = INVALID_NET_SOCKET;
+}
+
+template <typename Pred>
+static bool waitFor(Pred pred, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
+
+// RFC 6455 section 1.3 worked example
+void TestSTTStreamHandshakeAccept(test::TestContext& ctx) {
+    ASSERT_STR_EQ("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=", computeWebSocketAccept("dGhlIHNhbXBsZSBub25jZQ=="));
+}
+
+// Stream PCM to a stand-in server and receive partial + final transcripts
+void TestSTTStreamReceivesTranscript(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+
+    const int sampleRate = 16000;
+    WSStandIn server;
+    ASSERT_TRUE(startWSStandIn(server, sampleRate / 5 * sizeof(short), sampleRate / 2 * sizeof(short)));
+
+    ASSERT_TRUE(startSTTStream("127.0.0.1", server.port, "/v1/audio/stream", sampleRate, 20));
+    bool connected = waitFor([] { return isSTTStreamConnected(); }, 3000);
+
+    // Push 0.6s of audio in 20ms capture blocks
+    std::vector<short> block(sampleRate / 50, 1000);
+    const uint64_t startClock = 1000; // Capture clock when the stream came up
+    for (int i = 0; connected && i < 30; i++) {
+        pushSTTStreamSamples(block.data(), (int)block.size(), startClock + i * block.size());
+    }
+    bool gotFinal = waitFor([] { return getSTTStreamStats().finalCount > 0; }, 3000);
+
+    bool isFinal = false;
+    std::string transcript = getLatestTranscript(&isFinal);
+    STTStreamStats stats = getSTTStreamStats();
+    std::vector<STTStreamCoverage> streaming, stopped;
+    takeSTTStreamCoverage(streaming);
+    stopSTTStream();
+    takeSTTStreamCoverage(stopped);
+    stopWSStandIn(server);
+
+    ASSERT_TRUE(connected);
+    ASSERT_TRUE(server.handshakeOK);
+    ASSERT_TRUE(server.sawStartMessage);
+    ASSERT_TRUE(gotFinal);
+    ASSERT_STR_EQ("hello world", transcript);
+    ASSERT_TRUE(isFinal);
+    ASSERT_EQ(1, stats.partialCount);
+    ASSERT_EQ(1, stats.finalCount);
+    ASSERT_TRUE(stats.samplesSent >= (uint64_t)(sampleRate / 2));
+    ASSERT_TRUE(stats.bytesSent > stats.samplesSent * sizeof(short));
+    ASSERT_FALSE(isSTTStreamConnected());
+
+    // The connection carried the capture clock from its first block; once
+    // closed, only what left the socket counts
+    ASSERT_EQ((size_t)1, streaming.size());
+    ASSERT_TRUE(streaming[0].open);
+    ASSERT_EQ(startClock, streaming[0].from);
+    ASSERT_TRUE(streaming[0].to <= startClock + stats.samplesSent);
+    ASSERT_EQ((size_t)1, stopped.size());
+    ASSERT_FALSE(stopped[0].open);
+    ASSERT_EQ(startClock, stopped[0].from);
+    ASSERT_TRUE(stopped[0].to >= streaming[0].to && stopped[0].to <= startClock + stats.samplesSent);
+}
+
+// With no server listening the stream stays disconnected and stop returns promptly
+void TestSTTStreamNoServer(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+
+    int port = 0;
+    NetSocket probe = standin::listenLoopback(port);
+    ASSERT_TRUE(probe != INVALID_NET_SOCKET);
+    closeNetSocket(probe); // Port is now (almost certainly) closed
+
+    ASSERT_TRUE(startSTTStream("127.0.0.1", port, "/v1/audio/stream", 16000, 20));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(isSTTStreamConnected());
+
+    short samples[320] = {0};
+    pushSTTStreamSamples(samples, 320, 0); // Dropped while disconnected
+    std::vector<STTStreamCoverage> coverage;
+    ASSERT_FALSE(takeSTTStreamCoverage(coverage));
+
+    auto start = std::chrono::steady_clock::now();
+    stopSTTStream();
+    double stopSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_TRUE(stopSeconds < 1.0);
+    ASSERT_EQ((uint64_t)0, getSTTStreamStats().framesSent);
+}
+
+// Time-to-first-word and bytes per audio second: streaming vs the 3s POST window
+void BenchmarkSTTTimeToFirstWord(test::BenchContext& b) {
+    b.RunOnce();
+    initNetwork();
+
+    const int sampleRate = 16000;
+    const int frameMs = 20;
+    const double firstWordSeconds = 0.5; // Stand-in recognises the first word after 0.5s of audio
+
+    // Streaming: real-time paced capture blocks, first word arrives as a partial
+    WSStandIn server;
+    size_t firstWordBytes = (size_t)(sampleRate * firstWordSeconds) * sizeof(short);
+    if (!startWSStandIn(server, firstWordBytes, firstWordBytes * 2)) return;
+    startSTTStream("127.0.0.1", server.port, "/v1/audio/stream", sampleRate, frameMs);
+    waitFor([] { return isSTTStreamConnected(); }, 3000);
+
+    std::vector<short> block(sampleRate * frameMs / 1000, 1000);
+    auto speechStart = std::chrono::steady_clock::now();
+    double streamFirstWordMs = -1.0;
+    for (int i = 0; i < 2000 / frameMs && streamFirstWordMs < 0.0; i++) {
+        pushSTTStreamSamples(block.data(), (int)block.size(), (uint64_t)i * block.size());
+        std::this_thread::sleep_until(speechStart + std::chrono::milliseconds((i + 1) * frameMs));
+        if (getSTTStreamStats().partialCount > 0) {
+            streamFirstWordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - speechStart).count();
+        }
+    }
+    STTStreamStats stats = getSTTStreamStats();
+    double streamedSeconds = (double)stats.samplesSent / sampleRate;
+    stopSTTStream();
+    stopWSStandIn(server);
+
+    // POST: the whole 3s window must be captured before the request goes out,
+    // so first word = window + request round trip (measured against a stand-in)
+    const double windowSeconds = 3.0;
+    int httpPort = 0;
+    NetSocket httpListener = standin::listenLoopback(httpPort);
+    std::atomic<size_t> postBytes{0};
+    std::thread httpServer([&] {
+        NetSocket client = standin::acceptClient(httpListener, 5000);
+        std::string head, body;
+        if (client != INVALID_NET_SOCKET && standin::readHTTPRequest(client, head, body)) {
+            postBytes = head.size() + 4 + body.size();
+            standin::sendHTTPResponse(client, 200, "{\"text\":\"hello world\"}");
+        }
+        closeNetSocket(client);
+    });
+    std::vector<short> window((size_t)(sampleRate * windowSeconds), 1000);
+    auto postStart = std::chrono::steady_clock::now();
+    sendAudioToWhisper(window, sampleRate, "127.0.0.1", httpPort);
+    double postRoundTripMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - postStart).count();
+    httpServer.join();
+    closeNetSocket(httpListener);
+
+    b.ReportMetric(streamFirstWordMs, "ms/first-word-stream");
+    b.ReportMetric(windowSeconds * 1000.0 + postRoundTripMs, "ms/first-word-post");
+    if (streamedSeconds > 0.0) {
+        b.ReportMetric((double)stats.bytesSent / streamedSeconds, "B/audio-s-stream");
+    }
+    b.ReportMetric((double)postBytes / windowSeconds, "B/audio-s-post");
+}
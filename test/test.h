@@ -108,6 +108,42 @@ public:
     }
 };
 
+// Benchmark context similar to Go's testing.B
+// The benchmark body runs its workload N times; the runner grows N until the
+// run takes long enough to time reliably
+class BenchContext {
+private:
+    bool single_run;
+    std::vector<std::pair<std::string, double>> metrics;
+    
+public:
+    int N;
+    
+    BenchContext() : single_run(false), N(1) {}
+    
+    // Scenario benchmarks (stand-in servers, real-time pacing) run exactly once
+    void RunOnce() {
+        single_run = true;
+    }
+    
+    bool IsSingleRun() const {
+        return single_run;
+    }
+    
+    // Report an extra result, e.g. ReportMetric(12.5, "ms/first-word")
+    void ReportMetric(double value, const std::string& unit) {
+        metrics.push_back({unit, value});
+    }
+    
+    void ResetMetrics() {
+        metrics.clear();
+    }
+    
+    const std::vector<std::pair<std::string, double>>& Metrics() const {
+        return metrics;
+    }
+};
+
 // Global test context
 extern TestContext* g_test_ctx;
 
@@ -217,6 +253,9 @@ extern TestContext* g_test_ctx;
 namespace test {
     extern std::vector<std::pair<std::string, std::function<void(TestContext&)>>> test_functions;
     void RegisterTest(const std::string& name, std::function<void(TestContext&)> func);
+    
+    extern std::vector<std::pair<std::string, std::function<void(BenchContext&)>>> bench_functions;
+    void RegisterBenchmark(const std::string& name, std::function<void(BenchContext&)> func);
 }
 
 // Macro to register a test function (now included in DEFINE_TEST)
@@ -1,23 +1,72 @@
 #include "test.h"
 #include <chrono>
+#include <cstring>
 
 using namespace std::chrono;
 
 // Test registry implementation
 namespace test {
     std::vector<std::pair<std::string, std::function<void(TestContext&)>>> test_functions;
+    std::vector<std::pair<std::string, std::function<void(BenchContext&)>>> bench_functions;
     
     void RegisterTest(const std::string& name, std::function<void(TestContext&)> func) {
         test_functions.push_back({name, func});
     }
+    
+    void RegisterBenchmark(const std::string& name, std::function<void(BenchContext&)> func) {
+        bench_functions.push_back({name, func});
+    }
 }
 
 // Forward declaration
 extern void RegisterAllTests();
+extern void RegisterAllBenchmarks();
+
+// Run benchmarks whose name contains filter (like `go test -bench`)
+// N grows by 10x until a run takes at least one second
+static int runBenchmarks(const std::string& filter) {
+    RegisterAllBenchmarks();
+    std::cout << "Running benchmarks..." << std::endl;
+    std::cout << "=================" << std::endl;
+    
+    for (const auto& [name, func] : test::bench_functions) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+        
+        test::BenchContext ctx;
+        double elapsed_ns = 0.0;
+        for (int n = 1; ; n = (n > 100000000) ? 1000000000 : n * 10) {
+            ctx.N = n;
+            ctx.ResetMetrics();
+            auto start = high_resolution_clock::now();
+            try {
+                func(ctx);
+            } catch (const std::exception& e) {
+                std::cout << "Benchmark" << name << " failed: " << e.what() << std::endl;
+                break;
+            }
+            elapsed_ns = (double)duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+            if (ctx.IsSingleRun() || elapsed_ns >= 1e9 || n >= 1000000000) {
+                break;
+            }
+        }
+        
+        std::cout << "Benchmark" << name << "\t" << ctx.N << "\t"
+                  << std::fixed << std::setprecision(1) << (elapsed_ns / ctx.N) << " ns/op";
+        for (const auto& [unit, value] : ctx.Metrics()) {
+            std::cout << "\t" << std::setprecision(3) << value << " " << unit;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    (void)argc;  // Suppress unused parameter warning
-    (void)argv;  // Suppress unused parameter warning
+    // `test_runner -bench [filter]` runs benchmarks instead of tests
+    if (argc > 1 && std::strcmp(argv[1], "-bench") == 0) {
+        return runBenchmarks(argc > 2 ? argv[2] : "");
+    }
     
     std::cout << "Running tests..." << std::endl;
     std::cout << "=================" << std::endl;
@@ -17,6 +17,98 @@ extern void TestAudioUpdate(test::TestContext& ctx);
 extern void TestColorHexParsing(test::TestContext& ctx);
 extern void TestColorHexNoHash(test::TestContext& ctx);
 extern void TestColorRGBParsing(test::TestContext& ctx);
+extern void TestSTTStreamHandshakeAccept(test::TestContext& ctx);
+extern void TestSTTStreamReceivesTranscript(test::TestContext& ctx);
+extern void TestSTTStreamNoServer(test::TestContext& ctx);
+extern void TestSTTSpoolDrainsInOrderAfterOutage(test::TestContext& ctx);
+extern void TestSTTSpoolSurvivesRestart(test::TestContext& ctx);
+extern void TestSTTSpoolRejectsOversizedRecord(test::TestContext& ctx);
+extern void TestSTTSpoolBoundedDropsOldest(test::TestContext& ctx);
+extern void TestSTTSpoolDropsRejectedRecord(test::TestContext& ctx);
+extern void TestSTTRouterParseEndpoints(test::TestContext& ctx);
+extern void TestSTTRouterPrefersFastEndpoint(test::TestContext& ctx);
+extern void TestSTTRouterHedgesTailLatency(test::TestContext& ctx);
+extern void TestSTTRouterEjectsDeadEndpoint(test::TestContext& ctx);
+extern void TestSTTRouterHalfOpenProbe(test::TestContext& ctx);
+extern void TestNetReactorEpollBackend(test::TestContext& ctx);
+extern void TestNetReactorPollBackend(test::TestContext& ctx);
+extern void TestNetReactorShutdownFailsPending(test::TestContext& ctx);
+extern void TestTranscriptParserSegments(test::TestContext& ctx);
+extern void TestTranscriptParserReplies(test::TestContext& ctx);
+extern void TestTranscriptBusConcurrent(test::TestContext& ctx);
+extern void TestTranscriptFromWhisperReply(test::TestContext& ctx);
+extern void TestSTTSessionChunking(test::TestContext& ctx);
+extern void TestSTTSessionUploadCoverage(test::TestContext& ctx);
+extern void TestSTTSessionStreamCoverage(test::TestContext& ctx);
+extern void TestFFTMatchesDFT(test::TestContext& ctx);
+extern void TestKWSDetectsWakePhrase(test::TestContext& ctx);
+extern void TestKWSWakeGateOpensSession(test::TestContext& ctx);
+extern void TestDSPHighpassResponse(test::TestContext& ctx);
+extern void TestDSPAGCConverges(test::TestContext& ctx);
+extern void TestDSPNoiseGateHysteresis(test::TestContext& ctx);
+extern void TestGCCPHATDelay(test::TestContext& ctx);
+extern void TestBeamformerLocatesTalker(test::TestContext& ctx);
+extern void TestBeamformerImprovesSNR(test::TestContext& ctx);
+extern void TestFileCaptureBeamformsArray(test::TestContext& ctx);
+extern void TestSharedAudioRoundTrip(test::TestContext& ctx);
+extern void TestSharedAudioLappedReader(test::TestContext& ctx);
+extern void TestResamplerTones(test::TestContext& ctx);
+extern void TestSidecarPumpUploads(test::TestContext& ctx);
+extern void TestInputQueueOverflow(test::TestContext& ctx);
+extern void TestGesturesIndependentOfFrameRate(test::TestContext& ctx);
+extern void TestGestureTetraClickRegion(test::TestContext& ctx);
+extern void TestHitTestZOrderAndMargins(test::TestContext& ctx);
+extern void TestHitTestMatchesLinearScan(test::TestContext& ctx);
+extern void TestHitTestAdminTabs(test::TestContext& ctx);
+extern void TestTransitionProgress(test::TestContext& ctx);
+extern void TestDissolveTiles(test::TestContext& ctx);
+extern void TestJobsHammerFineGrained(test::TestContext& ctx);
+extern void TestJobsParallelForCoversRange(test::TestContext& ctx);
+extern void TestJobsDependencies(test::TestContext& ctx);
+extern void TestPhiloxKnownAnswers(test::TestContext& ctx);
+extern void TestRandomBatchMatchesScalar(test::TestContext& ctx);
+extern void TestRandomStreamsReproducible(test::TestContext& ctx);
+extern void TestRandomStatistics(test::TestContext& ctx);
+extern void TestSceneDiffWidgets(test::TestContext& ctx);
+extern void TestSceneWatcherReloads(test::TestContext& ctx);
+extern void TestWaveformFollowsAudioClock(test::TestContext& ctx);
+extern void TestWaveformPyramidMatchesBruteForce(test::TestContext& ctx);
+extern void TestWaveformPyramidFixedMemory(test::TestContext& ctx);
+extern void TestLatencyHistogramPercentiles(test::TestContext& ctx);
+extern void TestLatencyLoopbackClicks(test::TestContext& ctx);
+extern void TestSnapshotQOIRoundTrip(test::TestContext& ctx);
+extern void TestSnapshotDownscale(test::TestContext& ctx);
+extern void TestSnapshotServicePublishes(test::TestContext& ctx);
+extern void TestMirrorGroups(test::TestContext& ctx);
+extern void TestMirrorContentKey(test::TestContext& ctx);
+extern void TestStartupGraphOrder(test::TestContext& ctx);
+extern void TestWidgetAnimationKeyframes(test::TestContext& ctx);
+extern void TestWidgetAnimationBatchMatchesReference(test::TestContext& ctx);
+extern void TestSceneLoadWithAnimations(test::TestContext& ctx);
+extern void TestAtlasPacking(test::TestContext& ctx);
+extern void TestAtlasQuad(test::TestContext& ctx);
+extern void TestGLStateElision(test::TestContext& ctx);
+extern void TestGLStateInvalidate(test::TestContext& ctx);
+
+extern void BenchmarkSTTTimeToFirstWord(test::BenchContext& b);
+extern void BenchmarkSTTRouterTailLatency(test::BenchContext& b);
+extern void BenchmarkNetReactorConcurrentRequests(test::BenchContext& b);
+extern void BenchmarkTranscriptParse(test::BenchContext& b);
+extern void BenchmarkTranscriptDeliveryDelay(test::BenchContext& b);
+extern void BenchmarkKWSDetector(test::BenchContext& b);
+extern void BenchmarkCaptureDSP(test::BenchContext& b);
+extern void BenchmarkBeamformer(test::BenchContext& b);
+extern void BenchmarkSidecarRenderCPU(test::BenchContext& b);
+extern void BenchmarkHitTest(test::BenchContext& b);
+extern void BenchmarkJobScaling(test::BenchContext& b);
+extern void BenchmarkRandomGeneration(test::BenchContext& b);
+extern void BenchmarkWaveformPyramidRead(test::BenchContext& b);
+extern void BenchmarkSnapshot(test::BenchContext& b);
+extern void BenchmarkMirrorFrameCost(test::BenchContext& b);
+extern void BenchmarkStartup(test::BenchContext& b);
+extern void BenchmarkWidgetAnimations(test::BenchContext& b);
+extern void BenchmarkSceneAtlas(test::BenchContext& b);
+extern void BenchmarkGLStateFrame(test::BenchContext& b);
 
 void RegisterAllTests() {
     test::RegisterTest("SceneLoadCFileIO", TestSceneLoadCFileIO);
@@ -32,4 +124,98 @@ void RegisterAllTests() {
     test::RegisterTest("ColorHexParsing", TestColorHexParsing);
     test::RegisterTest("ColorHexNoHash", TestColorHexNoHash);
     test::RegisterTest("ColorRGBParsing", TestColorRGBParsing);
+    test::RegisterTest("STTStreamHandshakeAccept", TestSTTStreamHandshakeAccept);
+    test::RegisterTest("STTStreamReceivesTranscript", TestSTTStreamReceivesTranscript);
+    test::RegisterTest("STTStreamNoServer", TestSTTStreamNoServer);
+    test::RegisterTest("STTSpoolDrainsInOrderAfterOutage", TestSTTSpoolDrainsInOrderAfterOutage);
+    test::RegisterTest("STTSpoolSurvivesRestart", TestSTTSpoolSurvivesRestart);
+    test::RegisterTest("STTSpoolRejectsOversizedRecord", TestSTTSpoolRejectsOversizedRecord);
+    test::RegisterTest("STTSpoolBoundedDropsOldest", TestSTTSpoolBoundedDropsOldest);
+    test::RegisterTest("STTSpoolDropsRejectedRecord", TestSTTSpoolDropsRejectedRecord);
+    test::RegisterTest("STTRouterParseEndpoints", TestSTTRouterParseEndpoints);
+    test::RegisterTest("STTRouterPrefersFastEndpoint", TestSTTRouterPrefersFastEndpoint);
+    test::RegisterTest("STTRouterHedgesTailLatency", TestSTTRouterHedgesTailLatency);
+    test::RegisterTest("STTRouterEjectsDeadEndpoint", TestSTTRouterEjectsDeadEndpoint);
+    test::RegisterTest("STTRouterHalfOpenProbe", TestSTTRouterHalfOpenProbe);
+    test::RegisterTest("NetReactorEpollBackend", TestNetReactorEpollBackend);
+    test::RegisterTest("NetReactorPollBackend", TestNetReactorPollBackend);
+    test::RegisterTest("NetReactorShutdownFailsPending", TestNetReactorShutdownFailsPending);
+    test::RegisterTest("TranscriptParserSegments", TestTranscriptParserSegments);
+    test::RegisterTest("TranscriptParserReplies", TestTranscriptParserReplies);
+    test::RegisterTest("TranscriptBusConcurrent", TestTranscriptBusConcurrent);
+    test::RegisterTest("TranscriptFromWhisperReply", TestTranscriptFromWhisperReply);
+    test::RegisterTest("STTSessionChunking", TestSTTSessionChunking);
+    test::RegisterTest("STTSessionUploadCoverage", TestSTTSessionUploadCoverage);
+    test::RegisterTest("STTSessionStreamCoverage", TestSTTSessionStreamCoverage);
+    test::RegisterTest("FFTMatchesDFT", TestFFTMatchesDFT);
+    test::RegisterTest("KWSDetectsWakePhrase", TestKWSDetectsWakePhrase);
+    test::RegisterTest("KWSWakeGateOpensSession", TestKWSWakeGateOpensSession);
+    test::RegisterTest("DSPHighpassResponse", TestDSPHighpassResponse);
+    test::RegisterTest("DSPAGCConverges", TestDSPAGCConverges);
+    test::RegisterTest("DSPNoiseGateHysteresis", TestDSPNoiseGateHysteresis);
+    test::RegisterTest("GCCPHATDelay", TestGCCPHATDelay);
+    test::RegisterTest("BeamformerLocatesTalker", TestBeamformerLocatesTalker);
+    test::RegisterTest("BeamformerImprovesSNR", TestBeamformerImprovesSNR);
+    test::RegisterTest("FileCaptureBeamformsArray", TestFileCaptureBeamformsArray);
+    test::RegisterTest("SharedAudioRoundTrip", TestSharedAudioRoundTrip);
+    test::RegisterTest("SharedAudioLappedReader", TestSharedAudioLappedReader);
+    test::RegisterTest("ResamplerTones", TestResamplerTones);
+    test::RegisterTest("SidecarPumpUploads", TestSidecarPumpUploads);
+    test::RegisterTest("InputQueueOverflow", TestInputQueueOverflow);
+    test::RegisterTest("GesturesIndependentOfFrameRate", TestGesturesIndependentOfFrameRate);
+    test::RegisterTest("GestureTetraClickRegion", TestGestureTetraClickRegion);
+    test::RegisterTest("HitTestZOrderAndMargins", TestHitTestZOrderAndMargins);
+    test::RegisterTest("HitTestMatchesLinearScan", TestHitTestMatchesLinearScan);
+    test::RegisterTest("HitTestAdminTabs", TestHitTestAdminTabs);
+    test::RegisterTest("TransitionProgress", TestTransitionProgress);
+    test::RegisterTest("DissolveTiles", TestDissolveTiles);
+    test::RegisterTest("JobsHammerFineGrained", TestJobsHammerFineGrained);
+    test::RegisterTest("JobsParallelForCoversRange", TestJobsParallelForCoversRange);
+    test::RegisterTest("JobsDependencies", TestJobsDependencies);
+    test::RegisterTest("PhiloxKnownAnswers", TestPhiloxKnownAnswers);
+    test::RegisterTest("RandomBatchMatchesScalar", TestRandomBatchMatchesScalar);
+    test::RegisterTest("RandomStreamsReproducible", TestRandomStreamsReproducible);
+    test::RegisterTest("RandomStatistics", TestRandomStatistics);
+    test::RegisterTest("SceneDiffWidgets", TestSceneDiffWidgets);
+    test::RegisterTest("SceneWatcherReloads", TestSceneWatcherReloads);
+    test::RegisterTest("WaveformFollowsAudioClock", TestWaveformFollowsAudioClock);
+    test::RegisterTest("WaveformPyramidMatchesBruteForce", TestWaveformPyramidMatchesBruteForce);
+    test::RegisterTest("WaveformPyramidFixedMemory", TestWaveformPyramidFixedMemory);
+    test::RegisterTest("LatencyHistogramPercentiles", TestLatencyHistogramPercentiles);
+    test::RegisterTest("LatencyLoopbackClicks", TestLatencyLoopbackClicks);
+    test::RegisterTest("SnapshotQOIRoundTrip", TestSnapshotQOIRoundTrip);
+    test::RegisterTest("SnapshotDownscale", TestSnapshotDownscale);
+    test::RegisterTest("SnapshotServicePublishes", TestSnapshotServicePublishes);
+    test::RegisterTest("MirrorGroups", TestMirrorGroups);
+    test::RegisterTest("MirrorContentKey", TestMirrorContentKey);
+    test::RegisterTest("StartupGraphOrder", TestStartupGraphOrder);
+    test::RegisterTest("WidgetAnimationKeyframes", TestWidgetAnimationKeyframes);
+    test::RegisterTest("WidgetAnimationBatchMatchesReference", TestWidgetAnimationBatchMatchesReference);
+    test::RegisterTest("SceneLoadWithAnimations", TestSceneLoadWithAnimations);
+    test::RegisterTest("AtlasPacking", TestAtlasPacking);
+    test::RegisterTest("AtlasQuad", TestAtlasQuad);
+    test::RegisterTest("GLStateElision", TestGLStateElision);
+    test::RegisterTest("GLStateInvalidate", TestGLStateInvalidate);
+}
+
+void RegisterAllBenchmarks() {
+    test::RegisterBenchmark("STTTimeToFirstWord", BenchmarkSTTTimeToFirstWord);
+    test::RegisterBenchmark("STTRouterTailLatency", BenchmarkSTTRouterTailLatency);
+    test::RegisterBenchmark("NetReactorConcurrentRequests", BenchmarkNetReactorConcurrentRequests);
+    test::RegisterBenchmark("TranscriptParse", BenchmarkTranscriptParse);
+    test::RegisterBenchmark("TranscriptDeliveryDelay", BenchmarkTranscriptDeliveryDelay);
+    test::RegisterBenchmark("KWSDetector", BenchmarkKWSDetector);
+    test::RegisterBenchmark("CaptureDSP", BenchmarkCaptureDSP);
+    test::RegisterBenchmark("Beamformer", BenchmarkBeamformer);
+    test::RegisterBenchmark("SidecarRenderCPU", BenchmarkSidecarRenderCPU);
+    test::RegisterBenchmark("HitTest", BenchmarkHitTest);
+    test::RegisterBenchmark("JobScaling", BenchmarkJobScaling);
+    test::RegisterBenchmark("RandomGeneration", BenchmarkRandomGeneration);
+    test::RegisterBenchmark("WaveformPyramidRead", BenchmarkWaveformPyramidRead);
+    test::RegisterBenchmark("Snapshot", BenchmarkSnapshot);
+    test::RegisterBenchmark("MirrorFrameCost", BenchmarkMirrorFrameCost);
+    test::RegisterBenchmark("Startup", BenchmarkStartup);
+    test::RegisterBenchmark("WidgetAnimations", BenchmarkWidgetAnimations);
+    test::RegisterBenchmark("SceneAtlas", BenchmarkSceneAtlas);
+    test::RegisterBenchmark("GLStateFrame", BenchmarkGLStateFrame);
 }
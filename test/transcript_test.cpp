@@ -0,0 +1,232 @@
+#include "test.h"
+#include "stand_in_server.h"
+#include "../display/network.h"
+#include "../display/transcript.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Whisper verbose_json reply with n segments
+static std::string verboseReply(int segments) {
+    std::ostringstream json;
+    json << "{\"task\":\"transcribe\",\"language\":\"english\",\"duration\":" << segments * 2.5 << ",\"text\":\"";
+    for (int i = 0; i < segments; i++) json << " segment " << i;
+    json << "\",\"segments\":[";
+    for (int i = 0; i < segments; i++) {
+        if (i > 0) json << ",";
+        json << "{\"id\":" << i << ",\"seek\":0,\"start\":" << i * 2.5 << ",\"end\":" << (i + 1) * 2.5
+             << ",\"text\":\" segment " << i << "\",\"tokens\":[50364,1024,2048,50489],\"temperature\":0.0"
+             << ",\"avg_logprob\":-0.105,\"compression_ratio\":1.2,\"no_speech_prob\":0.01}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+static void drainBus() {
+    TranscriptEvent discard;
+    while (pollTranscriptEvent(discard)) {
+    }
+    clearTranscriptView();
+}
+
+// Segments survive any chunking: feed one byte at a time
+void TestTranscriptParserSegments(test::TestContext& ctx) {
+    std::string reply = "{\"text\":\" Caf\\u00e9 \\\"open\\\". Next\",\"segments\":["
+                        "{\"id\":0,\"start\":0.0,\"end\":1.5,\"text\":\" Caf\\u00e9 \\\"open\\\".\",\"avg_logprob\":-0.2,"
+                        "\"words\":[{\"word\":\"ignored\",\"start\":0.1}]},"
+                        "{\"id\":1,\"start\":1.5,\"end\":3.25,\"text\":\" Next \\ud83d\\ude00\",\"confidence\":0.5}"
+                        "],\"language\":\"en\"}";
+    TranscriptParser parser;
+    resetTranscriptParser(parser, 42);
+    bool ok = true;
+    for (size_t i = 0; i < reply.size() && ok; i++) {
+        ok = feedTranscriptParser(parser, reply.data() + i, 1);
+    }
+    ASSERT_TRUE(ok);
+    ASSERT_TRUE(finishTranscriptParser(parser));
+    ASSERT_EQ((size_t)2, parser.events.size());
+
+    const TranscriptEvent& first = parser.events[0];
+    ASSERT_EQ((uint64_t)42, first.utteranceId);
+    ASSERT_EQ(0, first.segmentId);
+    ASSERT_STR_EQ("Caf\xc3\xa9 \"open\".", first.text);
+    ASSERT_NEAR(0.0, first.startSeconds, 1e-9);
+    ASSERT_NEAR(1.5, first.endSeconds, 1e-9);
+    ASSERT_NEAR(0.8187, first.confidence, 1e-3);
+    ASSERT_TRUE(first.isFinal);
+
+    const TranscriptEvent& second = parser.events[1];
+    ASSERT_EQ(1, second.segmentId);
+    ASSERT_STR_EQ("Next \xf0\x9f\x98\x80", second.text);
+    ASSERT_NEAR(3.25, second.endSeconds, 1e-9);
+    ASSERT_NEAR(0.5, second.confidence, 1e-6);
+}
+
+void TestTranscriptParserReplies(test::TestContext& ctx) {
+    std::vector<TranscriptEvent> events;
+    ASSERT_TRUE(parseTranscriptJSON("{\"text\": \"hello world\"}", events));
+    ASSERT_EQ((size_t)1, events.size());
+    ASSERT_STR_EQ("hello world", events[0].text);
+    ASSERT_TRUE(events[0].isFinal);
+    ASSERT_TRUE(events[0].startSeconds < 0.0);
+
+    ASSERT_TRUE(parseTranscriptJSON("{\"type\":\"partial\",\"text\":\"hel\"}", events));
+    ASSERT_EQ((size_t)1, events.size());
+    ASSERT_FALSE(events[0].isFinal);
+    ASSERT_TRUE(parseTranscriptJSON("{\"text\":\"hello\",\"is_final\": true}", events));
+    ASSERT_TRUE(events[0].isFinal);
+
+    ASSERT_TRUE(parseTranscriptJSON("{\"type\":\"ready\",\"n\":[1,2,{\"a\":null}]}", events));
+    ASSERT_EQ((size_t)0, events.size()); // No text: not a transcript
+
+    ASSERT_FALSE(parseTranscriptJSON("{\"text\":\"cut off", events));
+    ASSERT_FALSE(parseTranscriptJSON("{\"text\":\"x\"]", events));
+    ASSERT_FALSE(parseTranscriptJSON("{\"text\":\"x\"} trailing", events));
+}
+
+// Several producers, one consumer: nothing lost beyond counted drops, per-producer order kept
+void TestTranscriptBusConcurrent(test::TestContext& ctx) {
+    drainBus();
+    TranscriptBusStats before = getTranscriptBusStats();
+
+    // Bounded: without a consumer the queue holds 256 events and counts the rest as dropped
+    int accepted = 0;
+    for (int i = 0; i < 300; i++) {
+        TranscriptEvent event = TranscriptEvent();
+        event.segmentId = i;
+        if (publishTranscriptEvent(event)) accepted++;
+    }
+    TranscriptBusStats full = getTranscriptBusStats();
+    drainBus();
+    ASSERT_EQ(256, accepted);
+    ASSERT_EQ((uint64_t)44, full.dropped - before.dropped);
+
+    const int producers = 4;
+    const int perProducer = 5000;
+    std::atomic<int> running{producers};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([p, &running] {
+            for (int i = 0; i < perProducer; i++) {
+                TranscriptEvent event = TranscriptEvent();
+                event.utteranceId = (uint64_t)p;
+                event.segmentId = i;
+                event.text = "word";
+                while (!publishTranscriptEvent(event)) {
+                    std::this_thread::yield(); // Full: retry (the consumer is draining)
+                }
+            }
+            running--;
+        });
+    }
+    std::vector<int> lastSeen(producers, -1);
+    int received = 0;
+    bool ordered = true;
+    TranscriptEvent event;
+    while (true) {
+        bool producing = running > 0; // Read before polling so the last pass sees every event
+        if (pollTranscriptEvent(event)) {
+            received++;
+            if (event.segmentId <= lastSeen[event.utteranceId]) ordered = false;
+            lastSeen[event.utteranceId] = event.segmentId;
+        } else if (!producing) {
+            break;
+        }
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    ASSERT_EQ(producers * perProducer, received);
+    ASSERT_TRUE(ordered);
+}
+
+// A Whisper reply reaches the transcript view through the bus
+void TestTranscriptFromWhisperReply(test::TestContext& ctx) {
+    ASSERT_TRUE(initNetwork());
+    drainBus();
+    standin::HTTPServer server;
+    server.replyBody = verboseReply(3);
+    ASSERT_TRUE(standin::startHTTPServer(server, 0));
+    bool sent = sendAudioToWhisper(std::vector<short>(1600, 7), 16000, "127.0.0.1", server.port);
+    standin::stopHTTPServer(server);
+
+    drainTranscriptEvents();
+    std::vector<TranscriptEvent> lines = getTranscriptLines();
+    TranscriptBusStats stats = getTranscriptBusStats();
+    clearTranscriptView();
+
+    ASSERT_TRUE(sent);
+    ASSERT_EQ((size_t)3, lines.size());
+    ASSERT_STR_EQ("segment 0", lines[0].text);
+    ASSERT_STR_EQ("segment 2", lines[2].text);
+    ASSERT_NEAR(5.0, lines[2].startSeconds, 1e-9);
+    ASSERT_EQ(lines[0].utteranceId, lines[2].utteranceId);
+    ASSERT_TRUE(stats.lastDeliveryMs >= 0.0);
+}
+
+// Parse throughput on a 200-segment verbose_json reply fed in TCP-sized chunks
+void BenchmarkTranscriptParse(test::BenchContext& b) {
+    std::string reply = verboseReply(200);
+    const size_t chunk = 1460;
+    size_t segments = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < b.N; i++) {
+        TranscriptParser parser;
+        resetTranscriptParser(parser, (uint64_t)i);
+        for (size_t offset = 0; offset < reply.size(); offset += chunk) {
+            feedTranscriptParser(parser, reply.data() + offset, std::min(chunk, reply.size() - offset));
+        }
+        finishTranscriptParser(parser);
+        segments += parser.events.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    b.ResetMetrics();
+    b.ReportMetric((double)reply.size() * b.N / seconds / (1024.0 * 1024.0), "MB/s");
+    b.ReportMetric((double)segments / seconds, "segments/s");
+}
+
+// Delay from the server's reply being parsed to the event reaching the render thread
+// "spin": consumer polls continuously (queue cost alone); "60fps": drained once per frame
+void BenchmarkTranscriptDeliveryDelay(test::BenchContext& b) {
+    b.RunOnce();
+    initNetwork();
+    drainBus();
+    standin::HTTPServer server;
+    server.replyBody = verboseReply(4);
+    if (!standin::startHTTPServer(server, 0)) return;
+
+    for (int mode = 0; mode < 2; mode++) {
+        std::atomic<bool> done{false};
+        std::vector<double> delays;
+        std::thread render([&] {
+            TranscriptEvent event;
+            while (!done) {
+                while (pollTranscriptEvent(event)) {
+                    delays.push_back((getTranscriptClock() - event.receivedTime) * 1000.0);
+                }
+                if (mode == 1) std::this_thread::sleep_for(std::chrono::microseconds(16667));
+            }
+            while (pollTranscriptEvent(event)) {
+                delays.push_back((getTranscriptClock() - event.receivedTime) * 1000.0);
+            }
+        });
+        std::vector<short> utterance(16000, 1000);
+        for (int i = 0; i < 40; i++) {
+            sendAudioToWhisper(utterance, 16000, "127.0.0.1", server.port);
+            std::this_thread::sleep_for(std::chrono::milliseconds(3 + (i * 7) % 11)); // Replies land at arbitrary frame phases
+        }
+        done = true;
+        render.join();
+
+        std::sort(delays.begin(), delays.end());
+        std::string suffix = mode == 0 ? "-spin" : "-60fps";
+        if (!delays.empty()) {
+            b.ReportMetric(delays[delays.size() / 2], "ms/p50" + suffix);
+            b.ReportMetric(delays[delays.size() * 99 / 100], "ms/p99" + suffix);
+        }
+    }
+    standin::stopHTTPServer(server);
+    clearTranscriptView();
+}
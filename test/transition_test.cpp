@@ -0,0 +1,67 @@
+#include "test.h"
+#include "../display/transition.h"
+
+void TestTransitionProgress(test::TestContext& ctx) {
+    ASSERT_TRUE(parseTransitionEffect("fade") == TransitionEffect::FADE);
+    ASSERT_TRUE(parseTransitionEffect("slide") == TransitionEffect::SLIDE);
+    ASSERT_TRUE(parseTransitionEffect("dissolve") == TransitionEffect::DISSOLVE);
+    ASSERT_TRUE(parseTransitionEffect("none") == TransitionEffect::NONE);
+    ASSERT_TRUE(parseTransitionEffect("") == TransitionEffect::NONE);
+
+    SceneTransition transition;
+    initSceneTransition(transition);
+    // A hard cut never touches GL and never becomes active
+    ASSERT_FALSE(beginSceneTransition(transition, TransitionEffect::NONE, 0.4, 1920, 1080, 10.0));
+    ASSERT_FALSE(transition.active);
+    ASSERT_NEAR(1.0, getTransitionProgress(transition, 10.0), 1e-6);
+
+    transition.active = true;
+    transition.effect = TransitionEffect::FADE;
+    transition.startTime = 10.0;
+    transition.duration = 0.4;
+    ASSERT_NEAR(0.0, getTransitionProgress(transition, 9.0), 1e-6);
+    ASSERT_NEAR(0.0, getTransitionProgress(transition, 10.0), 1e-6);
+    ASSERT_NEAR(0.5, getTransitionProgress(transition, 10.2), 1e-5);
+    ASSERT_NEAR(1.0, getTransitionProgress(transition, 10.4), 1e-6);
+    ASSERT_NEAR(1.0, getTransitionProgress(transition, 11.0), 1e-6);
+
+    // Eased: slow at both ends, never going backwards
+    float previous = 0.0f;
+    for (int i = 1; i <= 100; i++) {
+        float progress = getTransitionProgress(transition, 10.0 + 0.004 * i);
+        ASSERT_TRUE(progress >= previous);
+        previous = progress;
+    }
+    ASSERT_TRUE(getTransitionProgress(transition, 10.02) < 0.05f);
+}
+
+// Every tile goes from opaque to clear, each at its own time
+void TestDissolveTiles(test::TestContext& ctx) {
+    const int tiles = DISSOLVE_TILES_X * DISSOLVE_TILES_Y;
+    int clearedAtHalf = 0;
+    int clearsBeforeNext = 0;
+    for (int tile = 0; tile < tiles; tile++) {
+        ASSERT_NEAR(1.0, getDissolveTileAlpha(tile, 0.0f), 1e-6);
+        ASSERT_NEAR(0.0, getDissolveTileAlpha(tile, 1.0f), 1e-6);
+        float previous = 1.0f;
+        float clearAt = 1.0f;
+        for (int step = 1; step <= 100; step++) {
+            float alpha = getDissolveTileAlpha(tile, step / 100.0f);
+            ASSERT_TRUE(alpha <= previous);
+            if (alpha <= 0.0f && clearAt == 1.0f) clearAt = step / 100.0f;
+            previous = alpha;
+        }
+        if (getDissolveTileAlpha(tile, 0.5f) <= 0.0f) clearedAtHalf++;
+        if (tile + 1 < tiles) {
+            for (int step = 1; step <= 100; step++) {
+                if (getDissolveTileAlpha(tile + 1, step / 100.0f) <= 0.0f) {
+                    if (clearAt < step / 100.0f) clearsBeforeNext++;
+                    break;
+                }
+            }
+        }
+    }
+    // Spread over the transition, not swept in tile order
+    ASSERT_TRUE(clearedAtHalf > tiles / 5 && clearedAtHalf < tiles * 4 / 5);
+    ASSERT_TRUE(clearsBeforeNext > tiles / 4 && clearsBeforeNext < tiles * 3 / 4);
+}
@@ -0,0 +1,148 @@
+#include "test.h"
+#include "../display/waveform_pyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Tone whose loudness drifts, so neighbouring bins differ
+static std::vector<float> driftingTone(size_t count) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        float envelope = 0.5f + 0.5f * sinf(i * 0.0013f);
+        samples[i] = envelope * sinf(i * 0.37f) + 0.05f * sinf(i * 2.9f);
+    }
+    return samples;
+}
+
+// Every column equals min/max/RMS over the samples it claims to cover, and
+// the last column ends at the newest completed bin of its level
+void TestWaveformPyramidMatchesBruteForce(test::TestContext& ctx) {
+    WaveformPyramid pyramid;
+    initWaveformPyramid(pyramid, 100, 4, 2, 4, 64);
+    std::vector<float> samples = driftingTone(1003);
+    for (size_t at = 0; at < samples.size(); at += 7) {
+        appendWaveformSamples(pyramid, samples.data() + at, std::min((size_t)7, samples.size() - at));
+    }
+    ASSERT_EQ((uint64_t)1003, pyramid.samples);
+
+    struct Window { double seconds; int columns; };
+    for (Window window : {Window{1.0, 25}, Window{2.0, 10}, Window{5.0, 13}, Window{10.0, 30}, Window{0.2, 100}}) {
+        WaveformView view;
+        readWaveformView(pyramid, window.seconds, window.columns, view);
+        ASSERT_FALSE(view.columns.empty());
+        ASSERT_TRUE((int)view.columns.size() <= window.columns);
+        uint64_t levelBin = 4u << view.level;
+        ASSERT_EQ((uint64_t)0, view.samplesPerColumn % levelBin);
+        ASSERT_EQ(pyramid.samples / levelBin * levelBin,
+                  view.firstSample + view.columns.size() * view.samplesPerColumn);
+
+        for (size_t c = 0; c < view.columns.size(); c++) {
+            size_t begin = (size_t)(view.firstSample + c * view.samplesPerColumn);
+            float low = samples[begin], high = samples[begin];
+            double sumSquares = 0.0;
+            for (size_t i = begin; i < begin + view.samplesPerColumn; i++) {
+                low = std::min(low, samples[i]);
+                high = std::max(high, samples[i]);
+                sumSquares += (double)samples[i] * samples[i];
+            }
+            const WaveformBin& column = view.columns[c];
+            ASSERT_EQ((uint32_t)view.samplesPerColumn, column.count);
+            ASSERT_NEAR(low, column.min, 1e-6);
+            ASSERT_NEAR(high, column.max, 1e-6);
+            ASSERT_NEAR(sqrt(sumSquares / view.samplesPerColumn), waveformBinRMS(column), 1e-4);
+        }
+    }
+
+    // Wider windows come from coarser levels
+    WaveformView narrow, wide;
+    readWaveformView(pyramid, 0.5, 10, narrow);
+    readWaveformView(pyramid, 10.0, 10, wide);
+    ASSERT_TRUE(wide.level > narrow.level);
+
+    resetWaveformPyramid(pyramid);
+    readWaveformView(pyramid, 1.0, 10, narrow);
+    ASSERT_TRUE(narrow.columns.empty());
+}
+
+// Memory is fixed at init; once level 0 has wrapped, long windows are still
+// served from the coarser levels
+void TestWaveformPyramidFixedMemory(test::TestContext& ctx) {
+    WaveformPyramid pyramid;
+    initWaveformPyramid(pyramid, 1000, 10, 4, 3, 100);
+    size_t bytes = getWaveformPyramidBytes(pyramid);
+    ASSERT_EQ((size_t)3 * 100 * sizeof(WaveformBin), bytes);
+    ASSERT_NEAR(1.0, getWaveformPyramidSpanSeconds(pyramid, 0), 1e-9);
+    ASSERT_NEAR(16.0, getWaveformPyramidSpanSeconds(pyramid, 2), 1e-9);
+
+    std::vector<float> samples = driftingTone(1000);
+    for (int second = 0; second < 20; second++) appendWaveformSamples(pyramid, samples.data(), samples.size());
+    ASSERT_EQ(bytes, getWaveformPyramidBytes(pyramid));
+    for (const WaveformPyramidLevel& level : pyramid.levels) ASSERT_EQ((size_t)100, level.ring.size());
+    ASSERT_EQ((uint64_t)2000, pyramid.levels[0].written);
+    ASSERT_EQ((uint64_t)125, pyramid.levels[2].written);
+
+    WaveformView view;
+    readWaveformView(pyramid, 16.0, 50, view);
+    ASSERT_EQ(2, view.level);
+    ASSERT_EQ((size_t)50, view.columns.size());
+    ASSERT_EQ((uint64_t)20000, view.firstSample + 50 * view.samplesPerColumn);
+
+    // Columns are whole bins: 15 s over 50 columns rounds to 2 level-2 bins
+    // (0.32 s) per column, and only as many columns as the window needs
+    readWaveformView(pyramid, 15.0, 50, view);
+    ASSERT_EQ((uint64_t)320, view.samplesPerColumn);
+    ASSERT_EQ((size_t)47, view.columns.size());
+    ASSERT_NEAR(15.04, view.seconds, 1e-9);
+}
+
+// Render-side read cost against the length of the window shown, after an
+// hour of 44.1 kHz capture: the pyramid reads about one bin per column, a flat
+// history of 30 bars per second is scanned end to end
+void BenchmarkWaveformPyramidRead(test::BenchContext& b) {
+    b.RunOnce();
+    const int sampleRate = 44100;
+    const int columns = 960;
+    WaveformPyramid pyramid;
+    initWaveformPyramid(pyramid, sampleRate);
+    std::vector<float> second = driftingTone(sampleRate);
+    std::vector<float> flatBars;
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < 3600; s++) {
+        appendWaveformSamples(pyramid, second.data(), second.size());
+    }
+    double appendNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                      (3600.0 * sampleRate);
+    for (int bar = 0; bar < 3600 * 30; bar++) flatBars.push_back(0.5f + 0.5f * sinf(bar * 0.01f));
+
+    volatile float sink = 0.0f;
+    const int reads = 200;
+    for (double seconds : {10.0, 60.0, 600.0, 3600.0}) {
+        WaveformView view;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reads; r++) {
+            readWaveformView(pyramid, seconds, columns, view);
+            sink = sink + view.columns.back().max;
+        }
+        double pyramidNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reads;
+
+        std::vector<float> peaks(columns);
+        size_t bars = (size_t)(seconds * 30);
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reads; r++) {
+            std::fill(peaks.begin(), peaks.end(), 0.0f);
+            for (size_t i = 0; i < bars; i++) {
+                size_t column = i * columns / bars;
+                peaks[column] = std::max(peaks[column], flatBars[flatBars.size() - bars + i]);
+            }
+            sink = sink + peaks[columns - 1];
+        }
+        double flatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / reads;
+
+        std::string window = std::to_string((int)seconds) + "s";
+        b.ReportMetric(pyramidNs, "ns/read-pyramid-" + window);
+        b.ReportMetric(flatNs, "ns/read-flat-" + window);
+    }
+    b.ReportMetric(appendNs, "ns/sample-append");
+    b.ReportMetric((double)getWaveformPyramidBytes(pyramid) / 1024.0, "KiB");
+}